@@ -90,6 +90,15 @@ bmp_input_imageio_create()
 }
 
 OIIO_EXPORT const char* bmp_input_extensions[] = { "bmp", "dib", nullptr };
+OIIO_EXPORT const char* bmp_imageio_signatures[] = {
+    "424d",  // BM
+    "4241",  // BA
+    "4349",  // CI
+    "4350",  // CP
+    "4943",  // IC
+    "5054",  // PT
+    nullptr
+};
 
 OIIO_PLUGIN_EXPORTS_END
 
@@ -25,3 +25,49 @@ for t in image_span_test span_test ; do
     echo "========================================================"
     echo
 done
+
+
+# Startup time of a command-line tool on a single small file, which is
+# dominated by library initialization and plugin cataloging rather than by
+# reading pixels. It's timed without a plugin index, with a "cold" index
+# (deleted before every run, so each run scans the plugins and rewrites it),
+# and with a "warm" index left over from the previous run.
+t=iinfo-startup
+iters=50
+plugin_index=build/benchmarks/plugin_index.txt
+# Sub-second wall clock time (date's %N isn't portable to macOS)
+timestamp () {
+    if [[ -n "${EPOCHREALTIME}" ]] ; then
+        echo "${EPOCHREALTIME/,/.}"
+    else
+        python3 -c "import time; print(time.time())"
+    fi
+}
+# Usage: time_iinfo <label> <OPENIMAGEIO_OPTIONS> <remove index each run?>
+time_iinfo () {
+    local start end
+    start=$(timestamp)
+    for ((i = 0 ; i < iters ; i++)) ; do
+        if [[ "$3" == "1" ]] ; then
+            rm -f ${plugin_index}
+        fi
+        OPENIMAGEIO_OPTIONS="$2" \
+            ${BUILD_BIN_DIR}/iinfo testsuite/common/tahoe-tiny.tif > /dev/null
+    done
+    end=$(timestamp)
+    awk -v s=$start -v e=$end -v n=$iters -v label="$1" \
+        'BEGIN { printf "iinfo on one small file, %s: %.2f ms per run (%d runs)\n", label, (e - s) * 1000 / n, n }'
+}
+echo
+echo
+echo "$t"
+echo "========================================================"
+{
+    time_iinfo "no plugin index" "" 0
+    time_iinfo "cold plugin index" "plugin_index=${plugin_index}" 1
+    time_iinfo "warm plugin index" "plugin_index=${plugin_index}" 0
+} | tee build/benchmarks/$t.out
+rm -f ${plugin_index}
+echo "========================================================"
+echo "========================================================"
+echo
@@ -2,6 +2,7 @@
 // SPDX-License-Identifier: Apache-2.0
 // https://github.com/AcademySoftwareFoundation/OpenImageIO
 
+#include <algorithm>
 #include <cmath>
 
 #include "libcineon/Cineon.h"
@@ -25,6 +26,8 @@ public:
     bool close() override;
     bool read_native_scanline(int subimage, int miplevel, int y, int z,
                               void* data) override;
+    bool read_native_scanlines(int subimage, int miplevel, int ybegin, int yend,
+                               int z, void* data) override;
 
 private:
     InStream* m_stream = nullptr;
@@ -68,6 +71,11 @@ cineon_imageio_library_version()
 }
 
 OIIO_EXPORT const char* cineon_input_extensions[] = { "cin", nullptr };
+OIIO_EXPORT const char* cineon_imageio_signatures[] = {
+    "802a5fd7",
+    "d75f2a80",  // byte swapped
+    nullptr
+};
 
 OIIO_PLUGIN_EXPORTS_END
 
@@ -368,14 +376,29 @@ CineonInput::close()
 
 
 bool
-CineonInput::read_native_scanline(int subimage, int miplevel, int y, int /*z*/,
+CineonInput::read_native_scanline(int subimage, int miplevel, int y, int z,
                                   void* data)
+{
+    return read_native_scanlines(subimage, miplevel, y, y + 1, z, data);
+}
+
+
+
+bool
+CineonInput::read_native_scanlines(int subimage, int miplevel, int ybegin,
+                                   int yend, int /*z*/, void* data)
 {
     lock_guard lock(*this);
     if (!seek_subimage(subimage, miplevel))
         return false;
-
-    cineon::Block block(0, y, m_cin.header.Width() - 1, y);
+    yend = std::min(yend, m_spec.y + m_spec.height);
+    if (ybegin >= yend)
+        return true;
+
+    // Read the whole range as one block, so that the 10- and 12-bit unpacking
+    // can be done a band at a time.
+    m_cin.bandUnpack = OIIO::get_int_attribute("dpx:bitpack_bands", 1) != 0;
+    cineon::Block block(0, ybegin, m_cin.header.Width() - 1, yend - 1);
 
     // FIXME: un-hardcode the channel from 0
     if (!m_cin.ReadBlock(data, m_cin.header.ComponentDataSize(0), block))
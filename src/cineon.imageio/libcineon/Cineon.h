@@ -183,6 +183,11 @@ namespace cineon
 		 */
 		Header header;
 
+		/*!
+		 * \brief Read and unpack full-width blocks of 10- and 12-bit data a band at a time
+		 */
+		bool bandUnpack = true;
+
 		/*!
 		 * \brief Constructor
 		 */
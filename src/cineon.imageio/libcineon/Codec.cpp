@@ -62,7 +62,7 @@ void cineon::Codec::Reset()
 }
 
 
-bool cineon::Codec::Read(const Header &dpxHeader, ElementReadStream *fd, const Block &block, void *data, const DataSize size)
+bool cineon::Codec::Read(const Header &dpxHeader, ElementReadStream *fd, const Block &block, void *data, const DataSize size, const bool bandUnpack)
 {
 	// scanline buffer
 	if (this->scanline == 0)
@@ -84,6 +84,6 @@ bool cineon::Codec::Read(const Header &dpxHeader, ElementReadStream *fd, const B
 
 
 	// read the image block
-	return ReadImageBlock<ElementReadStream>(dpxHeader, this->scanline, fd, block, data, size);
+	return ReadImageBlock<ElementReadStream>(dpxHeader, this->scanline, fd, block, data, size, bandUnpack);
 }
 
@@ -72,13 +72,15 @@ namespace cineon
 		 * \param block image area to read
 		 * \param data buffer
 		 * \param size size of the buffer component
+		 * \param bandUnpack whether full-width blocks may be read and unpacked a band at a time
 		 * \return success
 		 */
 		virtual bool Read(const Header &dpxHeader,
 						  ElementReadStream *fd,
 						  const Block &block,
 						  void *data,
-						  const DataSize size);
+						  const DataSize size,
+						  const bool bandUnpack);
 
 	protected:
 		U32 *scanline;			//!< single scanline
@@ -168,7 +168,7 @@ bool cineon::Reader::ReadBlock(void *data, const DataSize size, Block &block)
 		this->codec = new Codec;
 
 	// read the image block
-	return this->codec->Read(this->header, this->rio, block, data, size);
+	return this->codec->Read(this->header, this->rio, block, data, size, this->bandUnpack);
 }
 
 
@@ -164,7 +164,7 @@ macro (oiio_add_all_tests)
                    )
 
     set (all_texture_tests
-                    texture-derivs texture-fill
+                    texture-derivs texture-ewa texture-fill
                     texture-flipt texture-gettexels texture-gray
                     texture-interp-bicubic
                     texture-blurtube
@@ -217,6 +217,7 @@ macro (oiio_add_all_tests)
             docs-examples-python
             python-colorconfig
             python-deep 
+            python-framesequence
             python-imagebuf
             python-imagecache
             python-imageoutput
@@ -331,6 +332,11 @@ macro (oiio_add_all_tests)
                     SUFFIX ".batch"
                     ENVIRONMENT TESTTEX_BATCH=1
                     FOUNDVAR OpenVDB_FOUND ENABLEVAR ENABLE_OpenVDB)
+    if (USE_PYTHON AND NOT SANITIZE)
+        oiio_add_tests (parallel-decode
+                    ENABLEVAR ENABLE_PSD
+                    IMAGEDIR oiio-images)
+    endif()
     oiio_add_tests (png png-damaged
                     ENABLEVAR ENABLE_PNG
                     IMAGEDIR oiio-images/png)
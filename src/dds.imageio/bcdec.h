@@ -52,6 +52,18 @@
     https://gist.github.com/rygorous/2144712
 */
 
+/*  Define BCDEC_STATIC before including this file (along with
+    BCDEC_IMPLEMENTATION) to give all functions internal linkage, so that
+    more than one translation unit may carry its own copy.
+*/
+#ifndef BCDECDEF
+#ifdef BCDEC_STATIC
+#define BCDECDEF static
+#else
+#define BCDECDEF extern
+#endif
+#endif
+
 #define BCDEC_BC1_BLOCK_SIZE    8
 #define BCDEC_BC2_BLOCK_SIZE    16
 #define BCDEC_BC3_BLOCK_SIZE    16
@@ -72,14 +84,14 @@
 extern "C" {
 #endif /* __cplusplus */
 
-void bcdec_bc1(const void* compressedBlock, void* decompressedBlock, int destinationPitch);
-void bcdec_bc2(const void* compressedBlock, void* decompressedBlock, int destinationPitch);
-void bcdec_bc3(const void* compressedBlock, void* decompressedBlock, int destinationPitch);
-void bcdec_bc4(const void* compressedBlock, void* decompressedBlock, int destinationPitch);
-void bcdec_bc5(const void* compressedBlock, void* decompressedBlock, int destinationPitch);
-void bcdec_bc6h_float(const void* compressedBlock, void* decompressedBlock, int destinationPitch, int isSigned);
-void bcdec_bc6h_half(const void* compressedBlock, void* decompressedBlock, int destinationPitch, int isSigned);
-void bcdec_bc7(const void* compressedBlock, void* decompressedBlock, int destinationPitch);
+BCDECDEF void bcdec_bc1(const void* compressedBlock, void* decompressedBlock, int destinationPitch);
+BCDECDEF void bcdec_bc2(const void* compressedBlock, void* decompressedBlock, int destinationPitch);
+BCDECDEF void bcdec_bc3(const void* compressedBlock, void* decompressedBlock, int destinationPitch);
+BCDECDEF void bcdec_bc4(const void* compressedBlock, void* decompressedBlock, int destinationPitch);
+BCDECDEF void bcdec_bc5(const void* compressedBlock, void* decompressedBlock, int destinationPitch);
+BCDECDEF void bcdec_bc6h_float(const void* compressedBlock, void* decompressedBlock, int destinationPitch, int isSigned);
+BCDECDEF void bcdec_bc6h_half(const void* compressedBlock, void* decompressedBlock, int destinationPitch, int isSigned);
+BCDECDEF void bcdec_bc7(const void* compressedBlock, void* decompressedBlock, int destinationPitch);
 
 #ifdef __cplusplus
 }
@@ -88,7 +100,7 @@ void bcdec_bc7(const void* compressedBlock, void* decompressedBlock, int destina
 
 #ifdef BCDEC_IMPLEMENTATION
 
-void bcdec__color_block(const void* compressedBlock, void* decompressedBlock, int destinationPitch, int onlyOpaqueMode) {
+BCDECDEF void bcdec__color_block(const void* compressedBlock, void* decompressedBlock, int destinationPitch, int onlyOpaqueMode) {
     unsigned short c0, c1;
     unsigned int refColors[4]; /* 0xAABBGGRR */
     unsigned char* dstColors;
@@ -148,7 +160,7 @@ void bcdec__color_block(const void* compressedBlock, void* decompressedBlock, in
     }
 }
 
-void bcdec__sharp_alpha_block(const void* compressedBlock, void* decompressedBlock, int destinationPitch) {
+BCDECDEF void bcdec__sharp_alpha_block(const void* compressedBlock, void* decompressedBlock, int destinationPitch) {
     unsigned short* alpha;
     unsigned char* decompressed;
     int i, j;
@@ -165,7 +177,7 @@ void bcdec__sharp_alpha_block(const void* compressedBlock, void* decompressedBlo
     }
 }
 
-void bcdec__smooth_alpha_block(const void* compressedBlock, void* decompressedBlock, int destinationPitch, int pixelSize) {
+BCDECDEF void bcdec__smooth_alpha_block(const void* compressedBlock, void* decompressedBlock, int destinationPitch, int pixelSize) {
     unsigned char* decompressed;
     unsigned char alpha[8];
     int i, j;
@@ -212,7 +224,7 @@ typedef struct bcdec__bitstream {
     unsigned long long high;
 } bcdec__bitstream_t;
 
-int bcdec__bitstream_read_bits(bcdec__bitstream_t* bstream, int numBits) {
+BCDECDEF int bcdec__bitstream_read_bits(bcdec__bitstream_t* bstream, int numBits) {
     unsigned int mask = (1 << numBits) - 1;
     /* Read the low N bits */
     unsigned int bits = (bstream->low & mask);
@@ -225,13 +237,13 @@ int bcdec__bitstream_read_bits(bcdec__bitstream_t* bstream, int numBits) {
     return bits;
 }
 
-int bcdec__bitstream_read_bit(bcdec__bitstream_t* bstream) {
+BCDECDEF int bcdec__bitstream_read_bit(bcdec__bitstream_t* bstream) {
     return bcdec__bitstream_read_bits(bstream, 1);
 }
 
 /*  reversed bits pulling, used in BC6H decoding
     why ?? just why ??? */
-int bcdec__bitstream_read_bits_r(bcdec__bitstream_t* bstream, int numBits) {
+BCDECDEF int bcdec__bitstream_read_bits_r(bcdec__bitstream_t* bstream, int numBits) {
     int bits = bcdec__bitstream_read_bits(bstream, numBits);
     /* Reverse the bits. */
     int result = 0;
@@ -245,35 +257,35 @@ int bcdec__bitstream_read_bits_r(bcdec__bitstream_t* bstream, int numBits) {
 
 
 
-void bcdec_bc1(const void* compressedBlock, void* decompressedBlock, int destinationPitch) {
+BCDECDEF void bcdec_bc1(const void* compressedBlock, void* decompressedBlock, int destinationPitch) {
     bcdec__color_block(compressedBlock, decompressedBlock, destinationPitch, 0);
 }
 
-void bcdec_bc2(const void* compressedBlock, void* decompressedBlock, int destinationPitch) {
+BCDECDEF void bcdec_bc2(const void* compressedBlock, void* decompressedBlock, int destinationPitch) {
     bcdec__color_block(((char*)compressedBlock) + 8, decompressedBlock, destinationPitch, 1);
     bcdec__sharp_alpha_block(compressedBlock, ((char*)decompressedBlock) + 3, destinationPitch);
 }
 
-void bcdec_bc3(const void* compressedBlock, void* decompressedBlock, int destinationPitch) {
+BCDECDEF void bcdec_bc3(const void* compressedBlock, void* decompressedBlock, int destinationPitch) {
     bcdec__color_block(((char*)compressedBlock) + 8, decompressedBlock, destinationPitch, 1);
     bcdec__smooth_alpha_block(compressedBlock, ((char*)decompressedBlock) + 3, destinationPitch, 4);
 }
 
-void bcdec_bc4(const void* compressedBlock, void* decompressedBlock, int destinationPitch) {
+BCDECDEF void bcdec_bc4(const void* compressedBlock, void* decompressedBlock, int destinationPitch) {
     bcdec__smooth_alpha_block(compressedBlock, decompressedBlock, destinationPitch, 1);
 }
 
-void bcdec_bc5(const void* compressedBlock, void* decompressedBlock, int destinationPitch) {
+BCDECDEF void bcdec_bc5(const void* compressedBlock, void* decompressedBlock, int destinationPitch) {
     bcdec__smooth_alpha_block(compressedBlock, decompressedBlock, destinationPitch, 2);
     bcdec__smooth_alpha_block(((char*)compressedBlock) + 8, ((char*)decompressedBlock) + 1, destinationPitch, 2);
 }
 
 /* http://graphics.stanford.edu/~seander/bithacks.html#VariableSignExtend */
-int bcdec__extend_sign(int val, int bits) {
+BCDECDEF int bcdec__extend_sign(int val, int bits) {
     return (val << (32 - bits)) >> (32 - bits);
 }
 
-int bcdec__transform_inverse(int val, int a0, int bits, int isSigned) {
+BCDECDEF int bcdec__transform_inverse(int val, int a0, int bits, int isSigned) {
     /* If the precision of A0 is "p" bits, then the transform algorithm is:
        B0 = (B0 + A0) & ((1 << p) - 1) */
     val = (val + a0) & ((1 << bits) - 1);
@@ -284,7 +296,7 @@ int bcdec__transform_inverse(int val, int a0, int bits, int isSigned) {
 }
 
 /* pretty much copy-paste from documentation */
-int bcdec__unquantize(int val, int bits, int isSigned) {
+BCDECDEF int bcdec__unquantize(int val, int bits, int isSigned) {
     int unq, s = 0;
 
     if (!isSigned) {
@@ -322,11 +334,11 @@ int bcdec__unquantize(int val, int bits, int isSigned) {
     return unq;
 }
 
-int bcdec__interpolate(int a, int b, int* weights, int index) {
+BCDECDEF int bcdec__interpolate(int a, int b, int* weights, int index) {
     return (a * (64 - weights[index]) + b * weights[index] + 32) >> 6;
 }
 
-unsigned short bcdec__finish_unquantize(int val, int isSigned) {
+BCDECDEF unsigned short bcdec__finish_unquantize(int val, int isSigned) {
     int s;
 
     if (!isSigned) {
@@ -343,7 +355,7 @@ unsigned short bcdec__finish_unquantize(int val, int isSigned) {
 }
 
 /* modified half_to_float_fast4 from https://gist.github.com/rygorous/2144712 */
-float bcdec__half_to_float_quick(unsigned short half) {
+BCDECDEF float bcdec__half_to_float_quick(unsigned short half) {
     typedef union {
         unsigned int u;
         float f;
@@ -370,7 +382,7 @@ float bcdec__half_to_float_quick(unsigned short half) {
     return o.f;
 }
 
-void bcdec_bc6h_half(const void* compressedBlock, void* decompressedBlock, int destinationPitch, int isSigned) {
+BCDECDEF void bcdec_bc6h_half(const void* compressedBlock, void* decompressedBlock, int destinationPitch, int isSigned) {
     static char actual_bits_count[4][14] = {
         { 10, 7, 11, 11, 11, 9, 8, 8, 8, 6, 10, 11, 12, 16 },   /*  W */
         {  5, 6,  5,  4,  4, 5, 6, 5, 5, 6, 10,  9,  8,  4 },   /* dR */
@@ -880,7 +892,7 @@ void bcdec_bc6h_half(const void* compressedBlock, void* decompressedBlock, int d
     }
 }
 
-void bcdec_bc6h_float(const void* compressedBlock, void* decompressedBlock, int destinationPitch, int isSigned) {
+BCDECDEF void bcdec_bc6h_float(const void* compressedBlock, void* decompressedBlock, int destinationPitch, int isSigned) {
     unsigned short block[16*3];
     float* decompressed;
     const unsigned short* b;
@@ -899,11 +911,11 @@ void bcdec_bc6h_float(const void* compressedBlock, void* decompressedBlock, int
     }    
 }
 
-void bcdec__swap_values(int* a, int* b) {
+BCDECDEF void bcdec__swap_values(int* a, int* b) {
     a[0] ^= b[0], b[0] ^= a[0], a[0] ^= b[0];
 }
 
-void bcdec_bc7(const void* compressedBlock, void* decompressedBlock, int destinationPitch) {
+BCDECDEF void bcdec_bc7(const void* compressedBlock, void* decompressedBlock, int destinationPitch) {
     static char actual_bits_count[2][8] = {
         { 4, 6, 5, 7, 5, 7, 7, 5 },     /* RGBA  */
         { 0, 0, 0, 0, 6, 8, 7, 5 },     /* Alpha */
@@ -69,15 +69,17 @@ private:
     uint32_t m_BitCounts[4];    ///< Bit counts in r,g,b,a channels
     uint32_t m_RightShifts[4];  ///< Shifts to extract r,g,b,a channels
     Compression m_compression = Compression::None;
-    dds_header m_dds;  ///< DDS header
+    bool m_blockinfo          = false;  ///< Report raw block locations
+    dds_header m_dds;                   ///< DDS header
     dds_header_dx10 m_dx10;
 
     /// Reset everything to initial state
     ///
     void init()
     {
-        m_subimage = -1;
-        m_miplevel = -1;
+        m_subimage  = -1;
+        m_miplevel  = -1;
+        m_blockinfo = false;
         m_buf.clear();
         ioproxy_clear();
     }
@@ -379,6 +381,10 @@ dds_imageio_library_version()
 }
 
 OIIO_EXPORT const char* dds_input_extensions[] = { "dds", nullptr };
+OIIO_EXPORT const char* dds_imageio_signatures[] = {
+    "44445320",  // "DDS "
+    nullptr
+};
 
 OIIO_PLUGIN_EXPORTS_END
 
@@ -410,6 +416,7 @@ DDSInput::open(const std::string& name, ImageSpec& newspec,
                const ImageSpec& config)
 {
     ioproxy_retrieve_from_config(config);
+    m_blockinfo = config.get_int_attribute("dds:blockinfo") != 0;
     return open(name, newspec);
 }
 
@@ -755,6 +762,7 @@ DDSInput::seek_subimage(int subimage, int miplevel)
 
     // for cube maps, the seek will be performed when reading a tile instead
     unsigned int w = 0, h = 0, d = 0;
+    int64_t blockoffset = -1;
     TypeDesc::BASETYPE basetype = GetBaseType(m_compression);
     if (m_dds.caps.flags2 & DDS_CAPS2_CUBEMAP) {
         // calc sizes separately for cube maps
@@ -784,6 +792,7 @@ DDSInput::seek_subimage(int subimage, int miplevel)
         m_spec.tile_depth = m_spec.full_depth = d;
     } else {
         internal_seek_subimage(0, miplevel, w, h, d);
+        blockoffset = iotell();
         // create imagespec
         m_spec       = ImageSpec(w, h, m_nchans, basetype);
         m_spec.depth = d;
@@ -807,6 +816,18 @@ DDSInput::seek_subimage(int subimage, int miplevel)
         }
         if (str != nullptr)
             m_spec.attribute("compression", str);
+        // If the caller asked, say where this level's blocks are in the
+        // file, so that they may be read and decoded independently (for
+        // example, by an ImageCache keeping tiles compressed). Only for
+        // plain 2D images whose blocks decode without any of our fixups:
+        // premultiplied DXT2/DXT4, RXGB swizzling, and normal map
+        // reconstruction all require the full decode here.
+        if (m_blockinfo && blockoffset >= 0 && d == 1
+            && m_compression != Compression::DXT2
+            && m_compression != Compression::DXT4
+            && m_dds.fmt.fourCC != DDS_4CC_RXGB
+            && !(m_dds.fmt.flags & DDS_PF_NORMAL))
+            m_spec.attribute("dds:blockoffset", TypeInt64, &blockoffset);
     }
 
     uint32_t bpp = 0;
@@ -113,6 +113,11 @@ dpx_imageio_library_version()
 }
 
 OIIO_EXPORT const char* dpx_input_extensions[] = { "dpx", nullptr };
+OIIO_EXPORT const char* dpx_imageio_signatures[] = {
+    "53445058",  // SDPX
+    "58504453",  // XPDS
+    nullptr
+};
 
 OIIO_PLUGIN_EXPORTS_END
 
@@ -589,6 +594,7 @@ DPXInput::read_native_scanlines(int subimage, int miplevel, int ybegin,
     if (!seek_subimage(subimage, miplevel))
         return false;
 
+    m_dpx.bandUnpack = OIIO::get_int_attribute("dpx:bitpack_bands", 1) != 0;
     dpx::Block block(0, ybegin - m_spec.y, m_dpx.header.Width() - 1,
                      yend - 1 - m_spec.y);
 
@@ -563,6 +563,7 @@ DPXOutput::write_buffer()
 
     bool ok = true;
     if (m_write_pending && m_buf.size()) {
+        m_dpx.bandPack = OIIO::get_int_attribute("dpx:bitpack_bands", 1) != 0;
         ok = m_dpx.WriteElement(m_subimage, m_buf.data(), m_datasize);
         if (!ok) {
             const char* err = strerror(errno);
@@ -62,7 +62,7 @@ void dpx::Codec::Reset()
 }
 
 
-bool dpx::Codec::Read(const Header &dpxHeader, ElementReadStream *fd, const int element, const Block &block, void *data, const DataSize size)
+bool dpx::Codec::Read(const Header &dpxHeader, ElementReadStream *fd, const int element, const Block &block, void *data, const DataSize size, const bool bandUnpack)
 {
 	// scanline buffer
 	if (this->scanline == 0)
@@ -82,6 +82,6 @@ bool dpx::Codec::Read(const Header &dpxHeader, ElementReadStream *fd, const int
 	
 	
 	// read the image block
-	return ReadImageBlock<ElementReadStream>(dpxHeader, this->scanline, fd, element, block, data, size);
+	return ReadImageBlock<ElementReadStream>(dpxHeader, this->scanline, fd, element, block, data, size, bandUnpack);
 }
 
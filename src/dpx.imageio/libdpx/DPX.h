@@ -184,6 +184,11 @@ namespace dpx
 		 */	
 		Header header;
 
+		/*!
+		 * \brief Read and unpack full-width blocks of 10- and 12-bit data a band at a time
+		 */
+		bool bandUnpack = true;
+
 		/*!
 		 * \brief Constructor
 		 */			
@@ -273,6 +278,11 @@ namespace dpx
 		 */		
 		Header header;
 
+		/*!
+		 * \brief Pack uncompressed 10-bit filled data a band at a time
+		 */
+		bool bandPack = true;
+
 		/*!
 		 * \brief Constructor
 		 */			
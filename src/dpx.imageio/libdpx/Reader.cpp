@@ -173,7 +173,7 @@ bool dpx::Reader::ReadBlock(const int element, unsigned char *data, Block &block
     }
 
     // read the image block
-    return this->codex[element]->Read(this->header, this->rio, element, block, data, size);
+    return this->codex[element]->Read(this->header, this->rio, element, block, data, size, this->bandUnpack);
 }
   
 
@@ -38,6 +38,13 @@
 
 
 #include <algorithm>
+#include <utility>
+#include <vector>
+
+#include <OpenImageIO/fmath.h>
+#include <OpenImageIO/parallel.h>
+#include <OpenImageIO/simd.h>
+
 #include "BaseTypeConverter.h"
 
 
@@ -60,6 +67,160 @@
 namespace dpx 
 {
 
+	// gather the lanes {field[F0][W0], field[F1][W1], ...} of the three fields of
+	// four 10-bit filled words
+	template<int W0, int W1, int W2, int W3, int F0, int F1, int F2, int F3>
+	OIIO_FORCEINLINE OIIO::simd::vint4 GatherFields(const OIIO::simd::vint4 *field)
+	{
+		using namespace OIIO::simd;
+		const vint4 a = shuffle<W0, W1, W2, W3>(field[0]);
+		const vint4 b = shuffle<W0, W1, W2, W3>(field[1]);
+		const vint4 c = shuffle<W0, W1, W2, W3>(field[2]);
+		const vint4 ab = select(vbool4(F0 == 1, F1 == 1, F2 == 1, F3 == 1), b, a);
+		return select(vbool4(F0 == 2, F1 == 2, F2 == 2, F3 == 2), c, ab);
+	}
+
+	// four words' worth of the datums of 8 words of 10-bit filled data, each
+	// output lane holding a pair of consecutive datums as U16 (low half first),
+	// the lo and hi datums being given by GatherFields
+	template<int LW0, int LW1, int LW2, int LW3, int LF0, int LF1, int LF2, int LF3,
+			 int HW0, int HW1, int HW2, int HW3, int HF0, int HF1, int HF2, int HF3>
+	OIIO_FORCEINLINE void UnfillDatumPairs(const U32 *words, const int shift0, const int shift1, const int shift2, U16 *obuf)
+	{
+		using namespace OIIO::simd;
+		const vint4 w(reinterpret_cast<const int *>(words));
+		const vint4 mask(0x3ff);
+		const vint4 field[3] = { srl(w, shift0) & mask, srl(w, shift1) & mask, srl(w, shift2) & mask };
+		const vint4 lo = GatherFields<LW0, LW1, LW2, LW3, LF0, LF1, LF2, LF3>(field);
+		const vint4 hi = GatherFields<HW0, HW1, HW2, HW3, HF0, HF1, HF2, HF3>(field);
+		const vint4 pair = lo | (hi << 16);
+		// BaseTypeConvertU10ToU16 on both halves at once
+		const vint4 u16 = (pair << 6) | (srl(pair, 4) & vint4(0x003f003f));
+		u16.store(reinterpret_cast<int *>(obuf));
+	}
+
+	// unpack 8 words at a time of a line of 10-bit filled data into U16, as the
+	// datum pairs starting at words 0, 2, and 4 of each group; returns the
+	// number of words done.  With AVX2 the compiler's own 8-wide vectorization
+	// of the word loop in Unfill10bitFilledLine is faster, so leave it to that.
+	inline int Unfill10bitFilledWordsU16(const U32 *readBuf, U16 *obuf, const int words, const int shift0, const int shift1, const int shift2)
+	{
+		if (OIIO_SIMD_AVX >= 2 || !OIIO::littleendian())
+			return 0;
+		int w = 0;
+		for (; w + 8 <= words; w += 8, readBuf += 8, obuf += 24)
+		{
+			UnfillDatumPairs<0, 0, 1, 2, 0, 2, 1, 0, 0, 1, 1, 2, 1, 0, 2, 1>(readBuf, shift0, shift1, shift2, obuf);
+			UnfillDatumPairs<0, 1, 2, 2, 2, 1, 0, 2, 1, 1, 2, 3, 0, 2, 1, 0>(readBuf + 2, shift0, shift1, shift2, obuf + 8);
+			UnfillDatumPairs<1, 2, 2, 3, 1, 0, 2, 1, 1, 2, 3, 3, 2, 1, 0, 2>(readBuf + 4, shift0, shift1, shift2, obuf + 16);
+		}
+		return w;
+	}
+
+	template<typename BUF>
+	inline int Unfill10bitFilledWords(const U32 *, BUF *, const int, const int, const int, const int)
+	{
+		return 0;
+	}
+
+	inline int Unfill10bitFilledWords(const U32 *readBuf, U16 *obuf, const int words, const int shift0, const int shift1, const int shift2)
+	{
+		return Unfill10bitFilledWordsU16(readBuf, obuf, words, shift0, shift1, shift2);
+	}
+
+	// unpack one full line of 10-bit filled data, three datums per 32-bit word,
+	// a word at a time
+	template<typename BUF, int PADDINGBITS>
+	void Unfill10bitFilledLine(const U32 *readBuf, BUF *obuf, const int count, const int numberOfComponents)
+	{
+		// 1-channel images store the first datum of each word in the low bits
+		const bool lowFirst = (numberOfComponents == 1);
+		const int shift0 = (lowFirst ? 0 : 20) + PADDINGBITS;
+		const int shift1 = 10 + PADDINGBITS;
+		const int shift2 = (lowFirst ? 20 : 0) + PADDINGBITS;
+
+		const int words = count / 3;
+		const int simdWords = Unfill10bitFilledWords(readBuf, obuf, words, shift0, shift1, shift2);
+		BUF *out = obuf + 3 * simdWords;
+		for (int w = simdWords; w < words; w++, out += 3)
+		{
+			const U32 word = readBuf[w];
+			U16 d0 = U16((word >> shift0) & 0x3ff);
+			U16 d1 = U16((word >> shift1) & 0x3ff);
+			U16 d2 = U16((word >> shift2) & 0x3ff);
+			BaseTypeConvertU10ToU16(d0, d0);
+			BaseTypeConvertU10ToU16(d1, d1);
+			BaseTypeConvertU10ToU16(d2, d2);
+			BaseTypeConverter(d0, out[0]);
+			BaseTypeConverter(d1, out[1]);
+			BaseTypeConverter(d2, out[2]);
+		}
+
+		// datums in the last, partially filled word
+		for (int i = words * 3; i < count; i++)
+		{
+			const int j = i - words * 3;
+			const int shift = (lowFirst ? j : 2 - j) * 10 + PADDINGBITS;
+			U16 d = U16((readBuf[words] >> shift) & 0x3ff);
+			BaseTypeConvertU10ToU16(d, d);
+			BaseTypeConverter(d, obuf[i]);
+		}
+	}
+
+
+	// one datum of a group of BITDEPTH-bit packed datums that starts on a word
+	// boundary; its position in the group, and so whether it straddles two
+	// words, is known at compile time
+	template<int BITDEPTH, int K>
+	inline U16 PackedDatum(const U32 *group)
+	{
+		constexpr int w = K * BITDEPTH / 32;
+		constexpr int off = K * BITDEPTH % 32;
+		U32 value = group[w] >> off;
+		if constexpr (off + BITDEPTH > 32)
+			value |= group[w + 1] << (32 - off);
+		U16 d = U16(value & ((1u << BITDEPTH) - 1));
+		if constexpr (BITDEPTH == 10)
+			BaseTypeConvertU10ToU16(d, d);
+		else
+			BaseTypeConvertU12ToU16(d, d);
+		return d;
+	}
+
+	template<typename BUF, int BITDEPTH, size_t... K>
+	inline void UnPackPackedGroup(const U32 *group, BUF *obuf, std::index_sequence<K...>)
+	{
+		U16 d[] = { PackedDatum<BITDEPTH, int(K)>(group)... };
+		for (size_t i = 0; i < sizeof...(K); i++)
+			BaseTypeConverter(d[i], obuf[i]);
+	}
+
+	// unpack one full line of 10-bit or 12-bit packed data, which is a stream of
+	// datums starting at the LSB of each 32-bit word, a group of words at a time:
+	// 16 datums in 5 words for 10-bit, 8 datums in 3 words for 12-bit
+	template<typename BUF, int BITDEPTH>
+	void UnPackPackedLine(const U32 *readBuf, BUF *obuf, const int count)
+	{
+		constexpr int groupDatums = (BITDEPTH == 10) ? 16 : 8;
+		constexpr int groupWords = groupDatums * BITDEPTH / 32;
+		const auto datumIndices = std::make_index_sequence<groupDatums>();
+		const int groups = count / groupDatums;
+		for (int g = 0; g < groups; g++)
+			UnPackPackedGroup<BUF, BITDEPTH>(readBuf + g * groupWords, obuf + g * groupDatums, datumIndices);
+
+		// the last, partial group, from a zero-padded copy of its words
+		const int rest = count - groups * groupDatums;
+		if (rest)
+		{
+			U32 group[groupWords] = {};
+			std::copy_n(readBuf + groups * groupWords, (rest * BITDEPTH + 31) / 32, group);
+			BUF tail[groupDatums];
+			UnPackPackedGroup<BUF, BITDEPTH>(group, tail, datumIndices);
+			std::copy_n(tail, rest, obuf + groups * groupDatums);
+		}
+	}
+
+
 	// this function is called when the DataSize is 10 bit and the packing method is kFilledMethodA or kFilledMethodB
 	template<typename BUF, int PADDINGBITS>
 	void Unfill10bitFilled(U32 *readBuf, const int x, BUF *data, int count, int bufoff, const int numberOfComponents)
@@ -119,7 +280,7 @@ namespace dpx
 	}
 	
 	template <typename IR, typename BUF, int PADDINGBITS>
-	bool Read10bitFilled(const Header &dpxHeader, U32 *readBuf, IR *fd, const int element, const Block &block, BUF *data)
+	bool Read10bitFilled(const Header &dpxHeader, U32 *readBuf, IR *fd, const int element, const Block &block, BUF *data, const bool bandUnpack)
 	{
 		// image height to read
 		const int height = block.y2 - block.y1 + 1;
@@ -136,6 +297,21 @@ namespace dpx
 		// Line length in bytes rounded to 32 bits boundary
 		int lineLength = ((datums - 1) / 3 + 1) * 4;
 
+		// full lines without padding are contiguous in the file, so read the
+		// whole band at once and unpack its lines in parallel
+		if (eolnPad == 0 && block.x1 == 0 && block.x2 == int(dpxHeader.Width() - 1) && bandUnpack)
+		{
+			const int words = lineLength / 4;
+			std::vector<U32> band(size_t(height) * words);
+			if (!fd->Read(dpxHeader, element, long(block.y1) * lineLength, band.data(), band.size() * sizeof(U32)))
+				return false;
+			OIIO::parallel_for_chunked(0, height, 0, [&](int64_t ybegin, int64_t yend) {
+				for (int64_t line = ybegin; line < yend; line++)
+					Unfill10bitFilledLine<BUF, PADDINGBITS>(&band[line * words], data + line * datums, datums, numberOfComponents);
+			});
+			return true;
+		}
+
 		// read in each line at a time directly into the user memory space
 		for (int line = 0; line < height; line++)
 		{
@@ -190,17 +366,17 @@ namespace dpx
 
 
 	template <typename IR, typename BUF>
-	bool Read10bitFilledMethodA(const Header &dpx, U32 *readBuf, IR *fd, const int element, const Block &block, BUF *data)
+	bool Read10bitFilledMethodA(const Header &dpx, U32 *readBuf, IR *fd, const int element, const Block &block, BUF *data, const bool bandUnpack)
 	{
 		// padding bits for PackedMethodA is 2
-		return Read10bitFilled<IR, BUF, PADDINGBITS_10BITFILLEDMETHODA>(dpx, readBuf, fd, element, block, data);
+		return Read10bitFilled<IR, BUF, PADDINGBITS_10BITFILLEDMETHODA>(dpx, readBuf, fd, element, block, data, bandUnpack);
 	}
 
 
 	template <typename IR, typename BUF>
-	bool Read10bitFilledMethodB(const Header &dpx, U32 *readBuf, IR *fd, const int element, const Block &block, BUF *data)
+	bool Read10bitFilledMethodB(const Header &dpx, U32 *readBuf, IR *fd, const int element, const Block &block, BUF *data, const bool bandUnpack)
 	{
-		return Read10bitFilled<IR, BUF, PADDINGBITS_10BITFILLEDMETHODB>(dpx, readBuf, fd, element, block, data);
+		return Read10bitFilled<IR, BUF, PADDINGBITS_10BITFILLEDMETHODB>(dpx, readBuf, fd, element, block, data, bandUnpack);
 	}
 
 
@@ -255,7 +431,7 @@ namespace dpx
 
 	
 	template <typename IR, typename BUF, U32 MASK, int MULTIPLIER, int REMAIN, int REVERSE>
-	bool ReadPacked(const Header &dpxHeader, U32 *readBuf, IR *fd, const int element, const Block &block, BUF *data)
+	bool ReadPacked(const Header &dpxHeader, U32 *readBuf, IR *fd, const int element, const Block &block, BUF *data, const bool bandUnpack)
 	{	
 		// image height to read
 		const int height = block.y2 - block.y1 + 1;
@@ -272,6 +448,28 @@ namespace dpx
 		// number of bytes 
 		const int lineSize = (dpxHeader.Width() * numberOfComponents * dataSize + 31) / 32;
 
+		// full lines without padding are contiguous in the file, so read the
+		// whole band at once and unpack its lines in parallel (the element by
+		// element code below reads 16-bit values out of the 32-bit words, which
+		// is only the same LSB-first stream on little endian machines)
+		if (eolnPad == 0 && block.x1 == 0 && block.x2 == int(dpxHeader.Width() - 1) && OIIO::littleendian() && bandUnpack)
+		{
+			const int datums = dpxHeader.Width() * numberOfComponents;
+			std::vector<U32> band(size_t(height) * lineSize);
+			if (!fd->Read(dpxHeader, element, long(block.y1) * lineSize * sizeof(U32), band.data(), band.size() * sizeof(U32)))
+				return false;
+			OIIO::parallel_for_chunked(0, height, 0, [&](int64_t ybegin, int64_t yend) {
+				for (int64_t line = ybegin; line < yend; line++)
+				{
+					if (dataSize == 10)
+						UnPackPackedLine<BUF, 10>(&band[line * lineSize], data + line * datums, datums);
+					else
+						UnPackPackedLine<BUF, 12>(&band[line * lineSize], data + line * datums, datums);
+				}
+			});
+			return true;
+		}
+
 		// read in each line at a time directly into the user memory space
 		for (int line = 0; line < height; line++)
 		{
@@ -299,16 +497,16 @@ namespace dpx
 	
 	
 	template <typename IR, typename BUF>
-	bool Read10bitPacked(const Header &dpxHeader, U32 *readBuf, IR *fd, const int element, const Block &block, BUF *data)
+	bool Read10bitPacked(const Header &dpxHeader, U32 *readBuf, IR *fd, const int element, const Block &block, BUF *data, const bool bandUnpack)
 	{
-		return ReadPacked<IR, BUF, MASK_10BITPACKED, MULTIPLIER_10BITPACKED, REMAIN_10BITPACKED, REVERSE_10BITPACKED>(dpxHeader, readBuf, fd, element, block, data);
+		return ReadPacked<IR, BUF, MASK_10BITPACKED, MULTIPLIER_10BITPACKED, REMAIN_10BITPACKED, REVERSE_10BITPACKED>(dpxHeader, readBuf, fd, element, block, data, bandUnpack);
 		
 	}
 	
 	template <typename IR, typename BUF>
-	bool Read12bitPacked(const Header &dpxHeader, U32 *readBuf, IR *fd, const int element, const Block &block, BUF *data)
+	bool Read12bitPacked(const Header &dpxHeader, U32 *readBuf, IR *fd, const int element, const Block &block, BUF *data, const bool bandUnpack)
 	{
-		return ReadPacked<IR, BUF, MASK_12BITPACKED, MULTIPLIER_12BITPACKED, REMAIN_12BITPACKED, REVERSE_12BITPACKED>(dpxHeader, readBuf, fd, element, block, data);
+		return ReadPacked<IR, BUF, MASK_12BITPACKED, MULTIPLIER_12BITPACKED, REMAIN_12BITPACKED, REVERSE_12BITPACKED>(dpxHeader, readBuf, fd, element, block, data, bandUnpack);
 	}
 
 
@@ -361,7 +559,7 @@ namespace dpx
 
 
 	template <typename IR, typename BUF>
-	bool Read12bitFilledMethodB(const Header &dpxHeader, U16 *readBuf, IR *fd, const int element, const Block &block, BUF *data)
+	bool Read12bitFilledMethodB(const Header &dpxHeader, U16 *readBuf, IR *fd, const int element, const Block &block, BUF *data, const bool bandUnpack)
 	{
 		// get the number of components for this element descriptor
 		const int numberOfComponents = dpxHeader.ImageElementComponentCount(element);
@@ -377,6 +575,24 @@ namespace dpx
 		int eolnPad = dpxHeader.EndOfLinePadding(element);
 		if (eolnPad == ~0)
 			eolnPad = 0;
+
+		// full lines without padding are contiguous in the file, so read the
+		// whole band at once and convert its lines in parallel
+		if (eolnPad == 0 && width == imageWidth * numberOfComponents && bandUnpack)
+		{
+			std::vector<U16> band(size_t(height) * width);
+			if (!fd->Read(dpxHeader, element, long(block.y1) * width * 2, band.data(), band.size() * sizeof(U16)))
+				return false;
+			OIIO::parallel_for_chunked(0, height, 0, [&](int64_t ybegin, int64_t yend) {
+				for (int64_t i = ybegin * width; i < yend * width; i++)
+				{
+					U16 d1 = band[i];
+					BaseTypeConvertU12ToU16(d1, d1);
+					BaseTypeConverter(d1, data[i]);
+				}
+			});
+			return true;
+		}
 				
 		// read in each line at a time directly into the user memory space
 		for (int line = 0; line < height; line++)
@@ -429,7 +645,7 @@ namespace dpx
 #endif
 	
 	template <typename IR, typename BUF, DataSize BUFTYPE>
-	bool ReadImageBlock(const Header &dpxHeader, U32 *readBuf, IR *fd, const int element, const Block &block, BUF *data)
+	bool ReadImageBlock(const Header &dpxHeader, U32 *readBuf, IR *fd, const int element, const Block &block, BUF *data, const bool bandUnpack)
 	{
 		const int bitDepth = dpxHeader.BitDepth(element);
 		const DataSize size = dpxHeader.ComponentDataSize(element);	
@@ -438,20 +654,20 @@ namespace dpx
 		if (bitDepth == 10)
 		{	
 			if (packing == kFilledMethodA)
-				return Read10bitFilledMethodA<IR, BUF>(dpxHeader, readBuf, fd, element, block, reinterpret_cast<BUF *>(data));	
+				return Read10bitFilledMethodA<IR, BUF>(dpxHeader, readBuf, fd, element, block, reinterpret_cast<BUF *>(data), bandUnpack);	
 			else if (packing == kFilledMethodB)
-				return Read10bitFilledMethodB<IR, BUF>(dpxHeader, readBuf, fd, element, block, reinterpret_cast<BUF *>(data));
+				return Read10bitFilledMethodB<IR, BUF>(dpxHeader, readBuf, fd, element, block, reinterpret_cast<BUF *>(data), bandUnpack);
 			else if (packing == kPacked)
-				return Read10bitPacked<IR, BUF>(dpxHeader, readBuf, fd, element, block, reinterpret_cast<BUF *>(data));
+				return Read10bitPacked<IR, BUF>(dpxHeader, readBuf, fd, element, block, reinterpret_cast<BUF *>(data), bandUnpack);
 		} 
 		else if (bitDepth == 12)
 		{			
 			if (packing == kPacked)
-				return Read12bitPacked<IR, BUF>(dpxHeader, readBuf, fd, element, block, reinterpret_cast<BUF *>(data));
+				return Read12bitPacked<IR, BUF>(dpxHeader, readBuf, fd, element, block, reinterpret_cast<BUF *>(data), bandUnpack);
 			else if (packing == kFilledMethodB)
 				// filled method B
 				// 12 bits fill LSB of 16 bits
-				return Read12bitFilledMethodB<IR, BUF>(dpxHeader, reinterpret_cast<U16 *>(readBuf), fd, element, block, reinterpret_cast<BUF *>(data));
+				return Read12bitFilledMethodB<IR, BUF>(dpxHeader, reinterpret_cast<U16 *>(readBuf), fd, element, block, reinterpret_cast<BUF *>(data), bandUnpack);
 			else	
 				// filled method A
 				// 12 bits fill MSB of 16 bits
@@ -473,18 +689,18 @@ namespace dpx
 	}
 
 	template <typename IR>
-	bool ReadImageBlock(const Header &dpxHeader, U32 *readBuf, IR *fd, const int element, const Block &block, void *data, const DataSize size)
+	bool ReadImageBlock(const Header &dpxHeader, U32 *readBuf, IR *fd, const int element, const Block &block, void *data, const DataSize size, const bool bandUnpack)
 	{
 		if (size == dpx::kByte)
-			return ReadImageBlock<IR, U8, dpx::kByte>(dpxHeader, readBuf, fd, element, block, reinterpret_cast<U8 *>(data));
+			return ReadImageBlock<IR, U8, dpx::kByte>(dpxHeader, readBuf, fd, element, block, reinterpret_cast<U8 *>(data), bandUnpack);
 		else if (size == dpx::kWord)
-			return ReadImageBlock<IR, U16, dpx::kWord>(dpxHeader, readBuf, fd, element, block, reinterpret_cast<U16 *>(data));
+			return ReadImageBlock<IR, U16, dpx::kWord>(dpxHeader, readBuf, fd, element, block, reinterpret_cast<U16 *>(data), bandUnpack);
 		else if (size == dpx::kInt)
-			return ReadImageBlock<IR, U32, dpx::kInt>(dpxHeader, readBuf, fd, element, block, reinterpret_cast<U32 *>(data));
+			return ReadImageBlock<IR, U32, dpx::kInt>(dpxHeader, readBuf, fd, element, block, reinterpret_cast<U32 *>(data), bandUnpack);
 		else if (size == dpx::kFloat)
-			return ReadImageBlock<IR, R32, dpx::kFloat>(dpxHeader, readBuf, fd, element, block, reinterpret_cast<R32 *>(data));	
+			return ReadImageBlock<IR, R32, dpx::kFloat>(dpxHeader, readBuf, fd, element, block, reinterpret_cast<R32 *>(data), bandUnpack);	
 		else if (size == dpx::kDouble)
-			return ReadImageBlock<IR, R64, dpx::kDouble>(dpxHeader, readBuf, fd, element, block, reinterpret_cast<R64 *>(data));
+			return ReadImageBlock<IR, R64, dpx::kDouble>(dpxHeader, readBuf, fd, element, block, reinterpret_cast<R64 *>(data), bandUnpack);
 
 		// should not reach here
 		return false;
@@ -70,7 +70,7 @@ void dpx::RunLengthEncoding::Reset()
 }
 
 
-bool dpx::RunLengthEncoding::Read(const Header &dpxHeader, ElementReadStream *fd, const int element, const Block &block, void *data, const DataSize size)
+bool dpx::RunLengthEncoding::Read(const Header &dpxHeader, ElementReadStream *fd, const int element, const Block &block, void *data, const DataSize size, const bool /*bandUnpack*/)
 {
 	int i;
 	
@@ -73,6 +73,7 @@ namespace dpx
 		 * \param block image area to read
 		 * \param data buffer
 		 * \param size size of the buffer component
+		 * \param bandUnpack whether full-width blocks may be read and unpacked a band at a time
 		 * \return success
 		 */		
 		virtual bool Read(const dpx::Header &dpxHeader, 
@@ -80,7 +81,8 @@ namespace dpx
 						  const int element, 
 						  const Block &block, 
 						  void *data, 
-                          const DataSize size) override;
+                          const DataSize size,
+                          const bool bandUnpack) override;
 		
 	protected:
 		U8 *buf;			//!< intermediate buffer
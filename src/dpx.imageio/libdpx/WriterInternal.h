@@ -37,6 +37,11 @@
 #define _DPX_WRITERINTERNAL_H 1
 
 
+#include <algorithm>
+#include <vector>
+
+#include <OpenImageIO/parallel.h>
+
 #include "BaseTypeConverter.h"
 
 
@@ -257,9 +262,98 @@ namespace dpx
 	
 			
 	
+	// pack one full line of 10-bit data into filled 32-bit words, three datums
+	// per word, a word at a time (the same layout as WritePackedMethodAB_10bit)
+	template <typename IB, Packing METHOD>
+	void Fill10bitFilledLine(const IB *src, U32 *dst, const int len, const bool reverse)
+	{
+		const int method_shift = (METHOD == kFilledMethodA ? 2 : 0);
+		const int shift0 = (reverse ? 20 : 0) + method_shift;
+		const int shift1 = 10 + method_shift;
+		const int shift2 = (reverse ? 0 : 20) + method_shift;
+
+		const int words = len / 3;
+		for (int w = 0; w < words; w++)
+		{
+			const U32 d0 = static_cast<U32>(src[3 * w]) >> 6;
+			const U32 d1 = static_cast<U32>(src[3 * w + 1]) >> 6;
+			const U32 d2 = static_cast<U32>(src[3 * w + 2]) >> 6;
+			dst[w] = ((d0 & 0x3ff) << shift0) | ((d1 & 0x3ff) << shift1) | ((d2 & 0x3ff) << shift2);
+		}
+
+		// datums in the last, partially filled word
+		if (words * 3 < len)
+		{
+			U32 value = 0;
+			for (int i = words * 3; i < len; i++)
+			{
+				const int rem = i - words * 3;
+				const U32 d = (static_cast<U32>(src[i]) >> 6) & 0x3ff;
+				value |= d << ((reverse ? 2 - rem : rem) * 10 + method_shift);
+			}
+			dst[words] = value;
+		}
+	}
+
+
+	// write uncompressed 10-bit filled data without end of line padding: pack
+	// bands of lines in parallel and write each band with a single call
+	template <typename IB, bool SAMEBUFTYPE>
+	int WriteFilled10bitBands(OutStream *fd, DataSize src_size, void *src_buf, const U32 width, const U32 height, const int noc, const Packing packing,
+					const bool reverse, bool &status, bool swapEndian)
+	{
+		const int len = width * noc;
+		const int words = (len + 2) / 3;
+		const U32 bandHeight = 64;
+		const unsigned char *imageBuf = reinterpret_cast<unsigned char*>(src_buf);
+		const int bytes = Header::DataSizeByteCount(src_size);
+
+		int fileOffset = 0;
+		std::vector<U32> band(size_t(std::min(height, bandHeight)) * words);
+		for (U32 y = 0; y < height; y += bandHeight)
+		{
+			const U32 lines = std::min(bandHeight, height - y);
+			OIIO::parallel_for_chunked(0, lines, 0, [&](int64_t lbegin, int64_t lend) {
+				std::vector<IB> copy(SAMEBUFTYPE ? len : 0);
+				for (int64_t l = lbegin; l < lend; l++)
+				{
+					unsigned char *lineBuf = const_cast<unsigned char*>(imageBuf + size_t(y + l) * len * bytes);
+					const IB *src = reinterpret_cast<const IB*>(lineBuf);
+
+					// copy buffer if need to promote data types from src to destination
+					if (SAMEBUFTYPE)
+					{
+						CopyWriteBuffer<IB>(src_size, lineBuf, copy.data(), len);
+						src = copy.data();
+					}
+
+					U32 *dst = &band[size_t(l) * words];
+					if (packing == kFilledMethodA)
+						Fill10bitFilledLine<IB, kFilledMethodA>(src, dst, len, reverse);
+					else
+						Fill10bitFilledLine<IB, kFilledMethodB>(src, dst, len, reverse);
+					if (swapEndian)
+						EndianBufferSwap(10, packing, dst, words * sizeof(U32));
+				}
+			});
+
+			// write band
+			const size_t size = size_t(lines) * words * sizeof(U32);
+			if (!fd->WriteCheck(band.data(), size))
+			{
+				status = false;
+				break;
+			}
+			fileOffset += int(size);
+		}
+
+		return fileOffset;
+	}
+
+
 	template <typename IB, int BITDEPTH, bool SAMEBUFTYPE>
 	int WriteBuffer(OutStream *fd, DataSize src_size, void *src_buf, const U32 width, const U32 height, const int noc, const Packing packing, 
-					const bool rle, bool reverse, const int eolnPad, char *blank, bool &status, bool swapEndian)
+					const bool rle, bool reverse, const int eolnPad, char *blank, bool &status, bool swapEndian, const bool bandPack)
 	{
 		int fileOffset = 0;
 		
@@ -274,14 +368,18 @@ namespace dpx
 		bufaccess.offset = 0;
 		bufaccess.length = width * noc;
 		
-		// allocate one line
-		IB *src;
-		IB *dst = new IB[(width * noc) + 1 + rleBufAdd];
-
 		// not exactly sure why, but the datum order is wrong when writing 4-channel images, so reverse it
 		if (noc == 4 && BITDEPTH == 10)
 			reverse = !reverse;
 
+		// uncompressed, unpadded 10-bit filled lines are packed a band at a time
+		if (BITDEPTH == 10 && packing != kPacked && !rle && eolnPad == 0 && bandPack)
+			return WriteFilled10bitBands<IB, SAMEBUFTYPE>(fd, src_size, src_buf, width, height, noc, packing, reverse, status, swapEndian);
+
+		// allocate one line
+		IB *src;
+		IB *dst = new IB[(width * noc) + 1 + rleBufAdd];
+
 		// each line in the buffer
 		for (U32 h = 0; h < height; h++)
 		{
@@ -24,6 +24,9 @@ extern "C" {  // ffmpeg is a C api
 #define USE_FFMPEG_4_2 (LIBAVCODEC_VERSION_INT >= AV_VERSION_INT(58, 54, 100))
 #define USE_FFMPEG_4_3 (LIBAVCODEC_VERSION_INT >= AV_VERSION_INT(58, 91, 100))
 #define USE_FFMPEG_4_4 (LIBAVCODEC_VERSION_INT >= AV_VERSION_INT(58, 134, 100))
+// Public access to a stream's index, which was a plain field before
+#define USE_FFMPEG_INDEX_API \
+    (LIBAVFORMAT_VERSION_INT >= AV_VERSION_INT(58, 78, 100))
 
 #if !USE_FFMPEG_4_0
 #    error "OIIO FFmpeg support requires FFmpeg >= 4.0"
@@ -72,13 +75,182 @@ receive_frame(AVCodecContext* avctx, AVFrame* picture, AVPacket* avpkt)
 
 
 #include <OpenImageIO/color.h>
+#include <OpenImageIO/filesystem.h>
 #include <OpenImageIO/imageio.h>
+#include <algorithm>
+#include <ctime>
 #include <iostream>
+#include <list>
+#include <map>
+#include <memory>
 #include <mutex>
 
 OIIO_PLUGIN_NAMESPACE_BEGIN
 
 
+// Where the keyframes of a movie's video stream are. Seeking always lands
+// on a keyframe and decodes forward from there, so this tells us when it's
+// cheaper to just go on decoding from where we are.
+struct FrameIndex {
+    std::vector<int> keyframes;  // Frame numbers, in ascending order
+    // What the file looked like when we indexed it
+    std::time_t mtime = 0;
+    uint64_t size     = 0;
+
+    // The last keyframe at or before `frame`, or -1 if there is none.
+    int keyframe_before(int frame) const
+    {
+        auto k = std::upper_bound(keyframes.begin(), keyframes.end(), frame);
+        return k == keyframes.begin() ? -1 : *(k - 1);
+    }
+};
+
+// Indexes are kept by filename, so that reopening a movie (as an
+// ImageCache may do many times) doesn't need to index it again. Only the
+// most recently used ones are kept, and any that no longer match their
+// file are dropped when next looked up.
+class FrameIndexCache {
+public:
+    // The index of the file, if we have one for it as it is now.
+    std::shared_ptr<const FrameIndex> find(const std::string& filename,
+                                           std::time_t mtime, uint64_t size)
+    {
+        std::lock_guard lock(m_mutex);
+        auto found = m_lookup.find(filename);
+        if (found == m_lookup.end())
+            return nullptr;
+        auto entry = found->second;
+        if (entry->second->mtime != mtime || entry->second->size != size) {
+            m_lookup.erase(found);  // The file has changed since
+            m_indexes.erase(entry);
+            return nullptr;
+        }
+        m_indexes.splice(m_indexes.begin(), m_indexes, entry);
+        return entry->second;
+    }
+
+    void insert(const std::string& filename,
+                std::shared_ptr<const FrameIndex> index)
+    {
+        std::lock_guard lock(m_mutex);
+        auto found = m_lookup.find(filename);
+        if (found != m_lookup.end())
+            m_indexes.erase(found->second);
+        m_indexes.emplace_front(filename, std::move(index));
+        m_lookup[filename] = m_indexes.begin();
+        while (m_indexes.size() > max_indexes) {
+            m_lookup.erase(m_indexes.back().first);
+            m_indexes.pop_back();
+        }
+    }
+
+private:
+    static constexpr size_t max_indexes = 64;
+    using Entry = std::pair<std::string, std::shared_ptr<const FrameIndex>>;
+    std::mutex m_mutex;
+    std::list<Entry> m_indexes;  // Most recently used first
+    std::map<std::string, std::list<Entry>::iterator> m_lookup;
+};
+
+static FrameIndexCache frame_indexes;
+
+
+
+// The most recently decoded frames of all the open movies, already
+// converted to the pixel format we deliver, up to a total size in bytes.
+// There is one cache for the whole process, so that its memory doesn't
+// multiply with the number of movies that are open at once (as many may
+// be, by an ImageCache). Frames are kept by the ImageInput that decoded
+// them, which forgets them when it closes its file.
+class FrameCache {
+public:
+    void capacity(size_t bytes)
+    {
+        std::lock_guard lock(m_mutex);
+        m_capacity = bytes;
+        shrink(m_capacity);
+    }
+    size_t capacity() const
+    {
+        std::lock_guard lock(m_mutex);
+        return m_capacity;
+    }
+
+    // Copy the frame's pixels into `pixels` and return true, or return
+    // false if we don't have them.
+    bool find(const void* owner, int frame, std::vector<uint8_t>& pixels)
+    {
+        std::lock_guard lock(m_mutex);
+        for (auto f = m_frames.begin(); f != m_frames.end(); ++f) {
+            if (f->owner == owner && f->frame == frame) {
+                m_frames.splice(m_frames.begin(), m_frames, f);
+                pixels = f->pixels;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void insert(const void* owner, int frame,
+                const std::vector<uint8_t>& pixels)
+    {
+        std::lock_guard lock(m_mutex);
+        if (pixels.size() > m_capacity)
+            return;
+        for (const auto& f : m_frames)
+            if (f.owner == owner && f.frame == frame)
+                return;
+        // Recycle the least recently used frame's memory
+        std::vector<uint8_t> buf = shrink(m_capacity - pixels.size());
+        buf.assign(pixels.begin(), pixels.end());
+        m_frames.push_front({ owner, frame, std::move(buf) });
+        m_bytes += pixels.size();
+    }
+
+    // Forget all the frames of one owner.
+    void clear(const void* owner)
+    {
+        std::lock_guard lock(m_mutex);
+        for (auto f = m_frames.begin(); f != m_frames.end();) {
+            if (f->owner == owner) {
+                m_bytes -= f->pixels.size();
+                f = m_frames.erase(f);
+            } else {
+                ++f;
+            }
+        }
+    }
+
+private:
+    struct Entry {
+        const void* owner;
+        int frame;
+        std::vector<uint8_t> pixels;
+    };
+
+    // Drop the least recently used frames until no more than `bytes` are
+    // kept, and return the memory of the last one dropped. Call with
+    // m_mutex held.
+    std::vector<uint8_t> shrink(size_t bytes)
+    {
+        std::vector<uint8_t> buf;
+        while (m_bytes > bytes) {
+            buf = std::move(m_frames.back().pixels);
+            m_bytes -= buf.size();
+            m_frames.pop_back();
+        }
+        return buf;
+    }
+
+    mutable std::mutex m_mutex;
+    std::list<Entry> m_frames;  // Most recently used first
+    size_t m_bytes    = 0;
+    size_t m_capacity = 0;
+};
+
+static FrameCache frame_cache;
+
+
 class FFmpegInput final : public ImageInput {
 public:
     FFmpegInput();
@@ -107,6 +279,7 @@ public:
     bool seek(int pos);
     double fps() const;
     int64_t time_stamp(int pos) const;
+    int frame_number(int64_t pts) const;
 
 private:
     std::string m_filename;
@@ -132,6 +305,13 @@ private:
     bool m_codec_cap_delay;
     bool m_read_frame;
     int64_t m_start_time;
+    int m_sequential_reads;  // How many frames we've just read in order
+    std::shared_ptr<const FrameIndex> m_index;
+
+    const FrameIndex& frame_index();
+    std::shared_ptr<FrameIndex> build_frame_index();
+    bool decodes_forward_to(int frame);
+    void convert_frame();
 
     // init to initialize state
     void init(void)
@@ -150,12 +330,15 @@ private:
         m_data_stream      = -1;
         m_frames           = 0;
         m_last_search_pos  = 0;
-        m_last_decoded_pos = 0;
+        m_last_decoded_pos = -1;
         m_offset_time      = true;
         m_read_frame       = false;
         m_codec_cap_delay  = false;
         m_subimage         = 0;
         m_start_time       = 0;
+        m_sequential_reads = 0;
+        m_index.reset();
+        frame_cache.clear(this);
     }
 };
 
@@ -558,6 +741,11 @@ FFmpegInput::open(const std::string& name, ImageSpec& spec)
     m_nsubimages = m_frames;
     spec         = m_spec;
     m_filename   = name;
+    frame_cache.capacity(
+        size_t(std::max(0, OIIO::get_int_attribute("ffmpeg:frame_cache_MB")))
+        << 20);
+    // Finding the frame count may have left the stream anywhere
+    m_last_decoded_pos = -1;
     return true;
 }
 
@@ -674,9 +862,28 @@ FFmpegInput::close(void)
 void
 FFmpegInput::read_frame(int frame)
 {
-    if (m_last_decoded_pos + 1 != frame) {
+    m_sequential_reads = (frame == m_last_decoded_pos + 1)
+                             ? m_sequential_reads + 1
+                             : 0;
+    if (frame_cache.find(this, frame, m_rgb_buffer)) {
+        avpicture_fill(m_rgb_frame, &m_rgb_buffer[0], m_dst_pix_format,
+                       m_codec_context->width, m_codec_context->height);
+        m_read_frame = true;
+        return;
+    }
+    if (!decodes_forward_to(frame)) {
         seek(frame);
     }
+
+    // Frames we decode on the way to this one are worth keeping if they
+    // will fit in the cache alongside it, since whoever wants this frame
+    // may well want the ones just before it next (when scrubbing backwards,
+    // say). When reading straight through, nobody will want any of them
+    // again.
+    int keep = 0;
+    if (m_sequential_reads < 2 && m_rgb_buffer.size())
+        keep = int(frame_cache.capacity() / m_rgb_buffer.size());
+
     AVPacket pkt;
     int finished = 0;
     int ret      = 0;
@@ -693,28 +900,25 @@ FFmpegInput::read_frame(int frame)
 
             finished = receive_frame(m_codec_context, m_frame, &pkt);
 
-            double pts = 0;
-            if (static_cast<int64_t>(m_frame->pts) != int64_t(AV_NOPTS_VALUE)) {
-                pts = av_q2d(
-                          m_format_context->streams[m_video_stream]->time_base)
-                      * m_frame->pts;
-            }
-
-            int current_frame = int((pts - m_start_time) * fps() + 0.5f);  //???
+            int current_frame = frame_number(m_frame->pts);
             //current_frame =   m_frame->display_picture_number;
             m_last_search_pos = current_frame;
 
             if (current_frame == frame && finished) {
-                avpicture_fill(m_rgb_frame, &m_rgb_buffer[0], m_dst_pix_format,
-                               m_codec_context->width, m_codec_context->height);
-                sws_scale(m_sws_rgb_context,
-                          static_cast<uint8_t const* const*>(m_frame->data),
-                          m_frame->linesize, 0, m_codec_context->height,
-                          m_rgb_frame->data, m_rgb_frame->linesize);
+                convert_frame();
                 m_last_decoded_pos = current_frame;
+                if (keep)
+                    frame_cache.insert(this, frame, m_rgb_buffer);
                 av_packet_unref(&pkt);
                 break;
             }
+            if (finished && current_frame < frame
+                && current_frame > frame - keep) {
+                convert_frame();
+                frame_cache.insert(this, current_frame, m_rgb_buffer);
+            }
+            if (finished)
+                m_last_decoded_pos = current_frame;
         }
         av_packet_unref(&pkt);
     }
@@ -723,6 +927,97 @@ FFmpegInput::read_frame(int frame)
 
 
 
+// Convert the decoded m_frame to our pixel format, in m_rgb_buffer.
+void
+FFmpegInput::convert_frame()
+{
+    avpicture_fill(m_rgb_frame, &m_rgb_buffer[0], m_dst_pix_format,
+                   m_codec_context->width, m_codec_context->height);
+    sws_scale(m_sws_rgb_context,
+              static_cast<uint8_t const* const*>(m_frame->data),
+              m_frame->linesize, 0, m_codec_context->height, m_rgb_frame->data,
+              m_rgb_frame->linesize);
+}
+
+
+
+// Can we get to `frame` just by decoding on from the last frame we decoded?
+// If not, we'll have to seek.
+bool
+FFmpegInput::decodes_forward_to(int frame)
+{
+    if (m_last_decoded_pos < 0 || frame <= m_last_decoded_pos)
+        return false;
+    if (frame == m_last_decoded_pos + 1)
+        return true;  // The next frame, as when reading straight through
+    const FrameIndex& index(frame_index());
+    if (m_last_decoded_pos < 0 || index.keyframes.empty())
+        return false;  // Indexing lost our place, or found nothing
+    // Seeking would take us back to the last keyframe at or before the
+    // frame, and decode forward from there. If we're already past that
+    // keyframe, that would only decode again the frames we've just done.
+    return index.keyframe_before(frame) <= m_last_decoded_pos;
+}
+
+
+
+const FrameIndex&
+FFmpegInput::frame_index()
+{
+    if (m_index)
+        return *m_index;
+    std::time_t mtime = Filesystem::last_write_time(m_filename);
+    uint64_t size     = Filesystem::file_size(m_filename);
+    m_index           = frame_indexes.find(m_filename, mtime, size);
+    if (!m_index) {
+        auto index   = build_frame_index();
+        index->mtime = mtime;
+        index->size  = size;
+        frame_indexes.insert(m_filename, index);
+        m_index = index;
+    }
+    return *m_index;
+}
+
+
+
+std::shared_ptr<FrameIndex>
+FFmpegInput::build_frame_index()
+{
+    auto index = std::make_shared<FrameIndex>();
+#if USE_FFMPEG_INDEX_API
+    AVStream* stream = m_format_context->streams[m_video_stream];
+    // Most containers have an index of their own, which we can use without
+    // reading anything more of the file.
+    for (int i = 0, n = avformat_index_get_entries_count(stream); i < n; ++i) {
+        const AVIndexEntry* entry = avformat_index_get_entry(stream, i);
+        if (entry && (entry->flags & AVINDEX_KEYFRAME))
+            index->keyframes.push_back(frame_number(entry->timestamp));
+    }
+#endif
+    if (index->keyframes.empty()) {
+        // No such luck, so read through all the video packets (without
+        // decoding them) to see which of them start keyframes.
+        seek(0);
+        AVPacket pkt;
+        while (av_read_frame(m_format_context, &pkt) >= 0) {
+            if (pkt.stream_index == m_video_stream
+                && (pkt.flags & AV_PKT_FLAG_KEY))
+                index->keyframes.push_back(frame_number(
+                    pkt.pts != int64_t(AV_NOPTS_VALUE) ? pkt.pts : pkt.dts));
+            av_packet_unref(&pkt);
+        }
+        m_last_decoded_pos = -1;  // Wherever we were, we're not there now
+    }
+    std::sort(index->keyframes.begin(), index->keyframes.end());
+    index->keyframes.erase(std::unique(index->keyframes.begin(),
+                                       index->keyframes.end()),
+                           index->keyframes.end());
+    return index;
+}
+
+
+
 #if 0
 const char *
 FFmpegInput::metadata (const char * key)
@@ -773,6 +1068,18 @@ FFmpegInput::time_stamp(int frame) const
 
 
 
+// The frame number of a decoded frame's presentation time stamp
+int
+FFmpegInput::frame_number(int64_t pts) const
+{
+    double t = 0;
+    if (pts != int64_t(AV_NOPTS_VALUE))
+        t = av_q2d(m_format_context->streams[m_video_stream]->time_base) * pts;
+    return int((t - m_start_time) * fps() + 0.5f);  //???
+}
+
+
+
 double
 FFmpegInput::fps() const
 {
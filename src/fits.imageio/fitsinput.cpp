@@ -32,6 +32,10 @@ fits_input_imageio_create()
 }
 
 OIIO_EXPORT const char* fits_input_extensions[] = { "fits", nullptr };
+OIIO_EXPORT const char* fits_imageio_signatures[] = {
+    "53494d504c45",  // SIMPLE
+    nullptr
+};
 
 OIIO_PLUGIN_EXPORTS_END
 
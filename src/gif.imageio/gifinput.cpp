@@ -128,6 +128,10 @@ gif_input_imageio_create()
     return new GIFInput;
 }
 OIIO_EXPORT const char* gif_input_extensions[] = { "gif", NULL };
+OIIO_EXPORT const char* gif_imageio_signatures[] = {
+    "47494638",  // GIF8
+    nullptr
+};
 
 OIIO_EXPORT const char*
 gif_imageio_library_version()
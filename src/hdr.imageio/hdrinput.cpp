@@ -112,6 +112,10 @@ hdr_input_imageio_create()
 }
 
 OIIO_EXPORT const char* hdr_input_extensions[] = { "hdr", "rgbe", nullptr };
+OIIO_EXPORT const char* hdr_imageio_signatures[] = {
+    "233f",  // #?
+    nullptr
+};
 
 OIIO_PLUGIN_EXPORTS_END
 
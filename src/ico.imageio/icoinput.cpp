@@ -106,6 +106,7 @@ ico_imageio_library_version()
 }
 
 OIIO_EXPORT const char* ico_input_extensions[] = { "ico", nullptr };
+OIIO_EXPORT const char* ico_imageio_signatures[] = { "00000100", nullptr };
 
 OIIO_PLUGIN_EXPORTS_END
 
@@ -5,6 +5,8 @@
 
 #include <cmath>
 
+#include <OpenImageIO/parallel.h>
+
 OIIO_PLUGIN_NAMESPACE_BEGIN
 
 using namespace iff_pvt;
@@ -49,6 +51,19 @@ private:
     // helper to read an image
     bool readimg(void);
 
+    // A tile chunk read by readimg(), waiting to be decoded into m_buf
+    struct TileChunk {
+        bool zbuf;
+        uint16_t xmin, ymin, xmax, ymax;
+        uint32_t size;                 // unaligned chunk size
+        std::vector<uint8_t> scratch;  // tile data after the coordinates
+    };
+
+    // helpers to decode one tile into m_buf. Safe to call for different
+    // tiles concurrently; on failure, err describes the problem.
+    bool decode_rgba_tile(TileChunk& tile, std::string& err);
+    bool decode_zbuf_tile(TileChunk& tile, std::string& err);
+
     // helper to uncompress a rle channel
     size_t uncompress_rle_channel(span<uint8_t> in, span<uint8_t> out,
                                   size_t max);
@@ -574,6 +589,9 @@ IffInput::readimg()
     // resize buffer
     m_buf.resize(m_header.image_bytes());
 
+    // Read all the tile chunks first. Each one is independent of the
+    // others, so they are decoded in parallel below.
+    std::vector<TileChunk> tiles;
     while ((rgbatiles < m_header.tiles && m_header.rgba_count > 0)
            || (ztiles < m_header.tiles && m_header.zbuffer > 0)) {
         // get type and length
@@ -583,419 +601,433 @@ IffInput::readimg()
         }
         chunksize = align_chunk(size, 4);
 
-        // chunk type: RGBA
-        if (std::memcmp(chunktype, iff_rgba_tag, 4) == 0) {
+        bool rgba = std::memcmp(chunktype, iff_rgba_tag, 4) == 0;
+        bool zbuf = std::memcmp(chunktype, iff_zbuf_tag, 4) == 0;
+        if (rgba || zbuf) {
             // get tile coordinates.
-            uint16_t xmin, xmax, ymin, ymax;
-            if (!read(&xmin) || !read(&ymin) || !read(&xmax) || !read(&ymax)) {
+            TileChunk tile;
+            tile.zbuf = zbuf;
+            tile.size = size;
+            if (!read(&tile.xmin) || !read(&tile.ymin) || !read(&tile.xmax)
+                || !read(&tile.ymax)) {
                 errorfmt("IFF error io read xmin, ymin, xmax and ymax failed");
                 return false;
             }
 
-            // get tile width/height
-            uint32_t tw = xmax - xmin + 1;
-            uint32_t th = ymax - ymin + 1;
+            // check tile
+            if (tile.xmin > tile.xmax || tile.ymin > tile.ymax
+                || tile.xmax >= m_spec.width || tile.ymax >= m_spec.height) {
+                errorfmt(
+                    "IFF error io xmin, ymin, xmax or ymax does not match");
+                return false;
+            }
+            if (rgba && m_header.rgba_bits != 8 && m_header.rgba_bits != 16) {
+                errorfmt("\"{}\": unsupported number of bits per pixel for tile",
+                         m_filename);
+                return false;
+            }
 
             // get image size
             // skip coordinates, uint16_t (2) * 4 = 8
-            uint32_t image_size = chunksize - 8;
+            if (chunksize < 8 || chunksize - 8 > ioproxy()->size()) {
+                errorfmt("IFF error io tile chunk size {} is invalid", size);
+                return false;
+            }
+            tile.scratch.resize(chunksize - 8);
+            if (!ioread(tile.scratch.data(), 1, tile.scratch.size()))
+                return false;
+            tiles.push_back(std::move(tile));
 
-            // check tile
-            if (xmin > xmax || ymin > ymax || xmax >= m_spec.width
-                || ymax >= m_spec.height || !tw || !th) {
-                errorfmt(
-                    "IFF error io xmin, ymin, xmax or ymax does not match");
+            if (rgba)
+                rgbatiles++;
+            else
+                ztiles++;
+        } else {
+            // skip to the next block
+            if (!ioseek(chunksize, SEEK_CUR)) {
                 return false;
             }
+        }
+    }
 
-            // tile compress
-            bool tile_compressed = false;
+    // Tiles of each kind must cover disjoint parts of the image: they're
+    // decompressed concurrently below, and overlapping tiles would have
+    // several threads writing the same parts of m_buf. (An RGBA and a zbuf
+    // tile may cover the same pixels, they write different bytes of them.)
+    std::vector<bool> covered[2];
+    for (const TileChunk& tile : tiles) {
+        std::vector<bool>& cov(covered[tile.zbuf]);
+        if (cov.empty())
+            cov.resize(size_t(m_spec.width) * m_spec.height);
+        for (int y = tile.ymin; y <= tile.ymax; ++y) {
+            for (int x = tile.xmin; x <= tile.xmax; ++x) {
+                size_t p = size_t(y) * m_spec.width + x;
+                if (cov[p]) {
+                    errorfmt("IFF error io tiles overlap at ({}, {})", x, y);
+                    return false;
+                }
+                cov[p] = true;
+            }
+        }
+    }
 
-            // if tile compression fails to be less than image data stored
-            // uncompressed the tile is written uncompressed
+    // Tiles cover disjoint parts of m_buf, so they may be decompressed
+    // concurrently. Errors can't be reported from the worker threads, so
+    // each tile stashes its own.
+    std::vector<std::string> errors(tiles.size());
+    OIIO::parallel_for(
+        int64_t(0), int64_t(tiles.size()),
+        [&](int64_t i) {
+            if (tiles[i].zbuf)
+                decode_zbuf_tile(tiles[i], errors[i]);
+            else
+                decode_rgba_tile(tiles[i], errors[i]);
+        },
+        paropt(threads()).minitems(1));
+    for (const std::string& err : errors) {
+        if (err.size()) {
+            errorfmt("{}", err);
+            return false;
+        }
+    }
 
-            // set tile size
-            uint32_t tile_size = tw * th * m_header.rgba_channels_bytes() + 8;
+    // flip buffer to make read_native_tile easier,
+    // from tga.imageio:
 
-            // test if compressed
-            // we use the non aligned size
-            if (tile_size > size) {
-                tile_compressed = true;
-            }
+    int bytespp = m_header.pixel_bytes();
 
-            // handle 8-bit data.
-            if (m_header.rgba_bits == 8) {
-                std::vector<uint8_t> scratch;
-                scratch.resize(image_size);
+    std::vector<unsigned char> flip(m_spec.width * bytespp);
+    unsigned char *src, *dst, *tmp = flip.data();
+    for (int y = 0; y < m_spec.height / 2; y++) {
+        src = &m_buf[(m_spec.height - y - 1) * m_spec.width * bytespp];
+        dst = &m_buf[y * m_spec.width * bytespp];
 
-                if (!ioread(scratch.data(), 1, scratch.size())) {
-                    return false;
-                }
+        memcpy(tmp, src, m_spec.width * bytespp);
+        memcpy(src, dst, m_spec.width * bytespp);
+        memcpy(dst, tmp, m_spec.width * bytespp);
+    }
+    return true;
+}
 
-                span<uint8_t> scratch_span(scratch);
 
-                if (tile_compressed) {
-                    for (int c = m_header.rgba_count - 1; c >= 0; --c) {
-                        std::vector<uint8_t> in(tw * th);
-                        span<uint8_t> in_span(in);
 
-                        size_t used = uncompress_rle_channel(scratch_span,
-                                                             in_span, tw * th);
-                        if (used > scratch_span.size()) {
-                            errorfmt(
-                                "RLE uncompress exceeds buffer size for channel: {}",
-                                c);
-                            return false;
-                        }
+bool
+IffInput::decode_rgba_tile(TileChunk& tile, std::string& err)
+{
+    uint16_t xmin = tile.xmin, ymin = tile.ymin;
+    uint16_t xmax = tile.xmax, ymax = tile.ymax;
 
-                        scratch_span = scratch_span.subspan(used);
+    // get tile width/height
+    uint32_t tw = xmax - xmin + 1;
+    uint32_t th = ymax - ymin + 1;
 
-                        size_t offset = 0;
-                        for (uint16_t py = ymin; py <= ymax; ++py) {
-                            uint8_t* out_dy = m_buf.data()
-                                              + (py * m_header.width)
-                                                    * m_header.pixel_bytes();
+    // tile compress
+    bool tile_compressed = false;
 
-                            for (uint16_t px = xmin; px <= xmax; ++px) {
-                                if (offset >= in_span.size()) {
-                                    errorfmt(
-                                        "in_span underflow at pixel ({}, {})",
-                                        px, py);
-                                    return false;
-                                }
+    // if tile compression fails to be less than image data stored
+    // uncompressed the tile is written uncompressed
 
-                                uint8_t* out_p
-                                    = out_dy + px * m_header.pixel_bytes() + c;
-                                *out_p = in_span[offset++];
-                            }
-                        }
-                    }
-                } else {
-                    uint8_t* p = scratch.data();
-                    span<uint8_t> input(p,
-                                        (ymax - ymin + 1) * tw
-                                            * m_header.rgba_channels_bytes());
-
-                    int sy = 0;
-                    for (uint16_t py = ymin; py <= ymax; ++py, ++sy) {
-                        uint8_t* out_dy = m_buf.data()
-                                          + (py * m_header.width)
-                                                * m_header.pixel_bytes();
-
-                        int sx = 0;
-                        for (uint16_t px = xmin; px <= xmax; ++px, ++sx) {
-                            size_t offset = (sy * tw + sx)
-                                            * m_header.rgba_channels_bytes();
-
-                            if (offset + m_header.rgba_channels_bytes()
-                                > input.size()) {
-                                errorfmt("input span overflow at ({}, {})", px,
-                                         py);
-                                return false;
-                            }
+    // set tile size
+    uint32_t tile_size = tw * th * m_header.rgba_channels_bytes() + 8;
 
-                            span<uint8_t> pixel_in
-                                = input.subspan(offset,
-                                                m_header.rgba_channels_bytes());
-                            uint8_t* out_p = out_dy
-                                             + px * m_header.pixel_bytes();
+    // test if compressed
+    // we use the non aligned size
+    if (tile_size > tile.size) {
+        tile_compressed = true;
+    }
 
-                            // map BGR(A) to RGB(A)
-                            for (int c = m_header.rgba_count - 1; c >= 0; --c) {
-                                *out_p++ = pixel_in[c];
-                            }
+    std::vector<uint8_t>& scratch = tile.scratch;
+    span<uint8_t> scratch_span(scratch);
+
+    // handle 8-bit data.
+    if (m_header.rgba_bits == 8) {
+        if (tile_compressed) {
+            for (int c = m_header.rgba_count - 1; c >= 0; --c) {
+                std::vector<uint8_t> in(tw * th);
+                span<uint8_t> in_span(in);
+
+                size_t used = uncompress_rle_channel(scratch_span, in_span,
+                                                     tw * th);
+                if (used > scratch_span.size()) {
+                    err = Strutil::fmt::format(
+                        "RLE uncompress exceeds buffer size for channel: {}",
+                        c);
+                    return false;
+                }
+
+                scratch_span = scratch_span.subspan(used);
+
+                size_t offset = 0;
+                for (uint16_t py = ymin; py <= ymax; ++py) {
+                    uint8_t* out_dy = m_buf.data()
+                                      + (py * m_header.width)
+                                            * m_header.pixel_bytes();
+
+                    for (uint16_t px = xmin; px <= xmax; ++px) {
+                        if (offset >= in_span.size()) {
+                            err = Strutil::fmt::format(
+                                "in_span underflow at pixel ({}, {})", px, py);
+                            return false;
                         }
+
+                        uint8_t* out_p = out_dy + px * m_header.pixel_bytes()
+                                         + c;
+                        *out_p = in_span[offset++];
                     }
                 }
             }
-            // handle 16-bit data.
-            else if (m_header.rgba_bits == 16) {
-                std::vector<uint8_t> scratch;
-                scratch.resize(image_size);
-
-                if (!ioread(scratch.data(), 1, scratch.size())) {
-                    return false;
-                }
+        } else {
+            uint8_t* p = scratch.data();
+            span<uint8_t> input(p, (ymax - ymin + 1) * tw
+                                       * m_header.rgba_channels_bytes());
+
+            int sy = 0;
+            for (uint16_t py = ymin; py <= ymax; ++py, ++sy) {
+                uint8_t* out_dy = m_buf.data()
+                                  + (py * m_header.width)
+                                        * m_header.pixel_bytes();
+
+                int sx = 0;
+                for (uint16_t px = xmin; px <= xmax; ++px, ++sx) {
+                    size_t offset = (sy * tw + sx)
+                                    * m_header.rgba_channels_bytes();
+
+                    if (offset + m_header.rgba_channels_bytes()
+                        > input.size()) {
+                        err = Strutil::fmt::format(
+                            "input span overflow at ({}, {})", px, py);
+                        return false;
+                    }
 
-                span<uint8_t> scratch_span(scratch);
+                    span<uint8_t> pixel_in
+                        = input.subspan(offset,
+                                        m_header.rgba_channels_bytes());
+                    uint8_t* out_p = out_dy + px * m_header.pixel_bytes();
 
-                if (tile_compressed) {
-                    std::vector<uint8_t> map;
-                    if (littleendian()) {
-                        uint8_t rgb16[]  = { 0, 2, 4, 1, 3, 5 };
-                        uint8_t rgba16[] = { 0, 2, 4, 6, 1, 3, 5, 7 };
-                        map              = (m_header.rgba_count == 3)
-                                               ? std::vector<uint8_t>(rgb16, rgb16 + 6)
-                                               : std::vector<uint8_t>(rgba16, rgba16 + 8);
-                    } else {
-                        uint8_t rgb16[]  = { 1, 3, 5, 0, 2, 4 };
-                        uint8_t rgba16[] = { 1, 3, 5, 7, 0, 2, 4, 6 };
-                        map              = (m_header.rgba_count == 3)
-                                               ? std::vector<uint8_t>(rgb16, rgb16 + 6)
-                                               : std::vector<uint8_t>(rgba16, rgba16 + 8);
+                    // map BGR(A) to RGB(A)
+                    for (int c = m_header.rgba_count - 1; c >= 0; --c) {
+                        *out_p++ = pixel_in[c];
                     }
+                }
+            }
+        }
+    }
+    // handle 16-bit data.
+    else if (m_header.rgba_bits == 16) {
+        if (tile_compressed) {
+            std::vector<uint8_t> map;
+            if (littleendian()) {
+                uint8_t rgb16[]  = { 0, 2, 4, 1, 3, 5 };
+                uint8_t rgba16[] = { 0, 2, 4, 6, 1, 3, 5, 7 };
+                map              = (m_header.rgba_count == 3)
+                                       ? std::vector<uint8_t>(rgb16, rgb16 + 6)
+                                       : std::vector<uint8_t>(rgba16,
+                                                              rgba16 + 8);
+            } else {
+                uint8_t rgb16[]  = { 1, 3, 5, 0, 2, 4 };
+                uint8_t rgba16[] = { 1, 3, 5, 7, 0, 2, 4, 6 };
+                map              = (m_header.rgba_count == 3)
+                                       ? std::vector<uint8_t>(rgb16, rgb16 + 6)
+                                       : std::vector<uint8_t>(rgba16,
+                                                              rgba16 + 8);
+            }
 
-                    for (int c = m_header.rgba_count * m_header.channel_bytes()
-                                 - 1;
-                         c >= 0; --c) {
-                        int mc = map[c];
-
-                        std::vector<uint8_t> in(tw * th);
-                        span<uint8_t> in_span(in);
+            for (int c = m_header.rgba_count * m_header.channel_bytes() - 1;
+                 c >= 0; --c) {
+                int mc = map[c];
 
-                        size_t used = uncompress_rle_channel(scratch_span,
-                                                             in_span, tw * th);
-                        if (used > scratch_span.size()) {
-                            errorfmt(
-                                "RLE uncompress exceeds span size (channel byte {})",
-                                c);
-                            return false;
-                        }
+                std::vector<uint8_t> in(tw * th);
+                span<uint8_t> in_span(in);
 
-                        scratch_span = scratch_span.subspan(used);
+                size_t used = uncompress_rle_channel(scratch_span, in_span,
+                                                     tw * th);
+                if (used > scratch_span.size()) {
+                    err = Strutil::fmt::format(
+                        "RLE uncompress exceeds span size (channel byte {})",
+                        c);
+                    return false;
+                }
 
-                        size_t offset = 0;
-                        for (uint16_t py = ymin; py <= ymax; ++py) {
-                            uint8_t* out_dy = m_buf.data()
-                                              + (py * m_header.width)
-                                                    * m_header.pixel_bytes();
+                scratch_span = scratch_span.subspan(used);
 
-                            for (uint16_t px = xmin; px <= xmax; ++px) {
-                                if (offset >= in_span.size()) {
-                                    errorfmt("in_span underflow at ({}, {})",
-                                             px, py);
-                                    return false;
-                                }
+                size_t offset = 0;
+                for (uint16_t py = ymin; py <= ymax; ++py) {
+                    uint8_t* out_dy = m_buf.data()
+                                      + (py * m_header.width)
+                                            * m_header.pixel_bytes();
 
-                                uint8_t* out_p
-                                    = out_dy + px * m_header.pixel_bytes() + mc;
-                                *out_p = in_span[offset++];
-                            }
+                    for (uint16_t px = xmin; px <= xmax; ++px) {
+                        if (offset >= in_span.size()) {
+                            err = Strutil::fmt::format(
+                                "in_span underflow at ({}, {})", px, py);
+                            return false;
                         }
-                    }
-                } else {
-                    uint8_t* p = scratch.data();
-                    span<uint8_t> input(p,
-                                        (ymax - ymin + 1) * tw
-                                            * m_header.rgba_channels_bytes());
-
-                    int sy = 0;
-                    for (uint16_t py = ymin; py <= ymax; ++py, ++sy) {
-                        uint8_t* out_dy = m_buf.data()
-                                          + (py * m_header.width + xmin)
-                                                * m_header.pixel_bytes();
-
-                        std::vector<uint16_t> scanline(tw
-                                                       * m_header.rgba_count);
-                        span<uint16_t> sl_span(scanline);
-
-                        int sx = 0;
-                        for (uint16_t px = xmin; px <= xmax; ++px, ++sx) {
-                            size_t offset = (sy * tw + sx)
-                                            * m_header.rgba_channels_bytes();
-
-                            if (offset + m_header.rgba_channels_bytes()
-                                > input.size()) {
-                                errorfmt("input span overflow at ({}, {})", px,
-                                         py);
-                                return false;
-                            }
 
-                            span<uint8_t> pixel_in
-                                = input.subspan(offset,
-                                                m_header.rgba_channels_bytes());
+                        uint8_t* out_p = out_dy + px * m_header.pixel_bytes()
+                                         + mc;
+                        *out_p = in_span[offset++];
+                    }
+                }
+            }
+        } else {
+            uint8_t* p = scratch.data();
+            span<uint8_t> input(p, (ymax - ymin + 1) * tw
+                                       * m_header.rgba_channels_bytes());
+
+            int sy = 0;
+            for (uint16_t py = ymin; py <= ymax; ++py, ++sy) {
+                uint8_t* out_dy = m_buf.data()
+                                  + (py * m_header.width + xmin)
+                                        * m_header.pixel_bytes();
+
+                std::vector<uint16_t> scanline(tw * m_header.rgba_count);
+                span<uint16_t> sl_span(scanline);
+
+                int sx = 0;
+                for (uint16_t px = xmin; px <= xmax; ++px, ++sx) {
+                    size_t offset = (sy * tw + sx)
+                                    * m_header.rgba_channels_bytes();
+
+                    if (offset + m_header.rgba_channels_bytes()
+                        > input.size()) {
+                        err = Strutil::fmt::format(
+                            "input span overflow at ({}, {})", px, py);
+                        return false;
+                    }
 
-                            for (int c = m_header.rgba_count - 1; c >= 0; --c) {
-                                uint16_t pixel;
-                                memcpy(&pixel, pixel_in.data() + c * 2, 2);
+                    span<uint8_t> pixel_in
+                        = input.subspan(offset,
+                                        m_header.rgba_channels_bytes());
 
-                                if (littleendian()) {
-                                    swap_endian(&pixel);
-                                }
+                    for (int c = m_header.rgba_count - 1; c >= 0; --c) {
+                        uint16_t pixel;
+                        memcpy(&pixel, pixel_in.data() + c * 2, 2);
 
-                                if (sl_span.empty()) {
-                                    errorfmt(
-                                        "scanline span overflow at ({}, {})",
-                                        px, py);
-                                    return false;
-                                }
+                        if (littleendian()) {
+                            swap_endian(&pixel);
+                        }
 
-                                sl_span.front() = pixel;
-                                sl_span         = sl_span.subspan(1);
-                            }
+                        if (sl_span.empty()) {
+                            err = Strutil::fmt::format(
+                                "scanline span overflow at ({}, {})", px, py);
+                            return false;
                         }
 
-                        memcpy(out_dy, scanline.data(),
-                               tw * m_header.pixel_bytes());
+                        sl_span.front() = pixel;
+                        sl_span         = sl_span.subspan(1);
                     }
                 }
-            } else {
-                errorfmt("\"{}\": unsupported number of bits per pixel for tile",
-                         m_filename);
-                return false;
-            }
-
-            rgbatiles++;
 
-            // chunk type: ZBUF
-        } else if (std::memcmp(chunktype, iff_zbuf_tag, 4) == 0) {
-            // get tile coordinates.
-            uint16_t xmin, xmax, ymin, ymax;
-            if (!read(&xmin) || !read(&ymin) || !read(&xmax) || !read(&ymax)) {
-                errorfmt("IFF error io read xmin, ymin, xmax and ymax failed");
-                return false;
+                memcpy(out_dy, scanline.data(), tw * m_header.pixel_bytes());
             }
+        }
+    }
+    return true;
+}
 
-            // get tile width/height
-            uint32_t tw = xmax - xmin + 1;
-            uint32_t th = ymax - ymin + 1;
 
-            // get image size
-            // skip coordinates, uint16_t (2) * 4 = 8
-            uint32_t image_size = chunksize - 8;
 
-            // check tile
-            if (xmin > xmax || ymin > ymax || xmax >= m_spec.width
-                || ymax >= m_spec.height || !tw || !th) {
-                errorfmt(
-                    "IFF error io xmin, ymin, xmax or ymax does not match");
-                return false;
-            }
+bool
+IffInput::decode_zbuf_tile(TileChunk& tile, std::string& err)
+{
+    uint16_t xmin = tile.xmin, ymin = tile.ymin;
+    uint16_t xmax = tile.xmax, ymax = tile.ymax;
 
-            // tile compress
-            bool tile_compressed = false;
+    // get tile width/height
+    uint32_t tw = xmax - xmin + 1;
+    uint32_t th = ymax - ymin + 1;
 
-            // if tile compression fails to be less than image data stored
-            // uncompressed the tile is written uncompressed
+    // tile compress
+    bool tile_compressed = false;
 
-            // set tile size
-            uint32_t tile_size = tw * th * m_header.zbuffer_bytes() + 8;
+    // if tile compression fails to be less than image data stored
+    // uncompressed the tile is written uncompressed
 
-            // test if compressed
-            // we use the non aligned size
-            if (tile_size > size) {
-                tile_compressed = true;
-            }
+    // set tile size
+    uint32_t tile_size = tw * th * m_header.zbuffer_bytes() + 8;
 
-            // set tile size
-            std::vector<uint8_t> scratch;
+    // test if compressed
+    // we use the non aligned size
+    if (tile_size > tile.size) {
+        tile_compressed = true;
+    }
 
-            // set bytes
-            scratch.resize(image_size);
+    // zbuffer is always compressed in IFF
+    span<uint8_t> scratch_span(tile.scratch);
 
-            // zbuffer is always compressed in IFF
+    // read tile
+    if (tile_compressed) {
+        for (int c = m_header.zbuffer_bytes() - 1; c >= 0; --c) {
+            std::vector<uint8_t> in(tw * th);
+            span<uint8_t> in_span(in);
 
-            if (!ioread(scratch.data(), 1, scratch.size())) {
+            // uncompress and advance span
+            size_t used = uncompress_rle_channel(scratch_span, in_span,
+                                                 tw * th);
+            if (used > scratch_span.size()) {
+                err = "rle read exceeds scratch buffer";
                 return false;
             }
+            scratch_span = scratch_span.subspan(used);
 
-            // read tile
-            if (tile_compressed) {
-                span<uint8_t> scratch_span(scratch);
+            // write to output buffer
+            for (uint32_t py = ymin; py <= ymax; py++) {
+                uint8_t* out_dy = static_cast<uint8_t*>(m_buf.data())
+                                  + (py * m_header.width)
+                                        * m_header.pixel_bytes();
 
-                for (int c = m_header.zbuffer_bytes() - 1; c >= 0; --c) {
-                    std::vector<uint8_t> in(tw * th);
-                    span<uint8_t> in_span(in);
-
-                    // uncompress and advance span
-                    size_t used = uncompress_rle_channel(scratch_span, in_span,
-                                                         tw * th);
-                    if (used > scratch_span.size()) {
-                        errorfmt("rle read exceeds scratch buffer");
+                for (uint16_t px = xmin; px <= xmax; px++) {
+                    uint8_t* out_p = out_dy + px * m_header.pixel_bytes()
+                                     + m_header.rgba_channels_bytes() + c;
+
+                    if (in_span.empty()) {
+                        err = "in span underflow";
                         return false;
                     }
-                    scratch_span = scratch_span.subspan(used);
-
-                    // write to output buffer
-                    for (uint32_t py = ymin; py <= ymax; py++) {
-                        uint8_t* out_dy = static_cast<uint8_t*>(m_buf.data())
-                                          + (py * m_header.width)
-                                                * m_header.pixel_bytes();
-
-                        for (uint16_t px = xmin; px <= xmax; px++) {
-                            uint8_t* out_p = out_dy
-                                             + px * m_header.pixel_bytes()
-                                             + m_header.rgba_channels_bytes()
-                                             + c;
-
-                            if (in_span.empty()) {
-                                errorfmt("in span underflow");
-                                return false;
-                            }
-                            *out_p++ = in_span.front();
-                            in_span  = in_span.subspan(1);
-                        }
-                    }
+                    *out_p++ = in_span.front();
+                    in_span  = in_span.subspan(1);
                 }
+            }
+        }
 
-            } else {
-                span<uint8_t> scratch_span(scratch);
-                size_t total_pixels   = tw * th;
-                size_t expected_bytes = total_pixels * m_header.zbuffer_bytes();
+    } else {
+        size_t total_pixels   = tw * th;
+        size_t expected_bytes = total_pixels * m_header.zbuffer_bytes();
 
-                if (scratch_span.size() < expected_bytes) {
-                    errorfmt(
-                        "scratch buffer too small for uncompressed zbuffer");
-                    return false;
-                }
+        if (scratch_span.size() < expected_bytes) {
+            err = "scratch buffer too small for uncompressed zbuffer";
+            return false;
+        }
 
-                int sy = 0;
-                for (uint16_t py = ymin; py <= ymax; py++, sy++) {
-                    uint8_t* out_dy = m_buf.data()
-                                      + (py * m_header.width)
-                                            * m_header.pixel_bytes();
+        int sy = 0;
+        for (uint16_t py = ymin; py <= ymax; py++, sy++) {
+            uint8_t* out_dy = m_buf.data()
+                              + (py * m_header.width) * m_header.pixel_bytes();
 
-                    int sx = 0;
-                    for (uint16_t px = xmin; px <= xmax; px++, sx++) {
-                        size_t pixel_index  = sy * tw + sx;
-                        size_t pixel_offset = pixel_index
-                                              * m_header.zbuffer_bytes();
+            int sx = 0;
+            for (uint16_t px = xmin; px <= xmax; px++, sx++) {
+                size_t pixel_index  = sy * tw + sx;
+                size_t pixel_offset = pixel_index * m_header.zbuffer_bytes();
 
-                        if (pixel_offset + m_header.zbuffer_bytes()
-                            > scratch_span.size()) {
-                            errorfmt("in span overflow at pixel ({}, {})", px,
-                                     py);
-                            return false;
-                        }
+                if (pixel_offset + m_header.zbuffer_bytes()
+                    > scratch_span.size()) {
+                    err = Strutil::fmt::format(
+                        "in span overflow at pixel ({}, {})", px, py);
+                    return false;
+                }
 
-                        span<uint8_t> in_span
-                            = scratch_span.subspan(pixel_offset,
-                                                   m_header.zbuffer_bytes());
-                        uint8_t* out_p = out_dy + px * m_header.pixel_bytes()
-                                         + m_header.rgba_channels_bytes();
+                span<uint8_t> in_span
+                    = scratch_span.subspan(pixel_offset,
+                                           m_header.zbuffer_bytes());
+                uint8_t* out_p = out_dy + px * m_header.pixel_bytes()
+                                 + m_header.rgba_channels_bytes();
 
-                        for (int c = m_header.zbuffer_bytes() - 1; c >= 0;
-                             --c) {
-                            *out_p++ = in_span[c];
-                        }
-                    }
+                for (int c = m_header.zbuffer_bytes() - 1; c >= 0; --c) {
+                    *out_p++ = in_span[c];
                 }
             }
-            ztiles++;
-
-        } else {
-            // skip to the next block
-            if (!ioseek(chunksize, SEEK_CUR)) {
-                return false;
-            }
         }
     }
-
-    // flip buffer to make read_native_tile easier,
-    // from tga.imageio:
-
-    int bytespp = m_header.pixel_bytes();
-
-    std::vector<unsigned char> flip(m_spec.width * bytespp);
-    unsigned char *src, *dst, *tmp = flip.data();
-    for (int y = 0; y < m_spec.height / 2; y++) {
-        src = &m_buf[(m_spec.height - y - 1) * m_spec.width * bytespp];
-        dst = &m_buf[y * m_spec.width * bytespp];
-
-        memcpy(tmp, src, m_spec.width * bytespp);
-        memcpy(src, dst, m_spec.width * bytespp);
-        memcpy(dst, tmp, m_spec.width * bytespp);
-    }
     return true;
 }
 
@@ -18,6 +18,7 @@
 #include <OpenImageIO/hash.h>
 #include <OpenImageIO/imagebuf.h>
 #include <OpenImageIO/imagebufalgo.h>
+#include <OpenImageIO/imagecache.h>
 #include <OpenImageIO/imageio.h>
 #include <OpenImageIO/strutil.h>
 #include <OpenImageIO/sysutil.h>
@@ -58,7 +59,7 @@ static bool
 read_input(const std::string& filename, ImageBuf& img, int subimage = 0,
            int miplevel = 0)
 {
-    if (img.read(subimage, miplevel, false, TypeDesc::FLOAT))
+    if (img.read(subimage, miplevel))
         return true;
 
     std::cerr << "iinfo ERROR: Could not read " << filename << ":\n\t"
@@ -68,20 +69,50 @@ read_input(const std::string& filename, ImageBuf& img, int subimage = 0,
 
 
 
+// The ImageCache that flat images are streamed through for --stats.
+// Scanline files are cached in bands of 64 full-width scanlines, so the
+// stats are computed as each band is read and only the bands in flight,
+// rather than the whole image, are held in memory.
+static std::shared_ptr<ImageCache>
+stats_cache()
+{
+    static std::shared_ptr<ImageCache> ic = []() {
+        auto ic = ImageCache::create(false /* not shared */);
+        ic->attribute("autotile", 64);
+        ic->attribute("autoscanline", 1);
+        return ic;
+    }();
+    return ic;
+}
+
+
+
 static void
 print_stats(const std::string& filename, const ImageSpec& originalspec,
             int subimage = 0, int miplevel = 0, bool indentmip = false)
 {
     const char* indent = indentmip ? "      " : "    ";
 
-    ImageBuf input(filename);
-    if (!read_input(filename, input, subimage, miplevel)) {
-        // Note: read_input prints an error message if one occurs
-        return;
+    // Deep images can't go through the ImageCache, so they are read whole.
+    // Flat ones are read a band (or tile) at a time, as the stats need
+    // them.
+    ImageBuf input;
+    if (originalspec.deep) {
+        input.reset(filename, subimage, miplevel);
+        if (!read_input(filename, input, subimage, miplevel)) {
+            // Note: read_input prints an error message if one occurs
+            return;
+        }
+    } else {
+        input.reset(filename, subimage, miplevel, stats_cache());
     }
 
     std::string err;
-    if (!pvt::print_stats(std::cout, indent, input, originalspec, ROI(), err)) {
+    bool ok = pvt::print_stats(std::cout, indent, input, originalspec, ROI(),
+                               err);
+    if (!originalspec.deep)
+        stats_cache()->invalidate(ustring(filename));
+    if (!ok) {
         OIIO::print("{}Stats: (unable to compute)\n", indent);
         if (err.size())
             std::cerr << "Error: " << err << "\n";
@@ -10,6 +10,8 @@
 #include <OpenImageIO/span.h>
 #include <OpenImageIO/string_view.h>
 
+#include <vector>
+
 OIIO_NAMESPACE_3_1_BEGIN
 
 
@@ -155,6 +157,64 @@ public:
     /// channel for each pixel.
     void get_pointers(std::vector<void*>& pointers) const;
 
+    /// A columnar ("structure of arrays") copy of the samples of a range of
+    /// pixels of a DeepData. DeepData itself always stores all channels of
+    /// each sample together; `Columns` instead holds the values of each
+    /// channel for every sample contiguously, which makes per-channel scans
+    /// (depth sorting, alpha accumulation, and so on) walk memory linearly
+    /// and lets the whole set of samples be rebuilt in one shot. It is
+    /// what `sort()`, `merge_overlaps()`, `occlusion_cull()` and
+    /// `ImageBufAlgo::flatten()` work on internally. Values are stored as
+    /// `float`; UINT32 channels keep their exact bit patterns, which can be
+    /// recovered with `bitcast<uint32_t, float>()`.
+    struct Columns {
+        /// Prefix sums of the sample counts: the samples of the i-th pixel
+        /// of the range occupy indices `[offsets[i], offsets[i+1])` of every
+        /// channel array. There are `pixels()+1` entries.
+        std::vector<uint64_t> offsets;
+        /// `channel[c]` holds the values of channel `c` for all samples.
+        std::vector<std::vector<float>> channel;
+
+        /// Number of pixels in the range.
+        int64_t pixels() const
+        {
+            return offsets.empty() ? 0 : int64_t(offsets.size()) - 1;
+        }
+        /// Number of samples of the i-th pixel of the range.
+        int samples(int64_t i) const
+        {
+            return int(offsets[i + 1] - offsets[i]);
+        }
+        /// Total number of samples in the range.
+        uint64_t total_samples() const
+        {
+            return offsets.empty() ? 0 : offsets.back();
+        }
+        /// The values of channel `c` for the samples of the i-th pixel.
+        span<float> values(int c, int64_t i)
+        {
+            return span<float>(channel[c].data() + offsets[i], samples(i));
+        }
+        cspan<float> values(int c, int64_t i) const
+        {
+            return cspan<float>(channel[c].data() + offsets[i], samples(i));
+        }
+    };
+
+    /// Fill `cols` with a columnar copy of all samples of pixels
+    /// `[pixbegin, pixend)` (`pixend < 0` means through the last pixel).
+    /// The storage of `cols` is reused if it is already big enough, so
+    /// repeated calls for successive ranges don't reallocate.
+    void get_columns(Columns& cols, int64_t pixbegin = 0,
+                     int64_t pixend = -1) const;
+
+    /// Bulk rebuild: replace the sample counts and values of every pixel
+    /// with those in `cols`, which must describe exactly `pixels()` pixels
+    /// and `channels()` channels. Storage is reallocated once, with each
+    /// pixel's capacity equal to its sample count, rather than growing
+    /// pixel by pixel. Return `true` if ok, `false` if `cols` did not match.
+    bool set_columns(const Columns& cols);
+
     /// Copy a deep sample from `src` to this `DeepData`. They must have the
     /// same channel layout. Return `true` if ok, `false` if the operation
     /// could not be performed.
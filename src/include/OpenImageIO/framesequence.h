@@ -0,0 +1,177 @@
+// Copyright Contributors to the OpenImageIO project.
+// SPDX-License-Identifier: Apache-2.0
+// https://github.com/AcademySoftwareFoundation/OpenImageIO
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <OpenImageIO/imagebuf.h>
+#include <OpenImageIO/imageio.h>
+#include <OpenImageIO/span.h>
+
+
+OIIO_NAMESPACE_BEGIN
+
+
+/// FrameSequenceReader reads the frames of an image sequence, one after the
+/// other, for applications such as playback, review, or batch conversion
+/// that go through a sequence in order. Background threads keep decoding a
+/// few frames ahead of the one the caller will ask for next, within a
+/// memory budget, so that decoding can keep pace with consumption rather
+/// than the caller waiting for each file to be opened and read in turn.
+/// The header of each frame is kept, once read, for as long as the reader
+/// is open. But reading a frame always opens its file again and parses its
+/// header along the way, even if `spec()` had already read that header.
+///
+/// Unlike the ImageCache, which pages in tiles of individual images on
+/// demand, this hands out whole decoded frames, each exactly once.
+///
+/// Example:
+///
+///     FrameSequenceReader seq;
+///     seq.set_readahead(8);
+///     if (! seq.open("shot.1-100#.exr"))
+///         error(seq.geterror());
+///     for (int i = 0; i < seq.nframes(); ++i) {
+///         ImageBuf frame;
+///         if (! seq.next(frame))
+///             error(seq.geterror());
+///         ... use frame ...
+///     }
+///
+/// A FrameSequenceReader may be used by one thread at a time (except that
+/// `spec()` may be called from any thread).
+class OIIO_API FrameSequenceReader {
+public:
+    FrameSequenceReader();
+    ~FrameSequenceReader();
+    FrameSequenceReader(const FrameSequenceReader&) = delete;
+    FrameSequenceReader& operator=(const FrameSequenceReader&) = delete;
+
+    /// @{
+    /// @name Settings
+    ///
+    /// These may be changed at any time. Except for the number of
+    /// threads, which takes effect at the next `open()`, new values apply
+    /// to the frames that start to be read after the change.
+
+    /// Set how many frames, counting the next one to be handed out, may be
+    /// read ahead (default: 4). Values less than 1 are treated as 1.
+    void set_readahead(int nframes);
+
+    /// Set the approximate limit, in MB, on the memory taken by frames that
+    /// have been read ahead but not yet handed out (default: 1024). The
+    /// next frame is always read, even if by itself it exceeds the limit.
+    void set_memory_limit(size_t megabytes);
+
+    /// Set the number of background threads that read frames. The default
+    /// of 0 means as many as the read-ahead, but no more than the hardware
+    /// concurrency.
+    void set_threads(int nthreads);
+
+    /// Set the pixel data type that frames are read into. The default of
+    /// `TypeUnknown` keeps each file's native type (or the widest of them,
+    /// for files whose channels are of different types).
+    void set_format(TypeDesc format);
+
+    /// @}
+
+    /// @{
+    /// @name Opening and closing
+
+    /// Open a sequence given as a file name pattern, using the same syntax
+    /// as oiiotool: the frame number is marked by `#` (4 digits each) or
+    /// `@` (1 digit each) characters, or by a printf-style `%0Nd`, which
+    /// may be preceded by a frame range such as `1-100` or `1-100x2,200`
+    /// (see `Filesystem::enumerate_sequence()`).
+    ///
+    /// @param  pattern
+    ///             The file name pattern, such as "shot.1-100#.exr" or
+    ///             "shot.%04d.exr".
+    /// @param  framespec
+    ///             The frame range to read, if the pattern doesn't give
+    ///             one itself. If neither does, the directory is scanned
+    ///             for all the files that match the pattern.
+    /// @param  framepadding
+    ///             If greater than 0, the number of digits of the frame
+    ///             numbers, overriding what the pattern implies.
+    /// @returns
+    ///             `true` if the pattern named at least one frame, `false`
+    ///             (with an error message ready for `geterror()`)
+    ///             otherwise. Frames that can't be read only fail later,
+    ///             when they are handed out.
+    bool open(string_view pattern, string_view framespec = "",
+              int framepadding = 0);
+
+    /// Open a "sequence" made of the given list of files, with the given
+    /// frame numbers (by default, 0, 1, 2, ...).
+    bool open_files(cspan<std::string> filenames,
+                    cspan<int> frame_numbers = {});
+
+    /// Stop reading ahead and forget the sequence, including any frames
+    /// read but not handed out.
+    void close();
+
+    /// Is a sequence open?
+    bool is_open() const;
+
+    /// @}
+
+    /// @{
+    /// @name Frames
+
+    /// The number of frames in the sequence.
+    int nframes() const;
+
+    /// The file name of frame `index` (counting from 0), or an empty
+    /// string if there is no such frame.
+    std::string filename(int index) const;
+
+    /// The frame number of frame `index` (counting from 0).
+    int frame_number(int index) const;
+
+    /// Return the header of frame `index`, reading it if nobody has done so
+    /// yet, or `nullptr` if there is no such frame or it can't be opened.
+    /// The pointer remains valid until the reader is closed. The file is
+    /// closed again once its header is read, so a frame asked about here
+    /// is still opened a second time when its pixels are read.
+    const ImageSpec* spec(int index);
+
+    /// The index of the frame that the next call to `next()` will return.
+    int position() const;
+
+    /// Hand out the next frame, waiting for it to be read if need be, and
+    /// move on to the one after it (whether or not this one could be read).
+    ///
+    /// @returns
+    ///             `true` if the frame was read into `frame`. `false` if
+    ///             the frame could not be read, in which case `geterror()`
+    ///             will say why, or if there are no more frames (which is
+    ///             not an error).
+    bool next(ImageBuf& frame);
+
+    /// Make frame `index` the next one to be handed out. Frames read ahead
+    /// that are no longer within the read-ahead window are discarded.
+    /// Returns `false` if there is no such frame.
+    bool seek(int index);
+
+    /// @}
+
+    /// Is there a pending error message waiting to be retrieved?
+    bool has_error() const;
+
+    /// Return the text of all pending error messages, and clear them
+    /// unless `clear` is `false`.
+    std::string geterror(bool clear = true) const;
+
+    class Impl;
+
+private:
+    std::unique_ptr<Impl> m_impl;
+};
+
+
+OIIO_NAMESPACE_END
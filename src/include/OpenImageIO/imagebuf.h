@@ -62,6 +62,9 @@ set_roi_full(ImageSpec& spec, const ROI& newroi);
 enum class InitializePixels { No = 0, Yes = 1 };
 
 
+class ColorProcessor;
+
+
 
 /// An ImageBuf is a simple in-memory representation of a 2D image.  It uses
 /// ImageInput and ImageOutput underneath for its file I/O, and has simple
@@ -561,6 +564,34 @@ public:
               TypeDesc convert, ProgressCallback progress_callback = nullptr,
               void* progress_callback_data = nullptr);
 
+    /// Read the file into local memory (always a forced read, never backed
+    /// by the ImageCache), applying the color transformation `processor`
+    /// to the pixels as they are decoded, one tile row or strip of
+    /// scanlines at a time, while that part of the image is still in
+    /// cache. The result is the same as a `read()` followed by an
+    /// in-place `ImageBufAlgo::colorconvert()`, but without a second pass
+    /// over the whole image. If `convert` is neither float nor the file's
+    /// native type, each strip is decoded and transformed as float and only
+    /// then converted to `convert`, so the pixels are quantized only once.
+    ///
+    /// Additional parameters:
+    ///
+    /// @param  processor
+    ///             The color transformation to apply. If it is `nullptr`
+    ///             or a no-op, this is equivalent to a forced `read()`.
+    /// @param  unpremult
+    ///             If true and the image has an alpha channel, unpremultiply
+    ///             before the color transformation and re-premultiply
+    ///             after, just like `ImageBufAlgo::colorconvert()`.
+    ///
+    /// It is up to the caller to update the "oiio:ColorSpace" metadata to
+    /// reflect the transformation. Deep images are not supported.
+    bool read_colorconvert(int subimage, int miplevel, int chbegin, int chend,
+                           TypeDesc convert, const ColorProcessor* processor,
+                           bool unpremult                     = true,
+                           ProgressCallback progress_callback = nullptr,
+                           void* progress_callback_data       = nullptr);
+
     /// Read the ImageSpec for the given file, subimage, and MIP level into
     /// the ImageBuf, but will not read the pixels or allocate any local
     /// storage (until a subsequent call to `read()`).  This is helpful if
@@ -635,6 +666,45 @@ public:
                ProgressCallback progress_callback = nullptr,
                void* progress_callback_data       = nullptr) const;
 
+    /// Write the image to the named file just like `write()`, but encode
+    /// and write it on a background thread, returning as soon as the write
+    /// has been queued. What gets written is a copy of the ImageBuf as it
+    /// stands at the time of the call, so the caller is free to go on
+    /// modifying or destroying it. For an ImageBuf that owns its pixels,
+    /// that copy needs as much memory as the image itself. One that wraps
+    /// application memory shares it instead, and the application must leave
+    /// that memory untouched until the write is done. Any IOProxy set with
+    /// `set_write_ioproxy()` is not used.
+    ///
+    /// If as many background writes as the global `"imagebuf:async_writes"`
+    /// attribute allows are already pending, this waits for one of them to
+    /// finish before queueing this one.
+    ///
+    /// Background writes are not finished just because the program exits:
+    /// call `wait_for_async_writes()` (or `OIIO::shutdown()`, which an
+    /// application should call before exiting anyway) first.
+    ///
+    /// @param  filename/dtype/fileformat
+    ///             The same as for `write()`.
+    ///
+    /// @returns
+    ///             `true` if the write was queued, or `false` if it could
+    ///             not even be started (in which case, you should be able to
+    ///             retrieve an error message via `geterror()`). Whether the
+    ///             write itself succeeded is only known once
+    ///             `wait_for_async_writes()` has been called.
+    bool write_async(string_view filename, TypeDesc dtype = TypeUnknown,
+                     string_view fileformat = string_view()) const;
+
+    /// Wait for every write started by `write_async()` to finish.
+    ///
+    /// @returns
+    ///             `true` if they all succeeded, or `false` if any failed,
+    ///             in which case their error messages may be retrieved by
+    ///             calling the global `OIIO::geterror()` from the same
+    ///             thread.
+    static bool wait_for_async_writes();
+
     /// Set the pixel data format that will be used for subsequent `write()`
     /// calls that do not themselves request a specific data type request.
     ///
@@ -1379,6 +1449,15 @@ public:
     /// ImageCache, and it is a writable IB, or an empty span otherwise.
     image_span<std::byte> localpixels_as_writable_byte_image_span();
 
+    /// Return a shared pointer owning the "local" pixel memory that this
+    /// ImageBuf allocated itself, or an empty pointer if it doesn't own its
+    /// pixels (wrapped application buffers, ImageCache-backed or deep
+    /// images). While it is held, that memory stays allocated even if the
+    /// ImageBuf is reset, reallocated, or destroyed -- the ImageBuf merely
+    /// stops using it -- so that views of the pixels handed out elsewhere
+    /// (such as Python buffers) never point at freed memory.
+    std::shared_ptr<void> localpixels_owner() const;
+
     /// Pixel-to-pixel stride within the localpixels memory.
     stride_t pixel_stride() const;
     /// Scanline-to-scanline stride within the localpixels memory.
@@ -1412,6 +1491,35 @@ public:
     /// -1 for an invalid coordinate that is not within the data window.
     int pixelindex(int x, int y, int z, bool check_range = false) const;
 
+    /// Retrieve scanline `(y,z)` of `roi` -- pixels `roi.xbegin` through
+    /// `roi.xend-1`, channels `roi.chbegin` through `roi.chend-1` -- as
+    /// `roi.width() * roi.nchannels()` contiguous values of type `format`.
+    /// If the pixels are local, already of type `format`, and laid out
+    /// contiguously in exactly that way, the return value points directly
+    /// into the buffer and `scratch` is untouched. Otherwise (different
+    /// type, channel subset, ImageCache-backed, or partly outside the data
+    /// window), the values are converted or fetched into `scratch`, which
+    /// must hold at least that many values, and a pointer to `scratch` is
+    /// returned (or `nullptr` if `scratch` is too small). Pixels outside the
+    /// data window, or that could not be read, come back as black. Most code
+    /// will prefer to use the `ConstRowSpans` helper rather than call this
+    /// directly.
+    const void* read_row(ROI roi, int y, int z, TypeDesc format,
+                         span<std::byte> scratch) const;
+
+    /// Return a writable pointer to scanline `(y,z)` of `roi` if it can be
+    /// written in place as contiguous values of type `format` (that is, the
+    /// buffer is local and writable, the row is within the data window, the
+    /// pixel type is `format`, and the ROI spans all of the pixel's
+    /// channels). Otherwise return `nullptr`, in which case the caller
+    /// should assemble the row elsewhere and store it with `write_row()`.
+    void* row_addr(ROI roi, int y, int z, TypeDesc format);
+
+    /// Store the `roi.width() * roi.nchannels()` contiguous values of type
+    /// `format` at `data` into scanline `(y,z)` of `roi`, converting to the
+    /// buffer's pixel type as needed. Return true upon success.
+    bool write_row(ROI roi, int y, int z, TypeDesc format, const void* data);
+
     /// Set the threading policy for this ImageBuf, controlling the maximum
     /// amount of parallelizing thread "fan-out" that might occur during
     /// expensive operations. The default of 0 means that the global
@@ -2022,6 +2130,103 @@ public:
     };
 
 
+    /// ConstRowSpans presents the pixels of a region of an ImageBuf as a
+    /// sequence of scanlines, each a contiguous `image_span<const T>` of
+    /// `roi.nchannels()` channels by `roi.width()` pixels, regardless of
+    /// the buffer's own pixel type, layout, or storage. This lets simple
+    /// per-value loops be written over plain arrays instead of through the
+    /// per-pixel Iterator proxies. When the buffer's memory already has the
+    /// requested layout, the spans refer to it directly; otherwise each row
+    /// is converted into a scratch buffer owned by the ConstRowSpans, and
+    /// the returned span is only valid until the next row is requested.
+    template<typename T> class ConstRowSpans {
+    public:
+        ConstRowSpans(const ImageBuf& ib, ROI roi)
+            : m_ib(&ib)
+            , m_roi(roi.defined() ? roi : ib.roi())
+        {
+            m_roi.chend = std::min(m_roi.chend, ib.nchannels());
+        }
+
+        /// Return the span of scanline `(y,z)` of the region.
+        image_span<const T> operator()(int y, int z = 0)
+        {
+            size_t n = size_t(m_roi.width()) * size_t(m_roi.nchannels());
+            if (m_scratch.size() < n)
+                m_scratch.resize(n);
+            auto scratch  = as_writable_bytes(make_span(m_scratch));
+            const void* p = m_ib->read_row(m_roi, y, z,
+                                           TypeDescFromC<T>::value(), scratch);
+            return image_span<const T>((const T*)p, m_roi.nchannels(),
+                                       m_roi.width(), 1);
+        }
+
+        const ROI& roi() const { return m_roi; }
+
+    private:
+        const ImageBuf* m_ib;
+        ROI m_roi;
+        std::vector<T> m_scratch;
+    };
+
+
+    /// RowSpans is the writable counterpart of ConstRowSpans: each
+    /// `operator()(y,z)` returns a contiguous `image_span<T>` that the
+    /// caller fills with the values of scanline `(y,z)` of the region.
+    /// Rows that can't be addressed in place are staged in a scratch
+    /// buffer and stored back into the ImageBuf (with conversion) when the
+    /// next row is requested, when `flush()` is called, or when the
+    /// RowSpans is destroyed.
+    template<typename T> class RowSpans {
+    public:
+        RowSpans(ImageBuf& ib, ROI roi)
+            : m_ib(&ib)
+            , m_roi(roi.defined() ? roi : ib.roi())
+        {
+            m_roi.chend = std::min(m_roi.chend, ib.nchannels());
+        }
+        RowSpans(const RowSpans&)            = delete;
+        RowSpans& operator=(const RowSpans&) = delete;
+        ~RowSpans() { flush(); }
+
+        /// Return the writable span of scanline `(y,z)` of the region.
+        image_span<T> operator()(int y, int z = 0)
+        {
+            flush();
+            T* p = (T*)m_ib->row_addr(m_roi, y, z, TypeDescFromC<T>::value());
+            if (!p) {
+                size_t n = size_t(m_roi.width()) * size_t(m_roi.nchannels());
+                if (m_scratch.size() < n)
+                    m_scratch.resize(n);
+                p         = m_scratch.data();
+                m_pending = true;
+                m_y       = y;
+                m_z       = z;
+            }
+            return image_span<T>(p, m_roi.nchannels(), m_roi.width(), 1);
+        }
+
+        /// Store any staged row back into the ImageBuf.
+        void flush()
+        {
+            if (m_pending) {
+                m_ib->write_row(m_roi, m_y, m_z, TypeDescFromC<T>::value(),
+                                m_scratch.data());
+                m_pending = false;
+            }
+        }
+
+        const ROI& roi() const { return m_roi; }
+
+    private:
+        ImageBuf* m_ib;
+        ROI m_roi;
+        std::vector<T> m_scratch;
+        int m_y = 0, m_z = 0;
+        bool m_pending = false;
+    };
+
+
 protected:
     // PIMPL idiom
     static void impl_deleter(ImageBufImpl*);
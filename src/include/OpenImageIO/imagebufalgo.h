@@ -2506,7 +2506,9 @@ bool OIIO_API deepen (ImageBuf &dst, const ImageBuf &src, float zvalue = 1.0f,
 
 /// Return the "flattened" composite of deep image `src`. That is, it
 /// converts a deep image to a simple flat image by front-to- back
-/// compositing the samples within each pixel.  If `src` is already a
+/// compositing the samples within each pixel. Samples need not be sorted
+/// or free of overlaps: pixels where they are not are sorted, split and
+/// merged (as by `deep_merge`) before compositing. If `src` is already a
 /// non-deep/flat image, it will just copy pixel values from `src` to `dst`.
 /// If `dst` is not already an initialized ImageBuf, it will be sized to
 /// match `src` (but made non-deep).
@@ -2543,6 +2545,34 @@ bool OIIO_API deep_holdout (ImageBuf &dst, const ImageBuf &src,
                             ROI roi={}, int nthreads=0);
 
 
+/// Bounded-memory, streaming versions of `flatten()`, `deep_merge()` and
+/// `deep_holdout()`, for deep images too big to hold in memory all at
+/// once. The deep inputs are read from files a band of `bandheight`
+/// scanlines at a time (0 means the default of 64; tiled inputs round it up
+/// to a whole number of tiles), the operation is applied to the band, and
+/// the result is appended to `outfilename` before the next band is read.
+/// Peak memory is therefore proportional to the band, not the frame.
+///
+/// `flatten_file` always writes a flat image. `deep_merge_file` and
+/// `deep_holdout_file` write a flat image if `flatten` is true, otherwise a
+/// deep one (which requires an output format that supports deep data).
+/// All inputs must have the same data window. Return true upon success, or
+/// false upon failure, in which case the error message may be retrieved
+/// with `OIIO::geterror()`.
+bool OIIO_API flatten_file (string_view outfilename, string_view infilename,
+                            int bandheight=0, int nthreads=0);
+bool OIIO_API deep_merge_file (string_view outfilename,
+                               string_view Afilename, string_view Bfilename,
+                               bool occlusion_cull = true,
+                               bool flatten = false,
+                               int bandheight=0, int nthreads=0);
+bool OIIO_API deep_holdout_file (string_view outfilename,
+                                 string_view srcfilename,
+                                 string_view holdoutfilename,
+                                 bool flatten = false,
+                                 int bandheight=0, int nthreads=0);
+
+
 
 
 ///////////////////////////////////////////////////////////////////////
@@ -210,6 +210,59 @@ public:
     ///           enabled, this reduces the number of file opens, at the
     ///           expense of not being able to open files if their format do
     ///           not actually match their filename extension). Default: 0
+    /// - `int microcache_size` :
+    ///           The number of recently used tiles each thread remembers
+    ///           privately (rounded up to a power of 2, between 2 and 256),
+    ///           so that lookups alternating among a few tiles or textures
+    ///           don't need to consult the shared tile cache and its locks.
+    ///           Each remembered tile stays in memory until it is replaced,
+    ///           even if the main cache has evicted it, so very large values
+    ///           can raise memory use with many threads. (Default: 8)
+    /// - `string float_storage` :
+    ///           How to store the tiles of float (or double) 2D images in
+    ///           the cache: `"float"` (the default) keeps full precision;
+    ///           `"half"` halves their memory; `"uint16"` also halves it,
+    ///           quantizing each tile relative to its own range of values,
+    ///           which gives more uniform precision than half for data
+    ///           with a limited range (such as displacement) but cannot
+    ///           represent infinities or NaNs. Texture lookups and
+    ///           `get_pixels()` see the values converted back to float;
+    ///           so do `get_tile()` callers for `"uint16"`, which receive
+    ///           an expanded copy of the tile. The largest errors
+    ///           introduced for each file are reported by the statistics
+    ///           and by the `"stat:precision_maxerror"` and
+    ///           `"stat:precision_maxrelerror"` queries of
+    ///           `get_image_info()`, so that the precision loss can be
+    ///           judged texture by texture. `forcefloat` takes precedence,
+    ///           and volume images are always stored at full precision.
+    /// - `int compressed_tiles` :
+    ///           When nonzero, tiles of GPU block-compressed images (DDS
+    ///           files using BC1-BC7, including BC6H) stay in the cache in
+    ///           their compressed form, typically 4-8x smaller than the
+    ///           decoded texels, so many more of them fit within
+    ///           `max_memory_MB`. A tile is decoded when first used, and
+    ///           the decoded copy is shared by all threads and counted
+    ///           against `max_decoded_memory_MB`, not `max_memory_MB`, so
+    ///           only the tiles in active use are held decoded as well.
+    ///           Decoded copies not used lately are let go first, and a
+    ///           tile needed again is decoded from memory rather than read
+    ///           from disk. BC1, BC3, and BC7 blocks are decoded with SIMD
+    ///           where it is available. Formats that need adjustment after
+    ///           decoding (normal maps, swizzled or premultiplied
+    ///           variants), cube maps, and volumes are cached decoded as
+    ///           usual. (Default: 0)
+    /// - `float max_decoded_memory_MB` :
+    ///           The approximate maximum amount of memory (measured in MB)
+    ///           for the decoded copies of tiles kept block-compressed
+    ///           (see `compressed_tiles`). (Default: 64.0 MB)
+    /// - `string trace_file` :
+    ///           When set to a filename, the cache records every tile it
+    ///           reads for the first time (file, subimage, MIP level and
+    ///           tile position) into a compact trace, which is written to
+    ///           that file when the attribute is changed again or the cache
+    ///           is destroyed. Passing the trace to `prefetch_trace()` at
+    ///           the start of a later run warms the cache with the same
+    ///           tiles. (Default: "", not recording)
     /// - `string colorspace` :
     ///           The working colorspace of the texture system. Default: none.
     /// - `string colorconfig` :
@@ -276,6 +329,10 @@ public:
     /// - `int64 stat:bytes_read` :
     ///           Total size (uncompressed bytes of pixel data) read.
     ///
+    /// - `int64 stat:tile_block_decodes` :
+    ///           Number of times the pixels of a block-compressed tile
+    ///           were decoded (see `compressed_tiles`).
+    ///
     /// - `int stat:unique_files` :
     ///           Number of unique files opened.
     ///
@@ -638,7 +695,12 @@ public:
     /// - `"cachedformat"` : The native data format of the pixels as stored
     ///   in the image cache (an integer, giving the `TypeDesc::BASETYPE` of
     ///   the data).  Note that this is not necessarily the same as the
-    ///   native data format of the file.
+    ///   native data format of the file. For images that `float_storage`
+    ///   `"uint16"` quantizes, this is `FLOAT`: their uint16 values mean
+    ///   nothing without each tile's scale and offset, so `get_tile()` and
+    ///   `get_pixels()` hand them out expanded to float, and callers that
+    ///   size their buffers or interpret tiles by this type (such as
+    ///   ImageBuf) must see the type they will actually receive.
     ///
     /// - `"datawindow"` : Returns the pixel data window of the image, which
     ///   is either an array of 4 integers (returning xmin, ymin, xmax,
@@ -724,6 +786,11 @@ public:
     /// - `"stat:is_duplicate"` : Stores 1 if this file was a duplicate of
     ///   another image, otherwise 0. (`int`)
     ///
+    /// - `"stat:precision_maxerror"`, `"stat:precision_maxrelerror"` :
+    ///   The largest absolute and relative errors introduced so far by
+    ///   storing this image at reduced precision (see the `float_storage`
+    ///   attribute), or 0 if it is stored at full precision. (`float`)
+    ///
     /// - *Anything else*  : For all other data names, the the metadata of
     ///   the image file will be searched for an item that matches both the
     ///   name and data type.
@@ -1180,6 +1247,18 @@ public:
     /// `close()` all files known to the cache.
     void close_all();
 
+    /// Read into the cache, ahead of need, all the tiles listed in a tile
+    /// access trace recorded by an earlier run with the `trace_file`
+    /// attribute set. Files are prefetched in parallel, in the order the
+    /// recorded run first touched them, and horizontally adjacent tiles
+    /// of a file are fetched with a single read. Tiles already in the
+    /// cache, and files or tiles that no longer exist, are skipped.
+    ///
+    /// @returns
+    ///             `true` upon success, `false` if the trace could not
+    ///             be read or is malformed.
+    bool prefetch_trace(string_view tracefile);
+
     /// An opaque data type that allows us to have a pointer to a tile but
     /// without exposing any internals.
     using Tile = ImageCacheTile;
@@ -3673,7 +3673,9 @@ template <> OIIO_API size_t pvt::footprint<ImageOutput>(const ImageOutput&);
 
 /// `OIIO::shutdown` prepares OpenImageIO for shutdown. Before exiting an 
 /// application that utilizes OpenImageIO the `OIIO::shutdown` function must be 
-/// called, which will perform shutdown of any running thread-pools. Failing 
+/// called, which will finish any writes still pending from
+/// `ImageBuf::write_async()` and perform shutdown of any running
+/// thread-pools. Failing 
 /// to call `OIIO::shutdown` could lead to a sporadic dead-lock during 
 /// application shutdown on certain platforms such as Windows. 
 OIIO_API void shutdown ();
@@ -3774,6 +3776,21 @@ OIIO_API std::string geterror(bool clear = true);
 ///    Colon-separated (or semicolon-separated) list of directories to search
 ///    for dynamically-loaded format plugins.
 ///
+/// - `string plugin_index`
+///
+///    If set to a filename, the capabilities of the dynamically-loaded
+///    format plugins found in the plugin searchpath (format names,
+///    extensions, and whether they are readers, writers, or procedural)
+///    are remembered in that file. On subsequent runs, a plugin that has
+///    not changed since it was indexed is not loaded until its format is
+///    actually requested, which speeds up program startup. Questions such
+///    as `is_imageio_format_name()` are answered from the index without
+///    scanning the searchpath at all, so a plugin installed since the index
+///    was last updated is only noticed once a reader or writer is requested
+///    for a format that isn't otherwise known. The default is empty,
+///    meaning that no index is used and every plugin found is loaded when
+///    the searchpath is first scanned.
+///
 /// - `int try_all_readers`
 ///
 ///    When nonzero (the default), a call to `ImageInput::create()` or
@@ -3833,6 +3850,23 @@ OIIO_API std::string geterror(bool clear = true);
 ///    When nonzero, treats BC5/ATI2 format files as normal maps (loads as
 ///    3 channels, computes blue from red and green). Default is 0.
 ///
+/// - `int ffmpeg:frame_cache_MB` (32)
+///
+///    How much memory may be used to keep the most recently decoded movie
+///    frames, so that going back and forth over the same frames doesn't
+///    decode them (and the frames leading up to them from the previous
+///    keyframe) all over again. This one budget is shared by all the open
+///    movie files, however many there are (an ImageCache may keep many of
+///    them open at once), and is separate from the ImageCache's own memory
+///    limit. Zero disables this cache.
+///
+/// - `int dpx:bitpack_bands` (1)
+///
+///    When nonzero (the default), DPX and Cineon 10- and 12-bit pixels are
+///    unpacked (and, for DPX output, packed) a whole band of scanlines at a
+///    time, in parallel. Zero uses the older one-pixel-at-a-time code, which
+///    is mainly useful for comparing the two.
+///
 /// - `int openexr:core`
 ///
 ///    When nonzero, use the new "OpenEXR core C library" when available.
@@ -3925,6 +3959,15 @@ OIIO_API std::string geterror(bool clear = true);
 ///   If nonzero, an `ImageBuf` that references a file but is not given an
 ///   ImageCache will read the image through the default ImageCache.
 ///
+/// - `imagebuf:async_writes` (int: 4)
+///
+///   The most background writes started by `ImageBuf::write_async()` (or
+///   by `oiiotool --async-writes`) that may be queued or in progress at
+///   once. Starting another one while that many are pending will wait for
+///   one of them to finish, which keeps a producer that computes images
+///   faster than they can be written from piling up copies of them all in
+///   memory.
+///
 /// - `imageinput:strict` (int: 0)
 ///
 ///   If zero (the default), ImageInput readers will try to be very tolerant
@@ -3937,6 +3980,17 @@ OIIO_API std::string geterror(bool clear = true);
 ///   enable globally in an environment where security is a higher priority
 ///   than being tolerant of partially broken image files.
 ///
+/// - `colorconvert:lut` (int: 1)
+///
+///   Controls whether `ImageBufAlgo::colorconvert()` and related functions
+///   may convert 8 and 16 bit unsigned integer images by table lookup
+///   instead of running the color transformation on every pixel. If 0,
+///   they never do. If 1 (the default), transformations without channel
+///   crosstalk are tabulated for every input value, which gives the same
+///   results as the direct computation. If 2, transformations with channel
+///   crosstalk are also sampled on a 65^3 lattice and tetrahedrally
+///   interpolated for 8 bit inputs, which is faster but approximate.
+///
 /// EXAMPLES:
 /// ```
 ///     // Setting single simple values simply:
@@ -4289,6 +4343,19 @@ OIIO_API void declare_imageio_format (const std::string &format_name,
                                       const char **output_extensions,
                                       const char *lib_version);
 
+/// Register the magic number signatures by which files of a particular
+/// format can be recognized, so that `ImageInput::create()` can find the
+/// right reader for a file whose extension is missing or wrong. Each
+/// signature is a string of hexadecimal digit pairs giving the bytes that
+/// must appear in the file, optionally preceded by a decimal byte offset
+/// and a colon (for example, `"8:57454250"` is "WEBP" at offset 8). The
+/// list is terminated by a `nullptr`. A file matches the format if it
+/// matches any one of its signatures.
+///
+/// @version 3.1
+OIIO_API void declare_imageio_format_signatures(const std::string& format_name,
+                                                const char** signatures);
+
 /// Is `name` one of the known format names?
 OIIO_API bool is_imageio_format_name(string_view name);
 
@@ -4657,6 +4724,7 @@ using v3_1::cspan_from_buffer;
 using v3_1::debug;
 using v3_1::debugfmt;
 using v3_1::declare_imageio_format;
+using v3_1::declare_imageio_format_signatures;
 using v3_1::equivalent_colorspace;
 using v3_1::errorfmt;
 using v3_1::get_extension_map;
@@ -111,6 +111,8 @@ enum class MipMode : uint8_t {
     OneLevel,   ///< Use just one mipmap level
     Trilinear,  ///< Use two MIPmap levels (trilinear)
     Aniso,      ///< Use two MIPmap levels w/ anisotropic
+    EWA,        ///< Elliptical weighted average (Gaussian) over the
+                ///<   exact footprint; slower, sharper than Aniso
 };
 
 /// Interp mode determines how we sample within a mipmap level
@@ -209,6 +211,7 @@ public:
     static constexpr Tex::MipMode MipModeOneLevel = MipMode::OneLevel;
     static constexpr Tex::MipMode MipModeTrilinear = MipMode::Trilinear;
     static constexpr Tex::MipMode MipModeAniso = MipMode::Aniso;
+    static constexpr Tex::MipMode MipModeEWA = MipMode::EWA;
     static constexpr Tex::InterpMode InterpClosest = Tex::InterpMode::Closest;
     static constexpr Tex::InterpMode InterpBilinear = Tex::InterpMode::Bilinear;
     static constexpr Tex::InterpMode InterpBicubic = Tex::InterpMode::Bicubic;
@@ -1712,6 +1715,12 @@ public:
     /// `close()` all files known to the cache.
     void close_all();
 
+    /// Warm the cache with the tiles listed in a tile access trace (see
+    /// the ImageCache `trace_file` attribute). This calls
+    /// `ImageCache::prefetch_trace(tracefile)` on the underlying
+    /// ImageCache.
+    bool prefetch_trace(string_view tracefile);
+
     /// @}
 
     /// @{
@@ -10,6 +10,10 @@
 #ifndef OPENIMAGEIO_IMAGEIO_PVT_H
 #define OPENIMAGEIO_IMAGEIO_PVT_H
 
+#include <functional>
+#include <future>
+#include <string>
+
 #include <OpenImageIO/imageio.h>
 #include <OpenImageIO/thread.h>
 #include <OpenImageIO/timer.h>
@@ -32,6 +36,7 @@ extern atomic_int oiio_read_chunk;
 extern atomic_int oiio_try_all_readers;
 extern ustring font_searchpath;
 extern ustring plugin_searchpath;
+extern ustring plugin_index;
 extern std::string format_list;
 extern std::string input_format_list;
 extern std::string output_format_list;
@@ -47,7 +52,9 @@ extern int limit_channels;
 extern int limit_imagesize_MB;
 extern int imagebuf_print_uncaught_errors;
 extern int imagebuf_use_imagecache;
+extern atomic_int imagebuf_async_writes;
 extern int imageinput_strict;
+extern int colorconvert_lut;
 extern atomic_ll IB_local_mem_current;
 extern atomic_ll IB_local_mem_peak;
 extern std::atomic<float> IB_total_open_time;
@@ -71,6 +78,16 @@ font_filename(string_view family, string_view style = "");
 void
 catalog_all_plugins(std::string searchpath);
 
+// Make sure the plugin searchpath has been inventoried at least once.
+void
+ensure_all_plugins_cataloged();
+
+// Forget that the plugin searchpath has been inventoried, so that the next
+// lookup of an unknown format scans it again. Called when the searchpath
+// changes.
+void
+reset_plugin_searchpath_scanned();
+
 // Inexpensive check if a file extension or format name corresponds to a
 // procedural input plugin.
 bool
@@ -131,6 +148,19 @@ check_texture_metadata_sanity(ImageSpec& spec);
 OIIO_API std::string
 timing_report();
 
+/// Run `job` on one of the background threads that do the writes for
+/// ImageBuf::write_async(), first waiting for one of them to finish if as
+/// many as the "imagebuf:async_writes" attribute allows are already
+/// pending. The job returns an error message, or an empty string if it
+/// succeeded, which is what the future will hold once it is done.
+OIIO_API std::shared_future<std::string>
+async_write(std::function<std::string()> job);
+
+/// Finish every job queued by async_write() and stop the threads running
+/// them. Called by OIIO::shutdown().
+void
+async_write_shutdown();
+
 /// An object that, if oiio_log_times is nonzero, logs time until its
 /// destruction. If oiio_log_times is 0, it does nothing.
 class LoggedTimer {
@@ -45,6 +45,7 @@ jpeg_input_imageio_create()
 
 OIIO_EXPORT const char* jpeg_input_extensions[]
     = { "jpg", "jpe", "jpeg", "jif", "jfif", "jfi", nullptr };
+OIIO_EXPORT const char* jpeg_imageio_signatures[] = { "ffd8", nullptr };
 
 OIIO_PLUGIN_EXPORTS_END
 
@@ -224,6 +224,11 @@ OIIO_EXPORT const char* jpeg2000_input_extensions[] = { "jp2", "j2k",
                                                         "j2c",
 #endif
                                                         nullptr };
+OIIO_EXPORT const char* jpeg2000_imageio_signatures[] = {
+    "0000000c6a5020200d0a870a",  // JP2 box
+    "ff4fff51",                  // raw codestream
+    nullptr
+};
 
 OIIO_PLUGIN_EXPORTS_END
 
@@ -98,6 +98,11 @@ jpegxl_input_imageio_create()
 }
 
 OIIO_EXPORT const char* jpegxl_input_extensions[] = { "jxl", nullptr };
+OIIO_EXPORT const char* jpegxl_imageio_signatures[] = {
+    "ff0a",                      // raw codestream
+    "0000000c4a584c200d0a870a",  // container
+    nullptr
+};
 
 OIIO_PLUGIN_EXPORTS_END
 
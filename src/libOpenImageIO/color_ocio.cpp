@@ -4,7 +4,9 @@
 
 #include <algorithm>
 #include <cmath>
+#include <limits>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <vector>
 
@@ -1440,8 +1442,91 @@ ocio_bitdepth(TypeDesc type)
 
 
 
+// Lookup tables that let colorconvert() of 8 and 16 bit unsigned integer
+// pixels skip running the ColorProcessor on every pixel. A processor with
+// no channel crosstalk is tabulated exactly, as its result for every code
+// value of each channel. One with crosstalk may instead be sampled on a 3D
+// lattice and interpolated, for 8 bit inputs, if the "colorconvert:lut"
+// attribute allows it. The tables are built on first use and live as long
+// as the processor does -- and processors are cached by the ColorConfig --
+// so repeated conversions with the same transform only pay for them once.
+class ColorProcessorLUTs {
+public:
+    // Interleaved RGBA results for every code value of unsigned integer
+    // type T: a pixel with codes r,g,b,a converts to lut[4*r+0],
+    // lut[4*g+1], lut[4*b+2], lut[4*a+3]. Returns nullptr if the processor
+    // has channel crosstalk.
+    template<typename T>
+    const float* lut1d(const ColorProcessor* proc) const
+    {
+        static_assert(std::is_same<T, uint8_t>::value
+                      || std::is_same<T, uint16_t>::value);
+        if (proc->hasChannelCrosstalk())
+            return nullptr;
+        constexpr bool is8    = std::is_same<T, uint8_t>::value;
+        std::once_flag& once  = is8 ? m_once8 : m_once16;
+        std::vector<float>& t = is8 ? m_lut8 : m_lut16;
+        std::call_once(once, [&]() {
+            size_t n = size_t(std::numeric_limits<T>::max()) + 1;
+            t.resize(4 * n);
+            for (size_t i = 0; i < n; ++i)
+                t[4 * i + 0] = t[4 * i + 1] = t[4 * i + 2] = t[4 * i + 3]
+                    = convert_type<T, float>(T(i));
+            proc->apply(t.data(), int(n), 1, 4, sizeof(float),
+                        4 * sizeof(float), stride_t(4 * n * sizeof(float)));
+        });
+        return t.data();
+    }
+
+    // RGB results on a lattice3d^3 grid spanning [0,1] (red varying
+    // fastest), or nullptr if the processor changes alpha or its color
+    // results depend on alpha, in which case the table can't be used.
+    const simd::vfloat4* lut3d(const ColorProcessor* proc) const
+    {
+        using namespace simd;
+        std::call_once(m_once3d, [&]() {
+            const int n = lattice3d;
+            size_t npts = size_t(n) * size_t(n) * size_t(n);
+            // Sample the lattice with alpha 1 and with alpha 0.
+            std::vector<vfloat4> opaque(npts), clear(npts);
+            for (int b = 0, i = 0; b < n; ++b)
+                for (int g = 0; g < n; ++g)
+                    for (int r = 0; r < n; ++r, ++i) {
+                        clear[i]  = vfloat4(float(r), float(g), float(b), 0.0f)
+                                   / float(n - 1);
+                        opaque[i] = clear[i] + vfloat4(0.0f, 0.0f, 0.0f, 1.0f);
+                    }
+            stride_t ystride = stride_t(npts * sizeof(vfloat4));
+            proc->apply((float*)opaque.data(), int(npts), 1, 4,
+                        sizeof(float), sizeof(vfloat4), ystride);
+            proc->apply((float*)clear.data(), int(npts), 1, 4,
+                        sizeof(float), sizeof(vfloat4), ystride);
+            const vbool4 rgb(true, true, true, false);
+            for (size_t i = 0; i < npts; ++i) {
+                if (extract<3>(opaque[i]) != 1.0f
+                    || extract<3>(clear[i]) != 0.0f
+                    || !all((opaque[i] == clear[i]) | !rgb))
+                    return;  // alpha isn't simply passed through
+                clear[i] = select(rgb, clear[i], vfloat4::Zero());
+            }
+            m_lut3d.swap(clear);
+        });
+        return m_lut3d.size() ? m_lut3d.data() : nullptr;
+    }
+
+    static constexpr int lattice3d = 65;
+
+private:
+    mutable std::once_flag m_once8, m_once16, m_once3d;
+    mutable std::vector<float> m_lut8, m_lut16;
+    mutable std::vector<simd::vfloat4> m_lut3d;
+};
+
+
+
 // Custom ColorProcessor that wraps an OpenColorIO Processor.
-class ColorProcessor_OCIO final : public ColorProcessor {
+class ColorProcessor_OCIO final : public ColorProcessor,
+                                  public ColorProcessorLUTs {
 public:
     ColorProcessor_OCIO(OCIO::ConstProcessorRcPtr p)
         : m_p(p)
@@ -1473,7 +1558,8 @@ private:
 
 
 // ColorProcessor that implements a matrix multiply color transformation.
-class ColorProcessor_Matrix final : public ColorProcessor {
+class ColorProcessor_Matrix final : public ColorProcessor,
+                                    public ColorProcessorLUTs {
 public:
     ColorProcessor_Matrix(const Imath::M44f& Matrix, bool inverse)
         : ColorProcessor()
@@ -1484,6 +1570,15 @@ public:
     }
     ~ColorProcessor_Matrix() override {}
 
+    bool hasChannelCrosstalk() const override
+    {
+        for (int j = 0; j < 4; ++j)
+            for (int i = 0; i < 4; ++i)
+                if (i != j && m_M[j][i] != 0.0f)
+                    return true;
+        return false;
+    }
+
     void apply(float* data, int width, int height, int channels,
                stride_t chanstride, stride_t xstride,
                stride_t ystride) const override
@@ -2351,6 +2446,131 @@ colorconvert_impl(ImageBuf& R, const ImageBuf& A,
 
 
 
+// Tetrahedral interpolation of a ColorProcessorLUTs 3D lattice at the
+// lattice cell `base` with fractional position (fx,fy,fz) within it.
+static inline simd::vfloat4
+lut3d_tetrahedral(const simd::vfloat4* lut, int base, float fx, float fy,
+                  float fz)
+{
+    using namespace simd;
+    const int n = ColorProcessorLUTs::lattice3d;
+    // Walk from the cell's first corner to the opposite one, taking the
+    // axes in order of decreasing fraction.
+    float f[3] = { fx, fy, fz };
+    int d[3]   = { 1, n, n * n };
+    if (f[0] < f[1])
+        std::swap(f[0], f[1]), std::swap(d[0], d[1]);
+    if (f[1] < f[2])
+        std::swap(f[1], f[2]), std::swap(d[1], d[2]);
+    if (f[0] < f[1])
+        std::swap(f[0], f[1]), std::swap(d[0], d[1]);
+    const vfloat4 c0 = lut[base];
+    const vfloat4 c1 = lut[base + d[0]];
+    const vfloat4 c2 = lut[base + d[0] + d[1]];
+    const vfloat4 c3 = lut[base + d[0] + d[1] + d[2]];
+    return c0 + (c1 - c0) * f[0] + (c2 - c1) * f[1] + (c3 - c2) * f[2];
+}
+
+
+
+// colorconvert of unsigned 8 or 16 bit pixels by lookup into tables from
+// ColorProcessorLUTs: either the exact per-channel `lut1d`, or (8 bit only)
+// the interpolated `lut3d` lattice. Only for roi.chbegin == 0 and at most
+// 4 channels. Pixels that would be unpremultiplied by a partial alpha can't
+// use the tables, so just those go through the processor.
+template<class Atype>
+static bool
+colorconvert_by_lut(ImageBuf& R, const ImageBuf& A,
+                 const ColorProcessor* processor, const float* lut1d,
+                 const simd::vfloat4* lut3d, bool unpremult, ROI roi,
+                 int nthreads)
+{
+    using namespace ImageBufAlgo;
+    using namespace simd;
+    OIIO_DASSERT(roi.chbegin == 0 && roi.chend <= 4 && (lut1d || lut3d));
+    const int nc = roi.nchannels();
+    if (nc < 4)
+        unpremult = false;
+    // Lattice cell and fraction within it of each 8 bit code value
+    const int n = ColorProcessorLUTs::lattice3d;
+    int cell[256];
+    float frac[256];
+    for (int i = 0; lut3d && i < 256; ++i) {
+        float x = float(i) * float(n - 1) / 255.0f;
+        cell[i] = std::min(int(x), n - 2);
+        frac[i] = x - float(cell[i]);
+    }
+    parallel_image(roi, paropt(nthreads), [&](ROI roi) {
+        const float fltmin = std::numeric_limits<float>::min();
+        int width          = roi.width();
+        ImageBuf::ConstRowSpans<Atype> a(A, roi);
+        ImageBuf::RowSpans<float> r(R, roi);
+        std::vector<vfloat4> slow;  // pixels needing the processor
+        std::vector<int> slowx;
+        for (int z = roi.zbegin; z < roi.zend; ++z) {
+            for (int y = roi.ybegin; y < roi.yend; ++y) {
+                const Atype* in = a(y, z).data();
+                float* out      = r(y, z).data();
+                slow.clear();
+                slowx.clear();
+                for (int x = 0; x < width; ++x) {
+                    const Atype* p = in + x * nc;
+                    Atype code[4]  = { 0, 0, 0, 0 };
+                    for (int c = 0; c < nc; ++c)
+                        code[c] = p[c];
+                    if (nc == 1)
+                        code[2] = code[1] = code[0];
+                    float alpha = convert_type<Atype, float>(code[3]);
+                    if (unpremult && alpha >= fltmin && alpha != 1.0f) {
+                        vfloat4 v(convert_type<Atype, float>(code[0]),
+                                  convert_type<Atype, float>(code[1]),
+                                  convert_type<Atype, float>(code[2]),
+                                  alpha);
+                        slow.push_back(v);
+                        slowx.push_back(x);
+                        continue;
+                    }
+                    vfloat4 v;
+                    if (lut1d) {
+                        v = vfloat4(lut1d[4 * code[0] + 0],
+                                    lut1d[4 * code[1] + 1],
+                                    lut1d[4 * code[2] + 2],
+                                    lut1d[4 * code[3] + 3]);
+                    } else {
+                        int base = cell[code[0]]
+                                   + n * (cell[code[1]] + n * cell[code[2]]);
+                        v = lut3d_tetrahedral(lut3d, base, frac[code[0]],
+                                              frac[code[1]], frac[code[2]]);
+                    }
+                    float* o = out + x * nc;
+                    for (int c = 0; c < nc; ++c)
+                        o[c] = (c == 3 && !lut1d) ? alpha : v[c];
+                }
+                if (slow.empty())
+                    continue;
+                // Unpremult, transform, and re-premult the stragglers, just
+                // as colorconvert_impl would have.
+                int nslow = int(slow.size());
+                for (auto& v : slow)
+                    v /= vfloat4(extract<3>(v), extract<3>(v), extract<3>(v),
+                                 1.0f);
+                processor->apply((float*)slow.data(), nslow, 1, 4,
+                                 sizeof(float), sizeof(vfloat4),
+                                 nslow * sizeof(vfloat4));
+                for (int i = 0; i < nslow; ++i) {
+                    float alpha = convert_type<Atype, float>(
+                        in[slowx[i] * nc + 3]);
+                    vfloat4 v   = slow[i] * vfloat4(alpha, alpha, alpha, 1.0f);
+                    v.store(out + slowx[i] * nc);
+                }
+            }
+        }
+    });
+    return true;
+}
+
+
+
 // Specialized version where both buffers are in memory (not cache based),
 // float data, and we are dealing with 4 channels.
 static bool
@@ -2457,6 +2677,34 @@ ImageBufAlgo::colorconvert(ImageBuf& dst, const ImageBuf& src,
                                             nthreads);
     }
 
+    // 8 and 16 bit unsigned inputs can often be converted by table lookup
+    // rather than running the processor on every pixel. The larger tables
+    // are only worth building if there are at least as many pixels to
+    // convert as table entries.
+    TypeDesc srcformat = src.spec().format;
+    int lutmode        = OIIO::pvt::colorconvert_lut;
+    auto luts          = dynamic_cast<const ColorProcessorLUTs*>(processor);
+    if (luts && lutmode && roi.chbegin == 0 && roi.chend <= 4
+        && (srcformat == TypeUInt8 || srcformat == TypeUInt16)) {
+        const int n         = ColorProcessorLUTs::lattice3d;
+        imagesize_t npixels = roi.npixels();
+        if (srcformat == TypeUInt8) {
+            const float* lut1d         = luts->lut1d<uint8_t>(processor);
+            const simd::vfloat4* lut3d = nullptr;
+            if (!lut1d && lutmode >= 2 && npixels >= imagesize_t(n * n * n))
+                lut3d = luts->lut3d(processor);
+            if (lut1d || lut3d)
+                return colorconvert_by_lut<uint8_t>(dst, src, processor,
+                                                    lut1d, lut3d, unpremult,
+                                                    roi, nthreads);
+        } else if (npixels >= 65536) {
+            if (const float* lut1d = luts->lut1d<uint16_t>(processor))
+                return colorconvert_by_lut<uint16_t>(dst, src, processor,
+                                                     lut1d, nullptr,
+                                                     unpremult, roi, nthreads);
+        }
+    }
+
     bool ok = true;
     OIIO_DISPATCH_COMMON_TYPES2(ok, "colorconvert", colorconvert_impl,
                                 dst.spec().format, src.spec().format, dst, src,
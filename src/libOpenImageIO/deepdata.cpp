@@ -13,6 +13,7 @@
 #include <OpenImageIO/deepdata.h>
 #include <OpenImageIO/fmath.h>
 #include <OpenImageIO/imageio.h>
+#include <OpenImageIO/simd.h>
 #include <OpenImageIO/strutil.h>
 #include <OpenImageIO/thread.h>
 
@@ -31,6 +32,147 @@ OIIO_NAMESPACE_3_1_BEGIN
 
 
 
+namespace {
+
+template<typename T>
+inline void
+gather_(const char* src, size_t stride, float* dst, size_t n)
+{
+    for (size_t i = 0; i < n; ++i, src += stride)
+        dst[i] = convert_type<T, float>(*(const T*)src);
+}
+
+
+template<typename T>
+inline void
+scatter_(const float* src, char* dst, size_t stride, size_t n)
+{
+    for (size_t i = 0; i < n; ++i, dst += stride)
+        *(T*)dst = convert_type<float, T>(src[i]);
+}
+
+
+// Convert n strided values of the given type into contiguous floats.
+// UINT32 values are copied bit for bit rather than converted, so that
+// integer channels (such as object IDs) survive the round trip.
+void
+gather_channel(TypeDesc type, const char* src, size_t stride, float* dst,
+               size_t n)
+{
+    switch (type.basetype) {
+    case TypeDesc::FLOAT: gather_<float>(src, stride, dst, n); break;
+    case TypeDesc::HALF: gather_<half>(src, stride, dst, n); break;
+    case TypeDesc::UINT:
+        for (size_t i = 0; i < n; ++i, src += stride)
+            memcpy(dst + i, src, sizeof(float));
+        break;
+    case TypeDesc::UINT8: gather_<unsigned char>(src, stride, dst, n); break;
+    case TypeDesc::INT8: gather_<char>(src, stride, dst, n); break;
+    case TypeDesc::UINT16: gather_<unsigned short>(src, stride, dst, n); break;
+    case TypeDesc::INT16: gather_<short>(src, stride, dst, n); break;
+    case TypeDesc::INT: gather_<int>(src, stride, dst, n); break;
+    case TypeDesc::UINT64: gather_<uint64_t>(src, stride, dst, n); break;
+    case TypeDesc::INT64: gather_<int64_t>(src, stride, dst, n); break;
+    default:
+        OIIO_ASSERT_MSG(0, "Unknown/unsupported data type %d", type.basetype);
+    }
+}
+
+
+// Inverse of gather_channel: store contiguous floats into n strided values.
+void
+scatter_channel(TypeDesc type, const float* src, char* dst, size_t stride,
+                size_t n)
+{
+    switch (type.basetype) {
+    case TypeDesc::FLOAT: scatter_<float>(src, dst, stride, n); break;
+    case TypeDesc::HALF: scatter_<half>(src, dst, stride, n); break;
+    case TypeDesc::UINT:
+        for (size_t i = 0; i < n; ++i, dst += stride)
+            memcpy(dst, src + i, sizeof(float));
+        break;
+    case TypeDesc::UINT8: scatter_<unsigned char>(src, dst, stride, n); break;
+    case TypeDesc::INT8: scatter_<char>(src, dst, stride, n); break;
+    case TypeDesc::UINT16: scatter_<unsigned short>(src, dst, stride, n); break;
+    case TypeDesc::INT16: scatter_<short>(src, dst, stride, n); break;
+    case TypeDesc::INT: scatter_<int>(src, dst, stride, n); break;
+    case TypeDesc::UINT64: scatter_<uint64_t>(src, dst, stride, n); break;
+    case TypeDesc::INT64: scatter_<int64_t>(src, dst, stride, n); break;
+    default:
+        OIIO_ASSERT_MSG(0, "Unknown/unsupported data type %d", type.basetype);
+    }
+}
+
+
+// The value of a gathered UINT32 (raw bits) or float, as deep_value()
+// would return it, and the reverse, as set_deep_value() would store it.
+inline float
+column_value(float v, bool isuint)
+{
+    return isuint ? convert_type<uint32_t, float>(bitcast<uint32_t>(v)) : v;
+}
+
+inline float
+column_store(float v, bool isuint)
+{
+    return isuint ? bitcast<float>(convert_type<float, uint32_t>(v)) : v;
+}
+
+
+
+// The first sample s >= 1 of a pixel's depth columns that belongs before
+// sample s-1 (lower z, or equal z and lower zback), or n if they are all
+// in order. Four neighboring pairs are compared at a time.
+int
+first_unsorted(const float* z, const float* zback, int n)
+{
+    using namespace simd;
+    int s = 1;
+    for (; s + 4 <= n; s += 4) {
+        vfloat4 z0(z + s - 1), z1(z + s), b0(zback + s - 1), b1(zback + s);
+        if (any((z1 < z0) | ((z1 == z0) & (b1 < b0))))
+            break;
+    }
+    for (; s < n; ++s)
+        if (z[s] < z[s - 1] || (z[s] == z[s - 1] && zback[s] < zback[s - 1]))
+            return s;
+    return n;
+}
+
+
+// The first sample s >= 1 with exactly the same depth range as sample
+// s-1, or n if there is none.
+int
+first_overlap(const float* z, const float* zback, int n)
+{
+    using namespace simd;
+    int s = 1;
+    for (; s + 4 <= n; s += 4) {
+        vfloat4 z0(z + s - 1), z1(z + s), b0(zback + s - 1), b1(zback + s);
+        if (any((z1 == z0) & (b1 == b0)))
+            break;
+    }
+    for (; s < n; ++s)
+        if (z[s] == z[s - 1] && zback[s] == zback[s - 1])
+            return s;
+    return n;
+}
+
+
+// Columns for the single pixel operations (sort, merge_overlaps,
+// occlusion_cull) to work in. There's one per thread, so it only
+// allocates when a pixel has more samples than the thread has seen.
+DeepData::Columns&
+pixel_columns()
+{
+    thread_local DeepData::Columns cols;
+    return cols;
+}
+
+}  // namespace
+
+
+
 class DeepData::Impl {  // holds all the nontrivial stuff
     // NOTE: Because the definition of DeepData::Impl is not exposed
     // externally, it can change at will even though it's inside the v3_1
@@ -105,7 +247,7 @@ public:
         }
     }
 
-    size_t data_offset(int64_t pixel, int channel, int sample)
+    size_t data_offset(int64_t pixel, int channel, int sample) const
     {
         OIIO_DASSERT(int(m_cumcapacity.size()) > pixel);
         OIIO_DASSERT(m_capacity[pixel] >= m_nsamples[pixel]);
@@ -125,6 +267,57 @@ public:
         return m_cumcapacity.back() + m_capacity.back();
     }
 
+    // Set up the offsets of `cols` for the samples of the `npix` pixels
+    // starting at `pixbegin`, reusing its storage. The channel arrays are
+    // only sized as get_column() fills them, so that an operation that
+    // needs just a few channels doesn't touch the others.
+    void size_columns(DeepData::Columns& cols, int64_t pixbegin,
+                      int64_t npix) const
+    {
+        cols.offsets.resize(npix + 1);
+        cols.offsets[0] = 0;
+        for (int64_t i = 0; i < npix; ++i)
+            cols.offsets[i + 1] = cols.offsets[i] + m_nsamples[pixbegin + i];
+        cols.channel.resize(m_channeltypes.size());
+    }
+
+    // Fill channel `c` of `cols`, which size_columns() set up for the
+    // pixels starting at `pixbegin`. UINT32 values are moved as raw bits.
+    void get_column(DeepData::Columns& cols, int c, int64_t pixbegin) const
+    {
+        cols.channel[c].resize(cols.total_samples());
+        for (int64_t i = 0, npix = cols.pixels(); i < npix; ++i) {
+            if (int n = cols.samples(i))
+                gather_channel(m_channeltypes[c],
+                               &m_data[data_offset(pixbegin + i, c, 0)],
+                               m_samplesize, cols.values(c, i).data(),
+                               size_t(n));
+        }
+    }
+
+    // Like get_column(), but UINT32 values are converted to the same
+    // normalized floats that deep_value() returns, for comparing them.
+    // Such a column must not be stored back.
+    void get_column_values(DeepData::Columns& cols, int c,
+                           int64_t pixbegin) const
+    {
+        get_column(cols, c, pixbegin);
+        if (m_channeltypes[c].basetype == TypeDesc::UINT)
+            for (float& v : cols.channel[c])
+                v = column_value(v, true);
+    }
+
+    // Store samples `[first, first+n)` of channel `c` of the i-th pixel of
+    // `cols` into the same samples of `pixel`.
+    void put_column(const DeepData::Columns& cols, int c, int64_t i,
+                    int64_t pixel, int first, int n)
+    {
+        if (n > 0)
+            scatter_channel(m_channeltypes[c], cols.values(c, i).data() + first,
+                            &m_data[data_offset(pixel, c, first)],
+                            m_samplesize, size_t(n));
+    }
+
     inline void sanity() const
     {
         // int nchannels = int (m_channeltypes.size());
@@ -871,6 +1064,64 @@ DeepData::get_pointers(std::vector<void*>& pointers) const
 
 
 
+void
+DeepData::get_columns(Columns& cols, int64_t pixbegin, int64_t pixend) const
+{
+    OIIO_DASSERT(m_impl);
+    if (pixend < 0 || pixend > m_npixels)
+        pixend = m_npixels;
+    pixbegin     = clamp(pixbegin, int64_t(0), pixend);
+    int64_t npix = pixend - pixbegin;
+
+    // Resizing (rather than reassigning) the arrays means that a Columns
+    // reused for successive ranges only allocates when it must grow.
+    m_impl->size_columns(cols, pixbegin, npix);
+    if (cols.total_samples())
+        m_impl->alloc(m_npixels);
+    for (int c = 0; c < m_nchannels; ++c)
+        m_impl->get_column(cols, c, pixbegin);
+}
+
+
+
+bool
+DeepData::set_columns(const Columns& cols)
+{
+    OIIO_DASSERT(m_impl);
+    if (cols.pixels() != m_npixels || int(cols.channel.size()) != m_nchannels
+        || (m_npixels && cols.offsets[0] != 0))
+        return false;
+    for (int64_t p = 0; p < m_npixels; ++p)
+        if (cols.offsets[p + 1] < cols.offsets[p])
+            return false;
+    uint64_t total = cols.total_samples();
+    for (auto& ch : cols.channel)
+        if (ch.size() < total)
+            return false;
+
+    Impl& impl(*m_impl);
+    {
+        spin_lock lock(impl.m_mutex);
+        size_t totalcapacity = 0;
+        for (int64_t p = 0; p < m_npixels; ++p) {
+            unsigned int n        = cols.samples(p);
+            impl.m_nsamples[p]    = n;
+            impl.m_capacity[p]    = n;
+            impl.m_cumcapacity[p] = totalcapacity;
+            totalcapacity += n;
+        }
+        impl.m_data.clear();  // don't bother copying the old contents
+        impl.m_data.resize(totalcapacity * impl.m_samplesize);
+        impl.m_allocated = true;
+    }
+    for (int64_t p = 0; p < m_npixels; ++p)
+        for (int c = 0; c < m_nchannels; ++c)
+            impl.put_column(cols, c, p, p, 0, cols.samples(p));
+    return true;
+}
+
+
+
 bool
 DeepData::copy_deep_sample(int64_t pixel, int sample, const DeepData& src,
                            int64_t srcpixel, int srcsample)
@@ -1028,65 +1279,47 @@ DeepData::split(int64_t pixel, float depth)
 
 
 
-namespace {
-
-// Comparator functor for depth sorting sample indices of a deep pixel.
-class SampleComparator {
-public:
-    SampleComparator(const DeepData& dd, int pixel, int zchan, int zbackchan)
-        : deepdata(dd)
-        , pixel(pixel)
-        , zchan(zchan)
-        , zbackchan(zbackchan)
-    {
-    }
-    bool operator()(int i, int j) const
-    {
-        // If either has a lower z, that's the lower
-        float iz = deepdata.deep_value(pixel, zchan, i);
-        float jz = deepdata.deep_value(pixel, zchan, j);
-        if (iz < jz)
-            return true;
-        if (iz > jz)
-            return false;
-        // If both z's are equal, sort based on zback
-        float izb = deepdata.deep_value(pixel, zbackchan, i);
-        float jzb = deepdata.deep_value(pixel, zbackchan, j);
-        return izb < jzb;
-    }
-
-private:
-    const DeepData& deepdata;
-    int pixel;
-    int zchan, zbackchan;
-};
-
-}  // namespace
-
-
-
 void
 DeepData::sort(int64_t pixel)
 {
     int zchan = m_impl->m_z_channel;
     if (zchan < 0)
         return;  // No channel labeled Z -- we don't know what to do
-    int zbackchan = m_impl->m_z_channel;
+    int zbackchan = m_impl->m_zback_channel;
     if (zbackchan < 0)
         zbackchan = zchan;
     int nsamples = samples(pixel);
     if (nsamples < 2)
         return;  // 0 or 1 samples -- no sort necessary
 
+    // Compare the Z and Zback columns of the pixel, which are contiguous
+    // floats rather than values spread through the interleaved samples.
+    // The other channels are never needed for that.
+    Columns& cols(pixel_columns());
+    m_impl->size_columns(cols, pixel, 1);
+    m_impl->get_column_values(cols, zchan, pixel);
+    if (zbackchan != zchan)
+        m_impl->get_column_values(cols, zbackchan, pixel);
+    const float* z     = cols.channel[zchan].data();
+    const float* zback = cols.channel[zbackchan].data();
+    if (first_unsorted(z, zback, nsamples) == nsamples)
+        return;  // Already in order (the common case) -- nothing to move
+    auto less = [&](int i, int j) {
+        // If either has a lower z, that's the lower. If both z's are
+        // equal, sort based on zback.
+        return z[i] < z[j] || (z[i] == z[j] && zback[i] < zback[j]);
+    };
+
     // Ick, std::sort and friends take a custom comparator, but not a custom
     // swapper, so there's no way to std::sort a data type whose size is not
     // known at compile time. So we just sort the indices!
     int* sample_indices = OIIO_ALLOCA(int, nsamples);
     std::iota(sample_indices, sample_indices + nsamples, 0);
-    std::stable_sort(sample_indices, sample_indices + nsamples,
-                     SampleComparator(*this, pixel, zchan, zbackchan));
+    std::stable_sort(sample_indices, sample_indices + nsamples, less);
 
-    // Now copy around using a temp buffer
+    // Now copy around using a temp buffer. The samples are stored
+    // interleaved, so moving each one whole is cheaper than permuting every
+    // column and storing them all back.
     size_t samplebytes = samplesize();
     char* tmppixel     = OIIO_ALLOCA(char, samplebytes* nsamples);
     memcpy(tmppixel, data_ptr(pixel, 0, 0), samplebytes * nsamples);
@@ -1107,70 +1340,98 @@ DeepData::merge_overlaps(int64_t pixel)
         return;  // No channel labeled Z -- we don't know what to do
     if (zbackchan < 0)
         zbackchan = zchan;  // Missing Zback -- use Z
+    int nsamples = samples(pixel);
+    if (nsamples < 2)
+        return;
+
+    // Work on the columns of the pixel. Look at just the depths first,
+    // since most pixels have no exactly overlapping samples at all.
     int nchans = channels();
-    for (int s = 1 /* YES, 1 */; s < samples(pixel); ++s) {
-        float zf = deep_value(pixel, zchan, s);      // z front
-        float zb = deep_value(pixel, zbackchan, s);  // z back
-        if (zf == deep_value(pixel, zchan, s - 1)
-            && zb == deep_value(pixel, zbackchan, s - 1)) {
-            // The samples overlap exactly, merge them per
-            // See http://www.openexr.com/InterpretingDeepPixels.pdf
-            for (int c = 0; c < nchans; ++c) {  // set the colors
-                int alphachan = m_impl->m_myalphachannel[c];
-                if (alphachan < 0)
-                    continue;  // Not color or alpha
-                if (alphachan == c)
-                    continue;  // Adjust the alphas in a second pass below
-                float a1 = (alphachan < 0)
-                               ? 1.0f
-                               : clamp(deep_value(pixel, alphachan, s - 1),
-                                       0.0f, 1.0f);
-                float a2 = (alphachan < 0)
-                               ? 1.0f
-                               : clamp(deep_value(pixel, alphachan, s), 0.0f,
-                                       1.0f);
-                float c1 = deep_value(pixel, c, s - 1);
-                float c2 = deep_value(pixel, c, s);
-                float am = a1 + a2 - a1 * a2;
-                float cm;
-                if (a1 == 1.0f && a2 == 1.0f)
-                    cm = (c1 + c2) / 2.0f;
-                else if (a1 == 1.0f)
-                    cm = c1;
-                else if (a2 == 1.0f)
-                    cm = c2;
-                else {
-                    static const float MAX = std::numeric_limits<float>::max();
-                    float u1               = -log1p(-a1);
-                    float v1               = (u1 < a1 * MAX) ? u1 / a1 : 1.0f;
-                    float u2               = -log1p(-a2);
-                    float v2               = (u2 < a2 * MAX) ? u2 / a2 : 1.0f;
-                    float u                = u1 + u2;
-                    float w = (u > 1.0f || am < u * MAX) ? am / u : 1.0f;
-                    cm      = (c1 * v1 + c2 * v2) * w;
-                }
-                set_deep_value(pixel, c, s - 1, cm);  // setting color
-            }
-            for (int c = 0; c < nchans; ++c) {  // set the alphas
-                int alphachan = m_impl->m_myalphachannel[c];
-                if (alphachan != c)
-                    continue;  // This pass is only for alphas
-                float a1 = (alphachan < 0)
-                               ? 1.0f
-                               : clamp(deep_value(pixel, alphachan, s - 1),
-                                       0.0f, 1.0f);
-                float a2 = (alphachan < 0)
-                               ? 1.0f
-                               : clamp(deep_value(pixel, alphachan, s), 0.0f,
-                                       1.0f);
-                float am = a1 + a2 - a1 * a2;
-                set_deep_value(pixel, c, s - 1, am);  // setting alpha
+    Columns& cols(pixel_columns());
+    m_impl->size_columns(cols, pixel, 1);
+    m_impl->get_column(cols, zchan, pixel);
+    if (zbackchan != zchan)
+        m_impl->get_column(cols, zbackchan, pixel);
+    float* z     = cols.channel[zchan].data();
+    float* zback = cols.channel[zbackchan].data();
+    int first    = first_overlap(z, zback, nsamples);
+    if (first == nsamples)
+        return;  // No overlaps
+    for (int c = 0; c < nchans; ++c)
+        if (c != zchan && c != zbackchan)
+            m_impl->get_column(cols, c, pixel);
+
+    // Compact the samples in a single pass: `out` is the last sample kept,
+    // and each following sample either merges into it or becomes the next
+    // one kept. UINT32 columns hold raw bits, which are only converted for
+    // the samples being blended, so that the others are copied exactly.
+    const int* myalpha = m_impl->m_myalphachannel.data();
+    bool* isuint       = OIIO_ALLOCA(bool, nchans);
+    float** col        = OIIO_ALLOCA(float*, nchans);
+    for (int c = 0; c < nchans; ++c) {
+        isuint[c] = (m_impl->m_channeltypes[c].basetype == TypeDesc::UINT);
+        col[c]    = cols.channel[c].data();
+    }
+    int out = first - 1;
+    for (int s = first; s < nsamples; ++s) {
+        if (!(z[s] == z[out] && zback[s] == zback[out])) {
+            if (++out != s)
+                for (int c = 0; c < nchans; ++c)
+                    col[c][out] = col[c][s];
+            continue;
+        }
+        // The samples overlap exactly, merge them per
+        // See http://www.openexr.com/InterpretingDeepPixels.pdf
+        for (int c = 0; c < nchans; ++c) {  // set the colors
+            int alphachan = myalpha[c];
+            if (alphachan < 0)
+                continue;  // Not color or alpha
+            if (alphachan == c)
+                continue;  // Adjust the alphas in a second pass below
+            const float* alpha = col[alphachan];
+            float* color       = col[c];
+            bool ua            = isuint[alphachan];
+            float a1 = clamp(column_value(alpha[out], ua), 0.0f, 1.0f);
+            float a2 = clamp(column_value(alpha[s], ua), 0.0f, 1.0f);
+            float c1 = column_value(color[out], isuint[c]);
+            float c2 = column_value(color[s], isuint[c]);
+            float am = a1 + a2 - a1 * a2;
+            float cm;
+            if (a1 == 1.0f && a2 == 1.0f)
+                cm = (c1 + c2) / 2.0f;
+            else if (a1 == 1.0f)
+                cm = c1;
+            else if (a2 == 1.0f)
+                cm = c2;
+            else {
+                static const float MAX = std::numeric_limits<float>::max();
+                float u1               = -log1p(-a1);
+                float v1               = (u1 < a1 * MAX) ? u1 / a1 : 1.0f;
+                float u2               = -log1p(-a2);
+                float v2               = (u2 < a2 * MAX) ? u2 / a2 : 1.0f;
+                float u                = u1 + u2;
+                float w = (u > 1.0f || am < u * MAX) ? am / u : 1.0f;
+                cm      = (c1 * v1 + c2 * v2) * w;
             }
-            // Now eliminate sample s and revisit again
-            erase_samples(pixel, s, 1);
-            --s;
+            color[out] = column_store(cm, isuint[c]);  // setting color
+        }
+        for (int c = 0; c < nchans; ++c) {  // set the alphas
+            if (myalpha[c] != c)
+                continue;  // This pass is only for alphas
+            float* alpha = col[c];
+            bool ua      = isuint[c];
+            float a1     = clamp(column_value(alpha[out], ua), 0.0f, 1.0f);
+            float a2     = clamp(column_value(alpha[s], ua), 0.0f, 1.0f);
+            // setting alpha
+            alpha[out] = column_store(a1 + a2 - a1 * a2, ua);
         }
     }
+
+    // Write back only the samples that changed, and drop the rest.
+    int nout = out + 1;
+    for (int c = 0; c < nchans; ++c)
+        m_impl->put_column(cols, c, 0, pixel, first - 1, nout - (first - 1));
+    set_samples(pixel, nout);
 }
 
 
@@ -1266,11 +1527,24 @@ DeepData::occlusion_cull(int64_t pixel)
     if (alpha_channel < 0)
         return;  // If there isn't a definitive alpha channel, never mind
     int nsamples = samples(pixel);
-    for (int s = 0; s < nsamples; ++s) {
-        if (deep_value(pixel, alpha_channel, s) >= 1.0f) {
+    if (!nsamples)
+        return;
+    // Scan the alpha column four samples per compare for the first opaque
+    // sample.
+    Columns& cols(pixel_columns());
+    m_impl->size_columns(cols, pixel, 1);
+    m_impl->get_column_values(cols, alpha_channel, pixel);
+    const float* alpha      = cols.channel[alpha_channel].data();
+    const simd::vfloat4 one = simd::vfloat4::One();
+    int s                   = 0;
+    for (; s + 4 <= nsamples; s += 4)
+        if (simd::any(simd::vfloat4(alpha + s) >= one))
+            break;
+    for (; s < nsamples; ++s) {
+        if (alpha[s] >= 1.0f) {
             // We hit an opaque sample. Cull everything farther.
             set_samples(pixel, s + 1);
-            break;
+            return;
         }
     }
 }
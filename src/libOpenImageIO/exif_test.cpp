@@ -0,0 +1,77 @@
+// Copyright Contributors to the OpenImageIO project.
+// SPDX-License-Identifier: Apache-2.0
+// https://github.com/AcademySoftwareFoundation/OpenImageIO
+
+
+#include <OpenImageIO/benchmark.h>
+#include <OpenImageIO/imageio.h>
+#include <OpenImageIO/tiffutils.h>
+#include <OpenImageIO/unittest.h>
+
+using namespace OIIO;
+
+
+
+// Readers of camera raw and JPEG files decode an Exif block into an
+// ImageSpec that may already hold hundreds of attributes, adding or
+// replacing each tag by name. Check the round trip, and time the decode.
+static void
+test_decode_exif()
+{
+    std::cout << "test_decode_exif\n";
+    ImageSpec src(640, 480, 3, TypeUInt8);
+    src.attribute("Make", "Canon");
+    src.attribute("Model", "EOS Test");
+    src.attribute("Exif:ISOSpeedRatings", 400);
+    src.attribute("Exif:FocalLength", 50.0f);
+    src.attribute("Exif:ApertureValue", 3.0f);
+    src.attribute("Exif:MeteringMode", 5);
+    src.attribute("Exif:Flash", 16);
+    src.attribute("Exif:DateTimeOriginal", "2024:01:02 03:04:05");
+    src.attribute("Exif:LensModel", "EF50mm f/1.8 STM");
+    src.attribute("Exif:BodySerialNumber", "0123456789");
+    std::vector<char> blob;
+    encode_exif(src, blob);
+
+    // What a raw reader has usually set by the time it gets to the Exif
+    const int nattribs = 300;
+    ImageSpec base(640, 480, 3, TypeUInt8);
+    for (int i = 0; i < nattribs; ++i)
+        base.attribute(Strutil::fmt::format("raw:Attribute{}", i), i);
+
+    ImageSpec spec = base;
+    OIIO_CHECK_ASSERT(decode_exif(string_view(blob.data(), blob.size()), spec));
+    OIIO_CHECK_EQUAL(spec.get_string_attribute("Model"), "EOS Test");
+    OIIO_CHECK_EQUAL(spec.get_int_attribute("Exif:ISOSpeedRatings"), 400);
+    OIIO_CHECK_EQUAL(spec.get_float_attribute("Exif:FocalLength"), 50.0f);
+    OIIO_CHECK_EQUAL(spec.get_int_attribute("Exif:MeteringMode"), 5);
+    OIIO_CHECK_EQUAL(spec.get_string_attribute("Exif:LensModel"),
+                     "EF50mm f/1.8 STM");
+    OIIO_CHECK_EQUAL(spec.get_int_attribute("raw:Attribute123"), 123);
+
+    Benchmarker bench;
+    bench.indent(2);
+    bench.units(Benchmarker::Unit::us);
+    bench("decode_exif into an empty spec", [&]() {
+        ImageSpec s(640, 480, 3, TypeUInt8);
+        decode_exif(string_view(blob.data(), blob.size()), s);
+        DoNotOptimize(s.extra_attribs.size());
+    });
+    bench(Strutil::fmt::format("decode_exif into a spec with {} attributes",
+                               nattribs),
+          [&]() {
+              ImageSpec s = base;
+              decode_exif(string_view(blob.data(), blob.size()), s);
+              DoNotOptimize(s.extra_attribs.size());
+          });
+}
+
+
+
+int
+main(int /*argc*/, char* /*argv*/[])
+{
+    test_decode_exif();
+
+    return unit_test_failures;
+}
@@ -0,0 +1,608 @@
+// Copyright Contributors to the OpenImageIO project.
+// SPDX-License-Identifier: Apache-2.0
+// https://github.com/AcademySoftwareFoundation/OpenImageIO
+
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <thread>
+
+#include <OpenImageIO/filesystem.h>
+#include <OpenImageIO/framesequence.h>
+#include <OpenImageIO/strutil.h>
+#include <OpenImageIO/sysutil.h>
+
+
+OIIO_NAMESPACE_BEGIN
+
+
+class FrameSequenceReader::Impl {
+public:
+    ~Impl() { close(); }
+
+    bool open(std::vector<std::string>&& filenames,
+              std::vector<int>&& frame_numbers);
+    void close();
+    bool next(ImageBuf& frame);
+    bool seek(int index);
+    const ImageSpec* spec(int index);
+
+    int nframes() const { return int(m_filenames.size()); }
+
+    int position() const
+    {
+        std::lock_guard lock(m_mutex);
+        return m_next;
+    }
+
+    void set_format(TypeDesc format)
+    {
+        std::lock_guard lock(m_mutex);
+        m_format = format;
+    }
+
+    // Let the threads know that the settings may allow more reading ahead.
+    void settings_changed() { m_work.notify_all(); }
+
+    template<typename... Args>
+    void errorfmt(const char* fmt, const Args&... args)
+    {
+        append_error(Strutil::fmt::format(fmt, args...));
+    }
+    void append_error(string_view message);
+    bool has_error() const;
+    std::string geterror(bool clear);
+
+    // Settings
+    std::atomic<int> m_readahead { 4 };
+    std::atomic<size_t> m_memory_limit { size_t(1024) << 20 };
+    int m_nthreads = 0;
+
+    std::vector<std::string> m_filenames;
+    std::vector<int> m_frame_numbers;
+
+private:
+    // A frame that is being read, or has been read but not handed out.
+    struct Frame {
+        bool reading = true;
+        size_t bytes = 0;  // Memory it takes (or will, as best we know)
+        ImageBuf buf;
+        std::string error;  // Why it couldn't be read
+    };
+
+    void work();
+    int pick_frame();
+    size_t estimated_bytes(int index);
+    bool in_window(int index) const
+    {
+        return index >= m_next
+               && index < m_next + std::max(1, m_readahead.load())
+               && index < nframes();
+    }
+    const ImageSpec* keep_spec(int index, const ImageSpec& spec);
+    std::string read_frame(int index, TypeDesc format, ImageBuf& buf);
+
+    mutable std::mutex m_mutex;
+    int m_next = 0;                  // Next frame to hand out, m_mutex
+    TypeDesc m_format;               // Guarded by m_mutex
+    std::condition_variable m_work;  // A frame may be read, or closing
+    std::condition_variable m_done;  // A frame has been read
+    std::map<int, Frame> m_frames;   // Being read or read ahead, by index
+    size_t m_bytes      = 0;         // Total of m_frames[*].bytes
+    size_t m_last_bytes = 0;         // Size of the last frame read
+    bool m_closing      = false;
+    std::vector<std::thread> m_threads;
+
+    // Headers, once read. They are never changed or removed until close(),
+    // so pointers to them may be handed out.
+    std::mutex m_spec_mutex;
+    std::vector<std::unique_ptr<ImageSpec>> m_specs;
+
+    mutable std::mutex m_error_mutex;
+    std::string m_error;
+};
+
+
+
+bool
+FrameSequenceReader::Impl::open(std::vector<std::string>&& filenames,
+                                std::vector<int>&& frame_numbers)
+{
+    close();
+    if (filenames.empty()) {
+        errorfmt("No frames in the sequence");
+        return false;
+    }
+    m_filenames     = std::move(filenames);
+    m_frame_numbers = std::move(frame_numbers);
+    m_specs.resize(m_filenames.size());
+    m_next = 0;
+
+    int nthreads = m_nthreads;
+    if (nthreads <= 0)
+        nthreads = std::min(std::max(1, m_readahead.load()),
+                            int(Sysutil::hardware_concurrency()));
+    nthreads = std::max(1, std::min(nthreads, nframes()));
+    for (int i = 0; i < nthreads; ++i)
+        m_threads.emplace_back([this]() { work(); });
+    return true;
+}
+
+
+
+void
+FrameSequenceReader::Impl::close()
+{
+    {
+        std::lock_guard lock(m_mutex);
+        m_closing = true;
+    }
+    m_work.notify_all();
+    for (auto& t : m_threads)
+        t.join();
+    m_threads.clear();
+    m_closing = false;
+    m_frames.clear();
+    m_bytes      = 0;
+    m_last_bytes = 0;
+    m_filenames.clear();
+    m_frame_numbers.clear();
+    m_specs.clear();
+    m_next = 0;
+}
+
+
+
+size_t
+FrameSequenceReader::Impl::estimated_bytes(int index)
+{
+    {
+        std::lock_guard lock(m_spec_mutex);
+        if (const ImageSpec* spec = m_specs[index].get()) {
+            TypeDesc format = m_format.basetype != TypeDesc::UNKNOWN
+                                  ? m_format
+                                  : spec->format;
+            return spec->image_pixels() * size_t(spec->nchannels)
+                   * format.size();
+        }
+    }
+    // Frames of a sequence are usually all alike
+    return m_last_bytes;
+}
+
+
+
+// Return the index of the frame that a thread should read next, or -1 if
+// none should be started now. Call with m_mutex held.
+int
+FrameSequenceReader::Impl::pick_frame()
+{
+    int end = std::min(nframes(), m_next + std::max(1, m_readahead.load()));
+    for (int i = m_next; i < end; ++i) {
+        if (m_frames.count(i))
+            continue;  // Already read or being read
+        // Read frames strictly in order, so that if this one doesn't fit
+        // in the memory budget, none after it are started either. The
+        // frame to be handed out next is always read.
+        if (i == m_next || m_bytes + estimated_bytes(i) <= m_memory_limit)
+            return i;
+        return -1;
+    }
+    return -1;
+}
+
+
+
+void
+FrameSequenceReader::Impl::work()
+{
+    std::unique_lock lock(m_mutex);
+    for (;;) {
+        int index = -1;
+        m_work.wait(lock, [&]() {
+            return m_closing || (index = pick_frame()) >= 0;
+        });
+        if (m_closing)
+            return;
+
+        Frame& frame(m_frames[index]);
+        frame.bytes = estimated_bytes(index);
+        m_bytes += frame.bytes;
+        TypeDesc format = m_format;
+        lock.unlock();
+
+        ImageBuf buf;
+        std::string err;
+        try {
+            err = read_frame(index, format, buf);
+        } catch (const std::exception& e) {
+            err = e.what();
+        }
+
+        lock.lock();
+        // Only the thread that reads a frame removes it from m_frames while
+        // it's being read, so `frame` is still there.
+        size_t bytes = err.empty() ? buf.spec().image_bytes() : 0;
+        m_bytes      = m_bytes - frame.bytes + bytes;
+        if (bytes)
+            m_last_bytes = bytes;
+        frame.bytes   = bytes;
+        frame.buf     = std::move(buf);
+        frame.error   = std::move(err);
+        frame.reading = false;
+        if (!in_window(index)) {
+            // seek() moved away from it while we were reading it
+            m_bytes -= frame.bytes;
+            m_frames.erase(index);
+        }
+        m_done.notify_all();
+        m_work.notify_all();  // The estimate may have been generous
+    }
+}
+
+
+
+const ImageSpec*
+FrameSequenceReader::Impl::keep_spec(int index, const ImageSpec& spec)
+{
+    std::lock_guard lock(m_spec_mutex);
+    if (!m_specs[index])
+        m_specs[index].reset(new ImageSpec(spec));
+    return m_specs[index].get();
+}
+
+
+
+std::string
+FrameSequenceReader::Impl::read_frame(int index, TypeDesc format,
+                                      ImageBuf& buf)
+{
+    const std::string& filename(m_filenames[index]);
+    auto in = ImageInput::open(filename);
+    if (!in) {
+        std::string err = OIIO::geterror();
+        return err.size() ? err
+                          : Strutil::fmt::format("Could not open \"{}\"",
+                                                 filename);
+    }
+    // The spec already kept for this frame, if spec() read it first
+    const ImageSpec& spec(*keep_spec(index, in->spec()));
+    if (format.basetype == TypeDesc::UNKNOWN)
+        format = spec.format;
+
+    if (spec.deep) {
+        // Deep images are always kept in their native data types. Read
+        // them through the file that is already open.
+        ImageBuf deep(spec);
+        if (!in->read_native_deep_image(0, 0, *deep.deepdata())) {
+            std::string err = in->geterror();
+            return err.size() ? err
+                              : Strutil::fmt::format("Could not read \"{}\"",
+                                                     filename);
+        }
+        buf = std::move(deep);
+        return std::string();
+    }
+
+    ImageSpec bufspec(spec);
+    bufspec.set_format(format);
+    ImageBuf pixels(bufspec, InitializePixels::No);
+    if (!in->read_image(0, 0, 0, spec.nchannels, format,
+                        pixels.localpixels())) {
+        std::string err = in->geterror();
+        return err.size() ? err
+                          : Strutil::fmt::format("Could not read \"{}\"",
+                                                 filename);
+    }
+    buf = std::move(pixels);
+    return std::string();
+}
+
+
+
+const ImageSpec*
+FrameSequenceReader::Impl::spec(int index)
+{
+    if (index < 0 || index >= nframes())
+        return nullptr;
+    {
+        std::lock_guard lock(m_spec_mutex);
+        if (m_specs[index])
+            return m_specs[index].get();
+    }
+    auto in = ImageInput::open(m_filenames[index]);
+    if (!in) {
+        append_error(OIIO::geterror());
+        return nullptr;
+    }
+    return keep_spec(index, in->spec());
+}
+
+
+
+bool
+FrameSequenceReader::Impl::next(ImageBuf& frame)
+{
+    std::unique_lock lock(m_mutex);
+    if (m_next >= nframes()) {
+        frame.reset();
+        return false;
+    }
+    int index = m_next;
+    m_done.wait(lock, [&]() {
+        auto f = m_frames.find(index);
+        return f != m_frames.end() && !f->second.reading;
+    });
+    auto f = m_frames.find(index);
+    Frame done(std::move(f->second));
+    m_frames.erase(f);
+    m_bytes -= done.bytes;
+    ++m_next;
+    lock.unlock();
+    m_work.notify_all();
+
+    if (done.error.size()) {
+        append_error(done.error);
+        frame.reset();
+        return false;
+    }
+    frame = std::move(done.buf);
+    return true;
+}
+
+
+
+bool
+FrameSequenceReader::Impl::seek(int index)
+{
+    if (index < 0 || index >= nframes()) {
+        errorfmt("Can't seek to frame index {}, there are {} frames", index,
+                 nframes());
+        return false;
+    }
+    {
+        std::lock_guard lock(m_mutex);
+        m_next = index;
+        // Drop what was read ahead and isn't needed any more. Frames still
+        // being read are dropped by their thread when it's done.
+        for (auto f = m_frames.begin(); f != m_frames.end();) {
+            if (!f->second.reading && !in_window(f->first)) {
+                m_bytes -= f->second.bytes;
+                f = m_frames.erase(f);
+            } else {
+                ++f;
+            }
+        }
+    }
+    m_work.notify_all();
+    return true;
+}
+
+
+
+void
+FrameSequenceReader::Impl::append_error(string_view message)
+{
+    std::lock_guard lock(m_error_mutex);
+    if (m_error.size() && m_error.back() != '\n')
+        m_error += '\n';
+    m_error += message;
+}
+
+
+
+bool
+FrameSequenceReader::Impl::has_error() const
+{
+    std::lock_guard lock(m_error_mutex);
+    return !m_error.empty();
+}
+
+
+
+std::string
+FrameSequenceReader::Impl::geterror(bool clear)
+{
+    std::lock_guard lock(m_error_mutex);
+    std::string e = m_error;
+    if (clear)
+        m_error.clear();
+    return e;
+}
+
+
+
+FrameSequenceReader::FrameSequenceReader()
+    : m_impl(new Impl)
+{
+}
+
+
+
+FrameSequenceReader::~FrameSequenceReader() {}
+
+
+
+void
+FrameSequenceReader::set_readahead(int nframes)
+{
+    m_impl->m_readahead = std::max(1, nframes);
+    m_impl->settings_changed();
+}
+
+
+
+void
+FrameSequenceReader::set_memory_limit(size_t megabytes)
+{
+    m_impl->m_memory_limit = megabytes << 20;
+    m_impl->settings_changed();
+}
+
+
+
+void
+FrameSequenceReader::set_threads(int nthreads)
+{
+    m_impl->m_nthreads = nthreads;
+}
+
+
+
+void
+FrameSequenceReader::set_format(TypeDesc format)
+{
+    m_impl->set_format(format);
+}
+
+
+
+bool
+FrameSequenceReader::open(string_view pattern, string_view framespec,
+                          int framepadding)
+{
+    std::string normalized_pattern, pattern_framespec;
+    if (!Filesystem::parse_pattern(std::string(pattern).c_str(), framepadding,
+                                   normalized_pattern, pattern_framespec)) {
+        m_impl->errorfmt("Could not parse sequence pattern \"{}\"", pattern);
+        return false;
+    }
+    if (pattern_framespec.empty())
+        pattern_framespec = framespec;
+
+    std::vector<int> numbers;
+    std::vector<std::string> filenames;
+    if (pattern_framespec.size()) {
+        if (!Filesystem::enumerate_sequence(pattern_framespec, numbers)) {
+            m_impl->errorfmt("Could not parse frame range \"{}\"",
+                             pattern_framespec);
+            return false;
+        }
+        Filesystem::enumerate_file_sequence(normalized_pattern, numbers,
+                                            filenames);
+    } else if (!Filesystem::scan_for_matching_filenames(normalized_pattern,
+                                                        numbers, filenames)
+               || filenames.empty()) {
+        m_impl->errorfmt("No files found matching \"{}\"", pattern);
+        return false;
+    }
+    return m_impl->open(std::move(filenames), std::move(numbers));
+}
+
+
+
+bool
+FrameSequenceReader::open_files(cspan<std::string> filenames,
+                                cspan<int> frame_numbers)
+{
+    if (frame_numbers.size() && frame_numbers.size() != filenames.size()) {
+        m_impl->errorfmt("{} frame numbers given for {} files",
+                         frame_numbers.size(), filenames.size());
+        return false;
+    }
+    std::vector<int> numbers(frame_numbers.begin(), frame_numbers.end());
+    if (numbers.empty())
+        for (int i = 0, e = int(filenames.size()); i < e; ++i)
+            numbers.push_back(i);
+    return m_impl->open(std::vector<std::string>(filenames.begin(),
+                                                 filenames.end()),
+                        std::move(numbers));
+}
+
+
+
+void
+FrameSequenceReader::close()
+{
+    m_impl->close();
+}
+
+
+
+bool
+FrameSequenceReader::is_open() const
+{
+    return m_impl->nframes() > 0;
+}
+
+
+
+int
+FrameSequenceReader::nframes() const
+{
+    return m_impl->nframes();
+}
+
+
+
+std::string
+FrameSequenceReader::filename(int index) const
+{
+    if (index < 0 || index >= m_impl->nframes())
+        return std::string();
+    return m_impl->m_filenames[index];
+}
+
+
+
+int
+FrameSequenceReader::frame_number(int index) const
+{
+    if (index < 0 || index >= m_impl->nframes())
+        return 0;
+    return m_impl->m_frame_numbers[index];
+}
+
+
+
+const ImageSpec*
+FrameSequenceReader::spec(int index)
+{
+    return m_impl->spec(index);
+}
+
+
+
+int
+FrameSequenceReader::position() const
+{
+    return m_impl->position();
+}
+
+
+
+bool
+FrameSequenceReader::next(ImageBuf& frame)
+{
+    return m_impl->next(frame);
+}
+
+
+
+bool
+FrameSequenceReader::seek(int index)
+{
+    return m_impl->seek(index);
+}
+
+
+
+bool
+FrameSequenceReader::has_error() const
+{
+    return m_impl->has_error();
+}
+
+
+
+std::string
+FrameSequenceReader::geterror(bool clear) const
+{
+    return m_impl->geterror(clear);
+}
+
+
+OIIO_NAMESPACE_END
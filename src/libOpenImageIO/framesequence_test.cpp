@@ -0,0 +1,174 @@
+// Copyright Contributors to the OpenImageIO project.
+// SPDX-License-Identifier: Apache-2.0
+// https://github.com/AcademySoftwareFoundation/OpenImageIO
+
+
+#include <OpenImageIO/filesystem.h>
+#include <OpenImageIO/framesequence.h>
+#include <OpenImageIO/imagebuf.h>
+#include <OpenImageIO/imagebufalgo.h>
+#include <OpenImageIO/imageio.h>
+#include <OpenImageIO/unittest.h>
+
+#include <iostream>
+
+using namespace OIIO;
+
+
+static std::string seqdir;
+static const int nframes = 6;
+
+
+
+// Write frames 1..nframes of a small sequence, each filled with a value
+// that tells which frame it is.
+static void
+create_sequence()
+{
+    // A fresh directory, so that concurrent runs don't trip over each other
+    // and the directory scan sees only our frames.
+    seqdir = Filesystem::temp_directory_path() + "/"
+             + Filesystem::unique_path("framesequence_test-%%%%%%%%");
+    Filesystem::create_directory(seqdir);
+    for (int f = 1; f <= nframes; ++f) {
+        ImageBuf frame(ImageSpec(64, 48, 3, TypeUInt8));
+        ImageBufAlgo::fill(frame, { f / 255.0f, 0.5f, 1.0f });
+        frame.write(Strutil::fmt::format("{}/seq.{:04d}.tif", seqdir, f));
+    }
+}
+
+
+
+// Which frame does this image hold?
+static int
+frame_value(const ImageBuf& buf)
+{
+    return int(buf.getchannel(0, 0, 0, 0) * 255.0f + 0.5f);
+}
+
+
+
+static void
+test_read_in_order()
+{
+    Strutil::print("Testing reading a sequence in order\n");
+    FrameSequenceReader seq;
+    seq.set_readahead(3);
+    OIIO_CHECK_ASSERT(seq.open(seqdir + "/seq.1-6#.tif"));
+    OIIO_CHECK_ASSERT(seq.is_open());
+    OIIO_CHECK_EQUAL(seq.nframes(), nframes);
+    OIIO_CHECK_EQUAL(seq.frame_number(0), 1);
+    OIIO_CHECK_EQUAL(seq.filename(2), seqdir + "/seq.0003.tif");
+
+    const ImageSpec* spec = seq.spec(4);
+    OIIO_CHECK_ASSERT(spec && spec->width == 64 && spec->nchannels == 3);
+    OIIO_CHECK_ASSERT(seq.spec(nframes) == nullptr);
+
+    for (int i = 0; i < nframes; ++i) {
+        OIIO_CHECK_EQUAL(seq.position(), i);
+        ImageBuf frame;
+        OIIO_CHECK_ASSERT(seq.next(frame));
+        OIIO_CHECK_EQUAL(frame.spec().format, TypeUInt8);
+        OIIO_CHECK_EQUAL(frame_value(frame), i + 1);
+    }
+    ImageBuf past_end;
+    OIIO_CHECK_FALSE(seq.next(past_end));
+    OIIO_CHECK_FALSE(seq.has_error());
+}
+
+
+
+static void
+test_settings()
+{
+    Strutil::print("Testing sequence settings, scanning, and seeking\n");
+    FrameSequenceReader seq;
+    // Even with no memory to spare, the frames still come, one at a time.
+    seq.set_memory_limit(0);
+    seq.set_threads(2);
+    seq.set_format(TypeFloat);
+    // No frame range: find the frames in the directory.
+    OIIO_CHECK_ASSERT(seq.open(seqdir + "/seq.#.tif"));
+    OIIO_CHECK_EQUAL(seq.nframes(), nframes);
+    ImageBuf frame;
+    OIIO_CHECK_ASSERT(seq.next(frame));
+    OIIO_CHECK_EQUAL(frame.spec().format, TypeFloat);
+    OIIO_CHECK_EQUAL(frame_value(frame), 1);
+
+    OIIO_CHECK_ASSERT(seq.seek(4));
+    OIIO_CHECK_ASSERT(seq.next(frame));
+    OIIO_CHECK_EQUAL(frame_value(frame), 5);
+    OIIO_CHECK_ASSERT(seq.seek(1));
+    OIIO_CHECK_ASSERT(seq.next(frame));
+    OIIO_CHECK_EQUAL(frame_value(frame), 2);
+    OIIO_CHECK_FALSE(seq.seek(nframes));
+    OIIO_CHECK_ASSERT(seq.has_error());
+    seq.geterror();
+
+    // The frame range may also be given separately, and the frames needn't
+    // be consecutive.
+    OIIO_CHECK_ASSERT(seq.open(seqdir + "/seq.%04d.tif", "5-1x2"));
+    OIIO_CHECK_EQUAL(seq.nframes(), 3);
+    for (int f : { 5, 3, 1 }) {
+        OIIO_CHECK_ASSERT(seq.next(frame));
+        OIIO_CHECK_EQUAL(frame_value(frame), f);
+    }
+
+    // Or as a list of files
+    std::vector<std::string> files { seqdir + "/seq.0002.tif",
+                                     seqdir + "/seq.0006.tif" };
+    OIIO_CHECK_ASSERT(seq.open_files(files));
+    OIIO_CHECK_EQUAL(seq.nframes(), 2);
+    OIIO_CHECK_EQUAL(seq.frame_number(1), 1);
+    OIIO_CHECK_ASSERT(seq.next(frame));
+    OIIO_CHECK_ASSERT(seq.next(frame));
+    OIIO_CHECK_EQUAL(frame_value(frame), 6);
+    seq.close();
+    OIIO_CHECK_FALSE(seq.is_open());
+}
+
+
+
+static void
+test_errors()
+{
+    Strutil::print("Testing sequence errors\n");
+    FrameSequenceReader seq;
+    OIIO_CHECK_FALSE(seq.open(seqdir + "/nosuchdir/seq.#.tif"));
+    OIIO_CHECK_ASSERT(seq.has_error());
+    seq.geterror();
+    OIIO_CHECK_FALSE(seq.open(seqdir + "/notapattern.tif"));
+    OIIO_CHECK_ASSERT(seq.geterror().size());
+
+    // A missing frame fails when its turn comes, and reading goes on after.
+    OIIO_CHECK_ASSERT(seq.open(seqdir + "/seq.5-8#.tif"));
+    ImageBuf frame;
+    OIIO_CHECK_ASSERT(seq.next(frame));
+    OIIO_CHECK_ASSERT(seq.next(frame));
+    OIIO_CHECK_FALSE(seq.has_error());
+    OIIO_CHECK_FALSE(seq.next(frame));
+    OIIO_CHECK_ASSERT(seq.has_error());
+    OIIO_CHECK_FALSE(frame.initialized());
+    Strutil::print("  expected error: {}\n", seq.geterror());
+    OIIO_CHECK_EQUAL(seq.position(), 3);
+    OIIO_CHECK_FALSE(seq.next(frame));
+    OIIO_CHECK_ASSERT(seq.has_error());
+    seq.geterror();
+    OIIO_CHECK_FALSE(seq.next(frame));  // End of the sequence
+    OIIO_CHECK_FALSE(seq.has_error());
+}
+
+
+
+int
+main(int /*argc*/, char* /*argv*/[])
+{
+    create_sequence();
+
+    test_read_in_order();
+    test_settings();
+    test_errors();
+
+    Filesystem::remove_all(seqdir);
+    return unit_test_failures;
+}
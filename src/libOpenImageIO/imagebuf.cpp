@@ -3,12 +3,18 @@
 // https://github.com/AcademySoftwareFoundation/OpenImageIO
 
 
+#include <algorithm>
+#include <chrono>
+#include <deque>
 #include <iostream>
 #include <memory>
 #include <regex>
+#include <thread>
+#include <vector>
 
 #include <OpenImageIO/half.h>
 
+#include <OpenImageIO/color.h>
 #include <OpenImageIO/dassert.h>
 #include <OpenImageIO/deepdata.h>
 #include <OpenImageIO/fmath.h>
@@ -32,10 +38,126 @@ OIIO_STRONG_PARAM_TYPE(DoLock, bool);
 namespace pvt {
 int imagebuf_print_uncaught_errors(1);
 int imagebuf_use_imagecache(0);
+atomic_int imagebuf_async_writes(4);
 atomic_ll IB_local_mem_current;
 atomic_ll IB_local_mem_peak;
 std::atomic<float> IB_total_open_time(0.0f);
 std::atomic<float> IB_total_image_read_time(0.0f);
+
+
+
+namespace {
+
+// The threads that do background writes. Threads are started as jobs need
+// them, never more than the number of jobs allowed to be pending at once,
+// and then stay around waiting for more jobs until shutdown().
+class AsyncWriteQueue {
+public:
+    // The queue is never destroyed: joining its threads from a static
+    // destructor, while the program exits or the library is unloaded, can
+    // deadlock. Pending writes are finished by OIIO::shutdown() instead.
+    static AsyncWriteQueue& instance()
+    {
+        static AsyncWriteQueue* queue = new AsyncWriteQueue;
+        return *queue;
+    }
+
+    // Finish all jobs still queued, and stop the threads. The queue may be
+    // used again afterwards, starting new threads as needed.
+    void shutdown()
+    {
+        std::vector<std::thread> threads;
+        {
+            std::lock_guard lock(m_mutex);
+            m_closing = true;
+            threads.swap(m_threads);
+        }
+        m_wake.notify_all();
+        for (auto& t : threads)
+            t.join();  // They finish any jobs still queued first
+        std::lock_guard lock(m_mutex);
+        m_closing = false;
+    }
+
+    std::shared_future<std::string> submit(std::function<std::string()> job)
+    {
+        Job j { std::move(job), {} };
+        auto done = j.done.get_future().share();
+        std::unique_lock lock(m_mutex);
+        m_room.wait(lock, [&]() { return m_pending < imagebuf_async_writes; });
+        ++m_pending;
+        m_jobs.push_back(std::move(j));
+        if (m_idle < int(m_jobs.size()) && m_nthreads < imagebuf_async_writes) {
+            ++m_nthreads;
+            m_threads.emplace_back([this]() { work(); });
+        }
+        lock.unlock();
+        m_wake.notify_one();
+        return done;
+    }
+
+private:
+    struct Job {
+        std::function<std::string()> run;
+        std::promise<std::string> done;
+    };
+
+    void work()
+    {
+        std::unique_lock lock(m_mutex);
+        for (;;) {
+            ++m_idle;
+            m_wake.wait(lock, [&]() { return m_jobs.size() || m_closing; });
+            --m_idle;
+            if (m_jobs.empty()) {
+                --m_nthreads;
+                return;
+            }
+            Job job = std::move(m_jobs.front());
+            m_jobs.pop_front();
+            lock.unlock();
+            std::string err;
+            try {
+                err = job.run();
+            } catch (const std::exception& e) {
+                err = e.what();
+            }
+            job.done.set_value(std::move(err));
+            lock.lock();
+            --m_pending;
+            m_room.notify_one();
+        }
+    }
+
+    std::mutex m_mutex;
+    std::condition_variable m_wake;  // A job was queued, or we're closing
+    std::condition_variable m_room;  // A pending job finished
+    std::deque<Job> m_jobs;
+    std::vector<std::thread> m_threads;
+    int m_pending  = 0;  // Jobs queued or running
+    int m_idle     = 0;  // Threads waiting for a job
+    int m_nthreads = 0;
+    bool m_closing = false;
+};
+
+}  // namespace
+
+
+
+std::shared_future<std::string>
+async_write(std::function<std::string()> job)
+{
+    return AsyncWriteQueue::instance().submit(std::move(job));
+}
+
+
+
+void
+async_write_shutdown()
+{
+    AsyncWriteQueue::instance().shutdown();
+}
+
 }  // namespace pvt
 
 OIIO_NAMESPACE_END
@@ -163,7 +285,16 @@ public:
               bool force = false, TypeDesc convert = TypeDesc::UNKNOWN,
               ProgressCallback progress_callback = nullptr,
               void* progress_callback_data       = nullptr,
-              DoLock do_lock                     = DoLock(true));
+              DoLock do_lock                     = DoLock(true),
+              const ColorProcessor* processor    = nullptr,
+              bool unpremult                     = true);
+    // Helper for read() with a color processor: read the pixels strip by
+    // strip, transforming each in place right after it's decoded.
+    bool read_colorconverted(ImageInput* in, int subimage, int miplevel,
+                             int chbegin, int chend,
+                             const ColorProcessor* processor, bool unpremult,
+                             ProgressCallback progress_callback,
+                             void* progress_callback_data);
     void copy_metadata(const ImageBufImpl& src);
     void merge_metadata(const ImageBufImpl& src, bool override = false,
                         string_view pattern = {});
@@ -342,7 +473,9 @@ private:
     mutable int m_threads  = 0;     // thread policy for this image
     ImageSpec m_spec;               // Describes the image (size, etc)
     ImageSpec m_nativespec;         // Describes the true native image
-    std::unique_ptr<char[]> m_pixels;  // Pixel data, if local and we own it
+    // Pixel data, if local and we own it. Shared so that views of the
+    // pixels handed out by localpixels_owner() outlive a reallocation.
+    std::shared_ptr<char[]> m_pixels;
     image_span<std::byte> m_bufspan;   // Bounded buffer for local pixels
     typedef std::recursive_mutex mutex_t;
     typedef std::unique_lock<mutex_t> lock_t;
@@ -1299,7 +1432,8 @@ bool
 ImageBufImpl::read(int subimage, int miplevel, int chbegin, int chend,
                    bool force, TypeDesc convert,
                    ProgressCallback progress_callback,
-                   void* progress_callback_data, DoLock do_lock)
+                   void* progress_callback_data, DoLock do_lock,
+                   const ColorProcessor* processor, bool unpremult)
 {
     lock_t lock(m_mutex, std::defer_lock_t());
     if (do_lock)
@@ -1319,8 +1453,10 @@ ImageBufImpl::read(int subimage, int miplevel, int chbegin, int chend,
     // If it's a local buffer from a file and we've already read the pixels
     // into memory, we're done, provided that we aren't asking it to force
     // a read with a different data type conversion or different number of
-    // channels.
-    if (m_storage == ImageBuf::LOCALBUFFER && m_pixels_valid && m_pixels_read
+    // channels. A color converting read always rereads, since the pixels
+    // we have were not transformed.
+    if (!processor && m_storage == ImageBuf::LOCALBUFFER && m_pixels_valid
+        && m_pixels_read
         && (convert == TypeUnknown || convert == m_spec.format)
         && subimage == m_current_subimage && miplevel == m_current_miplevel
         && ((chend - chbegin) == m_spec.nchannels || (chend <= chbegin)))
@@ -1340,6 +1476,10 @@ ImageBufImpl::read(int subimage, int miplevel, int chbegin, int chend,
         chend = nativespec().nchannels;
     bool use_channel_subset = (chbegin != 0 || chend != nativespec().nchannels);
 
+    if (m_spec.deep && processor) {
+        error("Color converting read is not supported for deep images");
+        return false;
+    }
     if (m_spec.deep) {
         Timer timer;
         auto input = ImageInput::open(m_name.string(), m_configspec.get(),
@@ -1454,17 +1594,24 @@ ImageBufImpl::read(int subimage, int miplevel, int chbegin, int chend,
                                    m_rioproxy);
         if (in) {
             in->threads(threads());  // Pass on our thread policy
-            bool ok = in->read_image(subimage, miplevel, chbegin, chend,
-                                     m_spec.format, localpixels(), AutoStride,
-                                     AutoStride, AutoStride, progress_callback,
-                                     progress_callback_data);
+            bool ok = processor
+                          ? read_colorconverted(in.get(), subimage, miplevel,
+                                                chbegin, chend, processor,
+                                                unpremult, progress_callback,
+                                                progress_callback_data)
+                          : in->read_image(subimage, miplevel, chbegin, chend,
+                                           m_spec.format, localpixels(),
+                                           AutoStride, AutoStride, AutoStride,
+                                           progress_callback,
+                                           progress_callback_data);
             in->close();
             if (ok) {
                 m_pixels_valid = true;
                 m_pixels_read  = true;
             } else {
                 m_pixels_valid = false;
-                error(in->geterror());
+                if (in->has_error())
+                    error(in->geterror());
             }
         } else {
             m_pixels_valid = false;
@@ -1513,6 +1660,122 @@ ImageBufImpl::read(int subimage, int miplevel, int chbegin, int chend,
 
 
 
+bool
+ImageBufImpl::read_colorconverted(ImageInput* in, int subimage, int miplevel,
+                                  int chbegin, int chend,
+                                  const ColorProcessor* processor,
+                                  bool unpremult,
+                                  ProgressCallback progress_callback,
+                                  void* progress_callback_data)
+{
+    const ImageSpec& native(m_nativespec);
+    const ImageSpec& spec(m_spec);
+    TypeDesc format  = spec.format;
+    int nchans       = chend - chbegin;
+    stride_t xstride = stride_t(format.size()) * nchans;
+    stride_t ystride = xstride * spec.width;
+    stride_t zstride = ystride * spec.height;
+
+    // Decode straight into our buffer and transform it there if that loses
+    // nothing. Otherwise, decode each strip as float into a scratch buffer
+    // and only convert to the buffer's type after the transformation, so
+    // the values are quantized once rather than twice.
+    bool direct        = (format == TypeFloat
+                   || (format == native.format
+                       && native.channelformats.empty()));
+    TypeDesc striptype = direct ? format : TypeFloat;
+    ImageSpec stripspec(spec.width, 1, nchans, striptype);
+    stripspec.x = spec.x;
+    if (native.alpha_channel >= chbegin && native.alpha_channel < chend)
+        stripspec.alpha_channel = native.alpha_channel - chbegin;
+    if (spec.get_int_attribute("oiio:UnassociatedAlpha"))
+        stripspec.attribute("oiio:UnassociatedAlpha", 1);
+
+    // Tiled files are read a row of tiles at a time. Scanline files are
+    // read in strips of about 2 MB of float pixels -- small enough that the
+    // strip is still in cache when we transform it -- rounded up to a
+    // multiple of the rows per strip so we don't decode any strip twice.
+    int strip_height = 1, strip_depth = 1;
+    if (native.tile_width) {
+        strip_height = native.tile_height;
+        strip_depth  = std::max(1, native.tile_depth);
+    } else {
+        int rps = std::max(1, native.get_int_attribute("tiff:RowsPerStrip",
+                                                       64));
+        imagesize_t rowbytes = imagesize_t(spec.width) * nchans * sizeof(float);
+        strip_height = int(std::max(imagesize_t(1),
+                                    (1 << 21) / std::max(rowbytes,
+                                                         imagesize_t(1))));
+        strip_height = round_to_multiple(strip_height, rps);
+    }
+
+    std::vector<float> scratch;
+    bool ok = true;
+    if (progress_callback && progress_callback(progress_callback_data, 0.0f))
+        return ok;
+    for (int z = 0; z < spec.depth && ok; z += strip_depth) {
+        for (int y = 0; y < spec.height && ok; y += strip_height) {
+            int ybegin = spec.y + y;
+            int yend   = std::min(ybegin + strip_height, spec.y + spec.height);
+            int zbegin = spec.z + z;
+            int zend   = std::min(zbegin + strip_depth, spec.z + spec.depth);
+            char* dst  = (char*)localpixels() + z * zstride + y * ystride;
+            void* strip = dst;
+            if (!direct) {
+                scratch.resize(size_t(nchans) * size_t(spec.width)
+                               * size_t(yend - ybegin) * size_t(zend - zbegin));
+                strip = scratch.data();
+            }
+            stride_t sxstride = stride_t(striptype.size()) * nchans;
+            stride_t systride = sxstride * spec.width;
+            stride_t szstride = systride * (yend - ybegin);
+            if (native.tile_width)
+                ok = in->read_tiles(subimage, miplevel, spec.x,
+                                    spec.x + spec.width, ybegin, yend, zbegin,
+                                    zend, chbegin, chend, striptype, strip,
+                                    sxstride, systride, szstride);
+            else
+                ok = in->read_scanlines(subimage, miplevel, ybegin, yend,
+                                        zbegin, chbegin, chend, striptype,
+                                        strip, sxstride, systride);
+            if (!ok)
+                break;
+
+            stripspec.y      = ybegin;
+            stripspec.height = yend - ybegin;
+            stripspec.z      = zbegin;
+            stripspec.depth  = zend - zbegin;
+            ImageBuf stripbuf(stripspec,
+                              image_span<std::byte>((std::byte*)strip, nchans,
+                                                    spec.width, yend - ybegin,
+                                                    zend - zbegin,
+                                                    striptype.size()));
+            ok = ImageBufAlgo::colorconvert(stripbuf, stripbuf, processor,
+                                            unpremult, {}, threads());
+            if (ok && !direct)
+                ok = parallel_convert_image(nchans, spec.width, yend - ybegin,
+                                            zend - zbegin, strip, striptype,
+                                            sxstride, systride, szstride, dst,
+                                            format, xstride, ystride, zstride,
+                                            threads());
+            if (!ok) {
+                error("{}", stripbuf.has_error() ? stripbuf.geterror()
+                                                 : "pixel conversion failed");
+                break;
+            }
+            if (progress_callback
+                && progress_callback(progress_callback_data,
+                                     float(y) / spec.height))
+                return ok;
+        }
+    }
+    if (ok && progress_callback)
+        progress_callback(progress_callback_data, 1.0f);
+    return ok;
+}
+
+
+
 bool
 ImageBuf::read(int subimage, int miplevel, bool force, TypeDesc convert,
                ProgressCallback progress_callback, void* progress_callback_data)
@@ -1536,6 +1799,23 @@ ImageBuf::read(int subimage, int miplevel, int chbegin, int chend, bool force,
 
 
 
+bool
+ImageBuf::read_colorconvert(int subimage, int miplevel, int chbegin,
+                            int chend, TypeDesc convert,
+                            const ColorProcessor* processor, bool unpremult,
+                            ProgressCallback progress_callback,
+                            void* progress_callback_data)
+{
+    if (processor && processor->isNoOp())
+        processor = nullptr;
+    return m_impl->read(subimage, miplevel, chbegin, chend, true /*force*/,
+                        convert, progress_callback, progress_callback_data,
+                        DoLock(true) /* acquire the lock */, processor,
+                        unpremult);
+}
+
+
+
 void
 ImageBuf::set_write_format(cspan<TypeDesc> format)
 {
@@ -1815,6 +2095,67 @@ ImageBuf::write(string_view _filename, TypeDesc dtype, string_view _fileformat,
 
 
 
+// Writes started by ImageBuf::write_async() whose outcome nobody has yet
+// asked about (or rather, those of them that might have failed).
+static std::mutex async_writes_mutex;
+static std::vector<std::shared_future<std::string>> async_writes;
+
+
+
+bool
+ImageBuf::write_async(string_view filename, TypeDesc dtype,
+                      string_view fileformat) const
+{
+    if (!initialized()) {
+        errorfmt("ImageBuf::write_async() called on an uninitialized "
+                 "ImageBuf");
+        return false;
+    }
+    auto img = std::make_shared<ImageBuf>(*this);
+    auto job = [img, filename = std::string(filename), dtype,
+                fileformat = std::string(fileformat)]() {
+        return img->write(filename, dtype, fileformat) ? std::string()
+                                                       : img->geterror();
+    };
+    auto done = OIIO::pvt::async_write(std::move(job));
+
+    std::lock_guard lock(async_writes_mutex);
+    // Don't let the list grow forever if nobody ever waits: forget the
+    // writes that are already known to have succeeded.
+    async_writes.erase(
+        std::remove_if(async_writes.begin(), async_writes.end(),
+                       [](const std::shared_future<std::string>& w) {
+                           return w.wait_for(std::chrono::seconds(0))
+                                      == std::future_status::ready
+                                  && w.get().empty();
+                       }),
+        async_writes.end());
+    async_writes.push_back(std::move(done));
+    return true;
+}
+
+
+
+bool
+ImageBuf::wait_for_async_writes()
+{
+    std::vector<std::shared_future<std::string>> writes;
+    {
+        std::lock_guard lock(async_writes_mutex);
+        writes.swap(async_writes);
+    }
+    bool ok = true;
+    for (auto& w : writes) {
+        if (w.get().size()) {
+            OIIO::errorfmt("{}", w.get());
+            ok = false;
+        }
+    }
+    return ok;
+}
+
+
+
 bool
 ImageBuf::make_writable(bool keep_cache_type)
 {
@@ -2140,6 +2481,16 @@ ImageBuf::localpixels()
 
 
 
+std::shared_ptr<void>
+ImageBuf::localpixels_owner() const
+{
+    m_impl->validate_pixels();
+    const auto& pixels(m_impl->m_pixels);
+    return std::shared_ptr<void>(pixels, pixels.get());
+}
+
+
+
 image_span<const std::byte>
 ImageBuf::localpixels_as_byte_image_span() const
 {
@@ -2830,6 +3181,88 @@ ImageBuf::set_pixels(ROI roi, TypeDesc format, cspan<std::byte> buffer,
 
 
 
+const void*
+ImageBuf::read_row(ROI roi, int y, int z, TypeDesc format,
+                   span<std::byte> scratch) const
+{
+    if (!roi.defined())
+        roi = this->roi();
+    roi.chend  = std::min(roi.chend, nchannels());
+    int nchans = roi.nchannels();
+    ROI row(roi.xbegin, roi.xend, y, y + 1, z, z + 1, roi.chbegin, roi.chend);
+    size_t bytes = size_t(roi.width()) * size_t(nchans) * format.size();
+    if (localpixels() && this->roi().contains(row)) {
+        const void* p = pixeladdr(roi.xbegin, y, z, roi.chbegin);
+        if (spec().format == format
+            && pixel_stride() == stride_t(nchans * format.size()))
+            return p;  // Already laid out as requested, use it in place
+        if (scratch.size() < bytes)
+            return nullptr;
+        if (convert_image(nchans, roi.width(), 1, 1, p, spec().format,
+                          pixel_stride(), AutoStride, AutoStride,
+                          scratch.data(), format, AutoStride, AutoStride,
+                          AutoStride))
+            return scratch.data();
+    }
+    if (scratch.size() < bytes)
+        return nullptr;
+    bool ok;
+    if (storage() == IMAGECACHE && !deep()) {
+        // Fetch the whole row from the cache in one call, which copies
+        // whole tile spans rather than visiting a pixel at a time.
+        ok = imagecache()->get_pixels(uname(), subimage(), miplevel(),
+                                      roi.xbegin, roi.xend, y, y + 1, z, z + 1,
+                                      roi.chbegin, roi.chend, format,
+                                      scratch.data());
+        if (!ok)
+            errorfmt("{}", imagecache()->geterror());
+    } else {
+        ok = get_pixels(row, format, scratch.data());
+    }
+    if (!ok)
+        memset(scratch.data(), 0, bytes);
+    return scratch.data();
+}
+
+
+
+void*
+ImageBuf::row_addr(ROI roi, int y, int z, TypeDesc format)
+{
+    if (!roi.defined())
+        roi = this->roi();
+    roi.chend = std::min(roi.chend, nchannels());
+    ROI row(roi.xbegin, roi.xend, y, y + 1, z, z + 1, roi.chbegin, roi.chend);
+    if (!localpixels() || !localpixels_as_writable_byte_image_span().data()
+        || spec().format != format
+        || pixel_stride() != stride_t(roi.nchannels() * format.size())
+        || !this->roi().contains(row))
+        return nullptr;
+    return pixeladdr(roi.xbegin, y, z, roi.chbegin);
+}
+
+
+
+bool
+ImageBuf::write_row(ROI roi, int y, int z, TypeDesc format, const void* data)
+{
+    if (!roi.defined())
+        roi = this->roi();
+    roi.chend = std::min(roi.chend, nchannels());
+    ROI row(roi.xbegin, roi.xend, y, y + 1, z, z + 1, roi.chbegin, roi.chend);
+    if (localpixels() && localpixels_as_writable_byte_image_span().data()
+        && this->roi().contains(row)) {
+        return convert_image(row.nchannels(), row.width(), 1, 1, data, format,
+                             AutoStride, AutoStride, AutoStride,
+                             pixeladdr(roi.xbegin, y, z, roi.chbegin),
+                             spec().format, pixel_stride(), AutoStride,
+                             AutoStride);
+    }
+    return set_pixels(row, format, data);
+}
+
+
+
 int
 ImageBuf::deep_samples(int x, int y, int z) const
 {
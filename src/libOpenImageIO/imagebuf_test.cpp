@@ -4,6 +4,7 @@
 
 
 #include <OpenImageIO/benchmark.h>
+#include <OpenImageIO/color.h>
 #include <OpenImageIO/filesystem.h>
 #include <OpenImageIO/imagebuf.h>
 #include <OpenImageIO/imagebufalgo.h>
@@ -429,6 +430,69 @@ time_get_pixels()
 
 
 
+void
+test_row_spans()
+{
+    std::cout << "\nTesting RowSpans, ConstRowSpans\n";
+    // 4x3 float RGBA image where pixel (x,y) channel c holds x+10*y+100*c
+    ImageBuf A(ImageSpec(4, 3, 4, TypeFloat));
+    for (ImageBuf::Iterator<float> p(A); !p.done(); ++p)
+        for (int c = 0; c < 4; ++c)
+            p[c] = float(p.x() + 10 * p.y() + 100 * c);
+
+    // Full-channel float rows should point right into the buffer
+    {
+        ImageBuf::ConstRowSpans<float> rows(A, A.roi());
+        auto row = rows(1);
+        OIIO_CHECK_EQUAL(row.width(), 4);
+        OIIO_CHECK_EQUAL(row.nchannels(), 4);
+        OIIO_CHECK_ASSERT(row.data() == A.pixeladdr(0, 1));
+        OIIO_CHECK_EQUAL(row.data()[2 * 4 + 3], 2.0f + 10.0f + 300.0f);
+    }
+    // A channel subset that extends past the data window gets packed
+    // into scratch, with black outside the image.
+    {
+        ImageBuf::ConstRowSpans<float> rows(A, ROI(2, 6, 0, 3, 0, 1, 1, 3));
+        auto row = rows(2);
+        OIIO_CHECK_ASSERT(row.data() != A.pixeladdr(2, 2, 0, 1));
+        OIIO_CHECK_EQUAL(row.data()[0], 2.0f + 20.0f + 100.0f);
+        OIIO_CHECK_EQUAL(row.data()[1], 2.0f + 20.0f + 200.0f);
+        OIIO_CHECK_EQUAL(row.data()[2], 3.0f + 20.0f + 100.0f);
+        OIIO_CHECK_EQUAL(row.data()[4], 0.0f);
+        OIIO_CHECK_EQUAL(row.data()[7], 0.0f);
+    }
+    // Writable rows of a uint8 image are staged as float and converted
+    // when the next row is requested or the RowSpans goes away.
+    ImageBuf B(ImageSpec(4, 3, 2, TypeUInt8));
+    {
+        ImageBuf::RowSpans<float> rows(B, B.roi());
+        for (int y = 0; y < 3; ++y) {
+            auto row = rows(y);
+            OIIO_CHECK_ASSERT(row.data() != B.pixeladdr(0, y));
+            for (int i = 0; i < 8; ++i)
+                row.data()[i] = (y == 1) ? 1.0f : 0.5f;
+        }
+    }
+    OIIO_CHECK_EQUAL(B.getchannel(3, 1, 0, 1), 1.0f);
+    OIIO_CHECK_EQUAL(B.getchannel(0, 2, 0, 0), 128.0f / 255.0f);
+
+    // ImageCache-backed images are fetched a row at a time from the cache
+    const char* filename = "rowspans.tif";
+    A.write(filename);
+    {
+        ImageBuf C(filename, 0, 0, ImageCache::create());
+        OIIO_CHECK_EQUAL(C.storage(), ImageBuf::IMAGECACHE);
+        ImageBuf::ConstRowSpans<float> rows(C, C.roi());
+        auto row = rows(2);
+        OIIO_CHECK_EQUAL(row.data()[3 * 4 + 1], 3.0f + 20.0f + 100.0f);
+        OIIO_CHECK_EQUAL(C.storage(), ImageBuf::IMAGECACHE);
+    }
+    ImageCache::create()->invalidate(ustring(filename));
+    Filesystem::remove(filename);
+}
+
+
+
 void
 test_read_channel_subset()
 {
@@ -463,6 +527,51 @@ test_read_channel_subset()
 
 
 
+void
+test_read_colorconvert()
+{
+    std::cout << "\nTesting read_colorconvert\n";
+    ColorConfig config;
+    auto processor = config.createColorProcessor("sRGB", "linear");
+    OIIO_CHECK_ASSERT(processor);
+    if (!processor)
+        return;
+
+    // A read that color converts as it goes should match a read followed
+    // by colorconvert, for scanline and tiled files, and whether or not
+    // the buffer type matches the file.
+    ImageSpec spec(97, 203, 4, TypeUInt16);
+    spec.alpha_channel = 3;
+    ImageBuf src(spec);
+    ImageBufAlgo::fill(src, { 0.1f, 0.2f, 0.9f, 0.25f },
+                       { 0.9f, 0.6f, 0.0f, 1.0f }, { 0.0f, 0.3f, 0.5f, 0.75f },
+                       { 1.0f, 1.0f, 1.0f, 0.0f });
+    for (int tiled = 0; tiled < 2; ++tiled) {
+        std::string filename = tiled ? "readcc_tiled.tif"
+                                     : "readcc_scanline.tif";
+        if (tiled)
+            src.set_write_tiles(32, 32);
+        src.write(filename);
+        ImageBuf ref(filename);
+        ref.read(0, 0, true, TypeFloat);
+        ImageBufAlgo::colorconvert(ref, ref, processor.get(), true);
+        for (TypeDesc convert : { TypeFloat, TypeUInt16, TypeUInt8 }) {
+            ImageBuf B(filename);
+            OIIO_CHECK_ASSERT(B.read_colorconvert(0, 0, 0, -1, convert,
+                                                  processor.get(), true));
+            OIIO_CHECK_EQUAL(B.spec().format, convert);
+            float tolerance = convert == TypeUInt8    ? 1.0f / 255.0f
+                              : convert == TypeUInt16 ? 1.0f / 65535.0f
+                                                      : 1.0e-6f;
+            auto comp = ImageBufAlgo::compare(B, ref, tolerance, tolerance);
+            OIIO_CHECK_EQUAL(comp.nfail, 0);
+        }
+        Filesystem::remove(filename);
+    }
+}
+
+
+
 void
 test_roi()
 {
@@ -539,6 +648,69 @@ test_write_over()
 
 
 
+// Test that write_async writes the image as it was when the write was
+// queued, and that failures are reported when waiting for the writes.
+static void
+test_write_async()
+{
+    ImageBuf img(ImageSpec(64, 64, 3, TypeUInt8));
+    const int nframes = 6;  // More than the default queue limit
+    for (int i = 0; i < nframes; ++i) {
+        ImageBufAlgo::fill(img, { i / 255.0f, 0.5f, 1.0f });
+        OIIO_CHECK_ASSERT(
+            img.write_async(Strutil::fmt::format("tmp-async-{}.tif", i)));
+    }
+    ImageBufAlgo::zero(img);  // Must not affect the writes already queued
+    OIIO_CHECK_ASSERT(ImageBuf::wait_for_async_writes());
+    for (int i = 0; i < nframes; ++i) {
+        std::string filename = Strutil::fmt::format("tmp-async-{}.tif", i);
+        ImageBuf B(filename);
+        float pixel[3];
+        B.getpixel(7, 9, make_span(pixel));
+        OIIO_CHECK_EQUAL(pixel[0], i / 255.0f);
+        OIIO_CHECK_EQUAL(pixel[2], 1.0f);
+        B.reset();
+        Filesystem::remove(filename);
+    }
+
+    // An error shows up when we wait, not when the write is queued
+    OIIO_CHECK_ASSERT(img.write_async("no-such-dir/tmp-async.tif"));
+    OIIO_CHECK_ASSERT(!ImageBuf::wait_for_async_writes());
+    OIIO_CHECK_ASSERT(OIIO::geterror().size());
+    // ... and only once
+    OIIO_CHECK_ASSERT(ImageBuf::wait_for_async_writes());
+}
+
+
+
+// Test that localpixels_owner() keeps the pixel memory valid through a
+// reallocation or destruction of the ImageBuf, and is empty for pixels the
+// ImageBuf doesn't own.
+static void
+test_localpixels_owner()
+{
+    std::shared_ptr<void> owner;
+    {
+        ImageBuf img(ImageSpec(16, 16, 3, TypeUInt8));
+        ImageBufAlgo::fill(img, { 1.0f, 0.0f, 1.0f });
+        owner = img.localpixels_owner();
+        OIIO_CHECK_EQUAL(owner.get(), img.localpixels());
+        img.reset(ImageSpec(64, 64, 4, TypeFloat));
+        OIIO_CHECK_NE(owner.get(), img.localpixels());
+        ImageBufAlgo::zero(img);
+    }
+    const unsigned char* pixels = (const unsigned char*)owner.get();
+    OIIO_CHECK_EQUAL(int(pixels[3 * 17 + 0]), 255);
+    OIIO_CHECK_EQUAL(int(pixels[3 * 17 + 1]), 0);
+
+    unsigned char appbuf[4 * 4 * 3] = {};
+    ImageBuf wrapped(ImageSpec(4, 4, 3, TypeUInt8), appbuf);
+    OIIO_CHECK_ASSERT(!wrapped.localpixels_owner());
+    OIIO_CHECK_ASSERT(!ImageBuf().localpixels_owner());
+}
+
+
+
 static void
 test_uncaught_error()
 {
@@ -741,11 +913,15 @@ main(int /*argc*/, char* /*argv*/[])
     ImageBuf_test_appbuffer_strided();
     test_open_with_config();
     test_read_channel_subset();
+    test_read_colorconvert();
 
     test_set_get_pixels();
     time_get_pixels();
+    test_row_spans();
 
     test_write_over();
+    test_write_async();
+    test_localpixels_owner();
 
     test_uncaught_error();
 
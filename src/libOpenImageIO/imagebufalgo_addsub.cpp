@@ -18,41 +18,38 @@
 #include <OpenImageIO/imagebufalgo.h>
 #include <OpenImageIO/imagebufalgo_util.h>
 
+#include "imagebufalgo_rowops_prv.h"
 #include "imageio_pvt.h"
 
 
 OIIO_NAMESPACE_3_1_BEGIN
 
 
-template<class Rtype, class Atype, class Btype>
 static bool
 add_impl(ImageBuf& R, const ImageBuf& A, const ImageBuf& B, ROI roi,
          int nthreads)
 {
-    ImageBufAlgo::parallel_image(roi, nthreads, [&](ROI roi) {
-        ImageBuf::Iterator<Rtype> r(R, roi);
-        ImageBuf::ConstIterator<Atype> a(A, roi);
-        ImageBuf::ConstIterator<Btype> b(B, roi);
-        for (; !r.done(); ++r, ++a, ++b)
-            for (int c = roi.chbegin; c < roi.chend; ++c)
-                r[c] = a[c] + b[c];
-    });
+    ImageBufAlgo::rowop_image(R, A, B, roi, nthreads,
+                              [](float* r, const float* a, const float* b,
+                                 size_t n) {
+                                  for (size_t i = 0; i < n; ++i)
+                                      r[i] = a[i] + b[i];
+                              });
     return true;
 }
 
 
 
-template<class Rtype, class Atype>
 static bool
 add_impl(ImageBuf& R, const ImageBuf& A, cspan<float> b, ROI roi, int nthreads)
 {
-    ImageBufAlgo::parallel_image(roi, nthreads, [&](ROI roi) {
-        ImageBuf::Iterator<Rtype> r(R, roi);
-        ImageBuf::ConstIterator<Atype> a(A, roi);
-        for (; !r.done(); ++r, ++a)
-            for (int c = roi.chbegin; c < roi.chend; ++c)
-                r[c] = a[c] + b[c];
-    });
+    std::vector<float> brow = ImageBufAlgo::perchannel_row(b, roi);
+    ImageBufAlgo::rowop_image(R, A, roi, nthreads,
+                              [&](float* r, const float* a, size_t n) {
+                                  const float* bv = brow.data();
+                                  for (size_t i = 0; i < n; ++i)
+                                      r[i] = a[i] + bv[i];
+                              });
     return true;
 }
 
@@ -95,10 +92,7 @@ ImageBufAlgo::add(ImageBuf& dst, Image_or_Const A_, Image_or_Const B_, ROI roi,
             return false;
         ROI origroi = roi;
         roi.chend = std::min(roi.chend, std::min(A.nchannels(), B.nchannels()));
-        bool ok;
-        OIIO_DISPATCH_COMMON_TYPES3(ok, "add", add_impl, dst.spec().format,
-                                    A.spec().format, B.spec().format, dst, A, B,
-                                    roi, nthreads);
+        bool ok = add_impl(dst, A, B, roi, nthreads);
         if (roi.chend < origroi.chend && A.nchannels() != B.nchannels()) {
             // Edge case: A and B differed in nchannels, we allocated dst to be
             // the bigger of them, but adjusted roi to be the lesser. Now handle
@@ -129,10 +123,7 @@ ImageBufAlgo::add(ImageBuf& dst, Image_or_Const A_, Image_or_Const B_, ROI roi,
             dst.deepdata()->set_all_samples(A.deepdata()->all_samples());
             return add_impl_deep(dst, A, b, roi, nthreads);
         }
-        bool ok;
-        OIIO_DISPATCH_COMMON_TYPES2(ok, "add", add_impl, dst.spec().format,
-                                    A.spec().format, dst, A, b, roi, nthreads);
-        return ok;
+        return add_impl(dst, A, b, roi, nthreads);
     }
     // Remaining cases: error
     dst.errorfmt("ImageBufAlgo::add(): at least one argument must be an image");
@@ -153,19 +144,16 @@ ImageBufAlgo::add(Image_or_Const A, Image_or_Const B, ROI roi, int nthreads)
 
 
 
-template<class Rtype, class Atype, class Btype>
 static bool
 sub_impl(ImageBuf& R, const ImageBuf& A, const ImageBuf& B, ROI roi,
          int nthreads)
 {
-    ImageBufAlgo::parallel_image(roi, nthreads, [&](ROI roi) {
-        ImageBuf::Iterator<Rtype> r(R, roi);
-        ImageBuf::ConstIterator<Atype> a(A, roi);
-        ImageBuf::ConstIterator<Btype> b(B, roi);
-        for (; !r.done(); ++r, ++a, ++b)
-            for (int c = roi.chbegin; c < roi.chend; ++c)
-                r[c] = a[c] - b[c];
-    });
+    ImageBufAlgo::rowop_image(R, A, B, roi, nthreads,
+                              [](float* r, const float* a, const float* b,
+                                 size_t n) {
+                                  for (size_t i = 0; i < n; ++i)
+                                      r[i] = a[i] - b[i];
+                              });
     return true;
 }
 
@@ -182,10 +170,7 @@ ImageBufAlgo::sub(ImageBuf& dst, Image_or_Const A_, Image_or_Const B_, ROI roi,
             return false;
         ROI origroi = roi;
         roi.chend = std::min(roi.chend, std::min(A.nchannels(), B.nchannels()));
-        bool ok;
-        OIIO_DISPATCH_COMMON_TYPES3(ok, "sub", sub_impl, dst.spec().format,
-                                    A.spec().format, B.spec().format, dst, A, B,
-                                    roi, nthreads);
+        bool ok = sub_impl(dst, A, B, roi, nthreads);
         if (roi.chend < origroi.chend && A.nchannels() != B.nchannels()) {
             // Edge case: A and B differed in nchannels, we allocated dst to be
             // the bigger of them, but adjusted roi to be the lesser. Now handle
@@ -222,10 +207,7 @@ ImageBufAlgo::sub(ImageBuf& dst, Image_or_Const A_, Image_or_Const B_, ROI roi,
             dst.deepdata()->set_all_samples(A.deepdata()->all_samples());
             return add_impl_deep(dst, A, b, roi, nthreads);
         }
-        bool ok;
-        OIIO_DISPATCH_COMMON_TYPES2(ok, "sub", add_impl, dst.spec().format,
-                                    A.spec().format, dst, A, b, roi, nthreads);
-        return ok;
+        return add_impl(dst, A, b, roi, nthreads);
     }
     // Remaining cases: error
     dst.errorfmt("ImageBufAlgo::sub(): at least one argument must be an image");
@@ -17,13 +17,42 @@
 #include <OpenImageIO/imagebuf.h>
 #include <OpenImageIO/imagebufalgo.h>
 #include <OpenImageIO/imagebufalgo_util.h>
+#include <OpenImageIO/simd.h>
 #include <OpenImageIO/thread.h>
 
+#include "imagebufalgo_stats_prv.h"
 #include "imageio_pvt.h"
 
 OIIO_NAMESPACE_3_1_BEGIN
 
 
+namespace {
+
+// Notes what errors an ImageBuf already has, so that after reading its
+// pixels we can tell whether that failed, without an error left over from
+// something earlier making us fail too.
+class NewErrorCheck {
+public:
+    explicit NewErrorCheck(const ImageBuf& buf)
+        : m_buf(buf)
+        , m_before(buf.has_error() ? buf.geterror(false).size() : 0)
+    {
+    }
+    // No errors since construction?
+    bool ok() const
+    {
+        return !m_buf.has_error() || m_buf.geterror(false).size() == m_before;
+    }
+
+private:
+    const ImageBuf& m_buf;
+    size_t m_before;
+};
+
+}  // namespace
+
+
+
 void
 ImageBufAlgo::PixelStats::reset(int nchannels)
 {
@@ -118,6 +147,275 @@ finalize(ImageBufAlgo::PixelStats& p)
 
 
 
+void
+ImageBufAlgo::PixelStatsAccumulator::reset(int nchannels, bool track_constancy)
+{
+    m_nchannels  = nchannels;
+    m_track      = track_constancy;
+    m_constant   = true;
+    m_monochrome = true;
+    m_npixels    = 0;
+    m_chan.assign(nchannels, Channel());
+    m_first.clear();
+}
+
+
+
+void
+ImageBufAlgo::PixelStatsAccumulator::combine(Channel& c, imagesize_t n,
+                                             double sum, double mean,
+                                             double m2)
+{
+    if (!n)
+        return;
+    imagesize_t total = c.finite + n;
+    double delta      = mean - c.mean;
+    c.mean += delta * double(n) / double(total);
+    c.m2 += m2 + delta * delta * double(c.finite) * double(n) / double(total);
+    c.sum += sum;
+    c.finite = total;
+}
+
+
+
+void
+ImageBufAlgo::PixelStatsAccumulator::add(const float* values, size_t npixels)
+{
+    using namespace simd;
+    const int nc = m_nchannels;
+    if (!nc || !npixels)
+        return;
+    const float inf = std::numeric_limits<float>::infinity();
+    m_npixels += npixels;
+
+    if (m_track) {
+        if (m_first.empty())
+            m_first.assign(values, values + nc);
+        for (size_t p = 0; m_monochrome && nc > 1 && p < npixels; ++p) {
+            const float* px = values + p * nc;
+            for (int c = 1; c < nc; ++c)
+                if (px[c] != px[0]) {
+                    m_monochrome = false;
+                    break;
+                }
+        }
+    }
+    bool checkconst = m_track && m_constant;
+
+    // Values [0,nsimd) are handled four at a time, in groups of nc vectors
+    // (so that the channel of each lane is the same in every group); the
+    // rest, fewer than 4*nc, one at a time.
+    size_t nvals   = npixels * size_t(nc);
+    size_t ngroups = nvals / (4 * size_t(nc));
+    size_t nsimd   = ngroups * 4 * size_t(nc);
+    OIIO_DASSERT(ngroups < size_t(std::numeric_limits<int>::max()));
+    m_rowsum.assign(nc, 0.0);
+    m_rowm2.assign(nc, 0.0);
+    m_rowfinite.assign(nc, 0);
+    m_rownan.assign(nc, 0);
+    m_rowcount.assign(nc, 0);
+    auto lanechan = [nc](int k, int j) { return (4 * k + j) % nc; };
+
+    // Pass 1: min, max, counts, compensated sum.
+    if (ngroups) {
+        m_vmin.assign(nc, vfloat4(inf));
+        m_vmax.assign(nc, vfloat4(-inf));
+        m_vsum.assign(nc, vfloat4::Zero());
+        m_vcomp.assign(nc, vfloat4::Zero());
+        m_vfinite.assign(nc, vint4::Zero());
+        m_vnan.assign(nc, vint4::Zero());
+        if (checkconst) {
+            m_vfirst.resize(nc);
+            for (int k = 0; k < nc; ++k)
+                m_vfirst[k] = vfloat4(m_first[lanechan(k, 0)],
+                                      m_first[lanechan(k, 1)],
+                                      m_first[lanechan(k, 2)],
+                                      m_first[lanechan(k, 3)]);
+        }
+        const vfloat4 vinf(inf);
+        vbool4 same    = vbool4::True();
+        const float* v = values;
+        for (size_t g = 0; g < ngroups; ++g) {
+            for (int k = 0; k < nc; ++k, v += 4) {
+                vfloat4 x     = vfloat4(v);
+                vbool4 finite = abs(x) < vinf;
+                m_vmin[k]     = min(m_vmin[k], select(finite, x, vinf));
+                m_vmax[k]     = max(m_vmax[k], select(finite, x, -vinf));
+                vfloat4 y     = select(finite, x, vfloat4::Zero()) - m_vcomp[k];
+                vfloat4 t     = m_vsum[k] + y;
+                m_vcomp[k]    = (t - m_vsum[k]) - y;
+                m_vsum[k]     = t;
+                m_vfinite[k] -= bitcast_to_int(finite);
+                m_vnan[k] -= bitcast_to_int(x != x);
+                if (checkconst)
+                    same &= (x == m_vfirst[k]);
+            }
+        }
+        if (checkconst && !all(same))
+            m_constant = checkconst = false;
+        for (int k = 0; k < nc; ++k) {
+            for (int j = 0; j < 4; ++j) {
+                int c = lanechan(k, j);
+                Channel& ch(m_chan[c]);
+                ch.min = std::min(ch.min, m_vmin[k][j]);
+                ch.max = std::max(ch.max, m_vmax[k][j]);
+                m_rowsum[c] += double(m_vsum[k][j]) - double(m_vcomp[k][j]);
+                m_rowfinite[c] += m_vfinite[k][j];
+                m_rownan[c] += m_vnan[k][j];
+                m_rowcount[c] += ngroups;
+            }
+        }
+    }
+    for (size_t i = nsimd; i < nvals; ++i) {
+        int c   = int((i - nsimd) % nc);
+        float x = values[i];
+        if (checkconst && x != m_first[c])
+            m_constant = checkconst = false;
+        ++m_rowcount[c];
+        if (std::isnan(x)) {
+            ++m_rownan[c];
+        } else if (!std::isinf(x)) {
+            ++m_rowfinite[c];
+            m_rowsum[c] += x;
+            m_chan[c].min = std::min(m_chan[c].min, x);
+            m_chan[c].max = std::max(m_chan[c].max, x);
+        }
+    }
+
+    // Pass 2: sum of squared deviations from this call's mean, over the
+    // values that are still in cache.
+    std::vector<double>& mean(m_rowsum);  // converted in place below
+    for (int c = 0; c < nc; ++c)
+        mean[c] = m_rowfinite[c] ? mean[c] / double(m_rowfinite[c]) : 0.0;
+    if (ngroups) {
+        for (int k = 0; k < nc; ++k) {
+            m_vmin[k] = vfloat4(float(mean[lanechan(k, 0)]),
+                                float(mean[lanechan(k, 1)]),
+                                float(mean[lanechan(k, 2)]),
+                                float(mean[lanechan(k, 3)]));
+            m_vsum[k]  = vfloat4::Zero();
+            m_vcomp[k] = vfloat4::Zero();
+        }
+        const float* v = values;
+        const vfloat4 vinf(inf);
+        for (size_t g = 0; g < ngroups; ++g) {
+            for (int k = 0; k < nc; ++k, v += 4) {
+                vfloat4 x     = vfloat4(v);
+                vbool4 finite = abs(x) < vinf;
+                vfloat4 d     = select(finite, x - m_vmin[k], vfloat4::Zero());
+                vfloat4 y     = d * d - m_vcomp[k];
+                vfloat4 t     = m_vsum[k] + y;
+                m_vcomp[k]    = (t - m_vsum[k]) - y;
+                m_vsum[k]     = t;
+            }
+        }
+        for (int k = 0; k < nc; ++k)
+            for (int j = 0; j < 4; ++j)
+                m_rowm2[lanechan(k, j)] += double(m_vsum[k][j])
+                                           - double(m_vcomp[k][j]);
+    }
+    for (size_t i = nsimd; i < nvals; ++i) {
+        int c   = int((i - nsimd) % nc);
+        float x = values[i];
+        if (std::isfinite(x)) {
+            double d = double(x) - mean[c];
+            m_rowm2[c] += d * d;
+        }
+    }
+
+    for (int c = 0; c < nc; ++c) {
+        Channel& ch(m_chan[c]);
+        ch.nan += m_rownan[c];
+        ch.inf += m_rowcount[c] - m_rowfinite[c] - m_rownan[c];
+        combine(ch, m_rowfinite[c], mean[c] * double(m_rowfinite[c]), mean[c],
+                m_rowm2[c]);
+    }
+}
+
+
+
+void
+ImageBufAlgo::PixelStatsAccumulator::merge(const PixelStatsAccumulator& other)
+{
+    OIIO_DASSERT(m_nchannels == other.m_nchannels);
+    for (int c = 0; c < m_nchannels; ++c) {
+        Channel& ch(m_chan[c]);
+        const Channel& o(other.m_chan[c]);
+        ch.min = std::min(ch.min, o.min);
+        ch.max = std::max(ch.max, o.max);
+        ch.nan += o.nan;
+        ch.inf += o.inf;
+        combine(ch, o.finite, o.sum, o.mean, o.m2);
+    }
+    m_npixels += other.m_npixels;
+    if (m_track && !other.m_first.empty()) {
+        if (m_first.empty())
+            m_first = other.m_first;
+        else if (m_first != other.m_first)
+            m_constant = false;
+        m_constant &= other.m_constant;
+        m_monochrome &= other.m_monochrome;
+    }
+}
+
+
+
+void
+ImageBufAlgo::PixelStatsAccumulator::finalize(PixelStats& stats,
+                                              int firstchan) const
+{
+    for (int c = 0; c < m_nchannels; ++c) {
+        const Channel& ch(m_chan[c]);
+        int s                = firstchan + c;
+        stats.nancount[s]    = ch.nan;
+        stats.infcount[s]    = ch.inf;
+        stats.finitecount[s] = ch.finite;
+        stats.sum[s]         = ch.sum;
+        stats.sum2[s]        = ch.m2 + ch.mean * ch.mean * double(ch.finite);
+        if (ch.finite == 0) {
+            stats.min[s]    = 0.0f;
+            stats.max[s]    = 0.0f;
+            stats.avg[s]    = 0.0f;
+            stats.stddev[s] = 0.0f;
+        } else {
+            stats.min[s]    = ch.min;
+            stats.max[s]    = ch.max;
+            stats.avg[s]    = float(ch.mean);
+            stats.stddev[s] = float(safe_sqrt(ch.m2 / double(ch.finite)));
+        }
+    }
+}
+
+
+
+bool
+ImageBufAlgo::accumulate_pixel_stats(PixelStatsAccumulator& acc,
+                                     const ImageBuf& src, ROI roi,
+                                     int nthreads)
+{
+    OIIO_DASSERT(acc.nchannels() == roi.nchannels());
+    NewErrorCheck errors(src);
+    OIIO::spin_mutex mutex;  // protect acc when merging
+    parallel_for_chunked(
+        roi.ybegin, roi.yend, 64,
+        [&](int64_t ybegin, int64_t yend) {
+            ROI subroi(roi.xbegin, roi.xend, ybegin, yend, roi.zbegin,
+                       roi.zend, roi.chbegin, roi.chend);
+            PixelStatsAccumulator tmp(acc.nchannels(),
+                                      acc.tracking_constancy());
+            ImageBuf::ConstRowSpans<float> rows(src, subroi);
+            for (int z = subroi.zbegin; z < subroi.zend; ++z)
+                for (int y = subroi.ybegin; y < subroi.yend; ++y)
+                    tmp.add(rows(y, z).data(), size_t(subroi.width()));
+            std::lock_guard<OIIO::spin_mutex> lock(mutex);
+            acc.merge(tmp);
+        },
+        paropt(nthreads));
+    return errors.ok();
+}
+
+
+
 template<class T>
 static bool
 computePixelStats_(const ImageBuf& src, ImageBufAlgo::PixelStats& stats,
@@ -132,6 +430,7 @@ computePixelStats_(const ImageBuf& src, ImageBufAlgo::PixelStats& stats,
     int nchannels = src.spec().nchannels;
 
     stats.reset(nchannels);
+    NewErrorCheck errors(src);
     OIIO::spin_mutex mutex;  // protect the shared stats when merging
 
     paropt opt(nthreads);
@@ -158,27 +457,18 @@ computePixelStats_(const ImageBuf& src, ImageBufAlgo::PixelStats& stats,
         }, opt);
 
     } else {  // Non-deep case
-        parallel_for_chunked(roi.ybegin, roi.yend, 64,
-                             [&](int64_t ybegin, int64_t yend) {
-            ROI subroi(roi.xbegin, roi.xend, ybegin, yend, roi.zbegin,
-                       roi.zend, roi.chbegin, roi.chend);
-            ImageBufAlgo::PixelStats tmp(nchannels);
-            for (ImageBuf::ConstIterator<T> s(src, subroi); !s.done();
-                 ++s) {
-                for (int c = subroi.chbegin; c < subroi.chend; ++c) {
-                    float value = s[c];
-                    val(tmp, c, value);
-                }
-            }
-            std::lock_guard<OIIO::spin_mutex> lock(mutex);
-            stats.merge(tmp);
-        }, opt);
+        ImageBufAlgo::PixelStatsAccumulator acc(roi.nchannels());
+        bool ok = ImageBufAlgo::accumulate_pixel_stats(acc, src, roi,
+                                                       nthreads);
+        finalize(stats);  // zero the channels outside the roi
+        acc.finalize(stats, roi.chbegin);
+        return ok;
     }
 
     // Compute final results
     finalize(stats);
 
-    return !src.has_error();
+    return errors.ok();
     // clang-format on
 };
 
@@ -899,32 +1189,68 @@ histogram_impl(const ImageBuf& src, int channel, std::vector<imagesize_t>& hist,
                int bins, float min, float max, bool ignore_empty, ROI roi,
                int nthreads)
 {
+    using namespace simd;
     // Double check A's type.
     if (src.spec().format != BaseTypeFromC<Atype>::value) {
         src.errorfmt("Unsupported pixel data format '{}'", src.spec().format);
         return false;
     }
 
+    NewErrorCheck errors(src);
     std::mutex mutex;  // thread safety for the histogram result
 
     ImageBufAlgo::parallel_image(roi, nthreads, [&](ROI roi) {
         float ratio      = bins / (max - min);
         int bins_minus_1 = bins - 1;
 
-        // Compute histogram to thread-local h.
+        // Compute histogram to thread-local h, from float rows holding just
+        // the histogram channel -- or, if we need to skip empty pixels,
+        // from all the channels of the roi plus the histogram channel.
         std::vector<imagesize_t> h(bins, 0);
-        for (ImageBuf::ConstIterator<Atype> a(src, roi); !a.done(); a++) {
-            if (ignore_empty) {
-                bool allblack = true;
-                for (int c = roi.chbegin; c < roi.chend; ++c)
-                    allblack &= (a[c] == 0.0f);
-                if (allblack)
+        ROI rowroi = roi;
+        if (ignore_empty) {
+            rowroi.chbegin = std::min(roi.chbegin, channel);
+            rowroi.chend   = std::max(roi.chend, channel + 1);
+        } else {
+            rowroi.chbegin = channel;
+            rowroi.chend   = channel + 1;
+        }
+        int nc = rowroi.nchannels(), w = roi.width();
+        auto bin = [&](float val) {
+            val = clamp(val, min, max);
+            return clamp(int((val - min) * ratio), 0, bins_minus_1);
+        };
+        ImageBuf::ConstRowSpans<float> rows(src, rowroi);
+        for (int z = roi.zbegin; z < roi.zend; ++z) {
+            for (int y = roi.ybegin; y < roi.yend; ++y) {
+                const float* row = rows(y, z).data();
+                if (ignore_empty) {
+                    for (int x = 0; x < w; ++x, row += nc) {
+                        bool allblack = true;
+                        for (int c = roi.chbegin; c < roi.chend; ++c)
+                            allblack &= (row[c - rowroi.chbegin] == 0.0f);
+                        if (!allblack)
+                            h[bin(row[channel - rowroi.chbegin])] += 1;
+                    }
                     continue;
+                }
+                // One contiguous channel: find four bins at a time
+                int x = 0;
+                for (; x + 4 <= w; x += 4) {
+                    vfloat4 v = vfloat4(row + x);
+                    v         = simd::min(simd::max(v, vfloat4(min)),
+                                          vfloat4(max));
+                    vint4 i   = vint4((v - vfloat4(min)) * vfloat4(ratio));
+                    i = simd::min(simd::max(i, vint4::Zero()),
+                                  vint4(bins_minus_1));
+                    h[i[0]] += 1;
+                    h[i[1]] += 1;
+                    h[i[2]] += 1;
+                    h[i[3]] += 1;
+                }
+                for (; x < w; ++x)
+                    h[bin(row[x])] += 1;
             }
-            float val = a[channel];
-            val       = clamp(val, min, max);
-            int i     = clamp(int((val - min) * ratio), 0, bins_minus_1);
-            h[i] += 1;
         }
 
         // Safely update the master histogram
@@ -932,7 +1258,7 @@ histogram_impl(const ImageBuf& src, int channel, std::vector<imagesize_t>& hist,
         for (int i = 0; i < bins; ++i)
             hist[i] += h[i];
     });
-    return true;
+    return errors.ok();
 }
 
 
@@ -3,9 +3,12 @@
 // https://github.com/AcademySoftwareFoundation/OpenImageIO
 
 
+#include <array>
 #include <cmath>
 #include <iostream>
+#include <numeric>
 #include <stdexcept>
+#include <vector>
 
 #include <OpenImageIO/half.h>
 
@@ -14,6 +17,7 @@
 #include <OpenImageIO/imagebuf.h>
 #include <OpenImageIO/imagebufalgo.h>
 #include <OpenImageIO/imagebufalgo_util.h>
+#include <OpenImageIO/simd.h>
 #include <OpenImageIO/thread.h>
 #include <OpenImageIO/timer.h>
 
@@ -23,12 +27,60 @@
 OIIO_NAMESPACE_3_1_BEGIN
 
 
-// FIXME -- NOT CORRECT!  This code assumes sorted, non-overlapping samples.
-// That is not a valid assumption in general. We will come back to fix this.
+// Sort the samples of a deep pixel, split them against each other so that
+// none partially overlap, and merge the ones that then coincide -- the
+// same clean-up DeepData::merge_deep_pixels does after combining pixels.
+static void
+tidy_deep_pixel(DeepData& dd, int64_t pixel)
+{
+    dd.sort(pixel);
+    int zchan     = dd.Z_channel();
+    int zbackchan = dd.Zback_channel();
+    for (int s = 0; s < dd.samples(pixel); ++s) {
+        float z     = dd.deep_value(pixel, zchan, s);
+        float zback = dd.deep_value(pixel, zbackchan, s);
+        dd.split(pixel, z);
+        dd.split(pixel, zback);
+    }
+    dd.sort(pixel);
+    dd.merge_overlaps(pixel);
+}
+
+
+
+// Are the n samples whose depths are given by z and zback already sorted
+// and free of overlaps (so that they can be composited front to back as
+// they are)?
+static bool
+deep_pixel_is_tidy(const float* z, const float* zback, int n)
+{
+    for (int s = 1; s < n; ++s)
+        if (z[s] < zback[s - 1]
+            || (z[s] == z[s - 1] && zback[s] == zback[s - 1]))
+            return false;
+    return true;
+}
+
+
+
+// Columns keep the bits of UINT32 channels; flatten wants their value in
+// the usual normalized sense.
+static void
+normalize_uint_columns(const DeepData& dd, DeepData::Columns& cols)
+{
+    for (int c = 0, nc = dd.channels(); c < nc; ++c)
+        if (dd.channeltype(c) == TypeDesc::UINT32)
+            for (float& v : cols.channel[c])
+                v = convert_type<uint32_t, float>(bitcast<uint32_t, float>(v));
+}
+
+
+
 template<class DSTTYPE>
 static bool
 flatten_(ImageBuf& dst, const ImageBuf& src, ROI roi, int nthreads)
 {
+    using namespace simd;
     ImageBufAlgo::parallel_image(roi, nthreads, [=, &dst, &src](ROI roi) {
         const ImageSpec& srcspec(src.spec());
         const DeepData* dd = src.deepdata();
@@ -42,43 +94,126 @@ flatten_(ImageBuf& dst, const ImageBuf& src, ROI roi, int nthreads)
         int G_channel      = srcspec.channelindex("G");
         int B_channel      = srcspec.channelindex("B");
         float* val         = OIIO_ALLOCA(float, nc);
-        float& ARval(val[AR_channel]);
-        float& AGval(val[AG_channel]);
-        float& ABval(val[AB_channel]);
-
-        for (ImageBuf::Iterator<DSTTYPE> r(dst, roi); !r.done(); ++r) {
-            int x = r.x(), y = r.y(), z = r.z();
-            int samps = src.deep_samples(x, y, z);
-            // Clear accumulated values for this pixel (0 for colors, big for Z)
-            memset(val, 0, nc * sizeof(float));
-            if (Z_channel >= 0 && samps == 0)
-                val[Z_channel] = 1.0e30;
-            if (Zback_channel >= 0 && samps == 0)
-                val[Zback_channel] = 1.0e30;
-            for (int s = 0; s < samps; ++s) {
-                float AR = ARval, AG = AGval, AB = ABval;  // make copies
-                float alpha = (AR + AG + AB) / 3.0f;
-                if (alpha >= 1.0f)
-                    break;
-                for (int c = 0; c < nc; ++c) {
-                    float v = src.deep_value(x, y, z, c, s);
-                    if (c == Z_channel || c == Zback_channel)
-                        val[c] *= alpha;  // because Z are not premultiplied
-                    float a;
-                    if (c == R_channel)
-                        a = AR;
-                    else if (c == G_channel)
-                        a = AG;
-                    else if (c == B_channel)
-                        a = AB;
-                    else
-                        a = alpha;
-                    val[c] += (1.0f - a) * v;
+        const float** col  = OIIO_ALLOCA(const float*, nc);
+        // Which accumulated alpha attenuates each channel: 0, 1, 2 for the
+        // R, G, B channels (AR, AG, AB), 3 for all others (their average).
+        int* sel = OIIO_ALLOCA(int, nc);
+        for (int c = 0; c < nc; ++c)
+            sel[c] = c == R_channel ? 0
+                     : c == G_channel ? 1
+                     : c == B_channel ? 2
+                                      : 3;
+
+        // Fetch the samples a scanline at a time as per-channel columns,
+        // so every loop below walks contiguous floats. Pixels whose samples
+        // are out of order or overlap are first tidied up in a one-pixel
+        // scratch DeepData, and composited from its columns instead.
+        DeepData::Columns cols, tidycols;
+        DeepData tidy;
+        std::vector<float> weights;
+        int xbegin = std::max(roi.xbegin, src.xbegin());
+        int xend   = std::max(xbegin, std::min(roi.xend, src.xend()));
+        for (int z = roi.zbegin; z < roi.zend; ++z) {
+            for (int y = roi.ybegin; y < roi.yend; ++y) {
+                bool inside = xbegin < xend && y >= src.ybegin()
+                              && y < src.yend() && z >= src.zbegin()
+                              && z < src.zend();
+                int64_t p0 = inside ? src.pixelindex(xbegin, y, z, true) : 0;
+                dd->get_columns(cols, p0, inside ? p0 + xend - xbegin : p0);
+                normalize_uint_columns(*dd, cols);
+
+                ImageBuf::Iterator<DSTTYPE> r(dst, roi.xbegin, roi.xend, y,
+                                              y + 1, z, z + 1);
+                for (; !r.done(); ++r) {
+                    int64_t i = r.x() - xbegin;
+                    int samps = (inside && r.x() >= xbegin && r.x() < xend)
+                                    ? cols.samples(i)
+                                    : 0;
+                    for (int c = 0; c < nc && samps; ++c)
+                        col[c] = &cols.channel[c][cols.offsets[i]];
+                    if (Z_channel >= 0 && samps > 1
+                        && !deep_pixel_is_tidy(col[Z_channel],
+                                               col[Zback_channel], samps)) {
+                        if (!tidy.initialized())
+                            tidy.init(1, nc, dd->all_channeltypes(),
+                                      srcspec.channelnames);
+                        tidy.copy_deep_pixel(0, *dd, p0 + i);
+                        tidy_deep_pixel(tidy, 0);
+                        tidy.get_columns(tidycols);
+                        normalize_uint_columns(tidy, tidycols);
+                        samps = tidycols.samples(0);
+                        for (int c = 0; c < nc; ++c)
+                            col[c] = tidycols.channel[c].data();
+                    }
+
+                    // Clear accumulated values for this pixel (0 for
+                    // colors, big for Z)
+                    memset(val, 0, nc * sizeof(float));
+                    if (samps == 0) {
+                        if (Z_channel >= 0)
+                            val[Z_channel] = 1.0e30;
+                        if (Zback_channel >= 0)
+                            val[Zback_channel] = 1.0e30;
+                        for (int c = roi.chbegin; c < roi.chend; ++c)
+                            r[c] = val[c];
+                        continue;
+                    }
+
+                    // First, run the alphas front to back to find the
+                    // weight (1 - accumulated alpha) of each sample, and
+                    // the sample at which the pixel becomes opaque.
+                    weights.resize(5 * size_t(samps));
+                    float* w         = weights.data();
+                    float* alpha     = w + 4 * samps;
+                    const float* vAR = col[AR_channel];
+                    const float* vAG = col[AG_channel];
+                    const float* vAB = col[AB_channel];
+                    float AR = 0.0f, AG = 0.0f, AB = 0.0f;
+                    int n = 0;
+                    for (; n < samps; ++n) {
+                        float a = (AR + AG + AB) / 3.0f;
+                        if (a >= 1.0f)
+                            break;
+                        w[0 * samps + n] = 1.0f - AR;
+                        w[1 * samps + n] = 1.0f - AG;
+                        w[2 * samps + n] = 1.0f - AB;
+                        w[3 * samps + n] = 1.0f - a;
+                        alpha[n]         = a;
+                        AR += w[sel[AR_channel] * samps + n] * vAR[n];
+                        AG += w[sel[AG_channel] * samps + n] * vAG[n];
+                        AB += w[sel[AB_channel] * samps + n] * vAB[n];
+                    }
+
+                    // Then each output channel is a weighted sum over its
+                    // own column, four samples at a time.
+                    for (int c = roi.chbegin; c < roi.chend; ++c) {
+                        const float* v  = col[c];
+                        const float* wc = w + sel[c] * samps;
+                        float sum       = 0.0f;
+                        if (c == Z_channel || c == Zback_channel) {
+                            // Z is not premultiplied, so it's a recurrence
+                            for (int s = 0; s < n; ++s)
+                                sum = sum * alpha[s] + wc[s] * v[s];
+                        } else {
+                            vfloat4 acc = vfloat4::Zero();
+                            int s       = 0;
+                            for (; s + 4 <= n; s += 4)
+                                acc += vfloat4(wc + s) * vfloat4(v + s);
+                            sum = reduce_add(acc);
+                            for (; s < n; ++s)
+                                sum += wc[s] * v[s];
+                        }
+                        val[c] = sum;
+                    }
+                    // The alphas themselves were already accumulated in
+                    // order above; use those exact values.
+                    val[AR_channel] = AR;
+                    val[AG_channel] = AG;
+                    val[AB_channel] = AB;
+                    for (int c = roi.chbegin; c < roi.chend; ++c)
+                        r[c] = val[c];
                 }
             }
-
-            for (int c = roi.chbegin; c < roi.chend; ++c)
-                r[c] = val[c];
         }
     });
     return true;
@@ -238,6 +373,101 @@ ImageBufAlgo::deepen(const ImageBuf& src, float zvalue, ROI roi, int nthreads)
 
 
 
+// Index of pixel (x,y,z) within roi, for per-pixel scratch arrays.
+inline imagesize_t
+roi_index(const ROI& roi, int x, int y, int z)
+{
+    return (imagesize_t(z - roi.zbegin) * roi.height()
+            + imagesize_t(y - roi.ybegin))
+               * roi.width()
+           + imagesize_t(x - roi.xbegin);
+}
+
+
+
+// Compute every pixel of roi in dst's deep data, in parallel, with
+// pixelop(dd, pixel, x, y, z), which returns false if it has nothing to
+// write for that pixel. The caller has already reserved each pixel's
+// capacity, so that the storage doesn't move while the threads write into
+// it. But growing any pixel past its capacity would reallocate the storage
+// under the other threads. So each pixel is first computed in a one-pixel
+// scratch DeepData, and only copied into dst if it fits. A pixel that
+// doesn't fit is computed again afterwards, in place and serially.
+template<typename PixelOp>
+static void
+deep_fill_reserved(ImageBuf& dst, ROI roi, int nthreads, PixelOp&& pixelop)
+{
+    DeepData& dstdd(*dst.deepdata());
+    std::vector<std::string> channelnames;
+    for (int c = 0; c < dstdd.channels(); ++c)
+        channelnames.emplace_back(dstdd.channelname(c));
+    std::vector<std::array<int, 3>> overflow;
+    spin_mutex overflow_mutex;
+    ImageBufAlgo::parallel_image(roi, nthreads, [&](ROI subroi) {
+        DeepData scratch;
+        scratch.init(1, dstdd.channels(), dstdd.all_channeltypes(),
+                     channelnames);
+        std::vector<std::array<int, 3>> spilled;
+        for (int z = subroi.zbegin; z < subroi.zend; ++z)
+            for (int y = subroi.ybegin; y < subroi.yend; ++y)
+                for (int x = subroi.xbegin; x < subroi.xend; ++x) {
+                    if (!pixelop(scratch, 0, x, y, z))
+                        continue;
+                    int64_t dstpixel = dst.pixelindex(x, y, z, true);
+                    if (scratch.samples(0) <= dstdd.capacity(dstpixel))
+                        dstdd.copy_deep_pixel(dstpixel, scratch, 0);
+                    else
+                        spilled.push_back({ x, y, z });
+                }
+        if (spilled.size()) {
+            spin_lock lock(overflow_mutex);
+            overflow.insert(overflow.end(), spilled.begin(), spilled.end());
+        }
+    });
+    for (auto& p : overflow)
+        pixelop(dstdd, dst.pixelindex(p[0], p[1], p[2], true), p[0], p[1],
+                p[2]);
+}
+
+
+
+// Upper bound on the number of samples that merging pixel Bpixel of B
+// into pixel Apixel of A can produce: all the samples of both, plus one
+// for every sample endpoint that lies strictly inside another sample
+// (each is a potential split). Samples of the same image are checked
+// against each other too, in case they overlap.
+static int
+deep_merge_capacity(const DeepData& A, int Apixel, const DeepData& B,
+                    int Bpixel, std::vector<float>& scratch)
+{
+    int Asamps = A.samples(Apixel);
+    int Bsamps = B.samples(Bpixel);
+    int n      = Asamps + Bsamps;
+    if (n < 2)
+        return n;
+    scratch.resize(2 * size_t(n));
+    float* zf = scratch.data();
+    float* zb = zf + n;
+    for (int s = 0; s < Asamps; ++s) {
+        zf[s] = A.deep_value(Apixel, A.Z_channel(), s);
+        zb[s] = A.deep_value(Apixel, A.Zback_channel(), s);
+    }
+    for (int s = 0; s < Bsamps; ++s) {
+        zf[Asamps + s] = B.deep_value(Bpixel, B.Z_channel(), s);
+        zb[Asamps + s] = B.deep_value(Bpixel, B.Zback_channel(), s);
+    }
+    int nsplits = 0;
+    for (int i = 0; i < n; ++i)
+        for (int j = i + 1; j < n; ++j)
+            nsplits += int(zf[j] > zf[i] && zf[j] < zb[i])
+                       + int(zb[j] > zf[i] && zb[j] < zb[i])
+                       + int(zf[i] > zf[j] && zf[i] < zb[j])
+                       + int(zb[i] > zf[j] && zb[i] < zb[j]);
+    return n + nsplits;
+}
+
+
+
 bool
 ImageBufAlgo::deep_merge(ImageBuf& dst, const ImageBuf& A, const ImageBuf& B,
                          bool occlusion_cull, ROI roi, int nthreads)
@@ -258,93 +488,44 @@ ImageBufAlgo::deep_merge(ImageBuf& dst, const ImageBuf& A, const ImageBuf& B,
 
     // First, set the capacity of the dst image to reserve enough space for
     // the segments of both source images, including any splits that may
-    // occur.
+    // occur. The counting is done in parallel, but the capacities are set
+    // serially, before any data is touched, so that the storage is laid
+    // out (prefix-summed) in one shot and never moves while the pixels are
+    // being merged below.
     DeepData& dstdd(*dst.deepdata());
     const DeepData& Add(*A.deepdata());
     const DeepData& Bdd(*B.deepdata());
-    int Azchan     = Add.Z_channel();
-    int Azbackchan = Add.Zback_channel();
-    int Bzchan     = Bdd.Z_channel();
-    int Bzbackchan = Bdd.Zback_channel();
-    for (int z = roi.zbegin; z < roi.zend; ++z)
-        for (int y = roi.ybegin; y < roi.yend; ++y)
-            for (int x = roi.xbegin; x < roi.xend; ++x) {
-                int dstpixel            = dst.pixelindex(x, y, z, true);
-                int Apixel              = A.pixelindex(x, y, z, true);
-                int Bpixel              = B.pixelindex(x, y, z, true);
-                int Asamps              = Add.samples(Apixel);
-                int Bsamps              = Bdd.samples(Bpixel);
-                int nsplits             = 0;
-                int self_overlap_splits = 0;
-                for (int s = 0; s < Asamps; ++s) {
-                    float src_z     = Add.deep_value(Apixel, Azchan, s);
-                    float src_zback = Add.deep_value(Apixel, Azbackchan, s);
-                    for (int d = 0; d < Bsamps; ++d) {
-                        float dst_z     = Bdd.deep_value(Bpixel, Bzchan, d);
-                        float dst_zback = Bdd.deep_value(Bpixel, Bzbackchan, d);
-                        if (src_z > dst_z && src_z < dst_zback)
-                            ++nsplits;
-                        if (src_zback > dst_z && src_zback < dst_zback)
-                            ++nsplits;
-                        if (dst_z > src_z && dst_z < src_zback)
-                            ++nsplits;
-                        if (dst_zback > src_z && dst_zback < src_zback)
-                            ++nsplits;
-                    }
-                    // Check for splits src vs src -- in case they overlap!
-                    for (int ss = s; ss < Asamps; ++ss) {
-                        float src_z2     = Add.deep_value(Apixel, Azchan, ss);
-                        float src_zback2 = Add.deep_value(Apixel, Azbackchan,
-                                                          ss);
-                        if (src_z2 > src_z && src_z2 < src_zback)
-                            ++self_overlap_splits;
-                        if (src_zback2 > src_z && src_zback2 < src_zback)
-                            ++self_overlap_splits;
-                        if (src_z > src_z2 && src_z < src_zback2)
-                            ++self_overlap_splits;
-                        if (src_zback > src_z2 && src_zback < src_zback2)
-                            ++self_overlap_splits;
-                    }
-                }
-                // Check for splits dst vs dst -- in case they overlap!
-                for (int d = 0; d < Bsamps; ++d) {
-                    float dst_z     = Bdd.deep_value(Bpixel, Bzchan, d);
-                    float dst_zback = Bdd.deep_value(Bpixel, Bzbackchan, d);
-                    for (int dd = d; dd < Bsamps; ++dd) {
-                        float dst_z2     = Bdd.deep_value(Bpixel, Bzchan, dd);
-                        float dst_zback2 = Bdd.deep_value(Bpixel, Bzbackchan,
-                                                          dd);
-                        if (dst_z2 > dst_z && dst_z2 < dst_zback)
-                            ++self_overlap_splits;
-                        if (dst_zback2 > dst_z && dst_zback2 < dst_zback)
-                            ++self_overlap_splits;
-                        if (dst_z > dst_z2 && dst_z < dst_zback2)
-                            ++self_overlap_splits;
-                        if (dst_zback > dst_z2 && dst_zback < dst_zback2)
-                            ++self_overlap_splits;
-                    }
-                }
-
-                dstdd.set_capacity(dstpixel, Asamps + Bsamps + nsplits
-                                                 + self_overlap_splits);
-            }
-
-    bool ok = ImageBufAlgo::copy(dst, A, TypeDesc::UNKNOWN, roi, nthreads);
-
+    std::vector<int> capacity(roi.npixels());
+    ImageBufAlgo::parallel_image(roi, nthreads, [&](ROI subroi) {
+        std::vector<float> zscratch;
+        for (int z = subroi.zbegin; z < subroi.zend; ++z)
+            for (int y = subroi.ybegin; y < subroi.yend; ++y)
+                for (int x = subroi.xbegin; x < subroi.xend; ++x)
+                    capacity[roi_index(roi, x, y, z)] = deep_merge_capacity(
+                        Add, A.pixelindex(x, y, z, true), Bdd,
+                        B.pixelindex(x, y, z, true), zscratch);
+    });
     for (int z = roi.zbegin; z < roi.zend; ++z)
         for (int y = roi.ybegin; y < roi.yend; ++y)
-            for (int x = roi.xbegin; x < roi.xend; ++x) {
-                int dstpixel = dst.pixelindex(x, y, z, true);
-                int Bpixel   = B.pixelindex(x, y, z, true);
-                OIIO_DASSERT(dstpixel >= 0);
-                // OIIO_UNUSED_OK int oldcap = dstdd.capacity (dstpixel);
-                dstdd.merge_deep_pixels(dstpixel, Bdd, Bpixel);
-                // OIIO_DASSERT (oldcap == dstdd.capacity(dstpixel) &&
-                //          "Broken: we did not preallocate enough capacity");
-                if (occlusion_cull)
-                    dstdd.occlusion_cull(dstpixel);
-            }
-    return ok;
+            for (int x = roi.xbegin; x < roi.xend; ++x)
+                dstdd.set_capacity(dst.pixelindex(x, y, z, true),
+                                   capacity[roi_index(roi, x, y, z)]);
+    dstdd.all_data();  // Force the allocation now, not from the threads
+
+    // Now copy A and merge B into it, pixel by pixel. With the capacity
+    // reserved, each pixel only touches its own samples, so this can
+    // proceed on separate pixels simultaneously.
+    deep_fill_reserved(dst, roi, nthreads,
+                       [&](DeepData& dd, int64_t pixel, int x, int y, int z) {
+                           dd.copy_deep_pixel(pixel, Add,
+                                              A.pixelindex(x, y, z, true));
+                           dd.merge_deep_pixels(pixel, Bdd,
+                                                B.pixelindex(x, y, z, true));
+                           if (occlusion_cull)
+                               dd.occlusion_cull(pixel);
+                           return true;
+                       });
+    return true;
 }
 
 
@@ -362,9 +543,39 @@ ImageBufAlgo::deep_merge(const ImageBuf& A, const ImageBuf& B,
 
 
 
+// Cut away the samples of a deep pixel that lie beyond depth zthresh,
+// splitting any that straddle it.
+static void
+holdout_pixel(DeepData& dd, int64_t pixel, float zthresh)
+{
+    int Zchan     = dd.Z_channel();
+    int Zbackchan = dd.Zback_channel();
+    // Eliminate the samples that are entirely beyond the depth threshold.
+    // Do this before the split; that makes it less likely that the split
+    // will force a re-allocation.
+    for (int s = 0, n = dd.samples(pixel); s < n; ++s) {
+        if (dd.deep_value(pixel, Zchan, s) > zthresh) {
+            dd.set_samples(pixel, s);
+            break;
+        }
+    }
+    // Now split any samples that straddle the z.
+    if (dd.split(pixel, zthresh)) {
+        // If a split did occur, do another discard pass.
+        for (int s = 0, n = dd.samples(pixel); s < n; ++s) {
+            if (dd.deep_value(pixel, Zbackchan, s) > zthresh) {
+                dd.set_samples(pixel, s);
+                break;
+            }
+        }
+    }
+}
+
+
+
 bool
 ImageBufAlgo::deep_holdout(ImageBuf& dst, const ImageBuf& src,
-                           const ImageBuf& thresh, ROI roi, int /*nthreads*/)
+                           const ImageBuf& thresh, ROI roi, int nthreads)
 {
     OIIO::pvt::LoggedTimer logtime("IBA::deep_holdout");
     if (!src.deep() || !thresh.deep()) {
@@ -380,53 +591,62 @@ ImageBufAlgo::deep_holdout(ImageBuf& dst, const ImageBuf& src,
 
     DeepData& dstdd(*dst.deepdata());
     const DeepData& srcdd(*src.deepdata());
-    // First, reserve enough space in dst, to reduce the number of
-    // allocations we'll do later.
+    const DeepData& threshdd(*thresh.deepdata());
+    int Zchan     = dstdd.Z_channel();
+    int Zbackchan = dstdd.Zback_channel();
+
+    // First, find each pixel's threshold depth and reserve enough space in
+    // dst for its src samples plus one for each sample that straddles that
+    // depth (and so may be split). As in deep_merge, the counting is done
+    // in parallel but the capacities are set serially, before any data is
+    // touched, so the storage never moves while pixels are computed.
+    std::vector<int> capacity(roi.npixels(), -1);
+    std::vector<float> zthresh(roi.npixels());
+    ImageBufAlgo::parallel_image(roi, nthreads, [&](ROI subroi) {
+        for (int z = subroi.zbegin; z < subroi.zend; ++z)
+            for (int y = subroi.ybegin; y < subroi.yend; ++y)
+                for (int x = subroi.xbegin; x < subroi.xend; ++x) {
+                    int srcpixel = src.pixelindex(x, y, z, true);
+                    if (srcpixel < 0)
+                        continue;
+                    imagesize_t i   = roi_index(roi, x, y, z);
+                    int threshpixel = thresh.pixelindex(x, y, z, true);
+                    float zt = threshpixel < 0
+                                   ? std::numeric_limits<float>::max()
+                                   : threshdd.opaque_z(threshpixel);
+                    int n   = srcdd.samples(srcpixel);
+                    int cap = n;
+                    for (int s = 0; s < n; ++s)
+                        cap += int(srcdd.deep_value(srcpixel, Zchan, s) < zt
+                                   && srcdd.deep_value(srcpixel, Zbackchan, s)
+                                          > zt);
+                    capacity[i] = cap;
+                    zthresh[i]  = zt;
+                }
+    });
     for (int z = roi.zbegin; z < roi.zend; ++z)
         for (int y = roi.ybegin; y < roi.yend; ++y)
             for (int x = roi.xbegin; x < roi.xend; ++x) {
-                int dstpixel = dst.pixelindex(x, y, z, true);
-                int srcpixel = src.pixelindex(x, y, z, true);
-                if (dstpixel >= 0 && srcpixel >= 0)
-                    dstdd.set_capacity(dstpixel, srcdd.capacity(srcpixel));
+                int cap = capacity[roi_index(roi, x, y, z)];
+                if (cap >= 0)
+                    dstdd.set_capacity(dst.pixelindex(x, y, z, true), cap);
             }
+    dstdd.all_data();  // Force the allocation now, not from the threads
+
     // Now we compute each pixel: We copy the src pixel to dst, then split
     // any samples that span the opaque threshold, and then delete any
     // samples that lie beyond the threshold.
-    int Zchan     = dstdd.Z_channel();
-    int Zbackchan = dstdd.Zback_channel();
-    const DeepData& threshdd(*thresh.deepdata());
-    for (ImageBuf::Iterator<float> r(dst, roi); !r.done(); ++r) {
-        int x = r.x(), y = r.y(), z = r.z();
-        int srcpixel = src.pixelindex(x, y, z, true);
-        if (srcpixel < 0)
-            continue;  // Nothing in this pixel
-        int dstpixel = dst.pixelindex(x, y, z, true);
-        dstdd.copy_deep_pixel(dstpixel, srcdd, srcpixel);
-        int threshpixel = thresh.pixelindex(x, y, z, true);
-        if (threshpixel < 0)
-            continue;  // No threshold mask for this pixel
-        float zthresh = threshdd.opaque_z(threshpixel);
-        // Eliminate the samples that are entirely beyond the depth
-        // threshold. Do this before the split; that makes it less
-        // likely that the split will force a re-allocation.
-        for (int s = 0, n = dstdd.samples(dstpixel); s < n; ++s) {
-            if (dstdd.deep_value(dstpixel, Zchan, s) > zthresh) {
-                dstdd.set_samples(dstpixel, s);
-                break;
-            }
-        }
-        // Now split any samples that straddle the z.
-        if (dstdd.split(dstpixel, zthresh)) {
-            // If a split did occur, do another discard pass.
-            for (int s = 0, n = dstdd.samples(dstpixel); s < n; ++s) {
-                if (dstdd.deep_value(dstpixel, Zbackchan, s) > zthresh) {
-                    dstdd.set_samples(dstpixel, s);
-                    break;
-                }
-            }
-        }
-    }
+    deep_fill_reserved(dst, roi, nthreads,
+                       [&](DeepData& dd, int64_t pixel, int x, int y, int z) {
+                           int srcpixel = src.pixelindex(x, y, z, true);
+                           if (srcpixel < 0)
+                               return false;  // Nothing in this pixel
+                           dd.copy_deep_pixel(pixel, srcdd, srcpixel);
+                           if (thresh.pixelindex(x, y, z, true) >= 0)
+                               holdout_pixel(dd, pixel,
+                                             zthresh[roi_index(roi, x, y, z)]);
+                           return true;
+                       });
     return true;
 }
 
@@ -444,4 +664,193 @@ ImageBufAlgo::deep_holdout(const ImageBuf& src, const ImageBuf& thresh, ROI roi,
 }
 
 
+
+
+namespace {
+
+// Read scanlines [ybegin,yend) of slice z of the deep image open in `in`
+// into `buf`, which is reset to be a deep image of exactly that band.
+bool
+read_deep_band(ImageInput& in, int ybegin, int yend, int z, ImageBuf& buf)
+{
+    const ImageSpec& spec(in.spec());
+    ImageSpec bandspec = spec;
+    bandspec.y         = ybegin;
+    bandspec.height    = yend - ybegin;
+    bandspec.z         = z;
+    bandspec.depth     = 1;
+    buf.reset(bandspec);
+    DeepData& dd(*buf.deepdata());
+    if (spec.tile_width)
+        return in.read_native_deep_tiles(0, 0, spec.x, spec.x + spec.width,
+                                         ybegin, yend, z, z + 1, 0,
+                                         spec.nchannels, dd);
+    return in.read_native_deep_scanlines(0, 0, ybegin, yend, z, 0,
+                                         spec.nchannels, dd);
+}
+
+
+
+// The engine for the streaming deep operations: open the deep inputs,
+// then for each band of scanlines read that band of every input, call
+// `op(dst, bands, roi)` to compute the band of output into `dst`, flatten
+// it if a flat result was requested, and append it to the output file.
+// Only one band of each image is ever in memory.
+template<class BandOp>
+bool
+deep_stream(string_view opname, string_view outfilename,
+            cspan<string_view> infilenames, bool flat_output, int bandheight,
+            int nthreads, BandOp&& op)
+{
+    OIIO::pvt::LoggedTimer logtime(opname);
+    std::vector<std::unique_ptr<ImageInput>> in;
+    for (auto name : infilenames) {
+        in.push_back(ImageInput::open(name));
+        if (!in.back()) {
+            errorfmt("{}: {}", opname, OIIO::geterror());
+            return false;
+        }
+        const ImageSpec& spec(in.back()->spec());
+        const ImageSpec& spec0(in.front()->spec());
+        if (!spec.deep) {
+            errorfmt("{}: \"{}\" is not a deep image", opname, name);
+            return false;
+        }
+        if (spec.tile_width && spec.tile_depth > 1) {
+            errorfmt("{}: \"{}\" has volumetric tiles, which can't be "
+                     "streamed by slice",
+                     opname, name);
+            return false;
+        }
+        if (spec.x != spec0.x || spec.y != spec0.y || spec.z != spec0.z
+            || spec.width != spec0.width || spec.height != spec0.height
+            || spec.depth != spec0.depth) {
+            errorfmt("{}: \"{}\" and \"{}\" have different data windows",
+                     opname, infilenames[0], name);
+            return false;
+        }
+    }
+
+    const ImageSpec& inspec(in[0]->spec());
+    ImageSpec outspec = inspec;
+    outspec.tile_width = outspec.tile_height = outspec.tile_depth = 0;
+    if (flat_output) {
+        outspec.deep = false;
+        outspec.channelformats.clear();
+    }
+    auto out = ImageOutput::create(outfilename);
+    if (!out) {
+        errorfmt("{}: {}", opname, OIIO::geterror());
+        return false;
+    }
+    if (!flat_output && !out->supports("deepdata")) {
+        errorfmt("{}: \"{}\" format does not support deep images", opname,
+                 out->format_name());
+        return false;
+    }
+    if (!out->open(outfilename, outspec)) {
+        errorfmt("{}: {}", opname, out->geterror());
+        return false;
+    }
+
+    // Bands must fall on tile boundaries of every tiled input, so they
+    // must be a multiple of all of their tile heights.
+    if (bandheight <= 0)
+        bandheight = 64;
+    int64_t align = 1;
+    for (auto& i : in)
+        if (i->spec().tile_width)
+            align = std::lcm(align, int64_t(i->spec().tile_height));
+    bandheight = int(std::min(round_to_multiple(int64_t(bandheight), align),
+                              int64_t(inspec.height)));
+
+    std::vector<ImageBuf> bands(in.size());
+    for (int z = inspec.z; z < inspec.z + inspec.depth; ++z) {
+        for (int y = inspec.y; y < inspec.y + inspec.height; y += bandheight) {
+            int yend = std::min(y + bandheight, inspec.y + inspec.height);
+            for (size_t i = 0; i < in.size(); ++i)
+                if (!read_deep_band(*in[i], y, yend, z, bands[i])) {
+                    errorfmt("{}: {}", opname, in[i]->geterror());
+                    return false;
+                }
+            ROI roi(inspec.x, inspec.x + inspec.width, y, yend, z, z + 1, 0,
+                    inspec.nchannels);
+            ImageBuf dst;
+            bool ok = op(dst, bands, roi);
+            if (ok && flat_output && dst.deep()) {
+                dst = ImageBufAlgo::flatten(dst, roi, nthreads);
+                ok  = !dst.has_error();
+            }
+            if (!ok) {
+                errorfmt("{}: {}", opname, dst.geterror());
+                return false;
+            }
+            ok = dst.deep()
+                     ? out->write_deep_scanlines(y, yend, z, *dst.deepdata())
+                     : out->write_scanlines(y, yend, z, dst.spec().format,
+                                            dst.localpixels());
+            if (!ok) {
+                errorfmt("{}: {}", opname, out->geterror());
+                return false;
+            }
+        }
+    }
+    if (!out->close()) {
+        errorfmt("{}: {}", opname, out->geterror());
+        return false;
+    }
+    return true;
+}
+
+}  // namespace
+
+
+
+bool
+ImageBufAlgo::flatten_file(string_view outfilename, string_view infilename,
+                           int bandheight, int nthreads)
+{
+    string_view inputs[] = { infilename };
+    return deep_stream("IBA::flatten_file", outfilename, inputs, true,
+                       bandheight, nthreads,
+                       [&](ImageBuf& dst, std::vector<ImageBuf>& src, ROI roi) {
+                           return flatten(dst, src[0], roi, nthreads);
+                       });
+}
+
+
+
+bool
+ImageBufAlgo::deep_merge_file(string_view outfilename, string_view Afilename,
+                              string_view Bfilename, bool occlusion_cull,
+                              bool flatten, int bandheight, int nthreads)
+{
+    string_view inputs[] = { Afilename, Bfilename };
+    return deep_stream("IBA::deep_merge_file", outfilename, inputs, flatten,
+                       bandheight, nthreads,
+                       [&](ImageBuf& dst, std::vector<ImageBuf>& src, ROI roi) {
+                           return deep_merge(dst, src[0], src[1],
+                                             occlusion_cull, roi, nthreads);
+                       });
+}
+
+
+
+bool
+ImageBufAlgo::deep_holdout_file(string_view outfilename,
+                                string_view srcfilename,
+                                string_view holdoutfilename, bool flatten,
+                                int bandheight, int nthreads)
+{
+    string_view inputs[] = { srcfilename, holdoutfilename };
+    return deep_stream("IBA::deep_holdout_file", outfilename, inputs, flatten,
+                       bandheight, nthreads,
+                       [&](ImageBuf& dst, std::vector<ImageBuf>& src, ROI roi) {
+                           return deep_holdout(dst, src[0], src[1], roi,
+                                               nthreads);
+                       });
+}
+
+
+
 OIIO_NAMESPACE_3_1_END
@@ -12,6 +12,7 @@
 #include <OpenImageIO/imagebufalgo.h>
 #include <OpenImageIO/imagebufalgo_util.h>
 
+#include "imagebufalgo_rowops_prv.h"
 #include "imageio_pvt.h"
 
 
@@ -19,120 +20,70 @@ OIIO_NAMESPACE_3_1_BEGIN
 
 
 
-template<class Rtype, class ABCtype>
 static bool
 mad_impl(ImageBuf& R, const ImageBuf& A, const ImageBuf& B, const ImageBuf& C,
          ROI roi, int nthreads)
 {
-    ImageBufAlgo::parallel_image(roi, nthreads, [&](ROI roi) {
-        if ((std::is_same<Rtype, float>::value
-             || std::is_same<Rtype, half>::value)
-            && (std::is_same<ABCtype, float>::value
-                || std::is_same<ABCtype, half>::value)
-            // && R.localpixels() // has to be, because it's writable
-            && A.localpixels() && B.localpixels()
-            && C.localpixels()
-            // && R.contains_roi(roi)  // has to be, because IBAPrep
-            && A.contains_roi(roi) && B.contains_roi(roi) && C.contains_roi(roi)
-            && roi.chbegin == 0 && roi.chend == R.nchannels()
-            && roi.chend == A.nchannels() && roi.chend == B.nchannels()
-            && roi.chend == C.nchannels()) {
-            // Special case when all inputs are either float or half, with in-
-            // memory contiguous data and we're operating on the full channel
-            // range: skip iterators: For these circumstances, we can operate on
-            // the raw memory very efficiently. Otherwise, we will need the
-            // magic of the the Iterators (and pay the price).
-            int nxvalues = roi.width() * R.nchannels();
-            for (int z = roi.zbegin; z < roi.zend; ++z)
-                for (int y = roi.ybegin; y < roi.yend; ++y) {
-                    Rtype* rraw = (Rtype*)R.pixeladdr(roi.xbegin, y, z);
-                    const ABCtype* araw
-                        = (const ABCtype*)A.pixeladdr(roi.xbegin, y, z);
-                    const ABCtype* braw
-                        = (const ABCtype*)B.pixeladdr(roi.xbegin, y, z);
-                    const ABCtype* craw
-                        = (const ABCtype*)C.pixeladdr(roi.xbegin, y, z);
-                    OIIO_DASSERT(araw && braw && craw);
-                    // The straightforward loop auto-vectorizes very well,
-                    // there's no benefit to using explicit SIMD here.
-                    for (int x = 0; x < nxvalues; ++x)
-                        rraw[x] = araw[x] * braw[x] + craw[x];
-                    // But if you did want to explicitly vectorize, this is
-                    // how it would look:
-                    // int simdend = nxvalues & (~3); // how many float4's?
-                    // for (int x = 0; x < simdend; x += 4) {
-                    //     simd::float4 a_simd(araw+x), b_simd(braw+x), c_simd(craw+x);
-                    //     simd::float4 r_simd = a_simd * b_simd + c_simd;
-                    //     r_simd.store (rraw+x);
-                    // }
-                    // for (int x = simdend; x < nxvalues; ++x)
-                    //     rraw[x] = araw[x] * braw[x] + craw[x];
-                }
-        } else {
-            ImageBuf::Iterator<Rtype> r(R, roi);
-            ImageBuf::ConstIterator<ABCtype> a(A, roi);
-            ImageBuf::ConstIterator<ABCtype> b(B, roi);
-            ImageBuf::ConstIterator<ABCtype> c(C, roi);
-            for (; !r.done(); ++r, ++a, ++b, ++c) {
-                for (int ch = roi.chbegin; ch < roi.chend; ++ch)
-                    r[ch] = a[ch] * b[ch] + c[ch];
-            }
-        }
-    });
+    // The straightforward loop over each row auto-vectorizes very well,
+    // there's no benefit to using explicit SIMD here.
+    ImageBufAlgo::rowop_image(R, A, B, C, roi, nthreads,
+                              [](float* r, const float* a, const float* b,
+                                 const float* c, size_t n) {
+                                  for (size_t i = 0; i < n; ++i)
+                                      r[i] = a[i] * b[i] + c[i];
+                              });
     return true;
 }
 
 
 
-template<class Rtype, class ABCtype>
 static bool
 mad_impl_ici(ImageBuf& R, const ImageBuf& A, cspan<float> b, const ImageBuf& C,
              ROI roi, int nthreads)
 {
-    ImageBufAlgo::parallel_image(roi, nthreads, [&](ROI roi) {
-        ImageBuf::Iterator<Rtype> r(R, roi);
-        ImageBuf::ConstIterator<ABCtype> a(A, roi);
-        ImageBuf::ConstIterator<ABCtype> c(C, roi);
-        for (; !r.done(); ++r, ++a, ++c) {
-            for (int ch = roi.chbegin; ch < roi.chend; ++ch)
-                r[ch] = a[ch] * b[ch] + c[ch];
-        }
-    });
+    std::vector<float> brow = ImageBufAlgo::perchannel_row(b, roi);
+    ImageBufAlgo::rowop_image(R, A, C, roi, nthreads,
+                              [&](float* r, const float* a, const float* c,
+                                  size_t n) {
+                                  const float* bv = brow.data();
+                                  for (size_t i = 0; i < n; ++i)
+                                      r[i] = a[i] * bv[i] + c[i];
+                              });
     return true;
 }
 
 
 
-template<class Rtype, class Atype>
 static bool
 mad_impl_icc(ImageBuf& R, const ImageBuf& A, cspan<float> b, cspan<float> c,
              ROI roi, int nthreads)
 {
-    ImageBufAlgo::parallel_image(roi, nthreads, [&](ROI roi) {
-        ImageBuf::Iterator<Rtype> r(R, roi);
-        ImageBuf::ConstIterator<Atype> a(A, roi);
-        for (; !r.done(); ++r, ++a)
-            for (int ch = roi.chbegin; ch < roi.chend; ++ch)
-                r[ch] = a[ch] * b[ch] + c[ch];
-    });
+    std::vector<float> brow = ImageBufAlgo::perchannel_row(b, roi);
+    std::vector<float> crow = ImageBufAlgo::perchannel_row(c, roi);
+    ImageBufAlgo::rowop_image(R, A, roi, nthreads,
+                              [&](float* r, const float* a, size_t n) {
+                                  const float* bv = brow.data();
+                                  const float* cv = crow.data();
+                                  for (size_t i = 0; i < n; ++i)
+                                      r[i] = a[i] * bv[i] + cv[i];
+                              });
     return true;
 }
 
 
 
-template<class Rtype, class Atype>
 static bool
 mad_impl_iic(ImageBuf& R, const ImageBuf& A, const ImageBuf& B, cspan<float> c,
              ROI roi, int nthreads)
 {
-    ImageBufAlgo::parallel_image(roi, nthreads, [&](ROI roi) {
-        ImageBuf::Iterator<Rtype> r(R, roi);
-        ImageBuf::ConstIterator<Atype> a(A, roi);
-        ImageBuf::ConstIterator<Atype> b(B, roi);
-        for (; !r.done(); ++r, ++a, ++b)
-            for (int ch = roi.chbegin; ch < roi.chend; ++ch)
-                r[ch] = a[ch] * b[ch] + c[ch];
-    });
+    std::vector<float> crow = ImageBufAlgo::perchannel_row(c, roi);
+    ImageBufAlgo::rowop_image(R, A, B, roi, nthreads,
+                              [&](float* r, const float* a, const float* b,
+                                  size_t n) {
+                                  const float* cv = crow.data();
+                                  for (size_t i = 0; i < n; ++i)
+                                      r[i] = a[i] * b[i] + cv[i];
+                              });
     return true;
 }
 
@@ -161,9 +112,10 @@ ImageBufAlgo::mad(ImageBuf& dst, Image_or_Const A_, Image_or_Const B_,
         return false;
     }
 
-    // To avoid the full cross-product of dst/A/B/C types, force any of
-    // A,B,C that are images to all be the same data type, copying if we
-    // have to.
+    // The row kernels see every image as float scanlines, so mixed input
+    // types work as is. But unify any of A,B,C that are images to the same
+    // data type anyway (copying if we have to), so that an uninitialized
+    // dst gets allocated as that merged type rather than float.
     TypeDesc abc_type
         = TypeDesc::basetype_merge(A ? A->spec().format : TypeUnknown,
                                    B ? B->spec().format : TypeUnknown,
@@ -184,34 +136,31 @@ ImageBufAlgo::mad(ImageBuf& dst, Image_or_Const A_, Image_or_Const B_,
 
     if (!IBAprep(roi, &dst, A, B ? B : C, C))
         return false;
+    roi.chend = std::min(roi.chend, A->nchannels());
+    if (B)
+        roi.chend = std::min(roi.chend, B->nchannels());
+    if (C)
+        roi.chend = std::min(roi.chend, C->nchannels());
 
     // Note: A is always an image. That leaves 4 cases to deal with.
     bool ok;
     if (B) {
         if (C) {
-            OIIO_DISPATCH_COMMON_TYPES2(ok, "mad", mad_impl, dst.spec().format,
-                                        abc_type, dst, *A, *B, *C, roi,
-                                        nthreads);
+            ok = mad_impl(dst, *A, *B, *C, roi, nthreads);
         } else {  // C not an image
             cspan<float> c(C_.val());
             IBA_FIX_PERCHAN_LEN_DEF(c, dst.nchannels());
-            OIIO_DISPATCH_COMMON_TYPES2(ok, "mad", mad_impl_iic,
-                                        dst.spec().format, abc_type, dst, *A,
-                                        *B, c, roi, nthreads);
+            ok = mad_impl_iic(dst, *A, *B, c, roi, nthreads);
         }
     } else {  // B is not an image
         cspan<float> b(B_.val());
         IBA_FIX_PERCHAN_LEN_DEF(b, dst.nchannels());
         if (C) {
-            OIIO_DISPATCH_COMMON_TYPES2(ok, "mad", mad_impl_ici,
-                                        dst.spec().format, abc_type, dst, *A, b,
-                                        *C, roi, nthreads);
+            ok = mad_impl_ici(dst, *A, b, *C, roi, nthreads);
         } else {  // C not an image
             cspan<float> c(C_.val());
             IBA_FIX_PERCHAN_LEN_DEF(c, dst.nchannels());
-            OIIO_DISPATCH_COMMON_TYPES2(ok, "mad", mad_impl_icc,
-                                        dst.spec().format, abc_type, dst, *A, b,
-                                        c, roi, nthreads);
+            ok = mad_impl_icc(dst, *A, b, c, roi, nthreads);
         }
     }
     return ok;
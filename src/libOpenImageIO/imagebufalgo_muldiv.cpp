@@ -19,24 +19,34 @@
 #include <OpenImageIO/imagebufalgo_util.h>
 #include <OpenImageIO/simd.h>
 
+#include "imagebufalgo_rowops_prv.h"
 #include "imageio_pvt.h"
 
 
 OIIO_NAMESPACE_3_1_BEGIN
 
 
-template<class Rtype, class Atype, class Btype>
 static bool
 scale_impl(ImageBuf& R, const ImageBuf& A, const ImageBuf& B, ROI roi,
            int nthreads)
 {
+    roi.chend = std::min(roi.chend, A.nchannels());
     ImageBufAlgo::parallel_image(roi, nthreads, [&](ROI roi) {
-        ImageBuf::Iterator<Rtype> r(R, roi);
-        ImageBuf::ConstIterator<Atype> a(A, roi);
-        ImageBuf::ConstIterator<Btype> b(B, roi);
-        for (; !r.done(); ++r, ++a, ++b)
-            for (int c = roi.chbegin; c < roi.chend; ++c)
-                r[c] = a[c] * b[0];
+        ImageBuf::RowSpans<float> r(R, roi);
+        ImageBuf::ConstRowSpans<float> a(A, roi);
+        ROI broi(roi.xbegin, roi.xend, roi.ybegin, roi.yend, roi.zbegin,
+                 roi.zend, 0, 1);
+        ImageBuf::ConstRowSpans<float> b(B, broi);
+        int nc = roi.nchannels(), w = roi.width();
+        for (int z = roi.zbegin; z < roi.zend; ++z)
+            for (int y = roi.ybegin; y < roi.yend; ++y) {
+                const float* ap = a(y, z).data();
+                const float* bp = b(y, z).data();
+                float* rp       = r(y, z).data();
+                for (int x = 0; x < w; ++x)
+                    for (int c = 0; c < nc; ++c)
+                        rp[x * nc + c] = ap[x * nc + c] * bp[x];
+            }
     });
     return true;
 }
@@ -51,16 +61,10 @@ ImageBufAlgo::scale(ImageBuf& dst, const ImageBuf& A, const ImageBuf& B,
     bool ok = false;
     if (B.nchannels() == 1) {
         if (IBAprep(roi, &dst, &A, &B))
-            OIIO_DISPATCH_COMMON_TYPES3(ok, "scale", scale_impl,
-                                        dst.spec().format, A.spec().format,
-                                        B.spec().format, dst, A, B, roi,
-                                        nthreads);
+            ok = scale_impl(dst, A, B, roi, nthreads);
     } else if (A.nchannels() == 1) {
         if (IBAprep(roi, &dst, &A, &B))
-            OIIO_DISPATCH_COMMON_TYPES3(ok, "scale", scale_impl,
-                                        dst.spec().format, B.spec().format,
-                                        A.spec().format, dst, B, A, roi,
-                                        nthreads);
+            ok = scale_impl(dst, B, A, roi, nthreads);
     } else {
         dst.errorfmt(
             "ImageBufAlgo::scale(): one of the arguments must be a single channel image.");
@@ -84,34 +88,31 @@ ImageBufAlgo::scale(const ImageBuf& A, const ImageBuf& B, KWArgs options,
 
 
 
-template<class Rtype, class Atype, class Btype>
 static bool
 mul_impl(ImageBuf& R, const ImageBuf& A, const ImageBuf& B, ROI roi,
          int nthreads)
 {
-    ImageBufAlgo::parallel_image(roi, nthreads, [&](ROI roi) {
-        ImageBuf::Iterator<Rtype> r(R, roi);
-        ImageBuf::ConstIterator<Atype> a(A, roi);
-        ImageBuf::ConstIterator<Btype> b(B, roi);
-        for (; !r.done(); ++r, ++a, ++b)
-            for (int c = roi.chbegin; c < roi.chend; ++c)
-                r[c] = a[c] * b[c];
-    });
+    ImageBufAlgo::rowop_image(R, A, B, roi, nthreads,
+                              [](float* r, const float* a, const float* b,
+                                 size_t n) {
+                                  for (size_t i = 0; i < n; ++i)
+                                      r[i] = a[i] * b[i];
+                              });
     return true;
 }
 
 
 
-template<class Rtype, class Atype>
 static bool
 mul_impl(ImageBuf& R, const ImageBuf& A, cspan<float> b, ROI roi, int nthreads)
 {
-    ImageBufAlgo::parallel_image(roi, nthreads, [&](ROI roi) {
-        ImageBuf::ConstIterator<Atype> a(A, roi);
-        for (ImageBuf::Iterator<Rtype> r(R, roi); !r.done(); ++r, ++a)
-            for (int c = roi.chbegin; c < roi.chend; ++c)
-                r[c] = a[c] * b[c];
-    });
+    std::vector<float> brow = ImageBufAlgo::perchannel_row(b, roi);
+    ImageBufAlgo::rowop_image(R, A, roi, nthreads,
+                              [&](float* r, const float* a, size_t n) {
+                                  const float* bv = brow.data();
+                                  for (size_t i = 0; i < n; ++i)
+                                      r[i] = a[i] * bv[i];
+                              });
     return true;
 }
 
@@ -152,11 +153,7 @@ ImageBufAlgo::mul(ImageBuf& dst, Image_or_Const A_, Image_or_Const B_, ROI roi,
         const ImageBuf &A(A_.img()), &B(B_.img());
         if (!IBAprep(roi, &dst, &A, &B, IBAprep_CLAMP_MUTUAL_NCHANNELS))
             return false;
-        bool ok;
-        OIIO_DISPATCH_COMMON_TYPES3(ok, "mul", mul_impl, dst.spec().format,
-                                    A.spec().format, B.spec().format, dst, A, B,
-                                    roi, nthreads);
-        return ok;
+        return mul_impl(dst, A, B, roi, nthreads);
     }
     if (A_.is_val() && B_.is_img())  // canonicalize to A_img, B_val
         A_.swap(B_);
@@ -172,10 +169,7 @@ ImageBufAlgo::mul(ImageBuf& dst, Image_or_Const A_, Image_or_Const B_, ROI roi,
             dst.deepdata()->set_all_samples(A.deepdata()->all_samples());
             return mul_impl_deep(dst, A, b, roi, nthreads);
         }
-        bool ok;
-        OIIO_DISPATCH_COMMON_TYPES2(ok, "mul", mul_impl, dst.spec().format,
-                                    A.spec().format, dst, A, b, roi, nthreads);
-        return ok;
+        return mul_impl(dst, A, b, roi, nthreads);
     }
     // Remaining cases: error
     dst.errorfmt("ImageBufAlgo::mul(): at least one argument must be an image");
@@ -196,21 +190,22 @@ ImageBufAlgo::mul(Image_or_Const A, Image_or_Const B, ROI roi, int nthreads)
 
 
 
-template<class Rtype, class Atype, class Btype>
 static bool
 div_impl(ImageBuf& R, const ImageBuf& A, const ImageBuf& B, ROI roi,
          int nthreads)
 {
-    ImageBufAlgo::parallel_image(roi, nthreads, [&](ROI roi) {
-        ImageBuf::Iterator<Rtype> r(R, roi);
-        ImageBuf::ConstIterator<Atype> a(A, roi);
-        ImageBuf::ConstIterator<Btype> b(B, roi);
-        for (; !r.done(); ++r, ++a, ++b)
-            for (int c = roi.chbegin; c < roi.chend; ++c) {
-                float v = b[c];
-                r[c]    = (v == 0.0f) ? 0.0f : (a[c] / v);
-            }
-    });
+    // The compiler won't vectorize the divide-unless-zero loop on its
+    // own, so do it explicitly.
+    ImageBufAlgo::rowop_image(R, A, B, roi, nthreads,
+                              [](float* r, const float* a, const float* b,
+                                 size_t n) {
+                                  ImageBufAlgo::simd_row(
+                                      r, n,
+                                      [](auto x, auto y) {
+                                          return simd::safe_div(x, y);
+                                      },
+                                      a, b);
+                              });
     return true;
 }
 
@@ -225,11 +220,7 @@ ImageBufAlgo::div(ImageBuf& dst, Image_or_Const A_, Image_or_Const B_, ROI roi,
         const ImageBuf &A(A_.img()), &B(B_.img());
         if (!IBAprep(roi, &dst, &A, &B, IBAprep_CLAMP_MUTUAL_NCHANNELS))
             return false;
-        bool ok;
-        OIIO_DISPATCH_COMMON_TYPES3(ok, "div", div_impl, dst.spec().format,
-                                    A.spec().format, B.spec().format, dst, A, B,
-                                    roi, nthreads);
-        return ok;
+        return div_impl(dst, A, B, roi, nthreads);
     }
     if (A_.is_val() && B_.is_img())  // canonicalize to A_img, B_val
         A_.swap(B_);
@@ -252,10 +243,7 @@ ImageBufAlgo::div(ImageBuf& dst, Image_or_Const A_, Image_or_Const B_, ROI roi,
             dst.deepdata()->set_all_samples(A.deepdata()->all_samples());
             return mul_impl_deep(dst, A, b, roi, nthreads);
         }
-        bool ok;
-        OIIO_DISPATCH_COMMON_TYPES2(ok, "div", mul_impl, dst.spec().format,
-                                    A.spec().format, dst, A, b, roi, nthreads);
-        return ok;
+        return mul_impl(dst, A, b, roi, nthreads);
     }
     // Remaining cases: error
     dst.errorfmt("ImageBufAlgo::div(): at least one argument must be an image");
@@ -19,41 +19,38 @@
 #include <OpenImageIO/imagebufalgo_util.h>
 #include <OpenImageIO/simd.h>
 
+#include "imagebufalgo_rowops_prv.h"
 #include "imageio_pvt.h"
 
 
 OIIO_NAMESPACE_3_1_BEGIN
 
 
-template<class Rtype, class Atype, class Btype>
 static bool
 min_impl(ImageBuf& R, const ImageBuf& A, const ImageBuf& B, ROI roi,
          int nthreads)
 {
-    ImageBufAlgo::parallel_image(roi, nthreads, [&](ROI roi) {
-        ImageBuf::Iterator<Rtype> r(R, roi);
-        ImageBuf::ConstIterator<Atype> a(A, roi);
-        ImageBuf::ConstIterator<Btype> b(B, roi);
-        for (; !r.done(); ++r, ++a, ++b)
-            for (int c = roi.chbegin; c < roi.chend; ++c)
-                r[c] = std::min(a[c], b[c]);
-    });
+    ImageBufAlgo::rowop_image(R, A, B, roi, nthreads,
+                              [](float* r, const float* a, const float* b,
+                                 size_t n) {
+                                  for (size_t i = 0; i < n; ++i)
+                                      r[i] = std::min(a[i], b[i]);
+                              });
     return true;
 }
 
 
 
-template<class Rtype, class Atype>
 static bool
 min_impl(ImageBuf& R, const ImageBuf& A, cspan<float> b, ROI roi, int nthreads)
 {
-    ImageBufAlgo::parallel_image(roi, nthreads, [&](ROI roi) {
-        ImageBuf::Iterator<Rtype> r(R, roi);
-        ImageBuf::ConstIterator<Atype> a(A, roi);
-        for (; !r.done(); ++r, ++a)
-            for (int c = roi.chbegin; c < roi.chend; ++c)
-                r[c] = std::min(a[c], b[c]);
-    });
+    std::vector<float> brow = ImageBufAlgo::perchannel_row(b, roi);
+    ImageBufAlgo::rowop_image(R, A, roi, nthreads,
+                              [&](float* r, const float* a, size_t n) {
+                                  const float* bv = brow.data();
+                                  for (size_t i = 0; i < n; ++i)
+                                      r[i] = std::min(a[i], bv[i]);
+                              });
     return true;
 }
 
@@ -70,10 +67,7 @@ ImageBufAlgo::min(ImageBuf& dst, Image_or_Const A_, Image_or_Const B_, ROI roi,
             return false;
         ROI origroi = roi;
         roi.chend = std::min(roi.chend, std::min(A.nchannels(), B.nchannels()));
-        bool ok;
-        OIIO_DISPATCH_COMMON_TYPES3(ok, "min", min_impl, dst.spec().format,
-                                    A.spec().format, B.spec().format, dst, A, B,
-                                    roi, nthreads);
+        bool ok = min_impl(dst, A, B, roi, nthreads);
         if (roi.chend < origroi.chend && A.nchannels() != B.nchannels()) {
             // Edge case: A and B differed in nchannels, we allocated dst to be
             // the bigger of them, but adjusted roi to be the lesser. Now handle
@@ -98,10 +92,7 @@ ImageBufAlgo::min(ImageBuf& dst, Image_or_Const A_, Image_or_Const B_, ROI roi,
         if (!IBAprep(roi, &dst, &A, IBAprep_CLAMP_MUTUAL_NCHANNELS))
             return false;
         IBA_FIX_PERCHAN_LEN_DEF(b, A.nchannels());
-        bool ok;
-        OIIO_DISPATCH_COMMON_TYPES2(ok, "min", min_impl, dst.spec().format,
-                                    A.spec().format, dst, A, b, roi, nthreads);
-        return ok;
+        return min_impl(dst, A, b, roi, nthreads);
     }
     // Remaining cases: error
     dst.errorfmt("ImageBufAlgo::min(): at least one argument must be an image");
@@ -122,35 +113,31 @@ ImageBufAlgo::min(Image_or_Const A, Image_or_Const B, ROI roi, int nthreads)
 
 
 
-template<class Rtype, class Atype, class Btype>
 static bool
 max_impl(ImageBuf& R, const ImageBuf& A, const ImageBuf& B, ROI roi,
          int nthreads)
 {
-    ImageBufAlgo::parallel_image(roi, nthreads, [&](ROI roi) {
-        ImageBuf::Iterator<Rtype> r(R, roi);
-        ImageBuf::ConstIterator<Atype> a(A, roi);
-        ImageBuf::ConstIterator<Btype> b(B, roi);
-        for (; !r.done(); ++r, ++a, ++b)
-            for (int c = roi.chbegin; c < roi.chend; ++c)
-                r[c] = std::max(a[c], b[c]);
-    });
+    ImageBufAlgo::rowop_image(R, A, B, roi, nthreads,
+                              [](float* r, const float* a, const float* b,
+                                 size_t n) {
+                                  for (size_t i = 0; i < n; ++i)
+                                      r[i] = std::max(a[i], b[i]);
+                              });
     return true;
 }
 
 
 
-template<class Rtype, class Atype>
 static bool
 max_impl(ImageBuf& R, const ImageBuf& A, cspan<float> b, ROI roi, int nthreads)
 {
-    ImageBufAlgo::parallel_image(roi, nthreads, [&](ROI roi) {
-        ImageBuf::Iterator<Rtype> r(R, roi);
-        ImageBuf::ConstIterator<Atype> a(A, roi);
-        for (; !r.done(); ++r, ++a)
-            for (int c = roi.chbegin; c < roi.chend; ++c)
-                r[c] = std::max(a[c], b[c]);
-    });
+    std::vector<float> brow = ImageBufAlgo::perchannel_row(b, roi);
+    ImageBufAlgo::rowop_image(R, A, roi, nthreads,
+                              [&](float* r, const float* a, size_t n) {
+                                  const float* bv = brow.data();
+                                  for (size_t i = 0; i < n; ++i)
+                                      r[i] = std::max(a[i], bv[i]);
+                              });
     return true;
 }
 
@@ -166,11 +153,8 @@ ImageBufAlgo::max(ImageBuf& dst, Image_or_Const A_, Image_or_Const B_, ROI roi,
         if (!IBAprep(roi, &dst, &A, &B))
             return false;
         ROI origroi = roi;
-        roi.chend = std::max(roi.chend, std::max(A.nchannels(), B.nchannels()));
-        bool ok;
-        OIIO_DISPATCH_COMMON_TYPES3(ok, "max", max_impl, dst.spec().format,
-                                    A.spec().format, B.spec().format, dst, A, B,
-                                    roi, nthreads);
+        roi.chend = std::min(roi.chend, std::min(A.nchannels(), B.nchannels()));
+        bool ok = max_impl(dst, A, B, roi, nthreads);
         if (roi.chend < origroi.chend && A.nchannels() != B.nchannels()) {
             // Edge case: A and B differed in nchannels, we allocated dst to be
             // the bigger of them, but adjusted roi to be the lesser. Now handle
@@ -195,10 +179,7 @@ ImageBufAlgo::max(ImageBuf& dst, Image_or_Const A_, Image_or_Const B_, ROI roi,
         if (!IBAprep(roi, &dst, &A, IBAprep_CLAMP_MUTUAL_NCHANNELS))
             return false;
         IBA_FIX_PERCHAN_LEN_DEF(b, A.nchannels());
-        bool ok;
-        OIIO_DISPATCH_COMMON_TYPES2(ok, "max", max_impl, dst.spec().format,
-                                    A.spec().format, dst, A, b, roi, nthreads);
-        return ok;
+        return max_impl(dst, A, b, roi, nthreads);
     }
     // Remaining cases: error
     dst.errorfmt("ImageBufAlgo::max(): at least one argument must be an image");
@@ -219,23 +200,37 @@ ImageBufAlgo::max(Image_or_Const A, Image_or_Const B, ROI roi, int nthreads)
 
 
 
-template<class D, class S>
 static bool
-clamp_(ImageBuf& dst, const ImageBuf& src, const float* min, const float* max,
+clamp_(ImageBuf& dst, const ImageBuf& src, cspan<float> min, cspan<float> max,
        bool clampalpha01, ROI roi, int nthreads)
 {
-    ImageBufAlgo::parallel_image(roi, nthreads, [&](ROI roi) {
-        ImageBuf::ConstIterator<S> s(src, roi);
-        for (ImageBuf::Iterator<D> d(dst, roi); !d.done(); ++d, ++s) {
-            for (int c = roi.chbegin; c < roi.chend; ++c)
-                d[c] = OIIO::clamp<float>(s[c], min[c], max[c]);
-        }
-        int a = src.spec().alpha_channel;
-        if (clampalpha01 && a >= roi.chbegin && a < roi.chend) {
-            for (ImageBuf::Iterator<D> d(dst, roi); !d.done(); ++d)
-                d[a] = OIIO::clamp<float>(d[a], 0.0f, 1.0f);
-        }
-    });
+    roi.chend = std::min(roi.chend, src.nchannels());
+    // The alpha clamp is applied after the per-channel one, so express it
+    // as a second pair of per-channel bounds that are unbounded except for
+    // the alpha channel.
+    const float big = std::numeric_limits<float>::max();
+    std::vector<float> alphalo(dst.nchannels(), -big);
+    std::vector<float> alphahi(dst.nchannels(), big);
+    int a = src.spec().alpha_channel;
+    if (clampalpha01 && a >= roi.chbegin && a < roi.chend) {
+        alphalo[a] = 0.0f;
+        alphahi[a] = 1.0f;
+    }
+    std::vector<float> lorow  = ImageBufAlgo::perchannel_row(min, roi);
+    std::vector<float> hirow  = ImageBufAlgo::perchannel_row(max, roi);
+    std::vector<float> alorow = ImageBufAlgo::perchannel_row(alphalo, roi);
+    std::vector<float> ahirow = ImageBufAlgo::perchannel_row(alphahi, roi);
+    ImageBufAlgo::rowop_image(dst, src, roi, nthreads,
+                              [&](float* d, const float* s, size_t n) {
+                                  const float* lo  = lorow.data();
+                                  const float* hi  = hirow.data();
+                                  const float* alo = alorow.data();
+                                  const float* ahi = ahirow.data();
+                                  for (size_t i = 0; i < n; ++i) {
+                                      float v = OIIO::clamp(s[i], lo[i], hi[i]);
+                                      d[i] = OIIO::clamp(v, alo[i], ahi[i]);
+                                  }
+                              });
     return true;
 }
 
@@ -253,11 +248,7 @@ ImageBufAlgo::clamp(ImageBuf& dst, const ImageBuf& src, cspan<float> min,
                         -big);
     IBA_FIX_PERCHAN_LEN(max, dst.nchannels(), max.size() ? max.back() : big,
                         big);
-    bool ok;
-    OIIO_DISPATCH_COMMON_TYPES2(ok, "clamp", clamp_, dst.spec().format,
-                                src.spec().format, dst, src, min.data(),
-                                max.data(), clampalpha01, roi, nthreads);
-    return ok;
+    return clamp_(dst, src, min, max, clampalpha01, roi, nthreads);
 }
 
 
@@ -266,6 +257,7 @@ ImageBuf
 ImageBufAlgo::clamp(const ImageBuf& src, cspan<float> min, cspan<float> max,
                     bool clampalpha01, ROI roi, int nthreads)
 {
+    roi.chend = std::min(roi.chend, src.nchannels());
     ImageBuf result;
     bool ok = clamp(result, src, min, max, clampalpha01, roi, nthreads);
     if (!ok && !result.has_error())
@@ -275,35 +267,32 @@ ImageBufAlgo::clamp(const ImageBuf& src, cspan<float> min, cspan<float> max,
 
 
 
-template<class Rtype, class Atype, class Btype>
 static bool
 absdiff_impl(ImageBuf& R, const ImageBuf& A, const ImageBuf& B, ROI roi,
              int nthreads)
 {
-    ImageBufAlgo::parallel_image(roi, nthreads, [&](ROI roi) {
-        ImageBuf::Iterator<Rtype> r(R, roi);
-        ImageBuf::ConstIterator<Atype> a(A, roi);
-        ImageBuf::ConstIterator<Btype> b(B, roi);
-        for (; !r.done(); ++r, ++a, ++b)
-            for (int c = roi.chbegin; c < roi.chend; ++c)
-                r[c] = std::abs(a[c] - b[c]);
-    });
+    ImageBufAlgo::rowop_image(R, A, B, roi, nthreads,
+                              [](float* r, const float* a, const float* b,
+                                 size_t n) {
+                                  for (size_t i = 0; i < n; ++i)
+                                      r[i] = std::abs(a[i] - b[i]);
+                              });
     return true;
 }
 
 
-template<class Rtype, class Atype>
+
 static bool
 absdiff_impl(ImageBuf& R, const ImageBuf& A, cspan<float> b, ROI roi,
              int nthreads)
 {
-    ImageBufAlgo::parallel_image(roi, nthreads, [&](ROI roi) {
-        ImageBuf::Iterator<Rtype> r(R, roi);
-        ImageBuf::ConstIterator<Atype> a(A, roi);
-        for (; !r.done(); ++r, ++a)
-            for (int c = roi.chbegin; c < roi.chend; ++c)
-                r[c] = std::abs(a[c] - b[c]);
-    });
+    std::vector<float> brow = ImageBufAlgo::perchannel_row(b, roi);
+    ImageBufAlgo::rowop_image(R, A, roi, nthreads,
+                              [&](float* r, const float* a, size_t n) {
+                                  const float* bv = brow.data();
+                                  for (size_t i = 0; i < n; ++i)
+                                      r[i] = std::abs(a[i] - bv[i]);
+                              });
     return true;
 }
 
@@ -321,10 +310,7 @@ ImageBufAlgo::absdiff(ImageBuf& dst, Image_or_Const A_, Image_or_Const B_,
         const ImageBuf &A(A_.img()), &B(B_.img());
         ROI origroi = roi;
         roi.chend = std::min(roi.chend, std::min(A.nchannels(), B.nchannels()));
-        bool ok;
-        OIIO_DISPATCH_COMMON_TYPES3(ok, "absdiff", absdiff_impl,
-                                    dst.spec().format, A.spec().format,
-                                    B.spec().format, dst, A, B, roi, nthreads);
+        bool ok = absdiff_impl(dst, A, B, roi, nthreads);
         if (roi.chend < origroi.chend && A.nchannels() != B.nchannels()) {
             // Edge case: A and B differed in nchannels, we allocated dst to be
             // the bigger of them, but adjusted roi to be the lesser. Now handle
@@ -347,11 +333,7 @@ ImageBufAlgo::absdiff(ImageBuf& dst, Image_or_Const A_, Image_or_Const B_,
         const ImageBuf& A(A_.img());
         cspan<float> b = B_.val();
         IBA_FIX_PERCHAN_LEN_DEF(b, A.nchannels());
-        bool ok;
-        OIIO_DISPATCH_COMMON_TYPES2(ok, "absdiff", absdiff_impl,
-                                    dst.spec().format, A.spec().format, dst, A,
-                                    b, roi, nthreads);
-        return ok;
+        return absdiff_impl(dst, A, b, roi, nthreads);
     }
     // Remaining cases: error
     dst.errorfmt(
@@ -394,16 +376,16 @@ ImageBufAlgo::abs(const ImageBuf& A, ROI roi, int nthreads)
 
 
 
-template<class Rtype, class Atype>
 static bool
 pow_impl(ImageBuf& R, const ImageBuf& A, cspan<float> b, ROI roi, int nthreads)
 {
-    ImageBufAlgo::parallel_image(roi, nthreads, [&](ROI roi) {
-        ImageBuf::ConstIterator<Atype> a(A, roi);
-        for (ImageBuf::Iterator<Rtype> r(R, roi); !r.done(); ++r, ++a)
-            for (int c = roi.chbegin; c < roi.chend; ++c)
-                r[c] = pow(a[c], b[c]);
-    });
+    std::vector<float> brow = ImageBufAlgo::perchannel_row(b, roi);
+    ImageBufAlgo::rowop_image(R, A, roi, nthreads,
+                              [&](float* r, const float* a, size_t n) {
+                                  const float* bv = brow.data();
+                                  for (size_t i = 0; i < n; ++i)
+                                      r[i] = std::pow(a[i], bv[i]);
+                              });
     return true;
 }
 
@@ -416,10 +398,7 @@ ImageBufAlgo::pow(ImageBuf& dst, const ImageBuf& A, cspan<float> b, ROI roi,
     if (!IBAprep(roi, &dst, &A, IBAprep_CLAMP_MUTUAL_NCHANNELS))
         return false;
     IBA_FIX_PERCHAN_LEN_DEF(b, dst.nchannels());
-    bool ok;
-    OIIO_DISPATCH_COMMON_TYPES2(ok, "pow", pow_impl, dst.spec().format,
-                                A.spec().format, dst, A, b, roi, nthreads);
-    return ok;
+    return pow_impl(dst, A, b, roi, nthreads);
 }
 
 
@@ -0,0 +1,137 @@
+// Copyright Contributors to the OpenImageIO project.
+// SPDX-License-Identifier: Apache-2.0
+// https://github.com/AcademySoftwareFoundation/OpenImageIO
+
+
+#pragma once
+
+#include <vector>
+
+#include <OpenImageIO/dassert.h>
+#include <OpenImageIO/imagebuf.h>
+#include <OpenImageIO/imagebufalgo_util.h>
+#include <OpenImageIO/simd.h>
+
+OIIO_NAMESPACE_3_1_BEGIN
+
+namespace ImageBufAlgo {
+
+// Helpers for pointwise IBA operations written as row kernels. Every image
+// is presented as contiguous float scanlines (via ImageBuf::RowSpans and
+// ConstRowSpans) of n = roi.width() * roi.nchannels() values, and `rowop`
+// is called once per scanline as rowop(r, a, [b, [c,]] n). Because the
+// kernel only sees flat float arrays, it is a plain loop over n values,
+// and no per-pixel-type template instantiations are needed: conversion to
+// and from the images' own pixel types happens a row at a time (or not at
+// all, for float buffers whose memory is already in the right layout).
+// Callers must have clamped roi.chend to the channel count of every image
+// involved.
+
+template<class RowOp>
+inline void
+rowop_image(ImageBuf& R, const ImageBuf& A, ROI roi, int nthreads,
+            RowOp&& rowop)
+{
+    OIIO_DASSERT(roi.chend <= R.nchannels() && roi.chend <= A.nchannels());
+    parallel_image(roi, nthreads, [&](ROI roi) {
+        ImageBuf::RowSpans<float> r(R, roi);
+        ImageBuf::ConstRowSpans<float> a(A, roi);
+        size_t n = size_t(roi.width()) * size_t(roi.nchannels());
+        for (int z = roi.zbegin; z < roi.zend; ++z)
+            for (int y = roi.ybegin; y < roi.yend; ++y) {
+                const float* ap = a(y, z).data();
+                rowop(r(y, z).data(), ap, n);
+            }
+    });
+}
+
+
+
+template<class RowOp>
+inline void
+rowop_image(ImageBuf& R, const ImageBuf& A, const ImageBuf& B, ROI roi,
+            int nthreads, RowOp&& rowop)
+{
+    OIIO_DASSERT(roi.chend <= R.nchannels() && roi.chend <= A.nchannels()
+                 && roi.chend <= B.nchannels());
+    parallel_image(roi, nthreads, [&](ROI roi) {
+        ImageBuf::RowSpans<float> r(R, roi);
+        ImageBuf::ConstRowSpans<float> a(A, roi), b(B, roi);
+        size_t n = size_t(roi.width()) * size_t(roi.nchannels());
+        for (int z = roi.zbegin; z < roi.zend; ++z)
+            for (int y = roi.ybegin; y < roi.yend; ++y) {
+                const float* ap = a(y, z).data();
+                const float* bp = b(y, z).data();
+                rowop(r(y, z).data(), ap, bp, n);
+            }
+    });
+}
+
+
+
+template<class RowOp>
+inline void
+rowop_image(ImageBuf& R, const ImageBuf& A, const ImageBuf& B,
+            const ImageBuf& C, ROI roi, int nthreads, RowOp&& rowop)
+{
+    OIIO_DASSERT(roi.chend <= R.nchannels() && roi.chend <= A.nchannels()
+                 && roi.chend <= B.nchannels() && roi.chend <= C.nchannels());
+    parallel_image(roi, nthreads, [&](ROI roi) {
+        ImageBuf::RowSpans<float> r(R, roi);
+        ImageBuf::ConstRowSpans<float> a(A, roi), b(B, roi), c(C, roi);
+        size_t n = size_t(roi.width()) * size_t(roi.nchannels());
+        for (int z = roi.zbegin; z < roi.zend; ++z)
+            for (int y = roi.ybegin; y < roi.yend; ++y) {
+                const float* ap = a(y, z).data();
+                const float* bp = b(y, z).data();
+                const float* cp = c(y, z).data();
+                rowop(r(y, z).data(), ap, bp, cp, n);
+            }
+    });
+}
+
+
+
+// Compute r[i] = op(src[i]...) for the n values of a row, a native-width
+// SIMD float vector (vfloat8 with AVX, otherwise vfloat4) at a time, with
+// `op` taking and returning that vector type. The last partial vector is
+// loaded and stored with only its remaining values. Plain loops of simple
+// arithmetic, min/max, and clamps are auto-vectorized just as well at -O3,
+// so this is only worth using for kernels the compiler won't vectorize,
+// such as ones with a per-value branch.
+template<class Op, class... Src>
+OIIO_FORCEINLINE void
+simd_row(float* r, size_t n, Op&& op, const Src*... src)
+{
+    using vfloat = simd::VecType<float, OIIO_SIMD_AVX ? 8 : 4>::type;
+    size_t i     = 0;
+    for (; i + vfloat::elements <= n; i += vfloat::elements)
+        op(vfloat(src + i)...).store(r + i);
+    if (i < n) {
+        int rest  = int(n - i);
+        auto load = [&](const float* p) {
+            vfloat v;
+            v.load(p, rest);
+            return v;
+        };
+        op(load(src + i)...).store(r + i, rest);
+    }
+}
+
+
+
+// Expand per-channel values (indexed by absolute channel number) into a
+// full scanline's worth of values for `roi`, so that a per-channel constant
+// operand can be consumed by a row kernel exactly like an image row.
+inline std::vector<float>
+perchannel_row(cspan<float> vals, ROI roi)
+{
+    std::vector<float> row(size_t(roi.width()) * size_t(roi.nchannels()));
+    for (size_t i = 0, nc = size_t(roi.nchannels()); i < row.size(); ++i)
+        row[i] = vals[roi.chbegin + int(i % nc)];
+    return row;
+}
+
+}  // namespace ImageBufAlgo
+
+OIIO_NAMESPACE_3_1_END
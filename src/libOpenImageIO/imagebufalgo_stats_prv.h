@@ -0,0 +1,105 @@
+// Copyright Contributors to the OpenImageIO project.
+// SPDX-License-Identifier: Apache-2.0
+// https://github.com/AcademySoftwareFoundation/OpenImageIO
+
+
+#pragma once
+
+#include <limits>
+#include <vector>
+
+#include <OpenImageIO/imagebuf.h>
+#include <OpenImageIO/imagebufalgo.h>
+#include <OpenImageIO/simd.h>
+
+OIIO_NAMESPACE_3_1_BEGIN
+
+namespace ImageBufAlgo {
+
+// Incremental, single pass accumulator of everything computePixelStats
+// reports for each channel -- min, max, NaN/Inf/finite counts, sum and sum
+// of squares -- fed with rows of interleaved float pixels.
+//
+// Each add() call runs over its values four at a time. Lane j of the k-th
+// vector of a group of nchannels vectors always holds channel (4k+j) % nc,
+// so per-lane accumulators can be folded back into channels at the end of
+// the call without any shuffling. Sums are Kahan-compensated within a call,
+// and the spread is computed as the sum of squared deviations from the
+// call's own mean (a second, cache-hot pass over the same values), then
+// combined across calls and threads with Chan's parallel update -- so the
+// standard deviation doesn't suffer the cancellation of sum2/n - avg^2.
+//
+// Optionally, it also tracks whether every pixel seen is identical to the
+// first (isConstantColor with 0 threshold) and whether every pixel has all
+// channels equal (isMonochrome with 0 threshold), so that a caller like
+// `iinfo --stats` can get all of them from one pass over the pixels. Those
+// use the same exact comparisons as isConstantColor and isMonochrome, so a
+// NaN anywhere makes an image of more than one pixel non-constant (and a
+// NaN next to any other channel value makes it non-monochrome).
+class PixelStatsAccumulator {
+public:
+    explicit PixelStatsAccumulator(int nchannels = 0,
+                                   bool track_constancy = false)
+    {
+        reset(nchannels, track_constancy);
+    }
+
+    void reset(int nchannels, bool track_constancy = false);
+    int nchannels() const { return m_nchannels; }
+    bool tracking_constancy() const { return m_track; }
+
+    // Add `npixels` pixels of nchannels() interleaved float values.
+    void add(const float* values, size_t npixels);
+
+    // Fold in the results of another accumulator (for example, one run by
+    // another thread over a different part of the image).
+    void merge(const PixelStatsAccumulator& other);
+
+    // Store the results for our channels into stats channels
+    // [firstchan, firstchan+nchannels()), which must already be sized.
+    void finalize(PixelStats& stats, int firstchan = 0) const;
+
+    // Constancy tracking (only meaningful if track_constancy was true).
+    bool constant() const { return m_constant || m_npixels == 1; }
+    bool monochrome() const { return m_monochrome; }
+    const std::vector<float>& first_pixel() const { return m_first; }
+
+private:
+    struct Channel {
+        float min = std::numeric_limits<float>::infinity();
+        float max = -std::numeric_limits<float>::infinity();
+        imagesize_t nan = 0, inf = 0, finite = 0;
+        double sum = 0.0;   // sum of finite values
+        double mean = 0.0;  // mean of finite values
+        double m2 = 0.0;    // sum of squared deviations from the mean
+    };
+    // Combine a partial result (count, sum, mean, m2) into channel c.
+    void combine(Channel& c, imagesize_t n, double sum, double mean,
+                 double m2);
+
+    int m_nchannels       = 0;
+    bool m_track          = false;
+    bool m_constant       = true;
+    bool m_monochrome     = true;
+    imagesize_t m_npixels = 0;
+    std::vector<Channel> m_chan;
+    std::vector<float> m_first;  // first pixel seen, if tracking
+    // Per-call scratch, kept to avoid reallocating for every row
+    std::vector<simd::vfloat4> m_vmin, m_vmax, m_vsum, m_vcomp, m_vfirst;
+    std::vector<simd::vint4> m_vfinite, m_vnan;
+    std::vector<double> m_rowsum, m_rowm2;
+    std::vector<imagesize_t> m_rowfinite, m_rownan, m_rowcount;
+};
+
+
+
+// Accumulate the stats of the non-deep image `src` over `roi` (whose
+// channel range the accumulator must match) into `acc`, in parallel, a
+// row at a time. Return false if there was an error reading pixels.
+bool
+accumulate_pixel_stats(PixelStatsAccumulator& acc, const ImageBuf& src,
+                       ROI roi, int nthreads);
+
+}  // namespace ImageBufAlgo
+
+OIIO_NAMESPACE_3_1_END
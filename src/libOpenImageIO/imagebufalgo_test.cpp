@@ -6,6 +6,7 @@
 #include <cstdio>
 #include <iomanip>
 #include <iostream>
+#include <sstream>
 #include <string>
 
 // Must be first to ensure that half is defined before typedesc.h included
@@ -13,9 +14,11 @@
 
 #include <OpenImageIO/platform.h>
 
+#include <OpenImageIO/Imath.h>
 #include <OpenImageIO/argparse.h>
 #include <OpenImageIO/benchmark.h>
 #include <OpenImageIO/color.h>
+#include <OpenImageIO/deepdata.h>
 #include <OpenImageIO/filesystem.h>
 #include <OpenImageIO/half.h>
 #include <OpenImageIO/imagebuf.h>
@@ -27,6 +30,7 @@
 #include <OpenImageIO/unittest.h>
 
 #include "imagebufalgo_demosaic_prv.h"
+#include "imageio_pvt.h"
 
 #if USE_OPENCV
 #    include <OpenImageIO/imagebufalgo_opencv.h>
@@ -507,6 +511,25 @@ test_mad()
     ImageBufAlgo::mad(D, A, cspan<float>(Bval), cspan<float>(Cval));
     auto comp = ImageBufAlgo::compare(R, D, 1e-6f, 1e-6f);
     OIIO_CHECK_EQUAL(comp.maxerror, 0.0f);
+
+    // Mixed pixel types, with a half image, a constant, and a float image
+    ImageBuf Ah(ImageSpec(WIDTH, HEIGHT, CHANNELS, TypeHalf));
+    ImageBufAlgo::fill(Ah, cspan<float>(Aval));
+    ImageBuf E = ImageBufAlgo::mad(Ah, cspan<float>(Bval), C);
+    comp       = ImageBufAlgo::compare(R, E, 1e-3f, 1e-3f);
+    OIIO_CHECK_EQUAL(comp.nfail, 0);
+
+    // Channel subset written into a uint8 image leaves the other channels
+    ImageBuf F(ImageSpec(WIDTH, HEIGHT, CHANNELS, TypeUInt8));
+    ImageBufAlgo::zero(F);
+    ImageBufAlgo::mad(F, A, cspan<float>(Bval), C,
+                      ROI(0, WIDTH, 0, HEIGHT, 0, 1, 1, 3));
+    OIIO_CHECK_EQUAL(F.getchannel(1, 1, 0, 0), 0.0f);
+    OIIO_CHECK_EQUAL_THRESH(F.getchannel(1, 1, 0, 1),
+                            Aval[1] * Bval[1] + Cval[1], 1.0f / 255.0f);
+    OIIO_CHECK_EQUAL_THRESH(F.getchannel(1, 1, 0, 2),
+                            Aval[2] * Bval[2] + Cval[2], 1.0f / 255.0f);
+    OIIO_CHECK_EQUAL(F.getchannel(1, 1, 0, 3), 0.0f);
 }
 
 
@@ -641,6 +664,228 @@ test_zover()
 
 
 
+// Test the columnar DeepData view and the deep operations built on it
+void
+test_deep_columns()
+{
+    std::cout << "test deep columns\n";
+
+    ImageSpec spec(2, 1, 6, TypeFloat);
+    spec.channelnames.assign({ "R", "G", "B", "A", "Z", "id" });
+    spec.channelformats.assign({ TypeFloat, TypeHalf, TypeFloat, TypeFloat,
+                                 TypeFloat, TypeUInt32 });
+    spec.alpha_channel = 3;
+    spec.z_channel     = 4;
+    spec.deep          = true;
+    DeepData dd(spec);
+
+    // Pixel 0: four samples out of depth order, two overlapping exactly at
+    // z == 5. Pixel 1: empty.
+    const float z[]     = { 5.0f, 2.0f, 5.0f, 9.0f };
+    const float alpha[] = { 0.25f, 0.5f, 0.25f, 1.0f };
+    dd.set_samples(0, 4);
+    for (int s = 0; s < 4; ++s) {
+        for (int c = 0; c < 3; ++c)
+            dd.set_deep_value(0, c, s, alpha[s] * 0.5f);
+        dd.set_deep_value(0, 3, s, alpha[s]);
+        dd.set_deep_value(0, 4, s, z[s]);
+        dd.set_deep_value(0, 5, s, uint32_t(0xabcd0000 + s));
+    }
+
+    DeepData::Columns cols;
+    dd.get_columns(cols);
+    OIIO_CHECK_EQUAL(cols.pixels(), 2);
+    OIIO_CHECK_EQUAL(cols.total_samples(), 4);
+    OIIO_CHECK_EQUAL(cols.samples(0), 4);
+    OIIO_CHECK_EQUAL(cols.samples(1), 0);
+    OIIO_CHECK_EQUAL(cols.values(4, 0)[1], 2.0f);
+    OIIO_CHECK_EQUAL(cols.values(1, 0)[0], 0.125f);
+    OIIO_CHECK_EQUAL(bitcast<uint32_t>(cols.values(5, 0)[3]), 0xabcd0003);
+
+    // Bulk rebuild: give pixel 1 a copy of pixel 0's second sample
+    for (auto& ch : cols.channel)
+        ch.push_back(ch[1]);
+    cols.offsets[2] = 5;
+    OIIO_CHECK_ASSERT(dd.set_columns(cols));
+    OIIO_CHECK_EQUAL(dd.samples(1), 1);
+    OIIO_CHECK_EQUAL(dd.capacity(1), 1);
+    OIIO_CHECK_EQUAL(dd.deep_value(1, 4, 0), 2.0f);
+    OIIO_CHECK_EQUAL(dd.deep_value_uint(1, 5, 0), 0xabcd0001);
+    cols.offsets.pop_back();
+    OIIO_CHECK_ASSERT(!dd.set_columns(cols));  // wrong number of pixels
+
+    // Sort, then merge the z == 5 pair
+    dd.sort(0);
+    OIIO_CHECK_EQUAL(dd.deep_value(0, 4, 0), 2.0f);
+    OIIO_CHECK_EQUAL(dd.deep_value(0, 4, 1), 5.0f);
+    OIIO_CHECK_EQUAL(dd.deep_value(0, 4, 2), 5.0f);
+    OIIO_CHECK_EQUAL(dd.deep_value(0, 4, 3), 9.0f);
+    OIIO_CHECK_EQUAL(dd.deep_value_uint(0, 5, 1), 0xabcd0000);
+    dd.merge_overlaps(0);
+    OIIO_CHECK_EQUAL(dd.samples(0), 3);
+    OIIO_CHECK_EQUAL(dd.deep_value(0, 3, 1), 0.4375f);
+    OIIO_CHECK_EQUAL(dd.deep_value(0, 4, 2), 9.0f);
+    OIIO_CHECK_EQUAL(dd.deep_value_uint(0, 5, 2), 0xabcd0003);
+
+    // Make the middle sample opaque and cull behind it
+    dd.set_deep_value(0, 3, 1, 1.0f);
+    dd.occlusion_cull(0);
+    OIIO_CHECK_EQUAL(dd.samples(0), 2);
+
+    // UINT32 color and alpha are merged and culled by the values that
+    // deep_value() returns, not by their bits.
+    ImageSpec uspec(1, 1, 3, TypeUInt32);
+    uspec.channelnames.assign({ "R", "A", "Z" });
+    uspec.channelformats.assign({ TypeUInt32, TypeUInt32, TypeFloat });
+    uspec.alpha_channel = 1;
+    uspec.z_channel     = 2;
+    uspec.deep          = true;
+    DeepData udd(uspec);
+    const float ured[] = { 0.25f, 0.75f, 0.5f };
+    const float uz[]   = { 1.0f, 1.0f, 2.0f };
+    udd.set_samples(0, 3);
+    for (int s = 0; s < 3; ++s) {
+        udd.set_deep_value(0, 0, s, ured[s]);
+        udd.set_deep_value(0, 1, s, 1.0f);
+        udd.set_deep_value(0, 2, s, uz[s]);
+    }
+    udd.merge_overlaps(0);
+    OIIO_CHECK_EQUAL(udd.samples(0), 2);
+    OIIO_CHECK_EQUAL_THRESH(udd.deep_value(0, 0, 0), 0.5f, 1.0e-6f);
+    OIIO_CHECK_EQUAL(udd.deep_value_uint(0, 1, 0), 0xffffffff);
+    OIIO_CHECK_EQUAL(udd.deep_value(0, 2, 1), 2.0f);
+    udd.occlusion_cull(0);
+    OIIO_CHECK_EQUAL(udd.samples(0), 1);
+
+    // Flatten: two half-transparent samples over each other, and an empty
+    // pixel.
+    ImageSpec fspec(2, 1, 5, TypeFloat);
+    fspec.channelnames.assign({ "R", "G", "B", "A", "Z" });
+    fspec.alpha_channel = 3;
+    fspec.z_channel     = 4;
+    fspec.deep          = true;
+    ImageBuf deep(fspec);
+    deep.set_deep_samples(0, 0, 0, 2);
+    for (int s = 0; s < 2; ++s) {
+        for (int c = 0; c < 4; ++c)
+            deep.set_deep_value(0, 0, 0, c, s, 0.5f);
+        deep.set_deep_value(0, 0, 0, 4, s, float(s + 1));
+    }
+    ImageBuf flat = ImageBufAlgo::flatten(deep);
+    OIIO_CHECK_EQUAL(flat.getchannel(0, 0, 0, 0), 0.75f);
+    OIIO_CHECK_EQUAL(flat.getchannel(0, 0, 0, 3), 0.75f);
+    OIIO_CHECK_EQUAL(flat.getchannel(0, 0, 0, 4), 1.5f);
+    OIIO_CHECK_EQUAL(flat.getchannel(1, 0, 0, 0), 0.0f);
+    OIIO_CHECK_EQUAL(flat.getchannel(1, 0, 0, 4), 1.0e30f);
+}
+
+
+
+// Test deep_merge and deep_holdout, and flattening unsorted samples
+void
+test_deep_merge()
+{
+    std::cout << "test deep merge\n";
+
+    ImageSpec spec(64, 64, 6, TypeFloat);
+    spec.channelnames.assign({ "R", "G", "B", "A", "Z", "Zback" });
+    spec.alpha_channel = 3;
+    spec.z_channel     = 4;
+    spec.deep          = true;
+    // A: one volume sample per pixel spanning [1,3]. B: one spanning
+    // [2,4], which only partly overlaps A's, so merging splits both.
+    auto make = [&](float zf, float zb, float a) {
+        ImageBuf buf(spec);
+        for (int y = 0; y < spec.height; ++y)
+            for (int x = 0; x < spec.width; ++x) {
+                buf.set_deep_samples(x, y, 0, 1);
+                for (int c = 0; c < 3; ++c)
+                    buf.set_deep_value(x, y, 0, c, 0, a * 0.5f);
+                buf.set_deep_value(x, y, 0, 3, 0, a);
+                buf.set_deep_value(x, y, 0, 4, 0, zf);
+                buf.set_deep_value(x, y, 0, 5, 0, zb);
+            }
+        return buf;
+    };
+    ImageBuf A = make(1.0f, 3.0f, 0.5f);
+    ImageBuf B = make(2.0f, 4.0f, 0.5f);
+    ImageBuf M = ImageBufAlgo::deep_merge(A, B);
+    OIIO_CHECK_ASSERT(!M.has_error());
+    // Expect [1,2] [2,3] (A and B merged) [3,4]
+    for (int y = 0; y < spec.height; y += 7)
+        for (int x = 0; x < spec.width; x += 5) {
+            OIIO_CHECK_EQUAL(M.deep_samples(x, y, 0), 3);
+            OIIO_CHECK_EQUAL(M.deep_value(x, y, 0, 4, 1), 2.0f);
+            OIIO_CHECK_EQUAL(M.deep_value(x, y, 0, 5, 1), 3.0f);
+            OIIO_CHECK_EQUAL(M.deep_value(x, y, 0, 4, 2), 3.0f);
+        }
+
+    // Flattening B over A unmerged, with the samples in the wrong order,
+    // must match flattening the properly merged result.
+    ImageBuf U(spec);
+    for (int y = 0; y < spec.height; ++y)
+        for (int x = 0; x < spec.width; ++x) {
+            U.set_deep_samples(x, y, 0, 2);
+            U.deepdata()->copy_deep_sample(U.pixelindex(x, y, 0), 0,
+                                           *B.deepdata(),
+                                           B.pixelindex(x, y, 0), 0);
+            U.deepdata()->copy_deep_sample(U.pixelindex(x, y, 0), 1,
+                                           *A.deepdata(),
+                                           A.pixelindex(x, y, 0), 0);
+        }
+    ImageBuf Mflat = ImageBufAlgo::flatten(M);
+    ImageBuf Uflat = ImageBufAlgo::flatten(U);
+    auto comp      = ImageBufAlgo::compare(Mflat, Uflat, 1.0e-6f, 1.0e-6f);
+    OIIO_CHECK_EQUAL(comp.nfail, 0);
+
+    // Hold out everything behind z == 2.5 (a flat-ish threshold made from
+    // an opaque sample there).
+    ImageBuf T = make(2.5f, 2.5f, 1.0f);
+    ImageBuf H = ImageBufAlgo::deep_holdout(M, T);
+    OIIO_CHECK_ASSERT(!H.has_error());
+    OIIO_CHECK_EQUAL(H.deep_samples(3, 3, 0), 2);
+    OIIO_CHECK_EQUAL(H.deep_value(3, 3, 0, 5, 1), 2.5f);
+
+    // The streaming, band-at-a-time version must match the in-memory one
+    A.write("deep_merge_A.exr");
+    B.write("deep_merge_B.exr");
+    OIIO_CHECK_ASSERT(ImageBufAlgo::deep_merge_file("deep_merge_out.exr",
+                                                    "deep_merge_A.exr",
+                                                    "deep_merge_B.exr", true,
+                                                    true /*flatten*/, 5));
+    ImageBuf streamed("deep_merge_out.exr");
+    comp = ImageBufAlgo::compare(streamed, Mflat, 1.0e-6f, 1.0e-6f);
+    OIIO_CHECK_EQUAL(comp.nfail, 0);
+    OIIO_CHECK_ASSERT(!ImageBufAlgo::flatten_file("deep_merge_out.exr",
+                                                  "no_such_file.exr"));
+    OIIO_CHECK_ASSERT(OIIO::geterror().size());
+
+    // Deep output, from inputs tiled with different tile heights: the bands
+    // must fall on the tile boundaries of both (16 and 24 high, so bands
+    // of 48 scanlines).
+    A.set_write_tiles(16, 16);
+    B.set_write_tiles(24, 24);
+    A.write("deep_merge_A.exr");
+    B.write("deep_merge_B.exr");
+    OIIO_CHECK_ASSERT(ImageBufAlgo::deep_merge_file("deep_merge_out.exr",
+                                                    "deep_merge_A.exr",
+                                                    "deep_merge_B.exr", true,
+                                                    false /*flatten*/, 5));
+    ImageBuf streamed_deep("deep_merge_out.exr");
+    OIIO_CHECK_ASSERT(streamed_deep.deep());
+    for (int y = 0; y < spec.height; y += 7)
+        for (int x = 0; x < spec.width; x += 5)
+            OIIO_CHECK_EQUAL(streamed_deep.deep_samples(x, y, 0), 3);
+    comp = ImageBufAlgo::compare(ImageBufAlgo::flatten(streamed_deep), Mflat,
+                                 1.0e-6f, 1.0e-6f);
+    OIIO_CHECK_EQUAL(comp.nfail, 0);
+    for (auto f : { "deep_merge_A.exr", "deep_merge_B.exr",
+                    "deep_merge_out.exr" })
+        Filesystem::remove(f);
+}
+
+
+
 // Test ImageBuf::resample
 void
 test_resample()
@@ -863,6 +1108,111 @@ test_computePixelStats()
         OIIO_CHECK_EQUAL(stats.infcount[c], 0);
         OIIO_CHECK_EQUAL(stats.finitecount[c], 4);
     }
+
+    // An odd channel count and width, so that the SIMD lanes wrap around
+    // pixels unevenly, with a few non-finite values sprinkled in. Compare
+    // against a straightforward double precision computation.
+    const int w = 37, h = 19, nc = 5;
+    ImageBuf odd(ImageSpec(w, h, nc, TypeDesc::FLOAT));
+    ImageBufAlgo::noise(odd, "uniform", -2.0f, 3.0f, false /*mono*/, 42);
+    float nan = std::numeric_limits<float>::quiet_NaN();
+    float inf = std::numeric_limits<float>::infinity();
+    auto poke = [&](int x, int y, int c, float v) {
+        float pixel[nc];
+        odd.getpixel(x, y, pixel, nc);
+        pixel[c] = v;
+        odd.setpixel(x, y, pixel, nc);
+    };
+    poke(3, 4, 1, nan);
+    poke(30, 10, 1, inf);
+    poke(36, 18, 4, nan);
+    poke(0, 0, 4, -inf);
+    std::vector<double> sum(nc, 0.0), sum2(nc, 0.0);
+    std::vector<float> mn(nc, inf), mx(nc, -inf);
+    std::vector<int> nans(nc, 0), infs(nc, 0), finite(nc, 0);
+    for (ImageBuf::ConstIterator<float> p(odd); !p.done(); ++p) {
+        for (int c = 0; c < nc; ++c) {
+            float v = p[c];
+            if (std::isnan(v)) {
+                ++nans[c];
+            } else if (std::isinf(v)) {
+                ++infs[c];
+            } else {
+                ++finite[c];
+                sum[c] += v;
+                sum2[c] += double(v) * v;
+                mn[c] = std::min(mn[c], v);
+                mx[c] = std::max(mx[c], v);
+            }
+        }
+    }
+    stats = ImageBufAlgo::computePixelStats(odd);
+    for (int c = 0; c < nc; ++c) {
+        double avg = sum[c] / finite[c];
+        double var = sum2[c] / finite[c] - avg * avg;
+        OIIO_CHECK_EQUAL(stats.min[c], mn[c]);
+        OIIO_CHECK_EQUAL(stats.max[c], mx[c]);
+        OIIO_CHECK_EQUAL_THRESH(stats.avg[c], avg, 1e-5);
+        OIIO_CHECK_EQUAL_THRESH(stats.stddev[c], std::sqrt(var), 1e-5);
+        OIIO_CHECK_EQUAL(stats.nancount[c], nans[c]);
+        OIIO_CHECK_EQUAL(stats.infcount[c], infs[c]);
+        OIIO_CHECK_EQUAL(stats.finitecount[c], finite[c]);
+        OIIO_CHECK_EQUAL_THRESH(stats.sum[c], sum[c], 1e-3);
+        OIIO_CHECK_EQUAL_THRESH(stats.sum2[c], sum2[c], 1e-2);
+    }
+
+    // A channel subset only touches its own channels
+    stats = ImageBufAlgo::computePixelStats(odd, ROI(0, w, 0, h, 0, 1, 2, 4));
+    OIIO_CHECK_EQUAL(stats.finitecount[0], 0);
+    OIIO_CHECK_EQUAL(stats.finitecount[2], finite[2]);
+    OIIO_CHECK_EQUAL(stats.max[3], mx[3]);
+    OIIO_CHECK_EQUAL(stats.finitecount[4], 0);
+}
+
+
+
+// The constant and monochrome answers that the stats report (as printed
+// by iinfo --stats) gathers along the way must match isConstantColor and
+// isMonochrome, NaNs included.
+void
+test_stats_constancy()
+{
+    std::cout << "test stats constancy\n";
+    float nan = std::numeric_limits<float>::quiet_NaN();
+    auto check = [](const ImageBuf& img, string_view what) {
+        std::ostringstream report;
+        std::string err;
+        OIIO_CHECK_ASSERT(
+            pvt::print_stats(report, "", img, img.spec(), ROI(), err));
+        std::cout << "  " << what << "\n";
+        OIIO_CHECK_EQUAL(Strutil::contains(report.str(), "Constant: Yes"),
+                         ImageBufAlgo::isConstantColor(img));
+        OIIO_CHECK_EQUAL(Strutil::contains(report.str(), "Monochrome: Yes"),
+                         ImageBufAlgo::isMonochrome(img));
+    };
+    const float gray[3] = { 0.5f, 0.5f, 0.5f };
+    const float nanpix[3] = { nan, nan, nan };
+    const float rednan[3] = { 0.5f, nan, 0.5f };
+
+    // Wide enough for the SIMD groups plus a few leftover values per row
+    ImageBuf A(ImageSpec(13, 5, 3, TypeDesc::FLOAT));
+    ImageBufAlgo::fill(A, gray);
+    check(A, "constant gray");
+    A.setpixel(7, 3, rednan);
+    check(A, "gray with one NaN channel");
+    ImageBufAlgo::fill(A, nanpix);
+    check(A, "all NaN");
+
+    ImageBuf one(ImageSpec(1, 1, 3, TypeDesc::FLOAT));
+    one.setpixel(0, 0, nanpix);
+    check(one, "single NaN pixel");
+    one.setpixel(0, 0, rednan);
+    check(one, "single partly NaN pixel");
+
+    ImageBuf H(ImageSpec(13, 5, 3, TypeDesc::HALF));
+    ImageBufAlgo::fill(H, gray);
+    H.setpixel(12, 4, nanpix);
+    check(H, "half with a NaN pixel");
 }
 
 
@@ -1206,6 +1556,46 @@ test_color_management()
             OIIO::print("colorconvert error: {}\n", OIIO::geterror());
         OIIO_CHECK_EQUAL_THRESH(rgba[1], 0.735356983052449f, 1.0e-5);
     }
+
+    // 8 and 16 bit images may be converted by table lookup. Compare that to
+    // the direct computation: exactly for 1D tables of transforms without
+    // crosstalk (including with partial alphas, which bypass the tables),
+    // and closely for the 3D lattice used for crosstalk with "lut" mode 2.
+    auto check_lut = [](const ColorProcessor* proc, TypeDesc format,
+                        int lutmode, float eps) {
+        ImageBuf src(ImageSpec(640, 480, 4, format));
+        ImageBufAlgo::noise(src, "uniform", 0.0f, 1.0f, false, 1);
+        ImageBufAlgo::fill(src, { 0.3f, 0.6f, 0.9f, 0.0f }, ROI(0, 64, 0, 64));
+        ImageBufAlgo::fill(src, { 0.3f, 0.6f, 0.9f, 1.0f },
+                           ROI(64, 128, 0, 64));
+        ImageBuf direct(ImageSpec(640, 480, 4, TypeFloat));
+        ImageBuf lut(ImageSpec(640, 480, 4, TypeFloat));
+        OIIO::attribute("colorconvert:lut", 0);
+        ImageBufAlgo::colorconvert(direct, src, proc, true);
+        OIIO::attribute("colorconvert:lut", lutmode);
+        ImageBufAlgo::colorconvert(lut, src, proc, true);
+        OIIO::attribute("colorconvert:lut", 1);
+        auto cr = ImageBufAlgo::compare(lut, direct, eps, eps);
+        OIIO_CHECK_EQUAL(cr.nfail, 0);
+        OIIO_CHECK_LE(cr.maxerror, eps);
+    };
+    check_lut(processor.get(), TypeUInt8, 1, 0.0f);
+    check_lut(processor.get(), TypeUInt16, 1, 0.0f);
+    Imath::M44f M(0.8f, 0.1f, 0.1f, 0.0f, 0.2f, 0.7f, 0.1f, 0.0f, 0.0f, 0.1f,
+                  0.9f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f);
+    auto mproc = config.createMatrixTransform(M);
+    OIIO_CHECK_ASSERT(mproc && mproc->hasChannelCrosstalk());
+    check_lut(mproc.get(), TypeUInt8, 2, 1.0e-5f);
+    // A nonlinear transform with crosstalk is where the lattice really has
+    // to interpolate. Decoding sRGB and converting to ACEScg must stay well
+    // within one 8 bit code value of the exact processor.
+    auto acesproc = config.createColorProcessor("srgb_rec709_scene", "ACEScg");
+    if (!acesproc)
+        acesproc = ColorConfig("ocio://default")
+                       .createColorProcessor("srgb_rec709_scene", "ACEScg");
+    OIIO_CHECK_ASSERT(acesproc && acesproc->hasChannelCrosstalk());
+    if (acesproc)
+        check_lut(acesproc.get(), TypeUInt8, 2, 1.0e-3f);
 }
 
 
@@ -1588,6 +1978,35 @@ test_demosaic()
 }
 
 
+// Timing of the simple pointwise ops, which run as float row kernels
+// regardless of the pixel types involved.
+void
+benchmark_pointwise_ops()
+{
+    std::cout << "benchmark pointwise ops\n";
+    Benchmarker bench;
+    bench.units(Benchmarker::Unit::ms);
+    for (TypeDesc td : { TypeFloat, TypeHalf, TypeUInt8 }) {
+        ImageBuf A = filled_image({ 0.25f, 0.5f, 0.75f, 1.0f }, 2048, 2048, td);
+        ImageBuf B = filled_image({ 0.5f, 0.5f, 0.5f, 0.5f }, 2048, 2048, td);
+        ImageBuf R(A.spec());
+        const char* t   = td.c_str();
+        const float k[] = { 0.5f, 0.25f, 0.125f, 1.0f };
+        bench(Strutil::fmt::format("  IBA::add img+img {}", t),
+              [&]() { ImageBufAlgo::add(R, A, B); });
+        bench(Strutil::fmt::format("  IBA::mul img*const {}", t),
+              [&]() { ImageBufAlgo::mul(R, A, k); });
+        bench(Strutil::fmt::format("  IBA::mad img*img+const {}", t),
+              [&]() { ImageBufAlgo::mad(R, A, B, k); });
+        bench(Strutil::fmt::format("  IBA::min img,img {}", t),
+              [&]() { ImageBufAlgo::min(R, A, B); });
+        bench(Strutil::fmt::format("  IBA::clamp {}", t),
+              [&]() { ImageBufAlgo::clamp(R, A, 0.3f, 0.6f); });
+    }
+}
+
+
+
 int
 main(int argc, char** argv)
 {
@@ -1616,12 +2035,15 @@ main(int argc, char** argv)
     test_over(TypeFloat);
     test_over(TypeHalf);
     test_zover();
+    test_deep_columns();
+    test_deep_merge();
     test_resample();
     test_compare();
     test_isConstantColor();
     test_isConstantChannel();
     test_isMonochrome();
     test_computePixelStats();
+    test_stats_constancy();
     histogram_computation_test();
     test_maketx_from_imagebuf();
     test_IBAprep();
@@ -1633,6 +2055,7 @@ main(int argc, char** argv)
     test_simple_perpixel<float>();
     test_simple_perpixel<half>();
 
+    benchmark_pointwise_ops();
     benchmark_parallel_image(64, iterations * 64);
     benchmark_parallel_image(512, iterations * 16);
     benchmark_parallel_image(1024, iterations * 4);
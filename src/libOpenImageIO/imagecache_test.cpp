@@ -8,11 +8,24 @@
 #include <OpenImageIO/imagebufalgo.h>
 #include <OpenImageIO/imagecache.h>
 #include <OpenImageIO/imageio.h>
+#include <OpenImageIO/texture.h>
 #include <OpenImageIO/unittest.h>
 
 #include <iostream>
+#include <random>
+
+#include "../libtexture/bcdecode_simd_pvt.h"
+
+// The reference scalar BCn decoders, to check the SIMD ones against
+OIIO_PRAGMA_WARNING_PUSH
+OIIO_GCC_PRAGMA(GCC diagnostic ignored "-Wunused-function")
+#define BCDEC_STATIC
+#define BCDEC_IMPLEMENTATION
+#include "../dds.imageio/bcdec.h"
+OIIO_PRAGMA_WARNING_POP
 
 using namespace OIIO;
+namespace bcn = OIIO::v3_1::pvt::bcn;
 
 
 static ustring udimpattern;
@@ -155,6 +168,426 @@ test_get_pixels_cachechannels(int chbegin = 0, int chend = 4,
 
 
 
+// Test get_pixels of regions that span many tiles, overhang the data
+// window, and are big enough to be split across threads.
+static void
+test_get_pixels_tiled_regions()
+{
+    Strutil::print("\nTesting get_pixels of multi-tile regions\n");
+    auto imagecache = ImageCache::create(false);
+
+    // A tiled float file whose pixel values encode their own coordinates
+    const int xres = 700, yres = 600, nchans = 3;
+    ImageSpec spec(xres, yres, nchans, TypeFloat);
+    spec.tile_width  = 64;
+    spec.tile_height = 64;
+    ImageBuf A(spec);
+    for (ImageBuf::Iterator<float> it(A); !it.done(); ++it) {
+        it[0] = float(it.x());
+        it[1] = float(it.y());
+        it[2] = float(it.x() + it.y());
+    }
+    ustring filename("tiledregions.tif");
+    A.set_write_tiles(64, 64);
+    A.write(filename);
+    files_to_delete.push_back(filename);
+
+    // Whole image plus a border on every side, channels [1,3), written
+    // into every other pixel of a wider buffer so the strides are not
+    // contiguous.
+    const int xb = -5, xe = xres + 7, yb = -3, ye = yres + 2;
+    const int w = xe - xb, h = ye - yb, nc = 2;
+    std::vector<float> buf(size_t(w) * h * 2 * nc, -1.0f);
+    stride_t xstride = 2 * nc * sizeof(float);
+    OIIO_CHECK_ASSERT(imagecache->get_pixels(filename, 0, 0, xb, xe, yb, ye,
+                                             0, 1, 1, 3, TypeFloat,
+                                             buf.data(), xstride));
+    int bad = 0;
+    for (int y = yb; y < ye; ++y) {
+        for (int x = xb; x < xe; ++x) {
+            const float* p = &buf[(size_t(y - yb) * w + (x - xb)) * 2 * nc];
+            bool inside    = (x >= 0 && x < xres && y >= 0 && y < yres);
+            float e1 = inside ? float(y) : 0.0f;
+            float e2 = inside ? float(x + y) : 0.0f;
+            if (p[0] != e1 || p[1] != e2 || p[2] != -1.0f || p[3] != -1.0f)
+                ++bad;
+        }
+    }
+    OIIO_CHECK_EQUAL(bad, 0);
+
+    // A small region straddling four tiles, converted to uint16
+    std::vector<uint16_t> small(10 * 10 * nchans, 0);
+    OIIO_CHECK_ASSERT(imagecache->get_pixels(filename, 0, 0, 59, 69, 59, 69,
+                                             0, 1, TypeUInt16, small.data()));
+    OIIO_CHECK_EQUAL(small[0], 0xffff);  // all values >= 1.0 clamp to max
+}
+
+
+
+static void
+test_float_storage()
+{
+    Strutil::print("\nTesting reduced-precision float storage\n");
+
+    // A tiled float file with values well outside [0,1]
+    const int res = 128;
+    ImageSpec spec(res, res, 2, TypeFloat);
+    ImageBuf A(spec);
+    for (ImageBuf::Iterator<float> it(A); !it.done(); ++it) {
+        it[0] = 0.37f * it.x() + 1.1f * it.y() - 30.0f;
+        it[1] = 1.0e-3f * it.x();
+    }
+    ustring filename("floatstorage.tif");
+    A.set_write_tiles(32, 32);
+    A.write(filename);
+    files_to_delete.push_back(filename);
+
+    for (const char* storage : { "half", "uint16" }) {
+        Strutil::print("  {}\n", storage);
+        auto imagecache = ImageCache::create(false);
+        OIIO_CHECK_ASSERT(imagecache->attribute("float_storage", storage));
+        std::vector<float> pels(res * res * 2);
+        OIIO_CHECK_ASSERT(imagecache->get_pixels(filename, 0, 0, 0, res, 0,
+                                                 res, 0, 1, TypeFloat,
+                                                 pels.data()));
+        float maxerr = 0.0f;
+        for (int y = 0; y < res; ++y)
+            for (int x = 0; x < res; ++x) {
+                const float* p = &pels[(y * res + x) * 2];
+                maxerr = std::max(maxerr,
+                                  std::abs(p[0]
+                                           - (0.37f * x + 1.1f * y - 30.0f)));
+                maxerr = std::max(maxerr, std::abs(p[1] - 1.0e-3f * x));
+            }
+        OIIO_CHECK_LT(maxerr, 0.07f);
+
+        if (Strutil::iequals(storage, "uint16")) {
+            // Each channel is normalized by its own range, so the one with
+            // a tiny range keeps its precision, also when a texture lookup
+            // starts at that channel.
+            float maxerr1 = 0.0f;
+            for (int y = 0; y < res; ++y)
+                for (int x = 0; x < res; ++x)
+                    maxerr1 = std::max(maxerr1,
+                                       std::abs(pels[(y * res + x) * 2 + 1]
+                                                - 1.0e-3f * x));
+            OIIO_CHECK_LT(maxerr1, 1.0e-6f);
+            auto texsys = TextureSystem::create(false, imagecache);
+            TextureOpt opt;
+            opt.firstchannel = 1;
+            opt.interpmode   = TextureOpt::InterpClosest;
+            opt.mipmode      = TextureOpt::MipModeNoMIP;
+            for (int x : { 5, 45, 100 }) {
+                float val = 0.0f;
+                OIIO_CHECK_ASSERT(texsys->texture(filename, opt,
+                                                  (x + 0.5f) / res, 0.5f, 0.0f,
+                                                  0.0f, 0.0f, 0.0f, 1, &val));
+                OIIO_CHECK_EQUAL_THRESH(val, 1.0e-3f * x, 1.0e-6f);
+            }
+        }
+
+        // The cache reports the error it introduced, which bounds what
+        // we observed.
+        float reported = -1.0f;
+        OIIO_CHECK_ASSERT(imagecache->get_image_info(
+            filename, 0, 0, ustring("stat:precision_maxerror"), TypeFloat,
+            &reported));
+        OIIO_CHECK_GT(reported, 0.0f);
+        OIIO_CHECK_GE(reported, maxerr);
+
+        // Quantized images look like float to users of raw tiles
+        int cachedformat = 0;
+        imagecache->get_image_info(filename, 0, 0, ustring("cachedformat"),
+                                   TypeInt, &cachedformat);
+        OIIO_CHECK_EQUAL(cachedformat, Strutil::iequals(storage, "half")
+                                           ? int(TypeDesc::HALF)
+                                           : int(TypeDesc::FLOAT));
+        ImageCache::Tile* tile = imagecache->get_tile(filename, 0, 0, 40, 40,
+                                                      0);
+        OIIO_CHECK_ASSERT(tile);
+        if (tile) {
+            TypeDesc format;
+            const void* data = imagecache->tile_pixels(tile, format);
+            OIIO_CHECK_EQUAL(format.basetype, cachedformat);
+            if (format == TypeFloat)
+                OIIO_CHECK_LT(std::abs(((const float*)data)[0]
+                                       - (0.37f * 32 + 1.1f * 32 - 30.0f)),
+                              0.07f);
+            imagecache->release_tile(tile);
+        }
+    }
+
+    auto imagecache = ImageCache::create(false);
+    OIIO_CHECK_FALSE(imagecache->attribute("float_storage", "int8"));
+    OIIO_CHECK_ASSERT(imagecache->has_error());
+    (void)imagecache->geterror();
+}
+
+
+
+// Write a 2D DDS file made of pseudo-random GPU blocks (any bits decode
+// to some texels) of the given compression, given either as a FourCC or,
+// for BC7, as a DX10 format number.
+static ustring
+write_bc_dds(string_view name, const char* fourcc, int dxgiformat,
+             size_t blocksize, int width, int height)
+{
+    int bw = (width + 3) / 4, bh = (height + 3) / 4;
+    std::vector<uint32_t> header(32, 0);
+    memcpy(&header[0], "DDS ", 4);
+    header[1] = 124;                                  // header size
+    header[2] = 0x1 | 0x2 | 0x4 | 0x1000 | 0x80000;  // valid fields
+    header[3] = height;
+    header[4] = width;
+    header[5] = uint32_t(bw * bh * blocksize);  // linear size
+    header[19] = 32;                            // pixel format size
+    header[20] = 0x4;                           // has FourCC
+    memcpy(&header[21], fourcc, 4);
+    header[27] = 0x1000;  // it's a texture
+    if (dxgiformat) {
+        // DX10 header: format, 2D, no flags, array size 1
+        for (uint32_t v : { uint32_t(dxgiformat), 3u, 0u, 1u, 0u })
+            header.push_back(v);
+    }
+    std::vector<unsigned char> data((const unsigned char*)header.data(),
+                                    (const unsigned char*)header.data()
+                                        + header.size() * sizeof(uint32_t));
+    std::mt19937 rng(42);
+    for (size_t i = 0, n = size_t(bw) * bh * blocksize; i < n; ++i)
+        data.push_back((unsigned char)(rng() & 0xff));
+    ustring filename(name);
+    Filesystem::write_binary_file(filename, data);
+    files_to_delete.push_back(filename);
+    return filename;
+}
+
+
+
+// The cache decodes BC1, BC3, and BC7 blocks with its own SIMD decoders
+// rather than bcdec, so make sure they agree texel for texel on random
+// blocks of every mode: BC1 with 4 and 3 colors, BC3 with 8 and 6
+// interpolated alphas, and all 8 BC7 modes.
+static void
+test_bc_simd_decode()
+{
+    Strutil::print("\nTesting SIMD BC1/BC3/BC7 block decoding\n");
+    using DecodeFunc = void (*)(const void*, void*, int);
+    // Decode into the middle of wider rows, to also check the pitch and
+    // that nothing outside the 4x4 block is touched.
+    const int pitch = 4 * 4 * 3;
+    auto compare    = [&](const unsigned char* block, DecodeFunc ref,
+                       DecodeFunc simd) {
+        unsigned char a[4 * pitch], b[4 * pitch];
+        memset(a, 0x5a, sizeof(a));
+        memset(b, 0x5a, sizeof(b));
+        ref(block, a + 16, pitch);
+        simd(block, b + 16, pitch);
+        return memcmp(a, b, sizeof(a)) == 0;
+    };
+    std::mt19937 rng(42);
+    const int trials = 10000;
+    unsigned char block[16];
+    auto randomize = [&]() {
+        for (auto& c : block)
+            c = (unsigned char)(rng() & 0xff);
+    };
+
+    for (bool fourcolor : { true, false }) {
+        int mismatches = 0;
+        for (int i = 0; i < trials; ++i) {
+            randomize();
+            // The endpoint order selects the mode: c0 > c1 is 4-color
+            uint16_t c0, c1;
+            memcpy(&c0, block, 2);
+            memcpy(&c1, block + 2, 2);
+            if (fourcolor ? c0 <= c1 : c0 > c1)
+                std::swap(c0, c1);
+            if (fourcolor && c0 == c1) {
+                c0 |= 1;
+                c1 = c0 - 1;
+            }
+            if (!fourcolor && (i & 15) == 0)
+                c1 = c0;  // Equal endpoints are also 3-color
+            memcpy(block, &c0, 2);
+            memcpy(block + 2, &c1, 2);
+            mismatches += !compare(block, bcdec_bc1, bcn::decode_bc1);
+        }
+        Strutil::print("  BC1 {}-color: {} mismatches\n", fourcolor ? 4 : 3,
+                       mismatches);
+        OIIO_CHECK_EQUAL(mismatches, 0);
+    }
+
+    for (bool eightalpha : { true, false }) {
+        int mismatches = 0;
+        for (int i = 0; i < trials; ++i) {
+            randomize();
+            // a0 > a1 interpolates 8 alphas, otherwise 6 plus 0 and 255
+            if (eightalpha ? block[0] <= block[1] : block[0] > block[1])
+                std::swap(block[0], block[1]);
+            if (eightalpha && block[0] == block[1]) {
+                block[0] |= 1;
+                block[1] = block[0] - 1;
+            }
+            mismatches += !compare(block, bcdec_bc3, bcn::decode_bc3);
+        }
+        Strutil::print("  BC3 {} alphas: {} mismatches\n",
+                       eightalpha ? 8 : 6, mismatches);
+        OIIO_CHECK_EQUAL(mismatches, 0);
+    }
+
+    for (int mode = 0; mode < 8; ++mode) {
+        int mismatches = 0;
+        for (int i = 0; i < trials; ++i) {
+            randomize();
+            // The mode is the position of the lowest set bit of byte 0
+            block[0] = (unsigned char)((block[0] << (mode + 1))
+                                       | (1 << mode));
+            mismatches += !compare(block, bcdec_bc7, bcn::decode_bc7);
+        }
+        Strutil::print("  BC7 mode {}: {} mismatches\n", mode, mismatches);
+        OIIO_CHECK_EQUAL(mismatches, 0);
+    }
+}
+
+
+
+static void
+test_compressed_tiles()
+{
+    Strutil::print("\nTesting block-compressed tiles\n");
+    struct BCFormat {
+        const char* name;
+        const char* fourcc;
+        int dxgiformat;
+        size_t blocksize;
+    };
+    // Neither a multiple of the tile size nor of the 4x4 block size
+    const int xres = 150, yres = 70;
+    for (BCFormat bc : { BCFormat { "bc1", "DXT1", 0, 8 },
+                         BCFormat { "bc3", "DXT5", 0, 16 },
+                         BCFormat { "bc7", "DX10", 98, 16 } }) {
+        Strutil::print("  {}\n", bc.name);
+        ustring filename = write_bc_dds(Strutil::fmt::format("{}.dds",
+                                                             bc.name),
+                                        bc.fourcc, bc.dxgiformat,
+                                        bc.blocksize, xres, yres);
+
+        // The reference is the DDS reader decoding the whole image
+        ImageBuf ref(filename);
+        OIIO_CHECK_ASSERT(ref.read(0, 0, true, TypeUInt8));
+        const int nchans = ref.nchannels();
+        std::vector<unsigned char> refpels(size_t(xres) * yres * nchans);
+        ref.get_pixels(ref.roi(), TypeUInt8, refpels.data());
+
+        auto compressed = ImageCache::create(false);
+        compressed->attribute("compressed_tiles", 1);
+        compressed->attribute("autotile", 32);
+        auto decoded = ImageCache::create(false);
+        decoded->attribute("autotile", 32);
+        for (auto& ic : { compressed, decoded }) {
+            std::vector<unsigned char> pels(refpels.size(), 0);
+            OIIO_CHECK_ASSERT(ic->get_pixels(filename, 0, 0, 0, xres, 0,
+                                             yres, 0, 1, TypeUInt8,
+                                             pels.data()));
+            OIIO_CHECK_ASSERT(pels == refpels);
+        }
+
+        // Each of the 5x3 tiles was decoded once. The decoded copies have
+        // their own budget, so only the blocks count against the cache's
+        // memory, which is then well under that of the decoded tiles.
+        long long decodes = 0, mem_compressed = 0, mem_decoded = 0;
+        compressed->getattribute("stat:tile_block_decodes", TypeInt64,
+                                 &decodes);
+        OIIO_CHECK_EQUAL(decodes, 15);
+        compressed->getattribute("stat:cache_memory_used", TypeInt64,
+                                 &mem_compressed);
+        decoded->getattribute("stat:cache_memory_used", TypeInt64,
+                              &mem_decoded);
+        OIIO_CHECK_LT(mem_compressed, mem_decoded);
+        float decoded_budget = 0.0f;
+        OIIO_CHECK_ASSERT(compressed->getattribute("max_decoded_memory_MB",
+                                                   decoded_budget));
+        OIIO_CHECK_EQUAL(decoded_budget, 64.0f);
+
+        // Filtered texture lookups match those through decoded tiles
+        auto tscompressed = TextureSystem::create(false, compressed);
+        auto tsdecoded    = TextureSystem::create(false, decoded);
+        TextureOpt opt;
+        int mismatches = 0;
+        for (auto interp :
+             { TextureOpt::InterpBilinear, TextureOpt::InterpBicubic }) {
+            opt.interpmode = interp;
+            for (float t = 0.01f; t < 1.0f; t += 0.07f) {
+                for (float s = 0.01f; s < 1.0f; s += 0.053f) {
+                    float a[4], b[4];
+                    OIIO_CHECK_ASSERT(tscompressed->texture(filename, opt, s,
+                                                            t, 0.01f, 0.0f,
+                                                            0.0f, 0.01f,
+                                                            nchans, a));
+                    OIIO_CHECK_ASSERT(tsdecoded->texture(filename, opt, s, t,
+                                                         0.01f, 0.0f, 0.0f,
+                                                         0.01f, nchans, b));
+                    for (int c = 0; c < nchans; ++c)
+                        mismatches += (a[c] != b[c]);
+                }
+            }
+        }
+        OIIO_CHECK_EQUAL(mismatches, 0);
+    }
+}
+
+
+
+static void
+test_access_trace()
+{
+    Strutil::print("\nTesting tile access trace record and prefetch\n");
+    ustring filename("tiledregions.tif");  // from test_get_pixels_tiled_regions
+    std::string tracefile("accesstrace.txt");
+    std::vector<float> pels(256 * 64 * 3);
+
+    // Record a run that touches a row of four tiles and one more
+    {
+        auto imagecache = ImageCache::create(false);
+        OIIO_CHECK_ASSERT(imagecache->attribute("trace_file", tracefile));
+        OIIO_CHECK_ASSERT(imagecache->get_pixels(filename, 0, 0, 0, 256, 0,
+                                                 64, 0, 1, TypeFloat,
+                                                 pels.data()));
+        OIIO_CHECK_ASSERT(imagecache->get_pixels(filename, 0, 0, 300, 301,
+                                                 300, 301, 0, 1, TypeFloat,
+                                                 pels.data()));
+        OIIO_CHECK_ASSERT(imagecache->attribute("trace_file", ""));
+    }
+    files_to_delete.emplace_back(tracefile);
+    OIIO_CHECK_ASSERT(Filesystem::exists(tracefile));
+
+    // Replaying it into a fresh cache reads those tiles, and nothing else
+    auto imagecache = ImageCache::create(false);
+    OIIO_CHECK_ASSERT(imagecache->prefetch_trace(tracefile));
+    int created = 0, misses = 0, misses_after = 0;
+    imagecache->getattribute("stat:tiles_created", created);
+    OIIO_CHECK_EQUAL(created, 5);
+    imagecache->getattribute("stat:find_tile_cache_misses", misses);
+    OIIO_CHECK_ASSERT(imagecache->get_pixels(filename, 0, 0, 0, 256, 0, 64,
+                                             0, 1, TypeFloat, pels.data()));
+    imagecache->getattribute("stat:find_tile_cache_misses", misses_after);
+    OIIO_CHECK_EQUAL(misses_after, misses);
+    int bad = 0;
+    for (int y = 0; y < 64; ++y)
+        for (int x = 0; x < 256; ++x) {
+            const float* p = &pels[(y * 256 + x) * 3];
+            if (p[0] != float(x) || p[1] != float(y))
+                ++bad;
+        }
+    OIIO_CHECK_EQUAL(bad, 0);
+
+    // Something that isn't a trace is an error
+    OIIO_CHECK_FALSE(imagecache->prefetch_trace("badfile.exr"));
+    OIIO_CHECK_ASSERT(imagecache->has_error());
+    (void)imagecache->geterror();
+}
+
+
 // Wimple wrapper to return a raw "null" ImageInput*.
 static ImageInput*
 NullInputCreator()
@@ -316,6 +749,57 @@ test_imagespec()
 
 
 
+static void
+test_microcache_size()
+{
+    Strutil::print("\nTesting microcache_size\n");
+    auto ic = ImageCache::create(false);
+    int size = 0;
+    OIIO_CHECK_ASSERT(ic->getattribute("microcache_size", size));
+    OIIO_CHECK_EQUAL(size, 8);
+    ic->attribute("microcache_size", 5);  // rounds up to a power of 2
+    OIIO_CHECK_ASSERT(ic->getattribute("microcache_size", size));
+    OIIO_CHECK_EQUAL(size, 8);
+    ic->attribute("microcache_size", 0);  // never less than one 2-way set
+    OIIO_CHECK_ASSERT(ic->getattribute("microcache_size", size));
+    OIIO_CHECK_EQUAL(size, 2);
+    ic->attribute("microcache_size", 100000);
+    OIIO_CHECK_ASSERT(ic->getattribute("microcache_size", size));
+    OIIO_CHECK_EQUAL(size, 256);
+
+    // Alternate among pixels in different tiles, repeatedly, and return
+    // the number of microcache misses. Which set a tile lands in depends on
+    // the ImageCacheFile's heap address, so use a one-set microcache, where
+    // the outcome doesn't depend on the mapping.
+    auto misses_for = [&](std::initializer_list<int> xs) {
+        long long calls0 = 0, misses0 = 0, calls = 0, misses = 0;
+        ic->getattribute("stat:find_tile_calls", TypeInt64, &calls0);
+        ic->getattribute("stat:find_tile_microcache_misses", TypeInt64,
+                         &misses0);
+        float pixel[3];
+        for (int i = 0; i < 10; ++i)
+            for (int x : xs)
+                OIIO_CHECK_ASSERT(ic->get_pixels(checkertex, 0, 0, x, x + 1,
+                                                 0, 1, 0, 1, TypeFloat,
+                                                 pixel));
+        ic->getattribute("stat:find_tile_calls", TypeInt64, &calls);
+        ic->getattribute("stat:find_tile_microcache_misses", TypeInt64,
+                         &misses);
+        Strutil::print("  {} tile requests, {} microcache misses\n",
+                       calls - calls0, misses - misses0);
+        OIIO_CHECK_EQUAL(calls - calls0, 10 * (long long)xs.size());
+        return misses - misses0;
+    };
+    ic->attribute("microcache_size", 2);
+    // Three tiles in one 2-way set: each visit evicts the tile that is
+    // needed next, so every request misses.
+    OIIO_CHECK_EQUAL(misses_for({ 0, 100, 200 }), 30);
+    // Two tiles fit in the set: only the first visit to each misses.
+    OIIO_CHECK_EQUAL(misses_for({ 0, 100 }), 2);
+}
+
+
+
 static void
 test_get_cache_dimensions()
 {
@@ -379,6 +863,7 @@ main(int /*argc*/, char* /*argv*/[])
     test_get_pixels_cachechannels(0, 4, 0, 4);
     test_get_pixels_cachechannels(6, 9);
     test_get_pixels_cachechannels(6, 9, 6, 9);
+    test_get_pixels_tiled_regions();
 
     test_app_buffer();
     test_tileptr();
@@ -386,6 +871,11 @@ main(int /*argc*/, char* /*argv*/[])
     test_custom_threadinfo();
     test_imagespec();
     test_get_cache_dimensions();
+    test_microcache_size();
+    test_float_storage();
+    test_bc_simd_decode();
+    test_compressed_tiles();
+    test_access_trace();
 
     auto ic = ImageCache::create();
     Strutil::print("\n\n{}\n", ic->getstats(5));
@@ -6,6 +6,7 @@
 // Tests related to ImageInput and ImageOutput
 /////////////////////////////////////////////////////////////////////////
 
+#include <atomic>
 #include <iostream>
 
 #if defined(__linux__)
@@ -18,6 +19,7 @@
 #include <OpenImageIO/imagebuf.h>
 #include <OpenImageIO/imagebufalgo.h>
 #include <OpenImageIO/imageio.h>
+#include <OpenImageIO/plugin.h>
 #include <OpenImageIO/unittest.h>
 
 using namespace OIIO;
@@ -26,6 +28,7 @@ using namespace OIIO;
 static std::string onlyformat = Sysutil::getenv("IMAGEINOUTTEST_ONLY_FORMAT");
 static bool nodelete          = false;  // Don't delete the test files
 static bool enable_fpe        = false;  // Throw exceptions on FP errors.
+static bool benchmark         = false;  // Time the DPX pack/unpack paths
 
 
 
@@ -44,6 +47,8 @@ getargs(int argc, char* argv[])
       .help("Enable floating point exceptions.");
     ap.arg("--onlyformat %s:FORMAT", &onlyformat)
       .help("Test only one format");
+    ap.arg("--benchmark", &benchmark)
+      .help("Benchmark DPX 10/12 bit reading and writing");
 
     ap.parse_args(argc, (const char**)argv);
     // clang-format on
@@ -531,6 +536,287 @@ test_read_tricky_sizes()
 
 
 
+// Read the raw bytes of a file.
+static std::vector<unsigned char>
+read_file_bytes(const std::string& filename)
+{
+    std::vector<unsigned char> bytes(Filesystem::file_size(filename));
+    Filesystem::read_bytes(filename, bytes.data(), bytes.size());
+    return bytes;
+}
+
+
+
+// Read all the pixels of a file as uint16.
+static std::vector<uint16_t>
+read_uint16_pixels(const std::string& filename)
+{
+    std::vector<uint16_t> pixels;
+    auto in = ImageInput::open(filename);
+    OIIO_CHECK_ASSERT(in);
+    if (in) {
+        const ImageSpec& spec(in->spec());
+        pixels.resize(spec.image_pixels() * spec.nchannels);
+        bool ok = in->read_image(0, 0, 0, spec.nchannels, TypeUInt16,
+                                 pixels.data());
+        OIIO_CHECK_ASSERT(ok);
+    }
+    return pixels;
+}
+
+
+
+// With a "plugin_index", format names are answered from the index without
+// loading the plugins it lists, and a plugin that has changed since it was
+// indexed is not trusted. The "plugins" here are not loadable at all, so
+// anything that gets them loaded can't find their formats.
+static void
+test_plugin_index()
+{
+    print("Testing the plugin index\n");
+    std::string dir = Filesystem::temp_directory_path() + "/"
+                      + Filesystem::unique_path("oiio-plugin-index-%%%%%%%%");
+    std::string err;
+    OIIO_CHECK_ASSERT(Filesystem::create_directory(dir, err));
+    std::string ext = Plugin::plugin_extension();
+    Filesystem::write_text_file(dir + "/fakefmt.imageio." + ext, "not a dso");
+    Filesystem::write_text_file(dir + "/stalefmt.imageio." + ext, "nor this");
+    std::vector<std::string> files;
+    Filesystem::get_directory_entries(dir, files);
+    std::string index;
+    for (const auto& f : files) {
+        bool stale = Strutil::contains(f, "stalefmt");
+        index += Strutil::fmt::format(
+            "{}\t{}\t{}\t{}\tip\t{}\t\tfakelib 1.0\n", f,
+            int64_t(Filesystem::last_write_time(f)),
+            Filesystem::file_size(f) + (stale ? 1 : 0),
+            stale ? "stalefmt" : "fakefmt", stale ? "sfk" : "fk1,fk2");
+    }
+    std::string indexfile = dir + "/index.txt";
+    Filesystem::write_text_file(indexfile, index);
+
+    // Scan the real searchpath first: switching to a new searchpath must
+    // make the next lookup scan it, no matter what was scanned before.
+    OIIO::get_string_attribute("extension_list");
+    std::string searchpath = OIIO::get_string_attribute("plugin_searchpath");
+    OIIO::attribute("plugin_searchpath", dir);
+    OIIO::attribute("plugin_index", indexfile);
+    OIIO_CHECK_EQUAL(OIIO::get_string_attribute("plugin_index"), indexfile);
+    OIIO_CHECK_ASSERT(is_imageio_format_name("fakefmt"));
+    OIIO_CHECK_ASSERT(is_imageio_format_name("FakeFmt"));
+    OIIO_CHECK_ASSERT(!is_imageio_format_name("stalefmt"));
+    OIIO_CHECK_ASSERT(!is_imageio_format_name("fk1"));
+
+    // Scanning the searchpath lists the indexed plugin without loading it,
+    // and tries (and fails) to load the stale one.
+    std::string extensions = OIIO::get_string_attribute("extension_list");
+    OIIO_CHECK_ASSERT(Strutil::contains(extensions, "fakefmt:fk1,fk2"));
+    OIIO_CHECK_ASSERT(!Strutil::contains(extensions, "stalefmt"));
+    OIIO_CHECK_ASSERT(Strutil::contains(OIIO::get_string_attribute(
+                                            "library_list"),
+                                        "fakefmt:fakelib 1.0"));
+
+    // Asking for a reader finally loads the plugin, which fails cleanly.
+    auto in = ImageInput::create("test.fk1");
+    OIIO_CHECK_ASSERT(!in);
+    OIIO::geterror();
+
+    OIIO::attribute("plugin_index", "");
+    OIIO::attribute("plugin_searchpath", searchpath);
+    Filesystem::remove_all(dir, err);
+}
+
+
+
+// A reader for a made-up format whose files start with "SIGF", which counts
+// how many times it has been created.
+class SigFakeInput final : public ImageInput {
+public:
+    SigFakeInput() { ++created; }
+    const char* format_name(void) const override { return "sigfake"; }
+    int supports(string_view feature) const override
+    {
+        return feature == "ioproxy";
+    }
+    bool open(const std::string& name, ImageSpec& newspec) override
+    {
+        return open(name, newspec, ImageSpec());
+    }
+    bool open(const std::string& name, ImageSpec& newspec,
+              const ImageSpec& config) override
+    {
+        ioproxy_retrieve_from_config(config);
+        if (!ioproxy_use_or_open(name))
+            return false;
+        char magic[4] = {};
+        if (ioproxy()->pread(magic, 4, 0) != 4 || memcmp(magic, "SIGF", 4)) {
+            errorfmt("\"{}\" is not a sigfake file", name);
+            close();
+            return false;
+        }
+        m_spec  = ImageSpec(1, 1, 1, TypeUInt8);
+        newspec = m_spec;
+        return true;
+    }
+    bool close() override
+    {
+        ioproxy_clear();
+        return true;
+    }
+    bool read_native_scanline(int /*subimage*/, int /*miplevel*/, int /*y*/,
+                              int /*z*/, void* data) override
+    {
+        *(unsigned char*)data = 0;
+        return true;
+    }
+
+    static ImageInput* create() { return new SigFakeInput; }
+    static std::atomic<int> created;
+};
+
+std::atomic<int> SigFakeInput::created(0);
+
+
+
+// A file whose extension is wrong is found by its signature, whether or not
+// create() is asked to open it, and readers whose signatures don't match
+// the file are never even constructed.
+static void
+test_format_signatures()
+{
+    print("Testing reader selection by format signature\n");
+    static const char* sigfake_extensions[] = { "sigfake", nullptr };
+    static const char* sigfake_signatures[] = { "53494746", nullptr };
+    declare_imageio_format("sigfake", SigFakeInput::create, sigfake_extensions,
+                           nullptr, nullptr, "");
+    declare_imageio_format_signatures("sigfake", sigfake_signatures);
+
+    // A BMP file named as if it were a TIFF
+    const char* bmpfile = "tmp_signature_bmp.tif";
+    ImageBuf buf(ImageSpec(4, 4, 3, TypeUInt8));
+    ImageBufAlgo::fill(buf, { 0.25f, 0.5f, 0.75f });
+    OIIO_CHECK_ASSERT(buf.write(bmpfile, TypeUnknown, "bmp"));
+    SigFakeInput::created = 0;
+    auto in               = ImageInput::open(bmpfile);
+    OIIO_CHECK_ASSERT(in && in->format_name() == string_view("bmp"));
+    in = ImageInput::create(bmpfile, false);
+    OIIO_CHECK_ASSERT(in && in->format_name() == string_view("bmp"));
+    OIIO_CHECK_EQUAL(SigFakeInput::created, 0);
+    in.reset();
+
+    // A file of the made-up format, with an extension nobody knows
+    const char* sigfile = "tmp_signature.unknownext";
+    Filesystem::write_text_file(sigfile, "SIGF and more");
+    in = ImageInput::open(sigfile);
+    OIIO_CHECK_ASSERT(in && in->format_name() == string_view("sigfake"));
+    OIIO_CHECK_GT(SigFakeInput::created, 0);
+    in.reset();
+    OIIO::geterror();
+
+    if (!nodelete) {
+        Filesystem::remove(bmpfile);
+        Filesystem::remove(sigfile);
+    }
+}
+
+
+
+// The DPX readers and writer unpack and pack 10- and 12-bit data a band of
+// scanlines at a time. Make sure they write the same bytes and read the
+// same pixels as the one-pixel-at-a-time code ("dpx:bitpack_bands" = 0).
+static void
+test_bitpack_bands()
+{
+    print("Testing DPX 10/12 bit band packing and unpacking\n");
+    const char* filename = "tmp_dpx_unpack.dpx";
+    for (int bits : { 10, 12 }) {
+        for (const char* packing :
+             { "Filled, method A", "Filled, method B", "Packed" }) {
+            for (int nchans : { 1, 3, 4 }) {
+                for (const char* endian : { "big", "little" }) {
+                    // Odd sized, so that lines end in partially filled words
+                    ImageSpec spec(37, 19, nchans, TypeUInt16);
+                    spec.attribute("oiio:BitsPerSample", bits);
+                    spec.attribute("dpx:Packing", packing);
+                    spec.attribute("oiio:Endian", endian);
+                    spec.attribute("DateTime", "2024:01:01 00:00:00");
+                    ImageBuf src(spec);
+                    ImageBufAlgo::noise(src, "uniform", 0.0f, 1.0f, false, 1);
+
+                    OIIO::attribute("dpx:bitpack_bands", 0);
+                    src.write(filename);
+                    auto slowfile = read_file_bytes(filename);
+                    OIIO::attribute("dpx:bitpack_bands", 1);
+                    src.write(filename);
+                    auto fastfile = read_file_bytes(filename);
+                    OIIO_CHECK_ASSERT(fastfile == slowfile);
+
+                    std::vector<uint16_t> fast = read_uint16_pixels(filename);
+                    OIIO::attribute("dpx:bitpack_bands", 0);
+                    std::vector<uint16_t> slow = read_uint16_pixels(filename);
+                    OIIO::attribute("dpx:bitpack_bands", 1);
+                    OIIO_CHECK_ASSERT(fast == slow);
+
+                    // And the round trip only loses the low bits
+                    std::vector<uint16_t> orig(fast.size());
+                    src.get_pixels(src.roi(), make_span(orig));
+                    const int maxerr = (1 << (16 - bits)) - 1;
+                    int err          = 0;
+                    for (size_t i = 0; i < orig.size() && i < fast.size(); ++i)
+                        err = std::max(err, std::abs(int(orig[i])
+                                                     - int(fast[i])));
+                    OIIO_CHECK_LE(err, maxerr);
+                }
+            }
+        }
+    }
+    if (!nodelete)
+        Filesystem::remove(filename);
+}
+
+
+
+// Compare the band-at-a-time DPX packing and unpacking against the
+// one-pixel-at-a-time code, for a 4K frame.
+static void
+benchmark_dpx_unpack()
+{
+    print("\nBenchmarking DPX 10/12 bit reads and writes (4096x2160 RGB):\n");
+    const char* filename = "tmp_dpx_bench.dpx";
+    Benchmarker bench;
+    bench.units(Benchmarker::Unit::ms);
+    for (int bits : { 10, 12 }) {
+        for (const char* packing : { "Filled, method A", "Packed" }) {
+            if (bits == 12 && Strutil::iequals(packing, "Filled, method A"))
+                continue;  // the writer always packs 12 bit data
+            ImageSpec spec(4096, 2160, 3, TypeUInt16);
+            spec.attribute("oiio:BitsPerSample", bits);
+            spec.attribute("dpx:Packing", packing);
+            ImageBuf src(spec);
+            ImageBufAlgo::noise(src, "uniform", 0.0f, 1.0f, false, 1);
+            std::vector<uint16_t> pixels(spec.image_pixels()
+                                         * spec.nchannels);
+            for (int fast : { 0, 1 }) {
+                OIIO::attribute("dpx:bitpack_bands", fast);
+                std::string label = Strutil::fmt::format("{}-bit {:16} {}",
+                                                         bits, packing,
+                                                         fast ? "band"
+                                                              : "pixel");
+                bench("write " + label, [&]() { src.write(filename); });
+                bench("read  " + label, [&]() {
+                    auto in = ImageInput::open(filename);
+                    in->read_image(0, 0, 0, 3, TypeUInt16, pixels.data());
+                });
+            }
+        }
+    }
+    OIIO::attribute("dpx:bitpack_bands", 1);
+    if (!nodelete)
+        Filesystem::remove(filename);
+}
+
+
+
 int
 main(int argc, char* argv[])
 {
@@ -547,8 +833,15 @@ main(int argc, char* argv[])
 #endif
     }
 
+    test_plugin_index();
     test_all_formats();
     test_read_tricky_sizes();
+    if (onlyformat.empty() || onlyformat == "bmp")
+        test_format_signatures();
+    if (onlyformat.empty() || onlyformat == "dpx")
+        test_bitpack_bands();
+    if (benchmark)
+        benchmark_dpx_unpack();
 
     return unit_test_failures;
 }
@@ -53,12 +53,16 @@ int png_linear_premult(0);
 int tiff_half(0);
 int tiff_multithread(1);
 int dds_bc5normal(0);
+int ffmpeg_frame_cache_MB(32);
+int dpx_bitpack_bands(1);
 int limit_channels(1024);
 int limit_imagesize_MB(std::min(32 * 1024,
                                 int(Sysutil::physical_memory() >> 20)));
 int imageinput_strict(0);
+int colorconvert_lut(1);
 ustring font_searchpath(Sysutil::getenv("OPENIMAGEIO_FONTS"));
 ustring plugin_searchpath(OIIO_DEFAULT_PLUGIN_SEARCHPATH);
+ustring plugin_index;
 std::string format_list;         // comma-separated list of all formats
 std::string input_format_list;   // comma-separated list of readable formats
 std::string output_format_list;  // comma-separated list of writable formats
@@ -278,6 +282,8 @@ OIIO_NAMESPACE_3_1_BEGIN
 void
 shutdown()
 {
+    // Background writes may use the thread pool, so finish them first
+    OIIO::pvt::async_write_shutdown();
     default_thread_pool_shutdown();
 }
 
@@ -376,7 +382,15 @@ attribute(string_view name, TypeDesc type, const void* val)
         return true;
     }
     if (name == "plugin_searchpath" && type == TypeString) {
-        plugin_searchpath = ustring(*(const char**)val);
+        ustring searchpath(*(const char**)val);
+        if (searchpath != plugin_searchpath) {
+            plugin_searchpath = searchpath;
+            reset_plugin_searchpath_scanned();
+        }
+        return true;
+    }
+    if (name == "plugin_index" && type == TypeString) {
+        plugin_index = ustring(*(const char**)val);
         return true;
     }
     if (name == "exr_threads" && type == TypeInt) {
@@ -407,6 +421,14 @@ attribute(string_view name, TypeDesc type, const void* val)
         dds_bc5normal = *(const int*)val;
         return true;
     }
+    if (name == "ffmpeg:frame_cache_MB" && type == TypeInt) {
+        ffmpeg_frame_cache_MB = std::max(0, *(const int*)val);
+        return true;
+    }
+    if (name == "dpx:bitpack_bands" && type == TypeInt) {
+        dpx_bitpack_bands = *(const int*)val;
+        return true;
+    }
     if (name == "limits:channels" && type == TypeInt) {
         limit_channels = *(const int*)val;
         return true;
@@ -427,10 +449,18 @@ attribute(string_view name, TypeDesc type, const void* val)
         imagebuf_use_imagecache = *(const int*)val;
         return true;
     }
+    if (name == "imagebuf:async_writes" && type == TypeInt) {
+        imagebuf_async_writes = std::max(1, *(const int*)val);
+        return true;
+    }
     if (name == "imageinput:strict" && type == TypeInt) {
         imageinput_strict = *(const int*)val;
         return true;
     }
+    if (name == "colorconvert:lut" && type == TypeInt) {
+        colorconvert_lut = *(const int*)val;
+        return true;
+    }
     if (name == "use_tbb" && type == TypeInt) {
         oiio_use_tbb = *(const int*)val;
         return true;
@@ -511,33 +541,32 @@ getattribute(string_view name, TypeDesc type, void* val)
         *(ustring*)val = plugin_searchpath;
         return true;
     }
+    if (name == "plugin_index" && type == TypeString) {
+        *(ustring*)val = plugin_index;
+        return true;
+    }
     if (name == "format_list" && type == TypeString) {
-        if (format_list.empty())
-            OIIO::pvt::catalog_all_plugins(plugin_searchpath.string());
+        OIIO::pvt::ensure_all_plugins_cataloged();
         *(ustring*)val = ustring(format_list);
         return true;
     }
     if (name == "input_format_list" && type == TypeString) {
-        if (input_format_list.empty())
-            OIIO::pvt::catalog_all_plugins(plugin_searchpath.string());
+        OIIO::pvt::ensure_all_plugins_cataloged();
         *(ustring*)val = ustring(input_format_list);
         return true;
     }
     if (name == "output_format_list" && type == TypeString) {
-        if (output_format_list.empty())
-            OIIO::pvt::catalog_all_plugins(plugin_searchpath.string());
+        OIIO::pvt::ensure_all_plugins_cataloged();
         *(ustring*)val = ustring(output_format_list);
         return true;
     }
     if (name == "extension_list" && type == TypeString) {
-        if (extension_list.empty())
-            OIIO::pvt::catalog_all_plugins(plugin_searchpath.string());
+        OIIO::pvt::ensure_all_plugins_cataloged();
         *(ustring*)val = ustring(extension_list);
         return true;
     }
     if (name == "library_list" && type == TypeString) {
-        if (library_list.empty())
-            OIIO::pvt::catalog_all_plugins(plugin_searchpath.string());
+        OIIO::pvt::ensure_all_plugins_cataloged();
         *(ustring*)val = ustring(library_list);
         return true;
     }
@@ -613,6 +642,14 @@ getattribute(string_view name, TypeDesc type, void* val)
         *(int*)val = dds_bc5normal;
         return true;
     }
+    if (name == "ffmpeg:frame_cache_MB" && type == TypeInt) {
+        *(int*)val = ffmpeg_frame_cache_MB;
+        return true;
+    }
+    if (name == "dpx:bitpack_bands" && type == TypeInt) {
+        *(int*)val = dpx_bitpack_bands;
+        return true;
+    }
     if (name == "oiio:print_uncaught_errors" && type == TypeInt) {
         *(int*)val = oiio_print_uncaught_errors;
         return true;
@@ -625,10 +662,18 @@ getattribute(string_view name, TypeDesc type, void* val)
         *(int*)val = imagebuf_use_imagecache;
         return true;
     }
+    if (name == "imagebuf:async_writes" && type == TypeInt) {
+        *(int*)val = imagebuf_async_writes;
+        return true;
+    }
     if (name == "imageinput:strict" && type == TypeInt) {
         *(int*)val = imageinput_strict;
         return true;
     }
+    if (name == "colorconvert:lut" && type == TypeInt) {
+        *(int*)val = colorconvert_lut;
+        return true;
+    }
     if (name == "use_tbb" && type == TypeInt) {
         *(int*)val = oiio_use_tbb;
         return true;
@@ -4,6 +4,8 @@
 
 #include <cstdio>
 #include <cstdlib>
+#include <cstring>
+#include <ctime>
 #include <map>
 #include <set>
 #include <string>
@@ -45,8 +47,39 @@ static std::map<std::string, std::string> extension_to_format_map;
 // This should be guarded by imageio_mutex.
 static std::vector<ustring> format_list_vector;
 
-// Which format names and extensions are procedural (not reading from files)
-static std::set<std::string> procedural_plugins;
+// Which format names and extensions are procedural (not reading from files).
+// Filled in lazily, the first time we are asked about each one.
+static std::map<std::string, bool> procedural_plugins;
+
+// Format names that already appear in the format, extension, and library
+// lists.
+static std::set<std::string> listed_formats;
+
+// Has the plugin searchpath been scanned at least once?
+static bool plugin_searchpath_scanned = false;
+
+// What we remember about a DSO plugin in the plugin index, so that on
+// subsequent runs we don't need to load the plugin until its format is
+// actually requested.
+struct PluginIndexEntry {
+    std::string format_name;
+    std::string lib_version;
+    std::vector<std::string> input_extensions;
+    std::vector<std::string> output_extensions;
+    std::time_t mtime = 0;
+    uint64_t filesize = 0;
+    bool has_input    = false;
+    bool has_output   = false;
+    bool procedural   = false;
+};
+
+// Map full path of a DSO plugin to its plugin index entry
+static std::map<std::string, PluginIndexEntry> plugin_index_entries;
+// Name of the plugin index file that plugin_index_entries was read from
+static std::string plugin_index_filename;
+// Map format name (and extensions) to the full path of DSO plugins that are
+// known from the plugin index, but have not yet been loaded.
+static std::map<std::string, std::string> deferred_plugins;
 
 static std::string pattern = Strutil::fmt::format(".imageio.{}",
                                                   Plugin::plugin_extension());
@@ -59,10 +92,149 @@ add_if_missing(std::vector<std::string>& vec, const std::string& val)
         vec.push_back(val);
 }
 
+
+
+// Magic number signatures of the file formats whose readers can reliably
+// recognize a file by its first few bytes, as declared by the plugins
+// themselves (see declare_imageio_format_signatures()). When
+// ImageInput::create() can't rely on the file extension, it reads the file
+// header once and matches it against these, so that only the readers that
+// could plausibly accept the file are asked to open it. Formats without
+// signatures (because they have no magic number, or one that can't be
+// checked this simply) are still tried, after the ones whose signatures
+// matched.
+struct FormatSignature {
+    size_t offset;      // Byte offset of the signature in the file
+    std::string bytes;  // The signature itself
+};
+
+// Map format name to its signatures. This should be guarded by
+// imageio_mutex.
+static std::map<std::string, std::vector<FormatSignature>> format_signatures;
+
+// How many bytes from the start of a file we need in order to check every
+// registered signature. This should be guarded by imageio_mutex.
+static size_t format_signature_header_size = 0;
+
+
+
+// Same as declare_imageio_format_signatures except that ownership of
+// imageio_mutex is implied.
+static void
+declare_imageio_format_signatures_locked(const std::string& format_name,
+                                         const char** signatures)
+{
+    auto hexdigit = [](char c) -> int {
+        return c >= '0' && c <= '9'   ? c - '0'
+               : c >= 'a' && c <= 'f' ? c - 'a' + 10
+               : c >= 'A' && c <= 'F' ? c - 'A' + 10
+                                      : -1;
+    };
+    for (const char** s = signatures; s && *s; ++s) {
+        string_view str(*s);
+        FormatSignature sig { 0, std::string() };
+        bool ok = true;
+        size_t colon = str.find(':');
+        if (colon != string_view::npos) {
+            ok = Strutil::string_is_int(str.substr(0, colon));
+            sig.offset = size_t(
+                std::max(0, Strutil::from_string<int>(str.substr(0, colon))));
+            str.remove_prefix(colon + 1);
+        }
+        ok &= str.size() && str.size() % 2 == 0;
+        for (size_t i = 0; ok && i < str.size(); i += 2) {
+            int hi = hexdigit(str[i]), lo = hexdigit(str[i + 1]);
+            ok = hi >= 0 && lo >= 0;
+            sig.bytes += char(hi * 16 + lo);
+        }
+        if (!ok) {
+            OIIO::debugfmt("Ignoring malformed signature \"{}\" for format {}\n",
+                           *s, format_name);
+            continue;
+        }
+        format_signature_header_size
+            = std::max(format_signature_header_size,
+                       sig.offset + sig.bytes.size());
+        format_signatures[format_name].push_back(std::move(sig));
+    }
+}
+
+
+
+enum class SignatureMatch { Unknown, Match, Mismatch };
+
+// Check the file header against the registered signatures for the format.
+// Return Unknown if the format has no registered signatures. Caller must
+// hold imageio_mutex.
+static SignatureMatch
+match_format_signature(const std::string& format_name,
+                       cspan<unsigned char> header)
+{
+    auto found = format_signatures.find(format_name);
+    if (found == format_signatures.end())
+        return SignatureMatch::Unknown;
+    for (const auto& sig : found->second) {
+        if (sig.offset + sig.bytes.size() <= size_t(header.size())
+            && !memcmp(header.data() + sig.offset, sig.bytes.data(),
+                       sig.bytes.size()))
+            return SignatureMatch::Match;
+    }
+    return SignatureMatch::Mismatch;
+}
+
+
+
+// IOProxy used while probing candidate readers: the first bytes of the file,
+// already read for signature matching, are served from memory, and only
+// reads past them go to the underlying proxy. This lets all of the
+// valid_file() probes share one open of the file.
+class IOHeaderPrefixed final : public Filesystem::IOProxy {
+public:
+    IOHeaderPrefixed(Filesystem::IOProxy* io, cspan<unsigned char> header)
+        : IOProxy(io->filename(), Read)
+        , m_io(io)
+        , m_header(header)
+    {
+    }
+    const char* proxytype() const override { return "headerprefixed"; }
+    size_t read(void* buf, size_t size) override
+    {
+        size = pread(buf, size, m_pos);
+        m_pos += size;
+        return size;
+    }
+    size_t pread(void* buf, size_t size, int64_t offset) override
+    {
+        if (offset < 0)
+            return 0;
+        size_t n = 0;
+        if (size_t(offset) < m_header.size()) {
+            n = std::min(size, m_header.size() - size_t(offset));
+            memcpy(buf, m_header.data() + offset, n);
+        }
+        if (n < size)
+            n += m_io->pread((char*)buf + n, size - n, offset + int64_t(n));
+        return n;
+    }
+    size_t size() const override { return m_io->size(); }
+
+private:
+    Filesystem::IOProxy* m_io;
+    cspan<unsigned char> m_header;
+};
+
 }  // namespace
 
 
 
+static void
+list_imageio_format(const std::string& format_name, bool has_input,
+                    bool has_output,
+                    const std::vector<std::string>& all_extensions,
+                    const char* lib_version);
+
+
+
 // Same as declare_imageio_format except that ownership of imageio_mutex is implied
 void
 declare_imageio_format_locked(const std::string& format_name,
@@ -111,18 +283,33 @@ declare_imageio_format_locked(const std::string& format_name,
             extension_to_format_map[ext] = format_name;
     }
 
-    // Add the name to the master list of format_names, and extensions to
-    // their master list.
+    list_imageio_format(format_name, input_creator != nullptr,
+                        output_creator != nullptr, all_extensions, lib_version);
+}
+
+
+
+// Add the name to the master list of format_names, and extensions to their
+// master list, unless it's already there (which will be the case when a
+// plugin known from the plugin index is finally loaded).
+static void
+list_imageio_format(const std::string& format_name, bool has_input,
+                    bool has_output,
+                    const std::vector<std::string>& all_extensions,
+                    const char* lib_version)
+{
+    if (!listed_formats.insert(format_name).second)
+        return;
     format_list_vector.emplace_back(Strutil::lower(format_name));
     if (format_list.length())
         format_list += std::string(",");
     format_list += format_name;
-    if (input_creator) {
+    if (has_input) {
         if (input_format_list.length())
             input_format_list += std::string(",");
         input_format_list += format_name;
     }
-    if (output_creator) {
+    if (has_output) {
         if (output_format_list.length())
             output_format_list += std::string(",");
         output_format_list += format_name;
@@ -162,34 +349,29 @@ declare_imageio_format(const std::string& format_name,
 
 
 
-bool
-is_imageio_format_name(string_view name)
+void
+declare_imageio_format_signatures(const std::string& format_name,
+                                  const char** signatures)
 {
-    ustring namelower(Strutil::lower(name));
-
-    std::unique_lock<std::recursive_mutex> lock(imageio_mutex);
-    // If we were called before any plugins were loaded at all, catalog now
-    if (!format_list_vector.size()) {
-        lock.unlock();
-        // catalog_all_plugins() will lock imageio_mutex.
-        OIIO::pvt::catalog_all_plugins(OIIO::pvt::plugin_searchpath.string());
-        lock.lock();
-    }
-    for (const auto& n : format_list_vector)
-        if (namelower == n)
-            return true;
-    return false;
+    std::lock_guard<std::recursive_mutex> lock(OIIO::pvt::imageio_mutex);
+    declare_imageio_format_signatures_locked(format_name, signatures);
 }
 
+
+
 OIIO_NAMESPACE_3_1_END
 
 
 
 OIIO_NAMESPACE_BEGIN
 
-static void
+// Load the DSO plugin and declare its format. If `entry` is not null, fill
+// it in with what the plugin index needs to remember about it. Return true
+// if the plugin was loaded and declared.
+static bool
 catalog_plugin(const std::string& format_name,
-               const std::string& plugin_fullpath)
+               const std::string& plugin_fullpath,
+               PluginIndexEntry* entry = nullptr)
 {
     // Remember the plugin
     std::map<std::string, std::string>::const_iterator found_path;
@@ -198,18 +380,18 @@ catalog_plugin(const std::string& format_name,
         // Hey, we already have an entry for this format
         if (found_path->second == plugin_fullpath) {
             // It's ok if they're both the same file; just skip it.
-            return;
+            return false;
         }
         OIIO::debugfmt("OpenImageIO WARNING: {} had multiple plugins:\n"
                        "\t\"{}\"\n    as well as\n\t\"{}\"\n"
                        "    Ignoring all but the first one.\n",
                        format_name, found_path->second, plugin_fullpath);
-        return;
+        return false;
     }
 
     Plugin::Handle handle = Plugin::open(plugin_fullpath);
     if (!handle) {
-        return;
+        return false;
     }
 
     std::string version_function = format_name + "_imageio_version";
@@ -217,7 +399,7 @@ catalog_plugin(const std::string& format_name,
                                                         version_function.c_str());
     if (!plugin_version || *plugin_version != OIIO_PLUGIN_VERSION) {
         Plugin::close(handle);
-        return;
+        return false;
     }
 
     std::string lib_version_function = format_name + "_imageio_library_version";
@@ -240,14 +422,219 @@ catalog_plugin(const std::string& format_name,
         = (const char**)Plugin::getsym(handle,
                                        format_name + "_output_extensions");
 
-    if (input_creator || output_creator)
-        declare_imageio_format_locked(format_name, input_creator,
-                                      input_extensions, output_creator,
-                                      output_extensions,
-                                      plugin_lib_version ? plugin_lib_version()
-                                                         : NULL);
-    else
+    if (!input_creator && !output_creator) {
         Plugin::close(handle);  // not useful
+        return false;
+    }
+    const char* lib_version = plugin_lib_version ? plugin_lib_version()
+                                                 : nullptr;
+    declare_imageio_format_locked(format_name, input_creator, input_extensions,
+                                  output_creator, output_extensions,
+                                  lib_version);
+    // Signatures are optional, so it's not an error if there are none.
+    const char** signatures
+        = (const char**)Plugin::getsym(handle,
+                                       format_name + "_imageio_signatures",
+                                       false);
+    if (input_creator)
+        declare_imageio_format_signatures_locked(format_name, signatures);
+
+    if (entry) {
+        entry->format_name = format_name;
+        entry->lib_version = lib_version ? lib_version : "";
+        entry->input_extensions.clear();
+        entry->output_extensions.clear();
+        for (const char** e = input_extensions; input_creator && e && *e; ++e)
+            entry->input_extensions.emplace_back(Strutil::lower(*e));
+        for (const char** e = output_extensions; output_creator && e && *e;
+             ++e)
+            entry->output_extensions.emplace_back(Strutil::lower(*e));
+        entry->mtime      = Filesystem::last_write_time(plugin_fullpath);
+        entry->filesize   = Filesystem::file_size(plugin_fullpath);
+        entry->has_input  = input_creator != nullptr;
+        entry->has_output = output_creator != nullptr;
+        // We have the plugin loaded anyway, so this is the time to find out
+        // whether it's procedural, to save loading it later just to ask.
+        std::unique_ptr<ImageInput> inp;
+        try {
+            if (input_creator)
+                inp.reset(input_creator());
+        } catch (...) {
+        }
+        entry->procedural = inp && inp->supports("procedural");
+    }
+    return true;
+}
+
+
+
+// Read the plugin index file named by the "plugin_index" attribute, if it
+// hasn't already been read. Each line describes one DSO plugin, with
+// tab-separated fields: full path, modification time, file size, format
+// name, capability flags ('i' input, 'o' output, 'p' procedural),
+// comma-separated input extensions, comma-separated output extensions, and
+// the underlying library version.
+static void
+read_plugin_index()
+{
+    std::string filename = pvt::plugin_index.string();
+    if (filename == plugin_index_filename)
+        return;
+    plugin_index_entries.clear();
+    plugin_index_filename = filename;
+    std::string contents;
+    if (filename.empty() || !Filesystem::read_text_file(filename, contents))
+        return;
+    for (string_view line : Strutil::splitsv(contents, "\n")) {
+        auto fields = Strutil::splits(line, "\t");
+        if (fields.size() != 8 || fields[0].empty() || fields[3].empty())
+            continue;
+        PluginIndexEntry& entry(plugin_index_entries[fields[0]]);
+        entry.mtime       = Strutil::from_string<int64_t>(fields[1]);
+        entry.filesize    = Strutil::from_string<uint64_t>(fields[2]);
+        entry.format_name = fields[3];
+        entry.has_input   = Strutil::contains(fields[4], "i");
+        entry.has_output  = Strutil::contains(fields[4], "o");
+        entry.procedural  = Strutil::contains(fields[4], "p");
+        if (fields[5].size())
+            entry.input_extensions = Strutil::splits(fields[5], ",");
+        if (fields[6].size())
+            entry.output_extensions = Strutil::splits(fields[6], ",");
+        entry.lib_version = fields[7];
+    }
+}
+
+
+
+// Is there a plugin index that lists at least one plugin? Caller must hold
+// imageio_mutex.
+static bool
+plugin_index_in_use()
+{
+    read_plugin_index();
+    return !plugin_index_entries.empty();
+}
+
+
+
+// Find the plugin index entry whose format name (or, if `extensions` is
+// true, one of whose input extensions) is `name`, provided that its plugin
+// hasn't changed since it was indexed. Caller must hold imageio_mutex.
+static const PluginIndexEntry*
+find_indexed_plugin(const std::string& name, bool extensions)
+{
+    read_plugin_index();
+    for (const auto& p : plugin_index_entries) {
+        const PluginIndexEntry& entry(p.second);
+        if (entry.format_name != name
+            && !(extensions
+                 && std::find(entry.input_extensions.begin(),
+                              entry.input_extensions.end(), name)
+                        != entry.input_extensions.end()))
+            continue;
+        if (entry.mtime == Filesystem::last_write_time(p.first)
+            && entry.filesize == Filesystem::file_size(p.first))
+            return &entry;
+    }
+    return nullptr;
+}
+
+
+
+// Write the plugin index file. The new contents are written to a temporary
+// file and renamed, so that concurrent processes never see a partial index.
+static void
+write_plugin_index()
+{
+    if (plugin_index_filename.empty())
+        return;
+    std::string contents;
+    for (const auto& p : plugin_index_entries) {
+        const PluginIndexEntry& entry(p.second);
+        std::string flags = Strutil::fmt::format("{}{}{}",
+                                                 entry.has_input ? "i" : "",
+                                                 entry.has_output ? "o" : "",
+                                                 entry.procedural ? "p" : "");
+        contents += Strutil::fmt::format(
+            "{}\t{}\t{}\t{}\t{}\t{}\t{}\t{}\n", p.first,
+            int64_t(entry.mtime), entry.filesize, entry.format_name, flags,
+            Strutil::join(entry.input_extensions, ","),
+            Strutil::join(entry.output_extensions, ","), entry.lib_version);
+    }
+    std::string tmpname = plugin_index_filename + "."
+                          + Filesystem::unique_path();
+    std::string err;
+    if (!Filesystem::write_text_file(tmpname, contents)
+        || !Filesystem::rename(tmpname, plugin_index_filename, err)) {
+        Filesystem::remove(tmpname, err);
+        OIIO::debugfmt("Could not write plugin index \"{}\"\n",
+                       plugin_index_filename);
+    }
+}
+
+
+
+// Declare a DSO plugin known from the plugin index without loading it: its
+// format name and extensions are listed and remembered, and the plugin
+// itself will be loaded by load_deferred_plugin() the first time that one
+// of them is actually requested.
+static void
+defer_plugin(const std::string& plugin_fullpath, const PluginIndexEntry& entry)
+{
+    const std::string& format_name(entry.format_name);
+    if (plugin_filepaths.find(format_name) != plugin_filepaths.end()
+        || deferred_plugins.find(format_name) != deferred_plugins.end())
+        return;  // first plugin for a format wins, as in catalog_plugin()
+    std::vector<std::string> all_extensions;
+    auto defer_name = [&](const std::string& name, bool input) {
+        deferred_plugins.emplace(name, plugin_fullpath);
+        if (input)
+            procedural_plugins.emplace(name, entry.procedural);
+    };
+    defer_name(format_name, entry.has_input);
+    for (const auto& ext : entry.input_extensions) {
+        defer_name(ext, true);
+        add_if_missing(all_extensions, ext);
+    }
+    for (const auto& ext : entry.output_extensions) {
+        defer_name(ext, false);
+        add_if_missing(all_extensions, ext);
+    }
+    list_imageio_format(format_name, entry.has_input, entry.has_output,
+                        all_extensions,
+                        entry.lib_version.size() ? entry.lib_version.c_str()
+                                                 : nullptr);
+}
+
+
+
+// If the format name or extension belongs to a deferred DSO plugin, load it
+// now. Return true if a plugin was loaded. Caller must hold imageio_mutex.
+static bool
+load_deferred_plugin(const std::string& name)
+{
+    auto found = deferred_plugins.find(name);
+    if (found == deferred_plugins.end())
+        return false;
+    std::string plugin_fullpath = found->second;
+    for (auto d = deferred_plugins.begin(); d != deferred_plugins.end();) {
+        if (d->second == plugin_fullpath)
+            d = deferred_plugins.erase(d);
+        else
+            ++d;
+    }
+    return catalog_plugin(plugin_index_entries[plugin_fullpath].format_name,
+                          plugin_fullpath);
+}
+
+
+
+// Load all of the deferred DSO plugins. Caller must hold imageio_mutex.
+static void
+load_all_deferred_plugins()
+{
+    while (!deferred_plugins.empty())
+        load_deferred_plugin(deferred_plugins.begin()->first);
 }
 
 
@@ -272,6 +659,7 @@ catalog_plugin(const std::string& format_name,
         ImageOutput* name##_output_imageio_create();   \
         extern const char* name##_output_extensions[]; \
         extern const char* name##_imageio_library_version();
+#    define PLUGSIGS(name) extern const char* name##_imageio_signatures[];
 
 PLUGENTRY(bmp);
 PLUGENTRY(cineon);
@@ -306,6 +694,25 @@ PLUGENTRY(targa);
 PLUGENTRY(webp);
 PLUGENTRY(zfile);
 
+PLUGSIGS(bmp);
+PLUGSIGS(cineon);
+PLUGSIGS(dds);
+PLUGSIGS(dpx);
+PLUGSIGS(fits);
+PLUGSIGS(gif);
+PLUGSIGS(hdr);
+PLUGSIGS(ico);
+PLUGSIGS(jpeg);
+PLUGSIGS(jpeg2000);
+PLUGSIGS(jpegxl);
+PLUGSIGS(openexr);
+PLUGSIGS(png);
+PLUGSIGS(psd);
+PLUGSIGS(sgi);
+PLUGSIGS(softimage);
+PLUGSIGS(tiff);
+PLUGSIGS(webp);
+
 
 #endif  // defined(EMBED_PLUGINS)
 
@@ -338,61 +745,76 @@ catalog_builtin_plugins()
             (ImageOutput::Creator)name##_output_imageio_create,          \
             name##_output_extensions,                                    \
             name##_imageio_library_version())
+#define DECLARESIGS(name)                                                \
+        declare_imageio_format_signatures(#name, name##_imageio_signatures)
 
 // Declare the most commonly used formats we encounter first, so that they are
 // tried right away any time we have to try each format in turn.
 #if !defined(DISABLE_OPENEXR)
     DECLAREPLUG (openexr);
+    DECLARESIGS (openexr);
 #endif
 #if !defined(DISABLE_TIFF)
     DECLAREPLUG (tiff);
+    DECLARESIGS (tiff);
 #endif
 #if !defined(DISABLE_JPEG)
     DECLAREPLUG (jpeg);
+    DECLARESIGS (jpeg);
 #endif
 
 // Now all the less common formats, in alphabetical order.
 #if !defined(DISABLE_BMP)
     DECLAREPLUG (bmp);
+    DECLARESIGS (bmp);
 #endif
 #if !defined(DISABLE_CINEON)
     DECLAREPLUG_RO (cineon);
+    DECLARESIGS (cineon);
 #endif
 #if !defined(DISABLE_DDS)
     DECLAREPLUG_RO (dds);
+    DECLARESIGS (dds);
 #endif
 #if defined(USE_DCMTK) && !defined(DISABLE_DICOM)
     DECLAREPLUG_RO (dicom);
 #endif
 #if !defined(DISABLE_DPX)
     DECLAREPLUG (dpx);
+    DECLARESIGS (dpx);
 #endif
 #if defined(USE_FFMPEG) && !defined(DISABLE_FFMPEG)
     DECLAREPLUG_RO (ffmpeg);
 #endif
 #if !defined(DISABLE_FITS)
     DECLAREPLUG (fits);
+    DECLARESIGS (fits);
 #endif
 #if defined(USE_GIF) && !defined(DISABLE_GIF)
     DECLAREPLUG (gif);
+    DECLARESIGS (gif);
 #endif
 #if defined(USE_HEIF) && !defined(DISABLE_HEIF)
     DECLAREPLUG (heif);
 #endif
 #if !defined(DISABLE_HDR)
     DECLAREPLUG (hdr);
+    DECLARESIGS (hdr);
 #endif
 #if !defined(DISABLE_ICO)
     DECLAREPLUG (ico);
+    DECLARESIGS (ico);
 #endif
 #if !defined(DISABLE_IFF)
     DECLAREPLUG (iff);
 #endif
 #if defined(USE_OPENJPEG) && !defined(DISABLE_JPEG2000)
     DECLAREPLUG (jpeg2000);
+    DECLARESIGS (jpeg2000);
 #endif
 #if defined(USE_JXL)
     DECLAREPLUG (jpegxl);
+    DECLARESIGS (jpegxl);
 #endif
 #if !defined(DISABLE_NULL)
     DECLAREPLUG (null);
@@ -402,12 +824,14 @@ catalog_builtin_plugins()
 #endif
 #if !defined(DISABLE_PNG)
     DECLAREPLUG (png);
+    DECLARESIGS (png);
 #endif
 #if !defined(DISABLE_PNM)
     DECLAREPLUG (pnm);
 #endif
 #if !defined(DISABLE_PSD)
     DECLAREPLUG_RO (psd);
+    DECLARESIGS (psd);
 #endif
 #if defined(USE_PTEX) && !defined(DISABLE_PTEX)
     DECLAREPLUG_RO (ptex);
@@ -423,9 +847,11 @@ catalog_builtin_plugins()
 #endif
 #if !defined(DISABLE_SGI)
     DECLAREPLUG (sgi);
+    DECLARESIGS (sgi);
 #endif
 #if !defined(DISABLE_SOFTIMAGE)
     DECLAREPLUG_RO (softimage);
+    DECLARESIGS (softimage);
 #endif
 #if !defined(DISABLE_TARGA)
     DECLAREPLUG (targa);
@@ -435,6 +861,7 @@ catalog_builtin_plugins()
 #endif
 #if defined(USE_WEBP) && !defined(DISABLE_WEBP)
     DECLAREPLUG (webp);
+    DECLARESIGS (webp);
 #endif
 #if !defined(DISABLE_ZFILE)
     DECLAREPLUG (zfile);
@@ -466,15 +893,26 @@ append_if_env_exists(std::string& searchpath, const char* env,
 
 
 
+static void
+catalog_builtin_plugins_once()
+{
+    static std::once_flag builtin_flag;
+    std::call_once(builtin_flag, catalog_builtin_plugins);
+}
+
+
+
 /// Look at ALL imageio plugins in the searchpath and add them to the
-/// catalog.
+/// catalog. Plugins that the plugin index says are unchanged since they
+/// were last indexed are not loaded, only listed, until they are needed.
 void
 pvt::catalog_all_plugins(std::string searchpath)
 {
-    static std::once_flag builtin_flag;
-    std::call_once(builtin_flag, catalog_builtin_plugins);
+    catalog_builtin_plugins_once();
 
     std::unique_lock<std::recursive_mutex> lock(imageio_mutex);
+    read_plugin_index();
+    bool index_changed = false;
     append_if_env_exists(searchpath, "OPENIMAGEIO_PLUGIN_PATH", true);
     // obsolete name:
     append_if_env_exists(searchpath, "OIIO_LIBRARY_PATH", true);
@@ -492,37 +930,133 @@ pvt::catalog_all_plugins(std::string searchpath)
                 && (found == leaf.length() - patlen)) {
                 std::string pluginname(leaf.begin(),
                                        leaf.begin() + leaf.length() - patlen);
-                catalog_plugin(pluginname, full_filename);
+                if (plugin_index_filename.empty()) {
+                    catalog_plugin(pluginname, full_filename);
+                    continue;
+                }
+                auto indexed = plugin_index_entries.find(full_filename);
+                if (indexed != plugin_index_entries.end()
+                    && indexed->second.format_name == pluginname
+                    && indexed->second.mtime
+                           == Filesystem::last_write_time(full_filename)
+                    && indexed->second.filesize
+                           == Filesystem::file_size(full_filename)) {
+                    defer_plugin(full_filename, indexed->second);
+                    continue;
+                }
+                PluginIndexEntry entry;
+                if (catalog_plugin(pluginname, full_filename, &entry)) {
+                    plugin_index_entries[full_filename] = entry;
+                    index_changed = true;
+                }
             }
         }
     }
+    plugin_searchpath_scanned = true;
+    if (index_changed)
+        write_plugin_index();
+}
+
 
-    // Inventory the procedural plugins
-    auto current_input_formats = input_formats;  // do a copy
-    for (auto&& f : current_input_formats) {
+
+/// Make sure that a plugin for the format name or extension, for input or
+/// output, is cataloged if there is one, doing as little work as possible:
+/// try the builtin plugins first, then a deferred plugin known from the
+/// plugin index, and only scan the whole searchpath if neither has it.
+static void
+catalog_plugin_for(const std::string& format, bool input,
+                   string_view searchpath)
+{
+    catalog_builtin_plugins_once();
+    std::unique_lock<std::recursive_mutex> lock(imageio_mutex);
+    auto cataloged = [&]() {
+        return input ? input_formats.find(format) != input_formats.end()
+                     : output_formats.find(format) != output_formats.end();
+    };
+    if (cataloged() || (load_deferred_plugin(format) && cataloged()))
+        return;
+    lock.unlock();
+    // catalog_all_plugins() will lock imageio_mutex.
+    pvt::catalog_all_plugins(searchpath);
+    lock.lock();
+    load_deferred_plugin(format);
+}
+
+
+
+void
+pvt::ensure_all_plugins_cataloged()
+{
+    std::unique_lock<std::recursive_mutex> lock(imageio_mutex);
+    if (!plugin_searchpath_scanned) {
         lock.unlock();
-        // ImageInput::create will take a lock of imageio_mutex
-        auto inp = ImageInput::create(f.first);
-        lock.lock();
-        if (inp->supports("procedural"))
-            procedural_plugins.insert(f.first);
+        // catalog_all_plugins() will lock imageio_mutex.
+        pvt::catalog_all_plugins(pvt::plugin_searchpath.string());
     }
 }
 
 
 
+void
+pvt::reset_plugin_searchpath_scanned()
+{
+    std::lock_guard<std::recursive_mutex> lock(imageio_mutex);
+    plugin_searchpath_scanned = false;
+}
+
+
+
 bool
 pvt::is_procedural_plugin(const std::string& name)
 {
-    std::unique_lock<std::recursive_mutex> lock(imageio_mutex);
+    // Format names and extensions never contain dots or path separators, so
+    // a filename needs no further looking into.
+    if (name.empty() || name.find_first_of("./\\") != std::string::npos)
+        return false;
 
-    if (!format_list_vector.size()) {
+    catalog_builtin_plugins_once();
+    std::unique_lock<std::recursive_mutex> lock(imageio_mutex);
+    auto found = procedural_plugins.find(name);
+    if (found != procedural_plugins.end())
+        return found->second;
+
+    auto plugin = input_formats.find(name);
+    if (plugin == input_formats.end() && !plugin_searchpath_scanned) {
+        // Not a builtin format. Rather than loading every plugin in the
+        // searchpath to find out, ask the plugin index if there is one
+        // (which then is taken to know every plugin there is).
+        if (plugin_index_in_use()) {
+            const PluginIndexEntry* entry = find_indexed_plugin(name, true);
+            if (!entry)
+                return false;
+            bool procedural = entry->has_input && entry->procedural;
+            procedural_plugins[name] = procedural;
+            return procedural;
+        }
         lock.unlock();
         // catalog_all_plugins() will lock imageio_mutex.
         pvt::catalog_all_plugins(pvt::plugin_searchpath.string());
         lock.lock();
+        plugin = input_formats.find(name);
+    }
+
+    // The first time we're asked about a format name or extension, create
+    // one of its readers and ask it. Anything else isn't procedural and
+    // isn't remembered.
+    if (plugin == input_formats.end() || !plugin->second)
+        return false;
+    ImageInput::Creator create_function = plugin->second;
+    lock.unlock();
+    std::unique_ptr<ImageInput> inp;
+    try {
+        inp.reset(create_function());
+    } catch (...) {
+        // Safety in case the ctr throws an exception
     }
-    return procedural_plugins.find(name) != procedural_plugins.end();
+    bool procedural = inp && inp->supports("procedural");
+    lock.lock();
+    procedural_plugins[name] = procedural;
+    return procedural;
 }
 
 OIIO_NAMESPACE_END
@@ -531,6 +1065,34 @@ OIIO_NAMESPACE_END
 OIIO_NAMESPACE_3_1_BEGIN
 
 
+bool
+is_imageio_format_name(string_view name)
+{
+    ustring namelower(Strutil::lower(name));
+    auto listed = [&]() {
+        for (const auto& n : format_list_vector)
+            if (namelower == n)
+                return true;
+        return false;
+    };
+
+    catalog_builtin_plugins_once();
+    std::unique_lock<std::recursive_mutex> lock(imageio_mutex);
+    if (listed() || plugin_searchpath_scanned)
+        return listed();
+    // Not a builtin format. Rather than loading every plugin in the
+    // searchpath to find out, ask the plugin index if there is one.
+    if (plugin_index_in_use())
+        return find_indexed_plugin(namelower.string(), false) != nullptr;
+    lock.unlock();
+    // catalog_all_plugins() will lock imageio_mutex.
+    OIIO::pvt::catalog_all_plugins(OIIO::pvt::plugin_searchpath.string());
+    lock.lock();
+    return listed();
+}
+
+
+
 std::unique_ptr<ImageOutput>
 ImageOutput::create(string_view filename, Filesystem::IOProxy* ioproxy,
                     string_view plugin_searchpath)
@@ -558,11 +1120,11 @@ ImageOutput::create(string_view filename, Filesystem::IOProxy* ioproxy,
         OutputPluginMap::const_iterator found = output_formats.find(format);
         if (found == output_formats.end()) {
             lock.unlock();
-            // catalog_all_plugins() will lock imageio_mutex
-            catalog_all_plugins(
-                plugin_searchpath.size()
-                    ? plugin_searchpath
-                    : string_view(OIIO::pvt::plugin_searchpath));
+            // catalog_plugin_for() will lock imageio_mutex
+            catalog_plugin_for(format, false,
+                               plugin_searchpath.size()
+                                   ? plugin_searchpath
+                                   : string_view(OIIO::pvt::plugin_searchpath));
             lock.lock();
             found = output_formats.find(format);
         }
@@ -661,8 +1223,8 @@ ImageInput::create(string_view filename, bool do_open, const ImageSpec* config,
             if (plugin_searchpath.empty())
                 plugin_searchpath = OIIO::pvt::plugin_searchpath;
             lock.unlock();
-            // catalog_all_plugins() will lock imageio_mutex.
-            catalog_all_plugins(plugin_searchpath);
+            // catalog_plugin_for() will lock imageio_mutex.
+            catalog_plugin_for(format, true, plugin_searchpath);
             lock.lock();
             found = input_formats.find(format);
         }
@@ -727,14 +1289,65 @@ ImageInput::create(string_view filename, bool do_open, const ImageSpec* config,
         // any will open the file.  Add a configuration request that
         // includes a "nowait" option so that it returns immediately if
         // it's a plugin that might wait for an event, like a socket that
-        // doesn't yet exist).
+        // doesn't yet exist). Every reader is a candidate here, so make
+        // sure that all the plugins are actually loaded.
+        if (plugin_searchpath.empty())
+            plugin_searchpath = OIIO::pvt::plugin_searchpath;
+        {
+            std::unique_lock<std::recursive_mutex> lock(imageio_mutex);
+            if (!plugin_searchpath_scanned) {
+                lock.unlock();
+                catalog_all_plugins(plugin_searchpath);
+                lock.lock();
+            }
+            load_all_deferred_plugins();
+        }
         ImageSpec myconfig;
         if (config)
             myconfig = *config;
         myconfig.attribute("nowait", (int)1);
+
+        // Read the header of the file just once and match it against the
+        // known format signatures. Readers whose signature matched are
+        // tried first, then those with no registered signature. Readers
+        // whose signatures don't match are skipped entirely, and the
+        // valid_file() probes share the one open file.
+        std::unique_ptr<Filesystem::IOProxy> localio;
+        Filesystem::IOProxy* headerio = ioproxy;
+        if (!headerio && Filesystem::is_regular(filename)) {
+            localio.reset(
+                new Filesystem::IOFile(filename, Filesystem::IOProxy::Read));
+            if (localio->opened())
+                headerio = localio.get();
+        }
         std::lock_guard<std::recursive_mutex> lock(imageio_mutex);
-        for (auto f : format_list_vector) {
-            auto plugin = input_formats.find(f.string());
+        std::vector<unsigned char> header(format_signature_header_size);
+        size_t headersize = headerio && header.size()
+                                ? headerio->pread(header.data(), header.size(),
+                                                  0)
+                                : 0;
+        cspan<unsigned char> headerspan(header.data(), headersize);
+        std::unique_ptr<IOHeaderPrefixed> probeio;
+        if (headerio)
+            probeio.reset(new IOHeaderPrefixed(headerio, headerspan));
+
+        std::vector<ustring> candidates;
+        if (headersize) {
+            candidates.reserve(format_list_vector.size());
+            for (auto f : format_list_vector)
+                if (match_format_signature(f.string(), headerspan)
+                    == SignatureMatch::Match)
+                    candidates.push_back(f);
+            for (auto f : format_list_vector)
+                if (match_format_signature(f.string(), headerspan)
+                    == SignatureMatch::Unknown)
+                    candidates.push_back(f);
+        } else {
+            candidates = format_list_vector;
+        }
+        for (auto f : candidates) {
+            const std::string& format_name(f.string());
+            auto plugin = input_formats.find(format_name);
             if (plugin == input_formats.end() || !plugin->second)
                 continue;  // format that's output only
             // If we already tried this create function, don't do it again
@@ -753,13 +1366,26 @@ ImageInput::create(string_view filename, bool do_open, const ImageSpec* config,
             }
             if (!in)
                 continue;
-            if (!do_open) {
-                if ((ioproxy && in->supports("ioproxy")
-                     && !in->valid_file(ioproxy))
-                    || (!ioproxy && !filename.empty()
-                        && !in->valid_file(filename))) {
-                    // Since we didn't need to open it, we just checked whether
-                    // it was a valid file, and it's not.  Try the next one.
+            // When we need to open the file anyway, a reader whose signature
+            // matched can go straight to open(). Any other reader that can
+            // read through an IOProxy is first asked to validate the header
+            // through the shared probe proxy, so that it doesn't open the
+            // file itself just to reject it.
+            bool probe = !do_open
+                         || (probeio && in->supports("ioproxy")
+                             && match_format_signature(format_name, headerspan)
+                                    != SignatureMatch::Match);
+            if (probe) {
+                bool valid = true;
+                if (probeio && in->supports("ioproxy")) {
+                    probeio->seek(0);
+                    valid = in->valid_file(probeio.get());
+                } else if (!ioproxy && !filename.empty()) {
+                    valid = in->valid_file(filename);
+                }
+                if (!valid) {
+                    // We just checked whether it was a valid file, and it's
+                    // not.  Try the next one.
                     if (OIIO::pvt::oiio_print_debug > 1)
                         OIIO::debugfmt(
                             "ImageInput::create: \"{}\" did not open using format \"{}\" {} [valid_file was false].\n",
@@ -24,6 +24,7 @@
 #include <OpenImageIO/span.h>
 #include <OpenImageIO/strutil.h>
 
+#include "imagebufalgo_stats_prv.h"
 #include "imageio_pvt.h"
 
 
@@ -320,11 +321,50 @@ print_deep_stats(std::ostream& out, string_view indent, const ImageBuf& input,
 
 
 
+// Can a pixel type be converted to float without two different values
+// becoming the same float? If so, the constant and monochrome checks can
+// be done on the float values the stats are computed from.
+static bool
+float_exact(TypeDesc type)
+{
+    switch (type.basetype) {
+    case TypeDesc::UINT8:
+    case TypeDesc::INT8:
+    case TypeDesc::UINT16:
+    case TypeDesc::INT16:
+    case TypeDesc::HALF:
+    case TypeDesc::FLOAT: return true;
+    default: return false;
+    }
+}
+
+
+
 bool
 print_stats(std::ostream& out, string_view indent, const ImageBuf& input,
             const ImageSpec& spec, ROI roi, std::string& err)
 {
-    PixelStats stats = computePixelStats(input, roi);
+    // For flat images, gather the stats and the constant/monochrome checks
+    // in a single pass, so an image that isn't in memory yet is read (or
+    // pulled through the ImageCache) only once, a row at a time.
+    bool onepass = !input.deep() && float_exact(input.spec().format);
+    PixelStats stats;
+    PixelStatsAccumulator acc;
+    bool wholeimage = false;
+    if (onepass) {
+        if (!roi.defined())
+            roi = get_roi(input.spec());
+        roi.chend = std::min(roi.chend, input.nchannels());
+        acc.reset(roi.nchannels(), true /*track constancy*/);
+        if (roi.nchannels() && accumulate_pixel_stats(acc, input, roi, 0)) {
+            stats.reset(input.nchannels());
+            acc.finalize(stats, roi.chbegin);
+        }
+        // The constant and monochrome reports are about the whole image.
+        wholeimage = roi == get_roi(input.spec()) && roi.npixels();
+    } else {
+        stats = computePixelStats(input, roi);
+    }
     if (!stats.min.size()) {
         err = input.geterror();
         if (err.empty())
@@ -343,7 +383,15 @@ print_stats(std::ostream& out, string_view indent, const ImageBuf& input,
         print_deep_stats(out, indent, input, spec);
     } else {
         std::vector<float> constantValues(input.spec().nchannels);
-        if (isConstantColor(input, 0.0f, constantValues)) {
+        bool constant = false;
+        if (wholeimage) {
+            constant = acc.constant();
+            for (int c = 0; c < roi.chend && constant; ++c)
+                constantValues[c] = acc.first_pixel()[c];
+        } else {
+            constant = isConstantColor(input, 0.0f, constantValues);
+        }
+        if (constant) {
             OIIO::print(out, "{}Constant: Yes\n", indent);
             OIIO::print(out, "{}Constant Color: ", indent);
             for (unsigned int i = 0; i < constantValues.size(); ++i) {
@@ -355,7 +403,8 @@ print_stats(std::ostream& out, string_view indent, const ImageBuf& input,
             OIIO::print(out, "{}Constant: No\n", indent);
         }
 
-        if (isMonochrome(input)) {
+        bool mono = wholeimage ? acc.monochrome() : isMonochrome(input);
+        if (mono) {
             OIIO::print(out, "{}Monochrome: Yes\n", indent);
         } else {
             OIIO::print(out, "{}Monochrome: No\n", indent);
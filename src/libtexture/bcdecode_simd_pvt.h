@@ -0,0 +1,347 @@
+// Copyright Contributors to the OpenImageIO project.
+// SPDX-License-Identifier: Apache-2.0
+// https://github.com/AcademySoftwareFoundation/OpenImageIO
+
+
+/// \file
+/// SIMD decoding of BC1, BC3, and BC7 GPU-compressed 4x4 blocks, for the
+/// tiles the ImageCache keeps resident in compressed form.
+///
+/// Each produces exactly the RGBA8 texels that bcdec's scalar decoders
+/// do. The bit unpacking is inherently serial, but the per-texel palette
+/// selection (BC1/BC3) and endpoint interpolation (BC7) are done with
+/// vint4, four texels or four channels at a time.
+
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <utility>
+
+#include <OpenImageIO/simd.h>
+
+
+OIIO_NAMESPACE_3_1_BEGIN
+
+namespace pvt {
+namespace bcn {
+
+using simd::vbool4;
+using simd::vint4;
+
+
+// Compute the four colors, each RGBA8 packed as 0xAABBGGRR, of the color
+// half of a BC1/BC2/BC3 block.
+inline void
+color_palette(const unsigned char* block, bool four_color_only, vint4 pal[4])
+{
+    uint16_t c0, c1;
+    memcpy(&c0, block, 2);
+    memcpy(&c1, block + 2, 2);
+    int r0   = (((c0 >> 11) & 0x1f) * 527 + 23) >> 6;
+    int g0   = (((c0 >> 5) & 0x3f) * 259 + 33) >> 6;
+    int b0   = ((c0 & 0x1f) * 527 + 23) >> 6;
+    int r1   = (((c1 >> 11) & 0x1f) * 527 + 23) >> 6;
+    int g1   = (((c1 >> 5) & 0x3f) * 259 + 33) >> 6;
+    int b1   = ((c1 & 0x1f) * 527 + 23) >> 6;
+    auto rgb = [](int r, int g, int b) {
+        return vint4(int(0xff000000u | (b << 16) | (g << 8) | r));
+    };
+    pal[0] = rgb(r0, g0, b0);
+    pal[1] = rgb(r1, g1, b1);
+    if (c0 > c1 || four_color_only) {
+        pal[2] = rgb((2 * r0 + r1 + 1) / 3, (2 * g0 + g1 + 1) / 3,
+                     (2 * b0 + b1 + 1) / 3);
+        pal[3] = rgb((r0 + 2 * r1 + 1) / 3, (g0 + 2 * g1 + 1) / 3,
+                     (b0 + 2 * b1 + 1) / 3);
+    } else {
+        // BC1 with 1-bit alpha: the last entry is transparent black
+        pal[2] = rgb((r0 + r1 + 1) >> 1, (g0 + g1 + 1) >> 1,
+                     (b0 + b1 + 1) >> 1);
+        pal[3] = vint4::Zero();
+    }
+}
+
+
+
+// Pick the palette entry for each of the 4 texels of a row, given the
+// row's byte of 2-bit color indices (in its low bits).
+OIIO_FORCEINLINE vint4
+select_color(unsigned int rowbits, const vint4 pal[4])
+{
+    // Rather than shift each lane's index down, compare it in place.
+    const vint4 mask(3, 3 << 2, 3 << 4, 3 << 6);
+    const vint4 one(1, 1 << 2, 1 << 4, 1 << 6);
+    const vint4 two(2, 2 << 2, 2 << 4, 2 << 6);
+    vint4 idx = vint4(int(rowbits)) & mask;
+    vint4 c   = select(idx == one, pal[1], pal[0]);
+    c         = select(idx == two, pal[2], c);
+    return select(idx == mask, pal[3], c);
+}
+
+
+
+// Decode a BC1 block into RGBA8 texels, rows `pitch` bytes apart.
+inline void
+decode_bc1(const void* src, void* dst, int pitch)
+{
+    const unsigned char* block = (const unsigned char*)src;
+    unsigned char* out         = (unsigned char*)dst;
+    vint4 pal[4];
+    color_palette(block, false, pal);
+    uint32_t indices;
+    memcpy(&indices, block + 4, 4);
+    for (int i = 0; i < 4; ++i, out += pitch, indices >>= 8)
+        select_color(indices, pal).store((int*)out);
+}
+
+
+
+// Decode a BC3 block (BC4-style alpha, then a BC1-style color block) into
+// RGBA8 texels, rows `pitch` bytes apart.
+inline void
+decode_bc3(const void* src, void* dst, int pitch)
+{
+    const unsigned char* block = (const unsigned char*)src;
+    unsigned char* out         = (unsigned char*)dst;
+
+    // The 8 alpha values, then 3-bit indices choosing among them
+    int a[8] = { block[0], block[1] };
+    if (a[0] > a[1]) {
+        for (int k = 1; k < 7; ++k)
+            a[k + 1] = ((7 - k) * a[0] + k * a[1] + 1) / 7;
+    } else {
+        for (int k = 1; k < 5; ++k)
+            a[k + 1] = ((5 - k) * a[0] + k * a[1] + 1) / 5;
+        a[6] = 0x00;
+        a[7] = 0xff;
+    }
+    uint64_t alphabits = 0;
+    memcpy(&alphabits, block + 2, 6);
+    const vint4 amask(7, 7 << 3, 7 << 6, 7 << 9);
+    vint4 akey[8], aval[8];
+    for (int k = 0; k < 8; ++k) {
+        akey[k] = vint4(k, k << 3, k << 6, k << 9);
+        aval[k] = vint4(int(uint32_t(a[k]) << 24));
+    }
+
+    vint4 pal[4];
+    color_palette(block + 8, true, pal);
+    const vint4 rgbmask(0x00ffffff);
+    for (int k = 0; k < 4; ++k)
+        pal[k] &= rgbmask;
+    uint32_t indices;
+    memcpy(&indices, block + 12, 4);
+
+    for (int i = 0; i < 4; ++i, out += pitch) {
+        vint4 aidx  = vint4(int(alphabits >> (12 * i))) & amask;
+        vint4 alpha = aval[0];
+        for (int k = 1; k < 8; ++k)
+            alpha = select(aidx == akey[k], aval[k], alpha);
+        vint4 c = select_color(indices >> (8 * i), pal) | alpha;
+        c.store((int*)out);
+    }
+}
+
+
+
+// Decode a BC7 block into RGBA8 texels, rows `pitch` bytes apart.
+inline void
+decode_bc7(const void* src, void* dst, int pitch)
+{
+    // Subset of each texel (2 bits per texel, texel 0 lowest) for each of
+    // the 64 2-subset and 3-subset partitions.
+    static const uint32_t partitions2[64] = {
+        0x50505050, 0x40404040, 0x54545454, 0x54505040, 0x50404000, 0x55545450,
+        0x55545040, 0x54504000, 0x50400000, 0x55555450, 0x55544000, 0x54400000,
+        0x55555440, 0x55550000, 0x55555500, 0x55000000, 0x55150100, 0x00004054,
+        0x15010000, 0x00405054, 0x00004050, 0x15050100, 0x05010000, 0x40505054,
+        0x00404050, 0x05010100, 0x14141414, 0x05141450, 0x01155440, 0x00555500,
+        0x15014054, 0x05414150, 0x44444444, 0x55005500, 0x11441144, 0x05055050,
+        0x05500550, 0x11114444, 0x41144114, 0x44111144, 0x15055054, 0x01055040,
+        0x05041050, 0x05455150, 0x14414114, 0x50050550, 0x41411414, 0x00141400,
+        0x00041504, 0x00105410, 0x10541000, 0x04150400, 0x50410514, 0x41051450,
+        0x05415014, 0x14054150, 0x41050514, 0x41505014, 0x40011554, 0x54150140,
+        0x50505500, 0x00555050, 0x15151010, 0x54540404,
+    };
+    static const uint32_t partitions3[64] = {
+        0xaa685050, 0x6a5a5040, 0x5a5a4200, 0x5450a0a8, 0xa5a50000, 0xa0a05050,
+        0x5555a0a0, 0x5a5a5050, 0xaa550000, 0xaa555500, 0xaaaa5500, 0x90909090,
+        0x94949494, 0xa4a4a4a4, 0xa9a59450, 0x2a0a4250, 0xa5945040, 0x0a425054,
+        0xa5a5a500, 0x55a0a0a0, 0xa8a85454, 0x6a6a4040, 0xa4a45000, 0x1a1a0500,
+        0x0050a4a4, 0xaaa59090, 0x14696914, 0x69691400, 0xa08585a0, 0xaa821414,
+        0x50a4a450, 0x6a5a0200, 0xa9a58000, 0x5090a0a8, 0xa8a09050, 0x24242424,
+        0x00aa5500, 0x24924924, 0x24499224, 0x50a50a50, 0x500aa550, 0xaaaa4444,
+        0x66660000, 0xa5a0a5a0, 0x50a050a0, 0x69286928, 0x44aaaa44, 0x66666600,
+        0xaa444444, 0x54a854a8, 0x95809580, 0x96969600, 0xa85454a8, 0x80959580,
+        0xaa141414, 0x96960000, 0xaaaa1414, 0xa05050a0, 0xa0a5a5a0, 0x96000000,
+        0x40804080, 0xa9a8a9a8, 0xaaaaaa44, 0x2a4a5254,
+    };
+    // The "anchor" texel of subset 1 (and 2) of each partition, whose
+    // index is stored with one bit fewer. Subset 0's anchor is texel 0.
+    static const uint8_t anchors2[64] = {
+        15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15,
+        15, 2, 8, 2, 2, 8, 8, 15, 2, 8, 2, 2, 8, 8, 2, 2,
+        15, 15, 6, 8, 2, 8, 15, 15, 2, 8, 2, 2, 2, 15, 15, 6,
+        6, 2, 6, 8, 15, 15, 2, 2, 15, 15, 15, 15, 15, 2, 2, 15,
+    };
+    static const uint8_t anchors3[64][2] = {
+        { 3, 15 }, { 3, 8 }, { 15, 8 }, { 15, 3 }, { 8, 15 }, { 3, 15 },
+        { 15, 3 }, { 15, 8 }, { 8, 15 }, { 8, 15 }, { 6, 15 }, { 6, 15 },
+        { 6, 15 }, { 5, 15 }, { 3, 15 }, { 3, 8 }, { 3, 15 }, { 3, 8 },
+        { 8, 15 }, { 15, 3 }, { 3, 15 }, { 3, 8 }, { 6, 15 }, { 10, 8 },
+        { 5, 3 }, { 8, 15 }, { 8, 6 }, { 6, 10 }, { 8, 15 }, { 5, 15 },
+        { 15, 10 }, { 15, 8 }, { 8, 15 }, { 15, 3 }, { 3, 15 }, { 5, 10 },
+        { 6, 10 }, { 10, 8 }, { 8, 9 }, { 15, 10 }, { 15, 6 }, { 3, 15 },
+        { 15, 8 }, { 5, 15 }, { 15, 3 }, { 15, 6 }, { 15, 6 }, { 15, 8 },
+        { 3, 15 }, { 15, 3 }, { 5, 15 }, { 5, 15 }, { 5, 15 }, { 8, 15 },
+        { 5, 15 }, { 10, 15 }, { 5, 15 }, { 10, 15 }, { 8, 15 }, { 13, 15 },
+        { 15, 3 }, { 12, 15 }, { 3, 15 }, { 3, 8 },
+    };
+    static const uint8_t color_bits[8] = { 4, 6, 5, 7, 5, 7, 7, 5 };
+    static const uint8_t alpha_bits[8] = { 0, 0, 0, 0, 6, 8, 7, 5 };
+    static const int weights2[4]       = { 0, 21, 43, 64 };
+    static const int weights3[8]       = { 0, 9, 18, 27, 37, 46, 55, 64 };
+    static const int weights4[16]      = { 0,  4,  9,  13, 17, 21, 26, 30,
+                                           34, 38, 43, 47, 51, 55, 60, 64 };
+
+    // The block is one 128 bit little-endian bit stream
+    uint64_t lo, hi;
+    memcpy(&lo, src, 8);
+    memcpy(&hi, (const char*)src + 8, 8);
+    auto read = [&](int nbits) {
+        uint64_t mask = (uint64_t(1) << nbits) - 1;
+        int bits      = int(lo & mask);
+        lo            = (lo >> nbits) | ((hi & mask) << (64 - nbits));
+        hi >>= nbits;
+        return bits;
+    };
+    unsigned char* out = (unsigned char*)dst;
+
+    int mode = 0;
+    while (mode < 8 && !read(1))
+        ++mode;
+    if (mode == 8) {
+        // Reserved mode: transparent black
+        for (int i = 0; i < 4; ++i, out += pitch)
+            memset(out, 0, 16);
+        return;
+    }
+
+    int nsubsets = 1, partition = 0, rotation = 0, selection = 0;
+    if (mode == 0 || mode == 1 || mode == 2 || mode == 3 || mode == 7) {
+        nsubsets  = (mode == 0 || mode == 2) ? 3 : 2;
+        partition = read(mode == 0 ? 4 : 6);
+    }
+    if (mode == 4 || mode == 5) {
+        rotation = read(2);
+        if (mode == 4)
+            selection = read(1);
+    }
+
+    // Endpoints, channel by channel, then expanded to 8 bits (with the
+    // P-bits of the modes that have them).
+    const int nendpoints = 2 * nsubsets;
+    int endpoints[6][4]  = {};
+    for (int c = 0; c < 3; ++c)
+        for (int e = 0; e < nendpoints; ++e)
+            endpoints[e][c] = read(color_bits[mode]);
+    if (alpha_bits[mode])
+        for (int e = 0; e < nendpoints; ++e)
+            endpoints[e][3] = read(alpha_bits[mode]);
+    const int haspbit = (0xcb >> mode) & 1;  // modes 0, 1, 3, 6, 7
+    if (haspbit) {
+        for (int e = 0; e < nendpoints; ++e)
+            for (int c = 0; c < 4; ++c)
+                endpoints[e][c] <<= 1;
+        if (mode == 1) {
+            // One P-bit shared by the two endpoints of each subset
+            for (int s = 0; s < 2; ++s) {
+                int p = read(1);
+                for (int c = 0; c < 3; ++c) {
+                    endpoints[2 * s][c] |= p;
+                    endpoints[2 * s + 1][c] |= p;
+                }
+            }
+        } else {
+            for (int e = 0; e < nendpoints; ++e) {
+                int p = read(1);
+                for (int c = 0; c < 4; ++c)
+                    endpoints[e][c] |= p;
+            }
+        }
+    }
+    const int cprec = color_bits[mode] + haspbit;
+    const int aprec = alpha_bits[mode] + haspbit;
+    for (int e = 0; e < nendpoints; ++e) {
+        for (int c = 0; c < 3; ++c) {
+            endpoints[e][c] <<= 8 - cprec;
+            endpoints[e][c] |= endpoints[e][c] >> cprec;
+        }
+        if (alpha_bits[mode]) {
+            endpoints[e][3] <<= 8 - aprec;
+            endpoints[e][3] |= endpoints[e][3] >> aprec;
+        } else {
+            endpoints[e][3] = 0xff;
+        }
+    }
+
+    // A rotation swaps alpha with one of the color channels after
+    // interpolation. Swapping the endpoints' channels before it, and
+    // giving that channel alpha's weights, comes to the same thing.
+    const int alane = rotation ? rotation - 1 : 3;
+    if (rotation)
+        for (int e = 0; e < nendpoints; ++e)
+            std::swap(endpoints[e][3], endpoints[e][alane]);
+
+    // Per-texel subsets and interpolation weights
+    uint32_t subsets = 0;
+    int anchor1 = -1, anchor2 = -1;
+    if (nsubsets == 2) {
+        subsets = partitions2[partition];
+        anchor1 = anchors2[partition];
+    } else if (nsubsets == 3) {
+        subsets = partitions3[partition];
+        anchor1 = anchors3[partition][0];
+        anchor2 = anchors3[partition][1];
+    }
+    const int ibits  = (mode == 0 || mode == 1) ? 3 : (mode == 6 ? 4 : 2);
+    const int ibits2 = mode == 4 ? 3 : (mode == 5 ? 2 : 0);
+    const int* w1 = ibits == 2 ? weights2 : (ibits == 3 ? weights3 : weights4);
+    const int* w2 = ibits2 == 2 ? weights2 : weights3;
+    int cweight[16], aweight[16];
+    for (int t = 0; t < 16; ++t) {
+        bool anchor = (t == 0 || t == anchor1 || t == anchor2);
+        cweight[t]  = w1[read(ibits - anchor)];
+    }
+    if (ibits2) {
+        for (int t = 0; t < 16; ++t)
+            aweight[t] = w2[read(ibits2 - (t == 0))];
+        if (selection)
+            std::swap(cweight, aweight);
+    } else {
+        memcpy(aweight, cweight, sizeof(cweight));
+    }
+
+    // Interpolate all four channels of a texel at once
+    vint4 e[6];
+    for (int i = 0; i < nendpoints; ++i)
+        e[i].load(endpoints[i]);
+    const vbool4 is_alpha = (vint4::Iota() == vint4(alane));
+    for (int i = 0, t = 0; i < 4; ++i, out += pitch) {
+        for (int j = 0; j < 4; ++j, ++t) {
+            int s   = (subsets >> (2 * t)) & 3;
+            vint4 w = select(is_alpha, vint4(aweight[t]), vint4(cweight[t]));
+            vint4 c = ((vint4(64) - w) * e[2 * s] + w * e[2 * s + 1]
+                       + vint4(32))
+                      >> 6;
+            c.store(out + 4 * j);
+        }
+    }
+}
+
+}  // namespace bcn
+}  // namespace pvt
+
+OIIO_NAMESPACE_3_1_END
@@ -21,6 +21,7 @@
 #include <OpenImageIO/imagecache.h>
 #include <OpenImageIO/imageio.h>
 #include <OpenImageIO/optparser.h>
+#include <OpenImageIO/parallel.h>
 #include <OpenImageIO/simd.h>
 #include <OpenImageIO/strutil.h>
 #include <OpenImageIO/sysutil.h>
@@ -30,11 +31,21 @@
 #include <OpenImageIO/typedesc.h>
 #include <OpenImageIO/ustring.h>
 
+#include "bcdecode_simd_pvt.h"
 #include "imagecache_memory_print.h"
 #include "imagecache_memory_pvt.h"
 #include "imagecache_pvt.h"
 #include "imageio_pvt.h"
 
+// Our own private copy of the BCn block decoder used by the DDS reader,
+// for tiles the cache keeps resident in compressed form.
+OIIO_PRAGMA_WARNING_PUSH
+OIIO_GCC_PRAGMA(GCC diagnostic ignored "-Wunused-function")
+#define BCDEC_STATIC
+#define BCDEC_IMPLEMENTATION
+#include "../dds.imageio/bcdec.h"
+OIIO_PRAGMA_WARNING_POP
+
 
 OIIO_NAMESPACE_3_1_BEGIN
 using namespace pvt;
@@ -69,6 +80,10 @@ static ustring s_constantalpha("constantalpha");
 
 // constantly increasing, so we can avoid issues if an ImageCache pointer is re-used after being freed
 static std::atomic_int64_t imagecache_next_id = 0;
+
+// get_pixels requests covering at least this many pixels (and more than
+// one row of tiles) are split across the thread pool.
+static constexpr imagesize_t get_pixels_parallel_min_pixels = 1 << 18;
 static thread_local tsl::robin_map<uint64_t, ImageCachePerThreadInfo*>
     imagecache_per_thread_infos;
 
@@ -160,11 +175,14 @@ ImageCacheStatistics::init()
     aniso_queries       = 0;
     aniso_probes        = 0;
     max_aniso           = 1;
+    ewa_queries         = 0;
+    ewa_texels          = 0;
     closest_interps     = 0;
     bilinear_interps    = 0;
     cubic_interps       = 0;
     file_retry_success  = 0;
     tile_retry_success  = 0;
+    tile_block_decodes  = 0;
 }
 
 
@@ -206,11 +224,14 @@ ImageCacheStatistics::merge(const ImageCacheStatistics& s)
     aniso_queries += s.aniso_queries;
     aniso_probes += s.aniso_probes;
     max_aniso = std::max(max_aniso, s.max_aniso);
+    ewa_queries += s.ewa_queries;
+    ewa_texels += s.ewa_texels;
     closest_interps += s.closest_interps;
     bilinear_interps += s.bilinear_interps;
     cubic_interps += s.cubic_interps;
     file_retry_success += s.file_retry_success;
     tile_retry_success += s.tile_retry_success;
+    tile_block_decodes += s.tile_block_decodes;
 }
 
 
@@ -329,7 +350,9 @@ LevelInfo::LevelInfo(ImageSpec* spec_, ImageDims* dims_)
 
 
 LevelInfo::LevelInfo(const LevelInfo& src)
-    : m_dims(src.m_dims)
+    : blockoffset(src.blockoffset)
+    , blockformat(src.blockformat)
+    , m_dims(src.m_dims)
     , nxtiles(src.nxtiles)
     , nytiles(src.nytiles)
     , nztiles(src.nztiles)
@@ -481,6 +504,22 @@ ImageCacheFile::SubimageInfo::init(ImageCacheFile& icfile, ImageSpec* spec_,
             || spec.format == TypeDesc::HALF
             /* future expansion:  || spec.format == AnotherFormat ... */)
             datatype = spec.format;
+        // Optionally store float 2D textures at reduced precision. Tiles
+        // are still read as float, then narrowed by the cache itself so
+        // that it can measure the error this introduces.
+        ustring storage = icfile.imagecache().float_storage();
+        if (!volume
+            && (spec.format == TypeDesc::FLOAT
+                || spec.format == TypeDesc::DOUBLE)) {
+            if (storage == "half") {
+                datatype          = TypeDesc::HALF;
+                reduced_precision = true;
+            } else if (storage == "uint16") {
+                datatype          = TypeDesc::UINT16;
+                reduced_precision = true;
+                quantized         = true;
+            }
+        }
     }
     channelsize = datatype.size();
     pixelsize   = channelsize * spec.nchannels;
@@ -718,6 +757,50 @@ clamp_dimensions(ImageSpec& spec)
 
 
 
+// Map the "compression" name a DDS file reports to a block format.
+static BlockCompression
+block_compression_from_name(string_view name)
+{
+    static const std::pair<string_view, BlockCompression> names[] = {
+        { "DXT1", BlockCompression::BC1 },   { "DXT3", BlockCompression::BC2 },
+        { "DXT5", BlockCompression::BC3 },   { "BC4", BlockCompression::BC4 },
+        { "BC5", BlockCompression::BC5 },    { "BC6HU", BlockCompression::BC6HU },
+        { "BC6HS", BlockCompression::BC6HS }, { "BC7", BlockCompression::BC7 },
+    };
+    for (auto& n : names)
+        if (name == n.first)
+            return n.second;
+    return BlockCompression::None;
+}
+
+
+
+// If the reader located the GPU-compressed blocks of this level (see the
+// "compressed_tiles" attribute), and our tiles are made of whole 4x4
+// blocks, remember where they are so tiles can be kept compressed.
+static void
+find_level_blocks(LevelInfo& lev, const ImageSpec& nativespec,
+                  const ImageSpec& cachespec)
+{
+    const ParamValue* p = nativespec.find_attribute("dds:blockoffset",
+                                                    TypeInt64);
+    if (!p || p->get<int64_t>() < 0 || cachespec.depth > 1)
+        return;
+    BlockCompression bc = block_compression_from_name(
+        nativespec.get_string_attribute("compression"));
+    if (bc == BlockCompression::None
+        || block_nchannels(bc) != nativespec.nchannels)
+        return;
+    if ((cachespec.tile_width % 4 && cachespec.tile_width != cachespec.width)
+        || (cachespec.tile_height % 4
+            && cachespec.tile_height != cachespec.height))
+        return;
+    lev.blockoffset = p->get<int64_t>();
+    lev.blockformat = bc;
+}
+
+
+
 std::shared_ptr<ImageInput>
 ImageCacheFile::open(ImageCachePerThreadInfo* thread_info)
 {
@@ -758,6 +841,11 @@ ImageCacheFile::open(ImageCachePerThreadInfo* thread_info)
         configspec = *m_configspec;
     if (imagecache().unassociatedalpha())
         configspec.attribute("oiio:UnassociatedAlpha", 1);
+    // Tiles may be kept block-compressed only for files we open with the
+    // built-in readers, not with a custom ImageInput.
+    bool blocktiles = imagecache().compressed_tiles() && !m_inputcreator;
+    if (blocktiles)
+        configspec.attribute("dds:blockinfo", 1);
 
     if (m_inputcreator)
         inp.reset(m_inputcreator());
@@ -771,8 +859,24 @@ ImageCacheFile::open(ImageCachePerThreadInfo* thread_info)
             fmt = OIIO::Filesystem::extension(fmt, false);
         else
             fmt = m_filename.string();
-        inp = ImageInput::create(fmt, false, &configspec, nullptr,
-                                 m_imagecache.plugin_searchpath());
+        auto created = ImageInput::create(fmt, false, &configspec, nullptr,
+                                          m_imagecache.plugin_searchpath());
+        if (blocktiles && created
+            && Strutil::iequals(created->format_name(), "dds")
+            && !configspec.find_attribute("oiio:ioproxy")) {
+            // We'll read compressed blocks through the same IOProxy as the
+            // reader, so open one for it, living as long as the ImageInput.
+            auto io = std::make_shared<Filesystem::IOFile>(
+                m_filename, Filesystem::IOProxy::Read);
+            if (io->opened()) {
+                Filesystem::IOProxy* ioptr = io.get();
+                configspec.attribute("oiio:ioproxy", TypeDesc::PTR, &ioptr);
+                inp = std::shared_ptr<ImageInput>(created.release(),
+                                                  BlockProxyHolder { io });
+            }
+        }
+        if (created)
+            inp = std::move(created);
     }
 
     //! helper: use `return invalid_file("error message")` whenever an error occurs
@@ -916,6 +1020,8 @@ ImageCacheFile::open(ImageCachePerThreadInfo* thread_info)
                 OIIO_DASSERT(dims);
             }
             si.levels.emplace_back(LevelInfo(sispec, dims));
+            if (blocktiles && si.untiled)
+                find_level_blocks(si.levels.back(), nativespec, tempspec);
             ++nmip;
         } while (inp->seek_subimage(nsubimages, nmip));
 
@@ -1071,8 +1177,8 @@ ImageCacheFile::init_from_spec()
 
 
 bool
-ImageCacheFile::read_tile(ImageCachePerThreadInfo* thread_info,
-                          const TileID& id, void* data)
+ImageCacheFile::read_tiles(ImageCachePerThreadInfo* thread_info,
+                           const TileID& id, int ntiles, void* data)
 {
     OIIO_DASSERT(id.chend() > id.chbegin());
 
@@ -1081,23 +1187,27 @@ ImageCacheFile::read_tile(ImageCachePerThreadInfo* thread_info,
     if (miplevel > 0)
         m_mipused = true;
     // count how many times this mipmap level was read
-    m_mipreadcount[miplevel]++;
+    m_mipreadcount[miplevel] += ntiles;
 
     int subimage = id.subimage();
     const SubimageInfo& si(subimageinfo(subimage));
     const ImageDims& dims(si.leveldims(miplevel));
 
     // Special case for un-MIP-mapped
-    if (si.unmipped && miplevel != 0)
+    if (si.unmipped && miplevel != 0) {
+        OIIO_DASSERT(ntiles == 1);
         return read_unmipped(thread_info, id, data);
+    }
 
     std::shared_ptr<ImageInput> inp = open(thread_info);
     if (!inp)
         return false;
 
     // Special case for untiled images -- need to do tile emulation
-    if (si.untiled)
+    if (si.untiled) {
+        OIIO_DASSERT(ntiles == 1);
         return read_untiled(thread_info, inp.get(), id, data);
+    }
 
     // Ordinary tiled
     int x           = id.x();
@@ -1105,11 +1215,12 @@ ImageCacheFile::read_tile(ImageCachePerThreadInfo* thread_info,
     int z           = id.z();
     int chbegin     = id.chbegin();
     int chend       = id.chend();
-    TypeDesc format = id.file().datatype(subimage);
+    TypeDesc format = id.file().readtype(subimage);
 
     bool ok = true;
     for (int tries = 0; tries <= imagecache().failure_retries(); ++tries) {
-        ok = inp->read_tiles(subimage, miplevel, x, x + dims.tile_width, y,
+        ok = inp->read_tiles(subimage, miplevel, x,
+                             x + ntiles * dims.tile_width, y,
                              y + dims.tile_height, z, z + dims.tile_depth,
                              chbegin, chend, format, data);
         if (ok) {
@@ -1134,14 +1245,14 @@ ImageCacheFile::read_tile(ImageCachePerThreadInfo* thread_info,
     }
 
     if (ok) {
-        size_t b = si.get_tile_bytes(miplevel);
+        size_t b = si.get_tile_bytes(miplevel) * ntiles;
         thread_info->m_stats.bytes_read += b;
         m_bytesread += b;
-        ++m_tilesread;
+        m_tilesread += ntiles;
         if (id.colortransformid() > 0) {
             // OIIO::print("CONVERT id {} {},{} to cs {}\n", filename(), id.x(), id.y(),
             //       id.colortransformid());
-            ImageSpec tilespec(dims.tile_width, dims.tile_height,
+            ImageSpec tilespec(ntiles * dims.tile_width, dims.tile_height,
                                dims.nchannels, format);
             ImageBuf wrapper(tilespec, make_cspan((const std::byte*)data,
                                                   tilespec.image_bytes()));
@@ -1158,6 +1269,109 @@ ImageCacheFile::read_tile(ImageCachePerThreadInfo* thread_info,
 
 
 
+Filesystem::IOProxy*
+ImageCacheFile::block_ioproxy(const std::shared_ptr<ImageInput>& inp) const
+{
+    if (auto holder = std::get_deleter<BlockProxyHolder>(inp))
+        return holder->io.get();
+    const ParamValue* p = m_configspec
+                              ? m_configspec->find_attribute("oiio:ioproxy",
+                                                             TypeDesc::PTR)
+                              : nullptr;
+    return p ? *(Filesystem::IOProxy* const*)p->data() : nullptr;
+}
+
+
+
+bool
+ImageCacheFile::read_tile_blocks(ImageCachePerThreadInfo* thread_info,
+                                 const TileID& id,
+                                 std::unique_ptr<char[]>& blocks, size_t& size)
+{
+    int miplevel = id.miplevel();
+    if (miplevel > 0)
+        m_mipused = true;
+    m_mipreadcount[miplevel]++;
+
+    // Go through open() like any other read, so that the open files
+    // limit applies and a closed file is reopened.
+    std::shared_ptr<ImageInput> inp = open(thread_info);
+    if (!inp)
+        return false;
+    Filesystem::IOProxy* io = block_ioproxy(inp);
+
+    const SubimageInfo& si(subimageinfo(id.subimage()));
+    const LevelInfo& lev(si.levelinfo(miplevel));
+    const ImageDims& dims(si.leveldims(miplevel));
+    const size_t blocksize = block_bytes(lev.blockformat);
+    // The block rows and columns overlapped by this tile. Tiles are
+    // made of whole blocks, except at the right and bottom edges.
+    int64_t levelbw = (dims.width + 3) / 4;
+    int bx0         = (id.x() - dims.x) / 4;
+    int by0         = (id.y() - dims.y) / 4;
+    int bx1 = (std::min(id.x() + dims.tile_width, dims.x + dims.width) - dims.x
+               + 3)
+              / 4;
+    int by1 = (std::min(id.y() + dims.tile_height, dims.y + dims.height)
+               - dims.y + 3)
+              / 4;
+    size_t rowbytes = size_t(bx1 - bx0) * blocksize;
+    size            = rowbytes * size_t(by1 - by0);
+    blocks.reset(new char[size]);
+
+    bool ok = (io != nullptr);
+    for (int tries = 0; ok && tries <= imagecache().failure_retries();
+         ++tries) {
+        {
+            // The reader may be using the proxy too, so hold it still.
+            std::lock_guard<ImageInput> lock(*inp);
+            if (bx1 - bx0 == levelbw) {
+                // Full-width tiles are one contiguous run of blocks
+                ok = io->pread(blocks.get(), size,
+                               lev.blockoffset
+                                   + int64_t(by0) * levelbw * blocksize)
+                     == size;
+            } else {
+                for (int by = by0; ok && by < by1; ++by) {
+                    int64_t offset = lev.blockoffset
+                                     + (by * levelbw + bx0)
+                                           * int64_t(blocksize);
+                    ok = io->pread(blocks.get() + (by - by0) * rowbytes,
+                                   rowbytes, offset)
+                         == rowbytes;
+                }
+            }
+        }
+        if (ok) {
+            if (tries)  // succeeded, but only after a failure!
+                ++thread_info->m_stats.tile_retry_success;
+            break;
+        }
+        if (tries < imagecache().failure_retries()) {
+            ok = true;
+            Sysutil::usleep(1000 * 100);  // 100 ms
+        }
+    }
+    if (!ok) {
+        m_broken = true;
+        if (errors_should_issue()) {
+            std::string err = io ? io->error() : std::string();
+            imagecache().error(
+                "Could not read compressed blocks from \"{}\"{}{}",
+                filename(), err.size() ? ": " : "", err);
+        }
+        blocks.reset();
+        size = 0;
+        return false;
+    }
+    thread_info->m_stats.bytes_read += size;
+    m_bytesread += size;
+    ++m_tilesread;
+    return true;
+}
+
+
+
 bool
 ImageCacheFile::read_unmipped(ImageCachePerThreadInfo* thread_info,
                               const TileID& id, void* data)
@@ -1180,7 +1394,7 @@ ImageCacheFile::read_unmipped(ImageCachePerThreadInfo* thread_info,
     // int z        = id.z();
     int chbegin     = id.chbegin();
     int chend       = id.chend();
-    TypeDesc format = id.file().datatype(id.subimage());
+    TypeDesc format = id.file().readtype(id.subimage());
 
     // Figure out the size and strides for a single tile, make an ImageBuf
     // to hold it temporarily.
@@ -1212,8 +1426,7 @@ ImageCacheFile::read_unmipped(ImageCachePerThreadInfo* thread_info,
     // tile after the pixels are read.  Well, except that below our call
     // to get_pixels may recursively trigger more tiles to be read, and
     // totally change the microcache.  Simple solution: save & restore it.
-    ImageCacheTileRef oldtile     = thread_info->tile;
-    ImageCacheTileRef oldlasttile = thread_info->lasttile;
+    ImageCacheTileRef oldtile = thread_info->tile;
 
     // Auto-mipping will totally thrash the cache if the user unwisely
     // sets it to be too small compared to the image file that needs to
@@ -1254,8 +1467,7 @@ ImageCacheFile::read_unmipped(ImageCachePerThreadInfo* thread_info,
                                size_t(tw * th * nchans) * format.size()));
 
     // Restore the microcache to the way it was before.
-    thread_info->tile     = oldtile;
-    thread_info->lasttile = oldlasttile;
+    thread_info->tile = oldtile;
 
     return ok;
 }
@@ -1275,7 +1487,7 @@ ImageCacheFile::read_untiled(ImageCachePerThreadInfo* thread_info,
     const int z                = id.z();
     const int chbegin          = id.chbegin();
     const int chend            = id.chend();
-    const TypeDesc format      = id.file().datatype(id.subimage());
+    const TypeDesc format      = id.file().readtype(id.subimage());
     const int colortransformid = id.colortransformid();
 
     // Strides for a single tile
@@ -1800,6 +2012,25 @@ ImageCacheTile::ImageCacheTile(const TileID& id)
 
 
 
+// Scratch space for pixels widened to float on their way in to or out of
+// the cache, reused by each thread instead of allocated for every tile.
+// Reading a tile may add the other tiles of its row to the cache while the
+// read is still using its scratch (see read_untiled), so each use gets its
+// own buffer.
+enum class FloatScratch { ReadTile, AddTile, GetPixels, Count };
+
+static float*
+float_scratch(FloatScratch use, size_t n)
+{
+    static thread_local std::vector<float> scratch[int(FloatScratch::Count)];
+    std::vector<float>& buf(scratch[int(use)]);
+    if (buf.size() < n)
+        buf.resize(n);
+    return buf.data();
+}
+
+
+
 ImageCacheTile::ImageCacheTile(const TileID& id, const void* pels,
                                TypeDesc format, stride_t xstride,
                                stride_t ystride, stride_t zstride, bool copy)
@@ -1819,12 +2050,29 @@ ImageCacheTile::ImageCacheTile(const TileID& id, const void* pels,
                         (unsigned long long)memsize());
         m_pixels_size = size;
         m_pixels.reset(new char[m_pixels_size]);
-        m_valid
-            = convert_image(id.nchannels(), dims.tile_width, dims.tile_height,
-                            dims.tile_depth, pels, format, xstride, ystride,
-                            zstride, &m_pixels[0], file.datatype(id.subimage()),
-                            m_pixelsize, m_pixelsize * dims.tile_width,
-                            m_pixelsize * dims.tile_width * dims.tile_height);
+        if (si.reduced_precision) {
+            // Widen to float, then narrow to the storage type ourselves
+            stride_t fpixel = id.nchannels() * sizeof(float);
+            size_t nvals    = si.get_tile_pixels(id.miplevel())
+                           * id.nchannels();
+            float* fpels    = float_scratch(FloatScratch::AddTile, nvals);
+            m_valid = convert_image(id.nchannels(), dims.tile_width,
+                                    dims.tile_height, dims.tile_depth, pels,
+                                    format, xstride, ystride, zstride, fpels,
+                                    TypeFloat, fpixel, fpixel * dims.tile_width,
+                                    fpixel * dims.tile_width
+                                        * dims.tile_height);
+            if (m_valid)
+                reduce_precision(fpels);
+        } else {
+            m_valid = convert_image(id.nchannels(), dims.tile_width,
+                                    dims.tile_height, dims.tile_depth, pels,
+                                    format, xstride, ystride, zstride,
+                                    &m_pixels[0], file.datatype(id.subimage()),
+                                    m_pixelsize, m_pixelsize * dims.tile_width,
+                                    m_pixelsize * dims.tile_width
+                                        * dims.tile_height);
+        }
     } else {
         m_nofree      = true;  // Don't free the pointer!
         m_pixels_size = 0;
@@ -1838,15 +2086,140 @@ ImageCacheTile::ImageCacheTile(const TileID& id, const void* pels,
 
 
 
+// Decode one 4x4 block into `dst`, whose rows are `pitch` channels apart.
+// The most common formats have SIMD decoders, which give the same texels
+// as bcdec's (imagecache_test checks this on random blocks of every mode)
+// but are only faster when there is real SIMD to use.
+static void
+decode_block(BlockCompression bc, const void* src, void* dst, int pitch)
+{
+    switch (bc) {
+#if OIIO_SIMD
+    case BlockCompression::BC1: bcn::decode_bc1(src, dst, pitch); break;
+    case BlockCompression::BC3: bcn::decode_bc3(src, dst, pitch); break;
+    case BlockCompression::BC7: bcn::decode_bc7(src, dst, pitch); break;
+#else
+    case BlockCompression::BC1: bcdec_bc1(src, dst, pitch); break;
+    case BlockCompression::BC3: bcdec_bc3(src, dst, pitch); break;
+    case BlockCompression::BC7: bcdec_bc7(src, dst, pitch); break;
+#endif
+    case BlockCompression::BC2: bcdec_bc2(src, dst, pitch); break;
+    case BlockCompression::BC4: bcdec_bc4(src, dst, pitch); break;
+    case BlockCompression::BC5: bcdec_bc5(src, dst, pitch); break;
+    case BlockCompression::BC6HU: bcdec_bc6h_half(src, dst, pitch, 0); break;
+    case BlockCompression::BC6HS: bcdec_bc6h_half(src, dst, pitch, 1); break;
+    default: break;
+    }
+}
+
+
+
+ImageCacheTile::ImageCacheTile(const TileID& id, const ImageCacheTile& packed)
+    : m_id(id)
+    , m_copy(true)
+{
+    ImageCacheFile& file(m_id.file());
+    const SubimageInfo& si(file.subimageinfo(m_id.subimage()));
+    const ImageDims& dims(si.leveldims(m_id.miplevel()));
+    // Quantized tiles are expanded back to float
+    TypeDesc format = packed.block_compressed() ? file.datatype(id.subimage())
+                                                : TypeFloat;
+    m_channelsize   = format.size();
+    m_pixelsize     = id.nchannels() * m_channelsize;
+    m_tile_width    = dims.tile_width;
+    m_pixels_size   = memsize_needed();
+    m_pixels.reset(new char[m_pixels_size]);
+    memset(m_pixels.get(), 0, m_pixels_size);
+    m_block_copy = packed.block_compressed();
+    if (m_block_copy)
+        file.imagecache().incr_decoded_mem(m_pixels_size);
+    else
+        file.imagecache().incr_mem(m_pixels_size);
+
+    if (!packed.block_compressed()) {
+        const int nc = id.nchannels();
+        size_t n     = si.get_tile_pixels(m_id.miplevel()) * nc;
+        float* f     = (float*)m_pixels.get();
+        m_valid      = convert_image(nc, dims.tile_width, dims.tile_height,
+                                     dims.tile_depth, packed.data(), TypeUInt16,
+                                     AutoStride, AutoStride, AutoStride, f,
+                                     TypeFloat, AutoStride, AutoStride,
+                                     AutoStride);
+        for (size_t i = 0; i < n; ++i)
+            f[i] = packed.dequantize(int(i % nc), f[i]);
+        m_pixels_ready = true;
+        return;
+    }
+
+    // Decode all channels of the blocks into a scratch buffer of whole
+    // blocks, then copy out the channels and data type the cache wants.
+    BlockCompression bc = packed.m_blockformat;
+    TypeDesc blocktype  = block_datatype(bc);
+    int blockchans      = block_nchannels(bc);
+    int w = std::min(dims.tile_width, dims.x + dims.width - id.x());
+    int h = std::min(dims.tile_height, dims.y + dims.height - id.y());
+    int bw = (w + 3) / 4, bh = (h + 3) / 4;
+    stride_t pixelbytes = blockchans * blocktype.size();
+    stride_t linebytes  = 4 * bw * pixelbytes;
+    std::unique_ptr<char[]> texels(new char[4 * bh * linebytes]);
+    const char* src  = packed.m_pixels.get();
+    size_t blocksize = block_bytes(bc);
+    for (int by = 0; by < bh; ++by) {
+        for (int bx = 0; bx < bw; ++bx, src += blocksize)
+            decode_block(bc, src,
+                         texels.get() + 4 * by * linebytes + 4 * bx * pixelbytes,
+                         4 * bw * blockchans);
+    }
+    m_valid = convert_image(id.nchannels(), w, h, 1,
+                            texels.get() + id.chbegin() * blocktype.size(),
+                            blocktype, pixelbytes, linebytes, AutoStride,
+                            m_pixels.get(), format, m_pixelsize,
+                            m_pixelsize * dims.tile_width, AutoStride);
+    m_pixels_ready = true;
+}
+
+
+
 ImageCacheTile::~ImageCacheTile()
 {
-    m_id.file().imagecache().decr_tiles(memsize());
+    if (m_block_copy)
+        m_id.file().imagecache().decr_decoded_mem(memsize());
+    else if (m_copy)
+        m_id.file().imagecache().decr_mem(memsize());
+    else
+        m_id.file().imagecache().decr_tiles(memsize());
     if (m_nofree)
         m_pixels.release();  // release without freeing
 }
 
 
 
+ImageCacheTileRef
+ImageCacheTile::decoded(bool& decoded_now)
+{
+    OIIO_DASSERT(block_compressed());
+    spin_lock lock(m_decoded_mutex);
+    decoded_now = !m_decoded;
+    if (decoded_now)
+        m_decoded = new ImageCacheTile(m_id, *this);
+    m_decoded_used = 1;
+    return m_decoded;
+}
+
+
+
+bool
+ImageCacheTile::drop_decoded()
+{
+    // The pixels are freed once the last thread using them lets go
+    ImageCacheTileRef old;
+    spin_lock lock(m_decoded_mutex);
+    std::swap(old, m_decoded);
+    return bool(old);
+}
+
+
+
 size_t
 ImageCacheTile::memsize_needed() const
 {
@@ -1864,18 +2237,41 @@ bool
 ImageCacheTile::read(ImageCachePerThreadInfo* thread_info)
 {
     ImageCacheFile& file(m_id.file());
-    m_channelsize = file.datatype(id().subimage()).size();
-    m_pixelsize   = m_id.nchannels() * m_channelsize;
-    size_t size   = memsize_needed();
-    OIIO_ASSERT(memsize() == 0 && size > OIIO_SIMD_MAX_SIZE_BYTES);
-    m_pixels.reset(new char[m_pixels_size = size]);
-    // Clear the end pad values so there aren't NaNs sucked up by simd loads
-    memset(m_pixels.get() + size - OIIO_SIMD_MAX_SIZE_BYTES, 0,
-           OIIO_SIMD_MAX_SIZE_BYTES);
-    m_valid = file.read_tile(thread_info, m_id, &m_pixels[0]);
-    file.imagecache().incr_mem(size);
+    SubimageInfo& si(file.subimageinfo(m_id.subimage()));
+    m_channelsize       = file.datatype(id().subimage()).size();
+    m_pixelsize         = m_id.nchannels() * m_channelsize;
+    BlockCompression bc = si.levelinfo(m_id.miplevel()).blockformat;
+    if (bc != BlockCompression::None && m_id.colortransformid() == 0) {
+        // Keep the GPU-compressed blocks; they are decoded into a copy
+        // shared by all threads when first used (see decoded()).
+        OIIO_ASSERT(memsize() == 0);
+        m_valid = file.read_tile_blocks(thread_info, m_id, m_pixels,
+                                        m_pixels_size);
+        if (m_valid)
+            m_blockformat = bc;
+        file.imagecache().incr_mem(m_pixels_size);
+    } else {
+        size_t size = memsize_needed();
+        OIIO_ASSERT(memsize() == 0 && size > OIIO_SIMD_MAX_SIZE_BYTES);
+        m_pixels.reset(new char[m_pixels_size = size]);
+        // Clear the end pad values so there aren't NaNs sucked up by simd
+        // loads
+        memset(m_pixels.get() + size - OIIO_SIMD_MAX_SIZE_BYTES, 0,
+               OIIO_SIMD_MAX_SIZE_BYTES);
+        if (si.reduced_precision) {
+            // Read as float, then narrow to the storage type ourselves
+            float* fpels = float_scratch(FloatScratch::ReadTile,
+                                         si.get_tile_pixels(m_id.miplevel())
+                                             * m_id.nchannels());
+            m_valid      = file.read_tile(thread_info, m_id, fpels);
+            if (m_valid)
+                reduce_precision(fpels);
+        } else {
+            m_valid = file.read_tile(thread_info, m_id, &m_pixels[0]);
+        }
+        file.imagecache().incr_mem(size);
+    }
     if (m_valid) {
-        SubimageInfo& si(file.subimageinfo(m_id.subimage()));
         LevelInfo& lev(si.levelinfo(m_id.miplevel()));
         const ImageDims& dims(si.leveldims(m_id.miplevel()));
         m_tile_width = dims.tile_width;
@@ -1915,6 +2311,69 @@ ImageCacheTile::read(ImageCachePerThreadInfo* thread_info)
 
 
 
+void
+ImageCacheTile::reduce_precision(const float* pels)
+{
+    ImageCacheFile& file(m_id.file());
+    const SubimageInfo& si(file.subimageinfo(m_id.subimage()));
+    size_t n = si.get_tile_pixels(m_id.miplevel()) * m_id.nchannels();
+    const float inf = std::numeric_limits<float>::infinity();
+    float maxerr = 0.0f, maxrelerr = 0.0f;
+    auto account = [&](float val, float stored) {
+        float err = std::abs(stored - val);
+        maxerr    = std::max(maxerr, err);
+        if (val != 0.0f)
+            maxrelerr = std::max(maxrelerr, err / std::abs(val));
+    };
+    if (si.quantized) {
+        // Normalize each channel by its own range of (finite) values in
+        // this tile, so that a channel with a small range isn't squeezed
+        // into a few steps of another's much larger one.
+        const int nc = m_id.nchannels();
+        std::vector<float> lo(nc, inf), hi(nc, -inf), tonorm(nc);
+        for (size_t i = 0; i < n; ++i) {
+            int c = int(i % nc);
+            if (std::isfinite(pels[i])) {
+                lo[c] = std::min(lo[c], pels[i]);
+                hi[c] = std::max(hi[c], pels[i]);
+            }
+        }
+        // Padded so that 4 channels can be loaded starting at any channel
+        m_qscale.reset(new float[nc + 3]());
+        m_qoffset.reset(new float[nc + 3]());
+        for (int c = 0; c < nc; ++c) {
+            if (lo[c] > hi[c])
+                lo[c] = hi[c] = 0.0f;
+            m_qoffset[c] = lo[c];
+            m_qscale[c]  = hi[c] - lo[c];
+            tonorm[c]    = m_qscale[c] > 0.0f ? 65535.0f / m_qscale[c] : 0.0f;
+        }
+        uint16_t* q = (uint16_t*)m_pixels.get();
+        for (size_t i = 0; i < n; ++i) {
+            int c     = int(i % nc);
+            float val = pels[i];
+            if (!std::isfinite(val)) {
+                q[i]   = 0;  // Can't be represented at all
+                maxerr = maxrelerr = inf;
+                continue;
+            }
+            q[i] = uint16_t(
+                clamp((val - lo[c]) * tonorm[c] + 0.5f, 0.0f, 65535.0f));
+            account(val, dequantize(c, q[i] * (1.0f / 65535.0f)));
+        }
+    } else {
+        half* h = (half*)m_pixels.get();
+        for (size_t i = 0; i < n; ++i) {
+            h[i] = pels[i];
+            if (std::isfinite(pels[i]))
+                account(pels[i], h[i]);
+        }
+    }
+    file.record_precision_error(maxerr, maxrelerr);
+}
+
+
+
 void
 ImageCacheTile::wait_pixels_ready() const
 {
@@ -1975,6 +2434,7 @@ ImageCacheImpl::init()
 {
     set_max_open_files(100);
     m_max_memory_bytes     = 1024LL * 1024 * 1024;  // 1 GB default cache size
+    m_max_decoded_bytes    = 64LL * 1024 * 1024;
     m_autotile             = 0;
     m_autoscanline         = false;
     m_automip              = false;
@@ -1987,6 +2447,7 @@ ImageCacheImpl::init()
     m_latlong_y_up_default = true;
     m_Mw2c.makeIdentity();
     m_colorspace              = ustring("scene_linear");
+    m_float_storage           = ustring("float");
     m_mem_used                = 0;
     m_statslevel              = 0;
     m_max_errors_per_file     = 100;
@@ -2008,6 +2469,8 @@ ImageCacheImpl::init()
 
 ImageCacheImpl::~ImageCacheImpl()
 {
+    if (m_trace_recording.exchange(false))
+        write_trace();
     printstats();
     // All the per_thread_infos get destroyed here, regardless of if they were created implicitly
     // or manually by the caller
@@ -2194,6 +2657,10 @@ ImageCacheImpl::getstats(int level) const
     opt += Strutil::fmt::format(#name "=\"{}\" ", m_##name)
         opt += Strutil::fmt::format("max_memory_MB={:0.1f} ",
                                     m_max_memory_bytes / (1024.0 * 1024.0));
+        if (m_compressed_tiles)
+            opt += Strutil::fmt::format("max_decoded_memory_MB={:0.1f} ",
+                                        m_max_decoded_bytes
+                                            / (1024.0 * 1024.0));
         INTOPT(max_open_files);
         BOOLOPT(max_open_files_strict);
         INTOPT(autotile);
@@ -2205,6 +2672,9 @@ ImageCacheImpl::getstats(int level) const
         INTOPT(deduplicate);
         INTOPT(unassociatedalpha);
         INTOPT(failure_retries);
+        BOOLOPT(compressed_tiles);
+        if (m_float_storage != "float")
+            STROPT(float_storage);
         opt += Strutil::fmt::format("openexr:core={} ",
                                     OIIO::get_int_attribute("openexr:core"));
 #undef BOOLOPT
@@ -2271,6 +2741,15 @@ ImageCacheImpl::getstats(int level) const
                             stats.find_tile_microcache_misses,
                             100.0 * stats.find_tile_microcache_misses
                                 / (double)stats.find_tile_calls);
+            if (stats.find_tile_calls)
+                OIIO::print(out,
+                            "    micro-cache hit rate : {:.1f}% ({} tiles "
+                            "per thread)\n",
+                            100.0
+                                * (stats.find_tile_calls
+                                   - stats.find_tile_microcache_misses)
+                                / (double)stats.find_tile_calls,
+                            m_microcache_size);
             if (stats.find_tile_cache_misses)
                 OIIO::print(out, "    main cache misses : {} ({:.1f}%)\n",
                             stats.find_tile_cache_misses,
@@ -2293,6 +2772,12 @@ ImageCacheImpl::getstats(int level) const
                         "    Failure reads followed by unexplained success:"
                         " {} files, {} tiles\n",
                         stats.file_retry_success, stats.tile_retry_success);
+        if (stats.tile_block_decodes) {
+            OIIO::print(out, "    Block-compressed tile decodes : {}\n",
+                        stats.tile_block_decodes);
+            OIIO::print(out, "    Peak decoded block memory : {}\n",
+                        Strutil::memformat(m_decoded_mem_peak));
+        }
 
         printImageCacheMemory(out, *this);
     }
@@ -2414,6 +2899,34 @@ ImageCacheImpl::getstats(int level) const
                 }
             }
         }
+        if (m_float_storage != "float") {
+            // Let users judge, per texture, whether the precision given up
+            // by storing float images narrower is acceptable.
+            std::sort(files.begin(), files.end(),
+                      [](const ImageCacheFileRef& a,
+                         const ImageCacheFileRef& b) {
+                          return a->precision_maxerr() > b->precision_maxerr();
+                      });
+            OIIO::print(out,
+                        "  Largest errors from {} storage of float images"
+                        " (max abs, max rel):\n",
+                        m_float_storage);
+            int nprinted = 0;
+            for (const ImageCacheFileRef& file : files) {
+                if (file->broken() || !file->validspec()
+                    || (file->precision_maxerr() == 0.0f
+                        && file->precision_maxrelerr() == 0.0f))
+                    continue;
+                if (level <= 2 && nprinted >= 10)
+                    break;
+                ++nprinted;
+                OIIO::print(out, "    {:10.4g} {:10.4g}  {}\n",
+                            file->precision_maxerr(),
+                            file->precision_maxrelerr(), file->filename());
+            }
+            if (nprinted == 0)
+                OIIO::print(out, "    (no precision was lost)\n");
+        }
         int nbroken = 0;
         for (const ImageCacheFileRef& file : files) {
             if (file->broken())
@@ -2498,6 +3011,12 @@ ImageCacheImpl::attribute(string_view name, TypeDesc type, const void* val)
         size = std::max(size, 1.0f);  // But let developers debugging do it
 #endif
         m_max_memory_bytes = (long long)(size * (long long)(1024 * 1024));
+    } else if (name == "max_decoded_memory_MB"
+               && (type == TypeDesc::FLOAT || type == TypeDesc::INT)) {
+        float size = type == TypeDesc::FLOAT ? *(const float*)val
+                                             : float(*(const int*)val);
+        size       = std::max(size, 1.0f);
+        m_max_decoded_bytes = (long long)(size * (long long)(1024 * 1024));
     } else if (name == "searchpath" && type == TypeDesc::STRING) {
         std::string s = std::string(*(const char**)val);
         if (s != m_searchpath) {
@@ -2600,6 +3119,45 @@ ImageCacheImpl::attribute(string_view name, TypeDesc type, const void* val)
     } else if (name == "max_mip_res" && type == TypeInt) {
         m_max_mip_res = *(const int*)val;
         do_invalidate = true;
+    } else if (name == "microcache_size" && type == TypeInt) {
+        // Two-way sets, so a power of 2 no smaller than one set
+        int a = clamp(ceil2(*(const int*)val), 2, 256);
+        if (a != m_microcache_size) {
+            m_microcache_size = a;
+            // Each thread resizes its own microcache at its next purge
+            purge_perthread_microcaches();
+        }
+    } else if (name == "float_storage" && type == TypeDesc::STRING) {
+        ustring uval(*(const char**)val);
+        if (uval != "float" && uval != "half" && uval != "uint16") {
+            error("Unknown float_storage \"{}\" (expected float, half, or "
+                  "uint16)",
+                  uval);
+            return false;
+        }
+        if (uval != m_float_storage) {
+            m_float_storage = uval;
+            do_invalidate   = true;
+        }
+    } else if (name == "trace_file" && type == TypeDesc::STRING) {
+        ustring uval(*(const char**)val);
+        if (uval != m_trace_file) {
+            // Finish any trace in progress before starting the next one
+            bool ok = !m_trace_recording.exchange(false) || write_trace();
+            {
+                std::lock_guard<std::mutex> lock(m_trace_mutex);
+                m_trace_file      = uval;
+                m_trace_recording = !uval.empty();
+            }
+            if (!ok)
+                return false;
+        }
+    } else if (name == "compressed_tiles" && type == TypeInt) {
+        bool c = *(const int*)val != 0;
+        if (c != m_compressed_tiles) {
+            m_compressed_tiles = c;
+            do_invalidate      = true;
+        }
     } else {
         // Otherwise, unknown name
         return false;
@@ -2618,6 +3176,7 @@ ImageCacheImpl::getattributetype(string_view name) const
     static std::unordered_map<std::string, TypeDesc> attr_types {
         { "max_open_files", TypeInt },
         { "max_memory_MB", TypeFloat },
+        { "max_decoded_memory_MB", TypeFloat },
         { "statistics:level", TypeInt },
         { "max_errors_per_file", TypeInt },
         { "autotile", TypeInt },
@@ -2632,6 +3191,10 @@ ImageCacheImpl::getattributetype(string_view name) const
         { "failure_retries", TypeInt },
         { "total_files", TypeInt },
         { "max_mip_res", TypeInt },
+        { "microcache_size", TypeInt },
+        { "compressed_tiles", TypeInt },
+        { "float_storage", TypeString },
+        { "trace_file", TypeString },
         { "searchpath", TypeString },
         { "plugin_searchpath", TypeString },
         { "worldtocommon", TypeMatrix },
@@ -2652,6 +3215,7 @@ ImageCacheImpl::getattributetype(string_view name) const
         { "stat:image_size", TypeInt64 },
         { "stat:file_size", TypeInt64 },
         { "stat:bytes_read", TypeInt64 },
+        { "stat:tile_block_decodes", TypeInt64 },
         { "stat:unique_files", TypeInt },
         { "stat:fileio_time", TypeFloat },
         { "stat:fileopen_time", TypeFloat },
@@ -2696,6 +3260,10 @@ ImageCacheImpl::getattribute(string_view name, TypeDesc type, void* val) const
     ATTR_DECODE("max_open_files", int, m_max_open_files);
     ATTR_DECODE("max_memory_MB", float, m_max_memory_bytes / (1024.0 * 1024.0));
     ATTR_DECODE("max_memory_MB", int, m_max_memory_bytes / (1024 * 1024));
+    ATTR_DECODE("max_decoded_memory_MB", float,
+                m_max_decoded_bytes / (1024.0 * 1024.0));
+    ATTR_DECODE("max_decoded_memory_MB", int,
+                m_max_decoded_bytes / (1024 * 1024));
     ATTR_DECODE("statistics:level", int, m_statslevel);
     ATTR_DECODE("max_errors_per_file", int, m_max_errors_per_file);
     ATTR_DECODE("autotile", int, m_autotile);
@@ -2711,6 +3279,8 @@ ImageCacheImpl::getattribute(string_view name, TypeDesc type, void* val) const
     ATTR_DECODE("failure_retries", int, m_failure_retries);
     ATTR_DECODE("total_files", int, m_files.size());
     ATTR_DECODE("max_mip_res", int, m_max_mip_res);
+    ATTR_DECODE("microcache_size", int, m_microcache_size);
+    ATTR_DECODE("compressed_tiles", int, m_compressed_tiles);
 
     // The cases that don't fit in the simple ATTR_DECODE scheme
     if (name == "searchpath" && type == TypeDesc::STRING) {
@@ -2747,6 +3317,14 @@ ImageCacheImpl::getattribute(string_view name, TypeDesc type, void* val) const
         *(const char**)val = m_colorspace.c_str();
         return true;
     }
+    if (name == "float_storage" && type == TypeDesc::STRING) {
+        *(const char**)val = m_float_storage.c_str();
+        return true;
+    }
+    if (name == "trace_file" && type == TypeDesc::STRING) {
+        *(const char**)val = m_trace_file.c_str();
+        return true;
+    }
     if (name == "all_filenames" && type.basetype == TypeDesc::STRING
         && type.is_sized_array()) {
         ustring* names = (ustring*)val;
@@ -2783,6 +3361,8 @@ ImageCacheImpl::getattribute(string_view name, TypeDesc type, void* val) const
         ATTR_DECODE("stat:image_size", long long, stats.files_totalsize);
         ATTR_DECODE("stat:file_size", long long, stats.files_totalsize_ondisk);
         ATTR_DECODE("stat:bytes_read", long long, stats.bytes_read);
+        ATTR_DECODE("stat:tile_block_decodes", long long,
+                    stats.tile_block_decodes);
         ATTR_DECODE("stat:unique_files", int, stats.unique_files);
         ATTR_DECODE("stat:fileio_time", float, stats.fileio_time);
         ATTR_DECODE("stat:fileopen_time", float, stats.fileopen_time);
@@ -2834,6 +3414,8 @@ ImageCacheImpl::find_tile_main_cache(const TileID& id, ImageCacheTileRef& tile,
             tile->use();
             OIIO_DASSERT(id == tile->id());
             OIIO_DASSERT(tile);
+            if (tile->block_compressed())
+                decode_block_tile(tile, thread_info);
             return true;
         }
     }
@@ -2841,6 +3423,8 @@ ImageCacheImpl::find_tile_main_cache(const TileID& id, ImageCacheTileRef& tile,
     // The tile was not found in cache.
 
     ++stats.find_tile_cache_misses;
+    if (m_trace_recording.load(std::memory_order_relaxed))
+        record_trace(id);
 
     // Yes, we're creating and reading a tile with no lock -- this is to
     // prevent all the other threads from blocking because of our
@@ -2854,6 +3438,8 @@ ImageCacheImpl::find_tile_main_cache(const TileID& id, ImageCacheTileRef& tile,
 
     bool ok = add_tile_to_cache(tile, thread_info);
     OIIO_DASSERT(id == tile->id());
+    if (ok && tile->block_compressed())
+        decode_block_tile(tile, thread_info);
     return ok && tile->valid();
 }
 
@@ -2948,7 +3534,13 @@ ImageCacheImpl::check_max_mem(ImageCachePerThreadInfo* /*thread_info*/)
             break;
         OIIO_DASSERT(sweep->second);
 
-        if (!sweep->second->release()) {
+        bool used = sweep->second->release();
+        if (!used && sweep->second->has_decoded()) {
+            // A block-compressed tile keeps its blocks for as long as its
+            // decoded pixels are kept, which check_max_decoded_mem will
+            // soon let go of if they aren't being used.
+            ++sweep;
+        } else if (!used) {
             // This is a tile we should delete.  To keep iterating
             // safely, we have a good trick:
             // 1. remember the TileID of the tile to delete
@@ -2986,6 +3578,40 @@ ImageCacheImpl::check_max_mem(ImageCachePerThreadInfo* /*thread_info*/)
 
 
 
+void
+ImageCacheImpl::check_max_decoded_mem(const ImageCacheTileRef& tile)
+{
+    // A "clock" sweep like check_max_mem's, but over just the tiles that
+    // hold decoded pixels, oldest first: one that was used since the
+    // sweep last passed goes to the back for another chance, and one
+    // that wasn't lets go of its decoded pixels (which are freed once the
+    // last microcache using them moves on).
+    spin_lock lock(m_decoded_tiles_mutex);
+    m_decoded_tiles.push_back(tile);
+    for (size_t n = 2 * m_decoded_tiles.size();
+         n-- && m_decoded_mem_used >= (long long)m_max_decoded_bytes;) {
+        ImageCacheTileRef oldest = std::move(m_decoded_tiles.front());
+        m_decoded_tiles.pop_front();
+        if (oldest->release_decoded())
+            m_decoded_tiles.push_back(std::move(oldest));
+        else
+            oldest->drop_decoded();
+    }
+}
+
+
+
+void
+ImageCacheImpl::drop_all_decoded()
+{
+    spin_lock lock(m_decoded_tiles_mutex);
+    for (auto& tile : m_decoded_tiles)
+        tile->drop_decoded();
+    m_decoded_tiles.clear();
+}
+
+
+
 std::string
 ImageCacheImpl::resolve_filename(const std::string& filename) const
 {
@@ -3068,6 +3694,10 @@ ImageCacheImpl::get_image_info(ImageCacheFile* file,
         ATTR_DECODE("stat:image_size", long long, file->m_total_imagesize);
         ATTR_DECODE("stat:file_size", long long,
                     file->m_total_imagesize_ondisk);
+        ATTR_DECODE("stat:precision_maxerror", float,
+                    file->precision_maxerr());
+        ATTR_DECODE("stat:precision_maxrelerror", float,
+                    file->precision_maxrelerr());
     }
 
     if (file->broken()) {
@@ -3198,7 +3828,11 @@ ImageCacheImpl::get_image_info(ImageCacheFile* file,
     }
     if ((dataname == s_cachedformat || dataname == s_cachedpixeltype)
         && datatype == TypeInt) {
-        *(int*)data = (int)file->datatype(subimage).basetype;
+        // Quantized images are presented as float by get_tile/get_pixels,
+        // since their uint16 values are meaningless without each tile's
+        // scale and offset, so report the type callers actually receive.
+        *(int*)data = si.quantized ? (int)TypeDesc::FLOAT
+                                   : (int)file->datatype(subimage).basetype;
         return true;
     }
     if (dataname == s_miplevels && datatype == TypeInt) {
@@ -3564,7 +4198,6 @@ ImageCacheImpl::get_pixels(ImageCacheFile* file,
         thread_info = get_perthread_info();
     const SubimageInfo& si(file->subimageinfo(subimage));
     const ImageDims& dims(si.leveldims(miplevel));
-    bool ok = true;
 
     // Compute channels and stride if not given (assume all channels,
     // contiguous data layout for strides).
@@ -3582,111 +4215,160 @@ ImageCacheImpl::get_pixels(ImageCacheFile* file,
     ImageSpec::auto_stride(xstride, ystride, zstride, format, result_nchans,
                            xend - xbegin, yend - ybegin);
 
-    // result_pixelsize, scanlinesize, and zplanesize assume contiguous
-    // layout.  This may or may not be the same as the strides passed by
-    // the caller.
+    // result_pixelsize assumes contiguous layout.  This may or may not be
+    // the same as the strides passed by the caller.
     TypeDesc cachetype          = file->datatype(subimage);
     const size_t cachesize      = cachetype.size();
     const stride_t cache_stride = cachesize * cache_nchans;
     size_t formatsize           = format.size();
     stride_t result_pixelsize   = result_nchans * formatsize;
-    bool xcontig                = (result_pixelsize == xstride
-                    && result_nchans == cache_nchans);
-    stride_t scanlinesize       = (xend - xbegin) * result_pixelsize;
-    stride_t zplanesize         = (yend - ybegin) * scanlinesize;
     OIIO_DASSERT(dims.depth >= 1 && dims.tile_depth >= 1);
 
-    imagesize_t npixelsread = 0;
-    char* zptr              = (char*)result;
-    for (int z = zbegin; z < zend; ++z, zptr += zstride) {
-        if (z < dims.z || z >= (dims.z + dims.depth)) {
-            // nonexistent planes
-            if (xstride == result_pixelsize && ystride == scanlinesize) {
-                // Can zero out the plane in one shot
-                memset(zptr, 0, zplanesize);
+    // Clamp the requested region to the data window. Pixels outside of it
+    // are zero-filled; everything inside is copied a whole tile-sized
+    // block at a time below.
+    const int vxbegin = std::max(xbegin, dims.x);
+    const int vxend   = std::min(xend, dims.x + dims.width);
+    const int vybegin = std::max(ybegin, dims.y);
+    const int vyend   = std::min(yend, dims.y + dims.height);
+    const int vzbegin = std::max(zbegin, dims.z);
+    const int vzend   = std::min(zend, dims.z + dims.depth);
+    const bool any_valid = (vxbegin < vxend && vybegin < vyend
+                            && vzbegin < vzend);
+    if (!any_valid || vxbegin > xbegin || vxend < xend || vybegin > ybegin
+        || vyend < yend || vzbegin > zbegin || vzend < zend) {
+        auto zero_span = [&](char* ptr, int n) {
+            if (n <= 0)
+                return;
+            if (xstride == result_pixelsize) {
+                // Can zero out the span in one shot
+                memset(ptr, 0, n * result_pixelsize);
             } else {
                 // Non-contiguous strides -- zero out individual pixels
-                char* yptr = zptr;
-                for (int y = ybegin; y < yend; ++y, yptr += ystride) {
-                    char* xptr = yptr;
-                    for (int x = xbegin; x < xend; ++x, xptr += xstride)
-                        memset(xptr, 0, result_pixelsize);
-                }
-            }
-            continue;
-        }
-        int old_tx = -100000, old_ty = -100000, old_tz = -100000;
-        int tz     = z - ((z - dims.z) % dims.tile_depth);
-        char* yptr = zptr;
-        int ty     = ybegin - ((ybegin - dims.y) % dims.tile_height);
-        int tyend  = ty + dims.tile_height;
-        for (int y = ybegin; y < yend; ++y, yptr += ystride) {
-            if (y == tyend) {
-                ty = tyend;
-                tyend += dims.tile_height;
+                for (int x = 0; x < n; ++x, ptr += xstride)
+                    memset(ptr, 0, result_pixelsize);
             }
-            if (y < dims.y || y >= (dims.y + dims.height)) {
-                // nonexistent scanlines
-                if (xstride == result_pixelsize) {
-                    // Can zero out the scanline in one shot
-                    memset(yptr, 0, scanlinesize);
+        };
+        char* zptr = (char*)result;
+        for (int z = zbegin; z < zend; ++z, zptr += zstride) {
+            bool zvalid = any_valid && z >= vzbegin && z < vzend;
+            char* yptr  = zptr;
+            for (int y = ybegin; y < yend; ++y, yptr += ystride) {
+                if (!zvalid || y < vybegin || y >= vyend) {
+                    // nonexistent planes or scanlines
+                    zero_span(yptr, xend - xbegin);
                 } else {
-                    // Non-contiguous strides -- zero out individual pixels
-                    char* xptr = yptr;
-                    for (int x = xbegin; x < xend; ++x, xptr += xstride)
-                        memset(xptr, 0, result_pixelsize);
+                    // nonexistent columns on either side
+                    zero_span(yptr, vxbegin - xbegin);
+                    zero_span(yptr + (vxend - xbegin) * xstride,
+                              xend - vxend);
                 }
-                continue;
             }
-            // int ty = y - ((y - dims.y) % dims.tile_height);
-            char* xptr       = yptr;
-            const char* data = NULL;
-            for (int x = xbegin; x < xend;
-                 ++x, xptr += xstride, ++npixelsread) {
-                if (x < dims.x || x >= (dims.x + dims.width)) {
-                    // nonexistent columns
-                    memset(xptr, 0, result_pixelsize);
-                    continue;
-                }
-                int tx = x - ((x - dims.x) % dims.tile_width);
-                if (old_tx != tx || old_ty != ty || old_tz != tz) {
-                    // Only do a find_tile and re-setup of the data
-                    // pointer when we move across a tile boundary.
+        }
+    }
+    if (!any_valid)
+        return true;
+
+    // Copy one row of tiles at a time. Each tile overlapping the region is
+    // found (and held) exactly once, and the whole overlap of the tile and
+    // the region is converted with a single strided convert_image call,
+    // rather than looking the tile up again for every scanline.
+    const stride_t tile_ystride = cache_stride * dims.tile_width;
+    const stride_t tile_zstride = tile_ystride * dims.tile_height;
+    const int tybegin = vybegin - ((vybegin - dims.y) % dims.tile_height);
+    const int txbegin = vxbegin - ((vxbegin - dims.x) % dims.tile_width);
+    const int tzbegin = vzbegin - ((vzbegin - dims.z) % dims.tile_depth);
+    const int ntilerows = (vyend - tybegin + dims.tile_height - 1)
+                          / dims.tile_height;
+    auto copy_tile_rows = [&](ImageCachePerThreadInfo* ti, int64_t rowbegin,
+                              int64_t rowend) -> bool {
+        for (int64_t row = rowbegin; row < rowend; ++row) {
+            int ty = tybegin + int(row) * dims.tile_height;
+            int y0 = std::max(ty, vybegin);
+            int y1 = std::min(ty + dims.tile_height, vyend);
+            for (int tz = tzbegin; tz < vzend; tz += dims.tile_depth) {
+                int z0 = std::max(tz, vzbegin);
+                int z1 = std::min(tz + dims.tile_depth, vzend);
+                for (int tx = txbegin; tx < vxend; tx += dims.tile_width) {
+                    int x0 = std::max(tx, vxbegin);
+                    int x1 = std::min(tx + dims.tile_width, vxend);
                     TileID tileid(*file, subimage, miplevel, tx, ty, tz,
                                   cache_chbegin, cache_chend);
-                    ok &= find_tile(tileid, thread_info, npixelsread == 0);
-                    if (!ok)
+                    if (!find_tile(tileid, ti, true))
                         return false;  // Just stop if file read failed
-                    old_tx = tx;
-                    old_ty = ty;
-                    old_tz = tz;
-                    data   = NULL;
-                }
-                if (!data) {
-                    ImageCacheTileRef& tile(thread_info->tile);
+                    const ImageCacheTileRef& tile(ti->tile);
                     OIIO_DASSERT(tile);
-                    data = (const char*)tile->data(x, y, z, chbegin);
-                    OIIO_DASSERT(data);
-                }
-                if (xcontig) {
-                    // Special case for a contiguous span within one tile
-                    int spanend   = std::min(tx + dims.tile_width, xend);
-                    stride_t span = spanend - x;
-                    convert_pixel_values(cachetype, data, format, xptr,
-                                         result_nchans * span);
-                    x += (span - 1);
-                    xptr += xstride * (span - 1);
-                    // no need to increment data, since next read will
-                    // be from a different tile
-                } else {
-                    convert_pixel_values(cachetype, data, format, xptr,
-                                         result_nchans);
-                    data += cache_stride;
+                    const char* src = (const char*)tile->data(x0, y0, z0,
+                                                              chbegin);
+                    OIIO_DASSERT(src);
+                    char* dst = (char*)result + (z0 - zbegin) * zstride
+                                + (y0 - ybegin) * ystride
+                                + (x0 - xbegin) * xstride;
+                    if (si.quantized) {
+                        // Undo the tile's normalization on the way out
+                        int nx = x1 - x0, ny = y1 - y0, nz = z1 - z0;
+                        size_t n = size_t(nx) * ny * nz * result_nchans;
+                        float* fpels = float_scratch(FloatScratch::GetPixels,
+                                                     n);
+                        stride_t fx  = result_nchans * sizeof(float);
+                        convert_image(result_nchans, nx, ny, nz, src,
+                                      cachetype, cache_stride, tile_ystride,
+                                      tile_zstride, fpels, TypeFloat, fx,
+                                      fx * nx, fx * nx * ny);
+                        int c0 = chbegin - tile->id().chbegin();
+                        for (size_t i = 0; i < n; ++i)
+                            fpels[i] = tile->dequantize(
+                                c0 + int(i % result_nchans), fpels[i]);
+                        convert_image(result_nchans, nx, ny, nz, fpels,
+                                      TypeFloat, fx, fx * nx, fx * nx * ny,
+                                      dst, format, xstride, ystride, zstride);
+                        continue;
+                    }
+                    convert_image(result_nchans, x1 - x0, y1 - y0, z1 - z0,
+                                  src, cachetype, cache_stride, tile_ystride,
+                                  tile_zstride, dst, format, xstride, ystride,
+                                  zstride);
                 }
             }
         }
-    }
+        return true;
+    };
 
+    // Small requests, or those spanning a single row of tiles, are done
+    // entirely by the calling thread.
+    const imagesize_t npixels = imagesize_t(vxend - vxbegin)
+                                * imagesize_t(vyend - vybegin)
+                                * imagesize_t(vzend - vzbegin);
+    if (ntilerows < 2 || npixels < get_pixels_parallel_min_pixels)
+        return copy_tile_rows(thread_info, 0, ntilerows);
+
+    // Large requests are split by rows of tiles across the thread pool.
+    // Workers use their own per-thread info (and thus tile microcache);
+    // errors are thread-specific, so a failing worker's messages are
+    // gathered and re-posted to the calling thread.
+    std::atomic<bool> ok(true);
+    std::mutex errmutex;
+    std::string errors;
+    const auto caller = std::this_thread::get_id();
+    parallel_for_chunked(0, ntilerows, 0, [&](int64_t b, int64_t e) {
+        if (!ok)
+            return;
+        bool in_caller = (std::this_thread::get_id() == caller);
+        ImageCachePerThreadInfo* ti = in_caller ? thread_info
+                                                : get_perthread_info();
+        if (!copy_tile_rows(ti, b, e)) {
+            ok = false;
+            if (!in_caller) {
+                std::string err = geterror();
+                std::lock_guard<std::mutex> lock(errmutex);
+                if (err.size() && errors.size())
+                    errors += '\n';
+                errors += err;
+            }
+        }
+    });
+    if (errors.size())
+        append_error(errors);
     return ok;
 }
 
@@ -3802,6 +4484,9 @@ ImageCacheImpl::get_tile(ImageHandle* file, Perthread* thread_info,
     TileID id(*file, subimage, miplevel, x, y, z, chbegin, chend);
     if (find_tile(id, thread_info, true)) {
         ImageCacheTileRef tile(thread_info->tile);
+        // Hand out quantized tiles expanded back to their float values
+        if (si.quantized)
+            tile = new ImageCacheTile(id, *tile);
         tile->_incref();  // Fake an extra reference count
         return (ImageCache::Tile*)tile.get();
     } else {
@@ -3854,6 +4539,8 @@ ImageCacheImpl::tile_pixels(ImageCache::Tile* tile, TypeDesc& format) const
         return NULL;
     ImageCacheTile* t = (ImageCacheTile*)tile;
     format            = t->file().datatype(t->id().subimage());
+    if (t->file().subimageinfo(t->id().subimage()).quantized)
+        format = TypeFloat;  // get_tile expanded it
     return t->data();
 }
 
@@ -3944,6 +4631,212 @@ ImageCacheImpl::add_tile(ustring filename, int subimage, int miplevel, int x,
 
 
 
+// First line of a tile access trace file.
+static const char trace_header[] = "# OpenImageIO tile access trace 1";
+
+// Most adjacent tiles the prefetcher will fetch with one read.
+static constexpr int max_prefetch_run = 32;
+
+
+
+void
+ImageCacheImpl::record_trace(const TileID& id)
+{
+    std::lock_guard<std::mutex> lock(m_trace_mutex);
+    if (m_trace_recording && m_trace_seen.insert(id).second)
+        m_trace.push_back({ id.file().filename(), id.subimage(),
+                            id.miplevel(), id.x(), id.y(), id.z(),
+                            id.chbegin(), id.chend(), id.colortransformid() });
+}
+
+
+
+bool
+ImageCacheImpl::write_trace()
+{
+    std::lock_guard<std::mutex> lock(m_trace_mutex);
+    // Each file is named once, by an "f" line preceding its first tile;
+    // "t" lines then refer to it by index.
+    std::string out = Strutil::fmt::format("{}\n", trace_header);
+    std::unordered_map<ustring, int> fileindex;
+    for (const TraceEntry& t : m_trace) {
+        auto f = fileindex.find(t.filename);
+        if (f == fileindex.end()) {
+            f = fileindex.emplace(t.filename, int(fileindex.size())).first;
+            out += Strutil::fmt::format("f {} {}\n", f->second, t.filename);
+        }
+        out += Strutil::fmt::format("t {} {} {} {} {} {} {} {} {}\n",
+                                    f->second, t.subimage, t.miplevel, t.x,
+                                    t.y, t.z, t.chbegin, t.chend,
+                                    t.colortransformid);
+    }
+    m_trace.clear();
+    m_trace_seen.clear();
+    if (!Filesystem::write_text_file(m_trace_file, out)) {
+        error("Could not write tile access trace \"{}\"", m_trace_file);
+        return false;
+    }
+    return true;
+}
+
+
+
+bool
+ImageCacheImpl::prefetch_trace(string_view tracefile)
+{
+    std::string text;
+    if (!Filesystem::read_text_file(tracefile, text)) {
+        error("Could not read tile access trace \"{}\"", tracefile);
+        return false;
+    }
+
+    // Gather the tiles of each file, keeping the files in the order in
+    // which the recorded run first touched them.
+    std::vector<ustring> filenames;
+    std::vector<std::vector<TraceEntry>> filetiles;
+    int linenum = 0;
+    for (string_view line : Strutil::splitsv(text, "\n")) {
+        ++linenum;
+        line = Strutil::strip(line);
+        if (linenum == 1) {
+            if (line != trace_header) {
+                error("\"{}\" is not a tile access trace", tracefile);
+                return false;
+            }
+            continue;
+        }
+        int v[9];
+        if (Strutil::parse_char(line, 'f')) {
+            if (!Strutil::parse_int(line, v[0])
+                || v[0] != int(filenames.size())) {
+                error("Malformed tile access trace \"{}\", line {}",
+                      tracefile, linenum);
+                return false;
+            }
+            Strutil::skip_whitespace(line);
+            filenames.emplace_back(line);
+            filetiles.emplace_back();
+        } else if (Strutil::parse_char(line, 't')) {
+            bool ok = true;
+            for (int& i : v)
+                ok &= Strutil::parse_int(line, i);
+            if (!ok || v[0] < 0 || v[0] >= int(filenames.size())) {
+                error("Malformed tile access trace \"{}\", line {}",
+                      tracefile, linenum);
+                return false;
+            }
+            filetiles[v[0]].push_back({ filenames[v[0]], v[1], v[2], v[3],
+                                        v[4], v[5], v[6], v[7], v[8] });
+        } else if (line.size()) {
+            error("Malformed tile access trace \"{}\", line {}", tracefile,
+                  linenum);
+            return false;
+        }
+    }
+
+    // One task per file, handed out in trace order. The trace is only a
+    // hint, so files that have since gone away are quietly skipped.
+    parallel_for(int64_t(0), int64_t(filenames.size()), [&](int64_t i) {
+        ImageCachePerThreadInfo* thread_info = get_perthread_info();
+        ImageCacheFile* file = find_file(filenames[i], thread_info);
+        file                 = verify_file(file, thread_info);
+        if (file && !file->broken() && !file->is_udim())
+            prefetch_file_tiles(file, filetiles[i]);
+    });
+    return true;
+}
+
+
+
+void
+ImageCacheImpl::prefetch_file_tiles(ImageCacheFile* file,
+                                    std::vector<TraceEntry>& tiles)
+{
+    ImageCachePerThreadInfo* thread_info = get_perthread_info();
+    auto tileid = [&](const TraceEntry& t) {
+        return TileID(*file, t.subimage, t.miplevel, t.x, t.y, t.z, t.chbegin,
+                      t.chend, t.colortransformid);
+    };
+
+    // Drop tiles the file no longer has and those already in the cache.
+    tiles.erase(std::remove_if(tiles.begin(), tiles.end(),
+                               [&](const TraceEntry& t) {
+                                   if (t.subimage < 0
+                                       || t.subimage >= file->subimages()
+                                       || t.miplevel < 0
+                                       || t.miplevel
+                                              >= file->miplevels(t.subimage)
+                                       || t.chbegin < 0 || t.chend <= t.chbegin
+                                       || t.chend > file->spec(t.subimage)
+                                                        .nchannels)
+                                       return true;
+                                   ImageCacheTileRef tile;
+                                   return m_tilecache.retrieve(tileid(t), tile);
+                               }),
+                tiles.end());
+
+    // Sort into the order the tiles are laid out in the file, so that
+    // neighbors on the same tile row become one read.
+    std::sort(tiles.begin(), tiles.end(),
+              [](const TraceEntry& a, const TraceEntry& b) {
+                  return std::tie(a.subimage, a.miplevel, a.colortransformid,
+                                  a.chbegin, a.chend, a.z, a.y, a.x)
+                         < std::tie(b.subimage, b.miplevel, b.colortransformid,
+                                    b.chbegin, b.chend, b.z, b.y, b.x);
+              });
+
+    for (size_t i = 0, n = tiles.size(); i < n;) {
+        const TraceEntry& first(tiles[i]);
+        const SubimageInfo& si(file->subimageinfo(first.subimage));
+        const ImageDims& dims(si.leveldims(first.miplevel));
+        // Emulated tiles of untiled or unmipped files, and tiles we keep
+        // block-compressed, have their own read paths.
+        bool coalesce = !si.untiled && !(si.unmipped && first.miplevel)
+                        && !(m_compressed_tiles
+                             && si.levelinfo(first.miplevel).blockformat
+                                    != BlockCompression::None);
+        size_t e = i + 1;
+        while (coalesce && e < n && e - i < max_prefetch_run
+               && tiles[e].subimage == first.subimage
+               && tiles[e].miplevel == first.miplevel
+               && tiles[e].colortransformid == first.colortransformid
+               && tiles[e].chbegin == first.chbegin
+               && tiles[e].chend == first.chend && tiles[e].z == first.z
+               && tiles[e].y == first.y
+               && tiles[e].x == tiles[e - 1].x + dims.tile_width)
+            ++e;
+        int ntiles = int(e - i);
+        TileID id  = tileid(first);
+        if (ntiles == 1) {
+            ImageCacheTileRef tile = new ImageCacheTile(id);
+            add_tile_to_cache(tile, thread_info);
+        } else {
+            TypeDesc format = file->readtype(first.subimage);
+            stride_t xstride = stride_t(id.nchannels() * format.size());
+            stride_t ystride = xstride * dims.tile_width * ntiles;
+            stride_t zstride = ystride * dims.tile_height;
+            std::unique_ptr<char[]> buf(new char[zstride * dims.tile_depth]);
+            Timer timer;
+            bool ok         = file->read_tiles(thread_info, id, ntiles,
+                                               buf.get());
+            double readtime = timer();
+            thread_info->m_stats.fileio_time += readtime;
+            file->iotime() += readtime;
+            for (int t = 0; ok && t < ntiles; ++t) {
+                ImageCacheTileRef tile
+                    = new ImageCacheTile(tileid(tiles[i + t]),
+                                         buf.get() + t * dims.tile_width * xstride,
+                                         format, xstride, ystride, zstride);
+                if (tile->valid())
+                    add_tile_to_cache(tile, thread_info);
+            }
+        }
+        i = e;
+    }
+}
+
+
+
 void
 ImageCacheImpl::invalidate(ustring filename, bool force)
 {
@@ -3986,6 +4879,7 @@ ImageCacheImpl::invalidate(ImageHandle* handle, bool force)
     // Safely erase all the tiles we found
     for (const TileID& id : tiles_to_delete)
         m_tilecache.erase(id);
+    drop_all_decoded();
 
     const ustring fingerprint = file->fingerprint();
 
@@ -4011,6 +4905,7 @@ ImageCacheImpl::invalidate_all(bool force)
     if (force) {
         // Clear the whole tile cache
         m_tilecache.clear();
+        drop_all_decoded();
         // Invalidate (close and clear spec) all individual files
         for (FilenameMap::iterator fileit = m_files.begin(), e = m_files.end();
              fileit != e; ++fileit) {
@@ -4279,7 +5174,8 @@ ImageCacheImpl::inventory_udim(ImageCacheFile* udimfile, Perthread* thread_info,
 ImageCachePerThreadInfo*
 ImageCacheImpl::create_thread_info()
 {
-    ImageCachePerThreadInfo* p = new ImageCachePerThreadInfo;
+    ImageCachePerThreadInfo* p = new ImageCachePerThreadInfo(
+        m_microcache_size);
     // printf ("New perthread %p\n", (void *)p);
     spin_lock lock(m_perthread_info_mutex);
     m_all_perthread_info.emplace_back(p);
@@ -4317,7 +5213,7 @@ ImageCacheImpl::get_perthread_info(ImageCachePerThreadInfo* p)
         p = ptr;
         if (!p) {
             // this thread doesn't have a ImageCachePerThreadInfo for this ImageCacheImpl yet
-            ptr = p = new ImageCachePerThreadInfo;
+            ptr = p = new ImageCachePerThreadInfo(m_microcache_size);
             // printf ("New perthread %p\n", (void *)p);
             spin_lock lock(m_perthread_info_mutex);
             m_all_perthread_info.emplace_back(p);
@@ -4326,9 +5222,8 @@ ImageCacheImpl::get_perthread_info(ImageCachePerThreadInfo* p)
     if (p->purge) {  // has somebody requested a tile purge?
         // This is safe, because it's our thread.
         spin_lock lock(m_perthread_info_mutex);
-        p->tile     = NULL;
-        p->lasttile = NULL;
-        p->purge    = 0;
+        p->reset_microcache(m_microcache_size);
+        p->purge = 0;
         p->m_thread_files.clear();
     }
     return p;
@@ -4836,6 +5731,13 @@ ImageCache::close_all()
 }
 
 
+bool
+ImageCache::prefetch_trace(string_view tracefile)
+{
+    return m_impl->prefetch_trace(tracefile);
+}
+
+
 ImageCache::Tile*
 ImageCache::get_tile(ustring filename, int subimage, int miplevel, int x, int y,
                      int z, int chbegin, int chend)
@@ -10,6 +10,9 @@
 #ifndef OPENIMAGEIO_IMAGECACHE_PVT_H
 #define OPENIMAGEIO_IMAGECACHE_PVT_H
 
+#include <deque>
+#include <unordered_set>
+
 #include <tsl/robin_map.h>
 
 #include <OpenImageIO/Imath.h>
@@ -97,11 +100,14 @@ struct ImageCacheStatistics {
     long long aniso_queries;
     long long aniso_probes;
     float max_aniso;
+    long long ewa_queries;
+    long long ewa_texels;
     long long closest_interps;
     long long bilinear_interps;
     long long cubic_interps;
     int file_retry_success;
     int tile_retry_success;
+    long long tile_block_decodes;
 
     ImageCacheStatistics() { init(); }
     void init();
@@ -110,9 +116,68 @@ struct ImageCacheStatistics {
 
 
 
+/// GPU block compression formats that the cache can keep tiles resident
+/// in (see the "compressed_tiles" attribute). Every format encodes 4x4
+/// pixel blocks.
+enum class BlockCompression : uint8_t {
+    None,
+    BC1,
+    BC2,
+    BC3,
+    BC4,
+    BC5,
+    BC6HU,
+    BC6HS,
+    BC7
+};
+
+/// Bytes per 4x4 block.
+inline size_t
+block_bytes(BlockCompression bc)
+{
+    return (bc == BlockCompression::BC1 || bc == BlockCompression::BC4) ? 8
+                                                                        : 16;
+}
+
+/// Number of channels a block decodes to.
+inline int
+block_nchannels(BlockCompression bc)
+{
+    switch (bc) {
+    case BlockCompression::None: return 0;
+    case BlockCompression::BC4: return 1;
+    case BlockCompression::BC5: return 2;
+    case BlockCompression::BC6HU:
+    case BlockCompression::BC6HS: return 3;
+    default: return 4;
+    }
+}
+
+/// Data type a block decodes to.
+inline TypeDesc
+block_datatype(BlockCompression bc)
+{
+    return (bc == BlockCompression::BC6HU || bc == BlockCompression::BC6HS)
+               ? TypeHalf
+               : TypeUInt8;
+}
+
+
+
 namespace pvt {
 
 
+/// Deleter for the ImageInput of a file whose tiles are kept
+/// block-compressed, which also owns the IOProxy that both the reader and
+/// the cache (see ImageCacheFile::read_tile_blocks) read the file through,
+/// so that the proxy stays open exactly as long as the ImageInput does.
+struct BlockProxyHolder {
+    std::shared_ptr<Filesystem::IOProxy> io;
+    void operator()(ImageInput* in) const { delete in; }
+};
+
+
+
 struct UdimInfo {
     ustring filename;
     std::atomic<ImageCacheFile*> icfile { nullptr };
@@ -199,13 +264,44 @@ public:
     {
         return m_subimages[subimage].datatype;
     }
+    /// The type in which tiles are read from the file. This is the cached
+    /// datatype, except for float images the cache stores at reduced
+    /// precision, which are read as float and then narrowed.
+    TypeDesc readtype(int subimage) const
+    {
+        return m_subimages[subimage].reduced_precision
+                   ? TypeFloat
+                   : m_subimages[subimage].datatype;
+    }
     ImageCacheImpl& imagecache() const { return m_imagecache; }
     ImageInput::Creator creator() const { return m_inputcreator; }
 
     /// Load new data tile
     ///
     bool read_tile(ImageCachePerThreadInfo* thread_info, const TileID& id,
-                   void* data);
+                   void* data)
+    {
+        return read_tiles(thread_info, id, 1, data);
+    }
+
+    /// Load a row of `ntiles` horizontally adjacent tiles, the first of
+    /// which is `id`, with a single read into a buffer `ntiles` tiles
+    /// wide.  Only ordinary tiled levels may read more than one tile.
+    bool read_tiles(ImageCachePerThreadInfo* thread_info, const TileID& id,
+                    int ntiles, void* data);
+
+    /// Load the still-compressed GPU blocks covering a tile of a level
+    /// whose blocks we located at open time, storing them in `blocks` and
+    /// their total size in `size`. They are read through the same IOProxy
+    /// as the file's ImageInput.
+    bool read_tile_blocks(ImageCachePerThreadInfo* thread_info,
+                          const TileID& id, std::unique_ptr<char[]>& blocks,
+                          size_t& size);
+
+    /// The IOProxy that `inp`, this file's ImageInput, reads through, if
+    /// the proxy is one we may read compressed blocks through as well.
+    Filesystem::IOProxy*
+    block_ioproxy(const std::shared_ptr<ImageInput>& inp) const;
 
     /// Mark the file as recently used.
     ///
@@ -242,6 +338,18 @@ public:
     size_t tilesread() const { return m_tilesread; }
     imagesize_t bytesread() const { return m_bytesread; }
     double& iotime() { return m_iotime; }
+
+    /// Note the errors introduced by storing a tile of this file at
+    /// reduced precision.
+    void record_precision_error(float abserr, float relerr)
+    {
+        atomic_max(m_precision_maxerr, abserr);
+        atomic_max(m_precision_maxrelerr, relerr);
+    }
+    /// Largest absolute and relative errors introduced so far by storing
+    /// this file at reduced precision.
+    float precision_maxerr() const { return m_precision_maxerr; }
+    float precision_maxrelerr() const { return m_precision_maxrelerr; }
     size_t redundant_tiles() const { return (size_t)m_redundant_tiles.load(); }
     imagesize_t redundant_bytesread() const
     {
@@ -329,6 +437,8 @@ public:
     /// Info for each MIP level that isn't in the ImageSpec, or that we
     /// precompute.
     struct LevelInfo {
+        int64_t blockoffset = -1;  ///< File offset of BC blocks, or -1
+        BlockCompression blockformat = BlockCompression::None;
         ImageDims* m_dims;                   ///< Level dimensions
         std::unique_ptr<float[]> polecolor;  ///< Pole colors
         atomic_ll* tiles_read;  ///< Bitfield for tiles read at least once
@@ -356,6 +466,8 @@ public:
         bool autotiled           = false;  ///< We are autotiling this image
         bool full_pixel_range    = false;  ///< data window matches image window
         bool is_constant_image   = false;  ///< Is the image a constant color?
+        bool reduced_precision   = false;  ///< Stored narrower than the file
+        bool quantized           = false;  ///< uint16 w/ per-tile scale/offset
         bool has_average_color   = false;  ///< We have an average color
         spin_mutex average_color_mutex;    ///< protect average_color
         std::vector<float> average_color;  ///< Average color
@@ -523,6 +635,8 @@ private:
     size_t m_timesopened;                ///< Separate times we opened this file
     double m_iotime;                     ///< I/O time for this file
     double m_mutex_wait_time;            ///< Wait time for m_input_mutex
+    atomic<float> m_precision_maxerr { 0.0f };     ///< Reduced precision error
+    atomic<float> m_precision_maxrelerr { 0.0f };  ///< ... relative error
     bool m_mipused;                      ///< MIP level >0 accessed
     volatile bool m_validspec;           ///< If false, reread spec upon open
     mutable int m_errors_issued;         ///< Errors issued for this file
@@ -722,6 +836,19 @@ struct TileID {
         size_t operator()(const TileID& a) const { return a.hash(); }
     };
 
+    /// A much cheaper hash than hash(), mixing only the fields that tend to
+    /// differ among the handful of tiles a thread is working with at once.
+    /// Good enough to pick a set in the per-thread microcache, not for the
+    /// main tile cache.
+    size_t microcache_hash() const
+    {
+        uint64_t h = uint64_t(uint32_t(m_x)) | (uint64_t(uint32_t(m_y)) << 32);
+        h ^= uint64_t(uint32_t(m_z)) * 0x9e3779b97f4a7c15ULL;
+        h ^= (uint64_t(m_miplevel) << 24) ^ (uint64_t(m_subimage) << 48);
+        h ^= uint64_t(uintptr_t(m_file));
+        return size_t(murmur::fmix(h));
+    }
+
     friend std::ostream& operator<<(std::ostream& o, const TileID& id)
     {
         return (o << "{xyz=" << id.m_x << ',' << id.m_y << ',' << id.m_z
@@ -757,6 +884,14 @@ public:
                    stride_t xstride, stride_t ystride, stride_t zstride,
                    bool copy = true);
 
+    /// Construct a decoded copy of a tile whose pixels are held in a
+    /// block-compressed format, or quantized (which is expanded back to
+    /// float).  The copy is not itself in the main cache.  The memory of
+    /// a quantized tile's copy counts against the cache's limit for as
+    /// long as it lives; that of a block-compressed tile's counts against
+    /// the separate, smaller limit for decoded blocks.
+    ImageCacheTile(const TileID& id, const ImageCacheTile& packed);
+
     ~ImageCacheTile();
 
     /// Actually read the pixels.  The caller had better be the thread that
@@ -824,6 +959,55 @@ public:
 
     bool valid(void) const { return m_valid; }
 
+    /// Is this a tile of an image stored quantized to uint16?
+    bool quantized() const { return m_qscale != nullptr; }
+
+    /// For quantized tiles, the scale and offset of each channel (numbered
+    /// from the tile's first channel) that map its normalized [0,1] values
+    /// back to their original range. Both arrays are padded with zeroes
+    /// so that four channels may be loaded starting at any channel.
+    const float* qscale() const { return m_qscale.get(); }
+    const float* qoffset() const { return m_qoffset.get(); }
+
+    /// Map a normalized [0,1] value of channel c (numbered from the tile's
+    /// first channel) back to its original range, if the tile is quantized.
+    float dequantize(int c, float val) const
+    {
+        return m_qscale ? val * m_qscale[c] + m_qoffset[c] : val;
+    }
+
+    /// Are the pixels held as GPU compressed blocks rather than texels?
+    /// Such tiles must be decoded before their pixels can be used.
+    bool block_compressed() const
+    {
+        return m_blockformat != BlockCompression::None;
+    }
+
+    /// For a block-compressed tile, return its pixels decoded, as a tile
+    /// of their own that all threads share, decoding the blocks only if
+    /// nobody has since the decoded pixels were last dropped.  Set
+    /// `decoded_now` if this call did the decoding.
+    intrusive_ptr<ImageCacheTile> decoded(bool& decoded_now);
+
+    /// Does this block-compressed tile currently hold decoded pixels?
+    bool has_decoded()
+    {
+        spin_lock lock(m_decoded_mutex);
+        return bool(m_decoded);
+    }
+
+    /// Mark the decoded pixels as not recently used, returning true if
+    /// they had been (like release(), for the decoded copy).
+    bool release_decoded()
+    {
+        int one = 1;
+        return m_decoded_used.compare_exchange_strong(one, 0);
+    }
+
+    /// Let go of the decoded pixels of a block-compressed tile, keeping
+    /// the blocks.  Return true if there were any.
+    bool drop_decoded();
+
     /// Are the pixels ready for use?  If false, they're still being
     /// read from disk.
     bool pixels_ready() const { return m_pixels_ready; }
@@ -857,8 +1041,20 @@ private:
     int m_tile_width { 0 };            ///< Tile width
     bool m_valid { false };            ///< Valid pixels
     bool m_nofree { false };  ///< We do NOT own the pixels, do not free!
+    bool m_copy { false };     ///< Decoded copy, memory but not a tile
+    bool m_block_copy { false };  ///< Decoded copy of compressed blocks
+    std::unique_ptr<float[]> m_qscale;   ///< Dequantization scales
+    std::unique_ptr<float[]> m_qoffset;  ///< Dequantization offsets
+    BlockCompression m_blockformat { BlockCompression::None };
     volatile bool m_pixels_ready { false };  // Pixels have been read from disk
     atomic_int m_used { 1 };                 ///< Used recently
+    intrusive_ptr<ImageCacheTile> m_decoded;  ///< Decoded block pixels
+    atomic_int m_decoded_used { 0 };          ///< Decoded used recently
+    spin_mutex m_decoded_mutex;               ///< Guards m_decoded
+
+    // Narrow a full tile of float pixels into m_pixels, for images stored
+    // at reduced precision.
+    void reduce_precision(const float* pels);
 };
 
 
@@ -892,15 +1088,24 @@ public:
     using ThreadFilenameMap = tsl::robin_map<ustring, ImageCacheFile*>;
     ThreadFilenameMap m_thread_files;
 
-    // We have a two-tile "microcache", storing the last two tiles needed.
-    ImageCacheTileRef tile, lasttile;
+    // The tile found by the most recent find_tile().
+    ImageCacheTileRef tile;
+    // The tile "microcache": a small 2-way set-associative cache of the
+    // tiles this thread used most recently, consulted before the shared
+    // tile cache and its locks. Each set is a pair of adjacent entries,
+    // the more recently used one first. The refs keep their tiles alive
+    // (but not necessarily resident in the main cache) until replaced or
+    // purged.
+    std::vector<ImageCacheTileRef> microcache;
+    size_t microcache_setmask = 0;
     atomic_int purge;  // If set, tile ptrs need purging!
     ImageCacheStatistics m_stats;
 
-    ImageCachePerThreadInfo()
+    ImageCachePerThreadInfo(int microcache_size = 2)
     {
         // std::cout << "Creating PerThreadInfo " << (void*)this << "\n";
         purge = 0;
+        reset_microcache(microcache_size);
     }
 
     ~ImageCachePerThreadInfo()
@@ -921,9 +1126,48 @@ public:
         return f == m_thread_files.end() ? nullptr : f->second;
     }
 
+    // Drop all microcache entries and resize it to hold `size` tiles (a
+    // power of 2, at least 2).
+    void reset_microcache(int size)
+    {
+        tile.reset();
+        microcache.clear();
+        microcache.resize(size_t(size));
+        microcache_setmask = size_t(size) / 2 - 1;
+    }
+
+    // Look for the tile in the microcache. If found, make it the most
+    // recently used entry of its set, place it in `result`, and return
+    // true.
+    bool microcache_find(const TileID& id, ImageCacheTileRef& result)
+    {
+        ImageCacheTileRef* set = &microcache[2 * (id.microcache_hash()
+                                                  & microcache_setmask)];
+        if (set[0] && set[0]->id() == id) {
+            result = set[0];
+            return true;
+        }
+        if (set[1] && set[1]->id() == id) {
+            set[0].swap(set[1]);
+            result = set[0];
+            return true;
+        }
+        return false;
+    }
+
+    // Add a tile to the microcache, evicting the least recently used
+    // entry of its set.
+    void microcache_insert(const ImageCacheTileRef& t)
+    {
+        ImageCacheTileRef* set = &microcache[2 * (t->id().microcache_hash()
+                                                  & microcache_setmask)];
+        set[1].swap(set[0]);
+        set[0] = t;
+    }
+
     size_t heapsize() const
     {
-        /// TODO: this should take into account the two last tiles, if their refcount is zero.
+        /// TODO: this should take into account the microcache tiles, if their refcount is zero.
         constexpr size_t sizeofPair = sizeof(ustring) + sizeof(ImageCacheFile*);
         return m_thread_files.size() * sizeofPair;
     }
@@ -1163,23 +1407,21 @@ public:
     {
         ++thread_info->m_stats.find_tile_calls;
         ImageCacheTileRef& tile(thread_info->tile);
-        if (tile) {
-            if (tile->id() == id) {
-                if (mark_same_tile_used)
-                    tile->use();
-                return true;  // already have the tile we want
-            }
-            // Tile didn't match, maybe lasttile will?  Swap tile
-            // and last tile.  Then the new one will either match,
-            // or we'll fall through and replace tile.
-            tile.swap(thread_info->lasttile);
-            if (tile && tile->id() == id) {
+        if (tile && tile->id() == id) {
+            if (mark_same_tile_used)
                 tile->use();
-                return true;
-            }
+            return true;  // already have the tile we want
+        }
+        // Not the last tile, but maybe one of the other recent ones?
+        if (thread_info->microcache_find(id, tile)) {
+            tile->use();
+            return true;
         }
-        return find_tile_main_cache(id, tile, thread_info);
+        bool ok = find_tile_main_cache(id, tile, thread_info);
         // N.B. find_tile_main_cache marks the tile as used
+        if (ok)
+            thread_info->microcache_insert(tile);
+        return ok;
     }
 
     Tile* get_tile(ustring filename, int subimage, int miplevel, int x, int y,
@@ -1214,6 +1456,7 @@ public:
     void invalidate_all(bool force = false);
     void close(ustring filename);
     void close_all();
+    bool prefetch_trace(string_view tracefile);
 
     /// Merge all the per-thread statistics into one set of stats.
     ///
@@ -1246,6 +1489,25 @@ public:
     /// is not created.
     void incr_mem(size_t size) { m_mem_used += size; }
 
+    /// Called when memory counted by incr_mem() is freed.
+    void decr_mem(size_t size)
+    {
+        m_mem_used -= size;
+        OIIO_DASSERT(m_mem_used >= 0);
+    }
+
+    /// Called when the decoded copy of a block-compressed tile is made
+    /// or freed.  These count against max_decoded_memory_MB instead.
+    void incr_decoded_mem(size_t size)
+    {
+        atomic_max(m_decoded_mem_peak, m_decoded_mem_used += size);
+    }
+    void decr_decoded_mem(size_t size)
+    {
+        m_decoded_mem_used -= size;
+        OIIO_DASSERT(m_decoded_mem_used >= 0);
+    }
+
     /// Called when a tile is destroyed, to update all the stats.
     ///
     void decr_tiles(size_t size)
@@ -1278,6 +1540,9 @@ public:
     void check_max_files(ImageCachePerThreadInfo* thread_info);
 
     int max_mip_res() const noexcept { return m_max_mip_res; }
+    int microcache_size() const noexcept { return m_microcache_size; }
+    bool compressed_tiles() const noexcept { return m_compressed_tiles; }
+    ustring float_storage() const noexcept { return m_float_storage; }
 
     ustring colorspace() const noexcept { return m_colorspace; }
 
@@ -1293,9 +1558,52 @@ private:
     bool find_tile_main_cache(const TileID& id, ImageCacheTileRef& tile,
                               ImageCachePerThreadInfo* thread_info);
 
+    /// Replace a reference to a block-compressed tile from the main cache
+    /// with one to its decoded pixels, decoding them if need be.
+    void decode_block_tile(ImageCacheTileRef& tile,
+                           ImageCachePerThreadInfo* thread_info)
+    {
+        bool decoded_now               = false;
+        ImageCacheTileRef decoded_tile = tile->decoded(decoded_now);
+        if (decoded_now) {
+            ++thread_info->m_stats.tile_block_decodes;
+            check_max_decoded_mem(tile);
+        }
+        tile = std::move(decoded_tile);
+    }
+
     /// Enforce the max memory for tile data.
     void check_max_mem(ImageCachePerThreadInfo* thread_info);
 
+    /// Note that the block-compressed `tile` has just been decoded, and
+    /// enforce the max memory for decoded blocks, letting go of the
+    /// decoded pixels of the tiles least recently decoded or used.
+    void check_max_decoded_mem(const ImageCacheTileRef& tile);
+
+    /// Let go of the decoded pixels of every block-compressed tile.
+    void drop_all_decoded();
+
+    /// One tile of an access trace, identified by file name rather than
+    /// by ImageCacheFile so it stays meaningful across caches.
+    struct TraceEntry {
+        ustring filename;
+        int subimage, miplevel;
+        int x, y, z;
+        int chbegin, chend;
+        int colortransformid;
+    };
+
+    /// Append the tile to the access trace, if it's not already there.
+    void record_trace(const TileID& id);
+
+    /// Write the access trace to m_trace_file and forget it.
+    bool write_trace();
+
+    /// Read the given tiles of one file (sorted in file order) into the
+    /// cache, coalescing horizontally adjacent tiles into single reads.
+    void prefetch_file_tiles(ImageCacheFile* file,
+                             std::vector<TraceEntry>& tiles);
+
     /// Internal statistics printing routine
     ///
     void printstats() const;
@@ -1324,6 +1632,7 @@ private:
     static spin_mutex m_perthread_info_mutex;  ///< Thread safety for perthread
     int m_max_open_files;
     atomic_ll m_max_memory_bytes;
+    atomic_ll m_max_decoded_bytes;  ///< Limit for decoded block tiles
     std::string m_searchpath;  ///< Colon-separated image directory list
     std::vector<std::string> m_searchdirs;  ///< Searchpath split into dirs
     std::string m_plugin_searchpath;  ///< Colon-separated plugin directory list
@@ -1338,11 +1647,14 @@ private:
     bool m_latlong_y_up_default;  ///< Is +y the default "up" for latlong?
     bool m_trust_file_extensions = false;  ///< Assume file extensions don't lie?
     bool m_max_open_files_strict = false;  ///< Be strict about open files limit?
+    bool m_compressed_tiles      = false;  ///< Keep BC tiles compressed?
     int m_failure_retries;                 ///< Times to re-try disk failures
     int m_max_mip_res = 1 << 30;  ///< Don't use MIP levels higher than this
+    int m_microcache_size = 8;    ///< Tiles in each per-thread microcache
     Imath::M44f m_Mw2c;           ///< world-to-"common" matrix
     Imath::M44f m_Mc2w;           ///< common-to-world matrix
     ustring m_substitute_image;   ///< Substitute this image for all others
+    ustring m_float_storage;      ///< Store float images as this type
     ustring m_colorspace;         ///< Working color space
     ustring m_colorconfigname;    ///< Filename of color config to use
 
@@ -1359,10 +1671,24 @@ private:
     TileID m_tile_sweep_id;         ///< Sweeper for "clock" paging algorithm
     spin_mutex m_tile_sweep_mutex;  ///< Ensure only one in check_max_mem
 
+    std::atomic<bool> m_trace_recording { false };  ///< Recording a trace?
+    ustring m_trace_file;             ///< Write the access trace here
+    std::mutex m_trace_mutex;         ///< Protect the trace
+    std::vector<TraceEntry> m_trace;  ///< Tiles in the order first read
+    std::unordered_set<TileID, TileID::Hasher> m_trace_seen;
+
     atomic_ll m_mem_used;       ///< Memory being used for tiles
+    atomic_ll m_decoded_mem_used { 0 };  ///< ... for decoded block tiles
+    atomic_ll m_decoded_mem_peak { 0 };  ///< Most ever decoded at once
     int m_statslevel;           ///< Statistics level
     int m_max_errors_per_file;  ///< Max errors to print for each file.
 
+    /// Block-compressed tiles holding decoded pixels, roughly in the order
+    /// they were decoded, for the "clock" sweep of check_max_decoded_mem.
+    /// Declared after the files and counters so it is destroyed first.
+    std::deque<ImageCacheTileRef> m_decoded_tiles;
+    spin_mutex m_decoded_tiles_mutex;  ///< Guards m_decoded_tiles
+
     // For debugging -- keep track of who holds the tile and file mutex
 
 private:
@@ -240,6 +240,10 @@ public:
     void invalidate_all(bool force = false);
     void close(ustring filename);
     void close_all();
+    bool prefetch_trace(string_view tracefile)
+    {
+        return m_imagecache->prefetch_trace(tracefile);
+    }
 
     // void operator delete(void* todel) { ::delete ((char*)todel); }
 
@@ -327,6 +331,16 @@ public:
         float _dsdx, float _dtdx, float _dsdy, float _dtdy, float* result,
         float* dresultds, float* resultdt);
 
+    /// Elliptical weighted average lookup (MipMode::EWA): Gaussian-weight
+    /// every texel inside the filter ellipse rather than placing bilinear
+    /// probes along its major axis.
+    bool texture_lookup_ewa(TextureFile& texfile, PerThreadInfo* thread_info,
+                            TextureOpt& options, int nchannels_result,
+                            int actualchannels, float _s, float _t,
+                            float _dsdx, float _dtdx, float _dsdy,
+                            float _dtdy, float* result, float* dresultds,
+                            float* resultdt);
+
     // For the samplers, it's guaranteed that all float* inputs and outputs
     // are padded to length 'simd' and aligned to a simd*4-byte boundary
     // (for example, 4 for SSE). This means that the functions can behave AS
@@ -356,6 +370,15 @@ public:
                         int actualchannels, const float* weight,
                         simd::vfloat4* accum, simd::vfloat4* daccumds,
                         simd::vfloat4* daccumdt);
+    // EWA filter of one MIP level over the ellipse centered at (s,t) with
+    // the given axis lengths (in st space) and orientation.  Unlike the
+    // samplers above, the result is already normalized.
+    bool sample_ewa(float s, float t, float majorlength, float minorlength,
+                    float theta, int level, TextureFile& texturefile,
+                    PerThreadInfo* thread_info, TextureOpt& options,
+                    int nchannels_result, int actualchannels,
+                    simd::vfloat4* accum, simd::vfloat4* daccumds,
+                    simd::vfloat4* daccumdt, int& ntexels);
 
     // Define a prototype of a member function pointer for texture3d
     // lookups.
@@ -70,10 +70,18 @@ uchar2float4(const unsigned char* c)
 }
 
 
+// Convert uint16 texels of a tile, starting at channel `firstchannel` of
+// the image, to float, also undoing the per-channel normalization of tiles
+// of images that are cached quantized.
 OIIO_FORCEINLINE vfloat4
-ushort2float4(const unsigned short* s)
+ushort2float4(const unsigned short* s, const ImageCacheTile& tile,
+              int firstchannel)
 {
-    return vfloat4(s) * u16scale;
+    if (!tile.quantized())
+        return vfloat4(s) * u16scale;
+    int c = firstchannel - tile.id().chbegin();
+    return madd(vfloat4(s) * u16scale, vfloat4(tile.qscale() + c),
+                vfloat4(tile.qoffset() + c));
 }
 
 
@@ -514,6 +522,13 @@ TextureSystem::close_all()
 }
 
 
+bool
+TextureSystem::prefetch_trace(string_view tracefile)
+{
+    return m_impl->prefetch_trace(tracefile);
+}
+
+
 
 bool
 TextureSystem::has_error() const
@@ -832,6 +847,10 @@ TextureSystemImpl::getstats(int level, bool icstats) const
             OIIO::print(out, "  Average anisotropic probes : 0\n");
         OIIO::print(out, "  Max anisotropy in the wild : {:.3g}\n",
                     stats.max_aniso);
+        if (stats.ewa_queries)
+            OIIO::print(out, "  EWA lookups : {} (average {:.3g} texels)\n",
+                        stats.ewa_queries,
+                        (double)stats.ewa_texels / (double)stats.ewa_queries);
         if (icstats)
             OIIO::print(out, "\n");
     }
@@ -1557,7 +1576,7 @@ TextureSystemImpl::texture(TextureHandle* texture_handle_,
         &TextureSystemImpl::texture_lookup_trilinear_mipmap,
         &TextureSystemImpl::texture_lookup_trilinear_mipmap,
         &TextureSystemImpl::texture_lookup,
-        &TextureSystemImpl::texture_lookup_trilinear_mipmap,
+        &TextureSystemImpl::texture_lookup_ewa,
         &TextureSystemImpl::texture_lookup
     };
     texture_lookup_prototype lookup = lookup_functions[(int)options.mipmode];
@@ -2411,6 +2430,290 @@ TextureSystemImpl::texture_lookup(TextureFile& texturefile,
 
 
 
+// Gaussian falloff of the EWA filter, tabulated on the squared elliptical
+// radius q in [0,1].  The curve is shifted down so that it reaches exactly
+// zero on the ellipse boundary, otherwise texels popping in and out of the
+// footprint would make the result discontinuous as the lookup moves.
+static constexpr int ewa_lut_size = 128;
+static constexpr float ewa_alpha  = 2.0f;
+
+struct EWAWeightTable {
+    float w[ewa_lut_size + 1];
+    EWAWeightTable()
+    {
+        for (int i = 0; i <= ewa_lut_size; ++i)
+            w[i] = expf(-ewa_alpha * float(i) / float(ewa_lut_size))
+                   - expf(-ewa_alpha);
+    }
+};
+
+static const EWAWeightTable ewa_weights;
+
+
+
+bool
+TextureSystemImpl::texture_lookup_ewa(TextureFile& texturefile,
+                                      PerThreadInfo* thread_info,
+                                      TextureOpt& options,
+                                      int nchannels_result, int actualchannels,
+                                      float s, float t, float dsdx, float dtdx,
+                                      float dsdy, float dtdy, float* result,
+                                      float* dresultds, float* dresultdt)
+{
+    OIIO_DASSERT((dresultds == NULL) == (dresultdt == NULL));
+
+    bool stoch_mip = (options.rnd >= 0.0f)
+                     && (m_stochastic & StochasticStrategy_MIP);
+    adjust_width(dsdx, dtdx, dsdy, dtdy, options.swidth, options.twidth);
+
+    // The ellipse, blur, anisotropy limit and MIP level selection are
+    // exactly those of the Aniso path, so that the two modes differ only
+    // in how the footprint is integrated.
+    float majorlength, minorlength, theta;
+    ellipse_axes(dsdx, dtdx, dsdy, dtdy, majorlength, minorlength, theta);
+    adjust_blur(majorlength, minorlength, theta, options.sblur, options.tblur);
+    float aspect, trueaspect;
+    aspect = anisotropic_aspect(majorlength, minorlength, options, trueaspect);
+    int miplevel[2]      = { -1, -1 };
+    float levelweight[2] = { 0, 0 };
+    compute_miplevels(texturefile, options, stoch_mip, majorlength, minorlength,
+                      aspect, miplevel, levelweight);
+
+    bool ok     = true;
+    int ntexels = 0;
+    vfloat4 r_sum, drds_sum, drdt_sum;
+    r_sum.clear();
+    if (dresultds) {
+        drds_sum.clear();
+        drdt_sum.clear();
+    }
+    for (int level = 0; level < 2; ++level) {
+        if (!levelweight[level])  // No contribution from this level, skip it
+            continue;
+        vfloat4 r, drds, drdt;
+        int n = 0;
+        ok &= sample_ewa(s, t, majorlength, minorlength, theta,
+                         miplevel[level], texturefile, thread_info, options,
+                         nchannels_result, actualchannels, &r,
+                         dresultds ? &drds : NULL, dresultds ? &drdt : NULL, n);
+        ntexels += n;
+        vfloat4 lw = levelweight[level];
+        r_sum += lw * r;
+        if (dresultds) {
+            drds_sum += lw * drds;
+            drdt_sum += lw * drdt;
+        }
+    }
+
+    *(simd::vfloat4*)(result) = r_sum;
+    if (dresultds) {
+        *(simd::vfloat4*)(dresultds) = drds_sum;
+        *(simd::vfloat4*)(dresultdt) = drdt_sum;
+    }
+
+    // Update stats
+    ImageCacheStatistics& stats(thread_info->m_stats);
+    ++stats.ewa_queries;
+    stats.ewa_texels += ntexels;
+    if (trueaspect > stats.max_aniso)
+        stats.max_aniso = trueaspect;
+    return ok;
+}
+
+
+
+bool
+TextureSystemImpl::sample_ewa(float s, float t, float majorlength,
+                              float minorlength, float theta, int miplevel,
+                              TextureFile& texturefile,
+                              PerThreadInfo* thread_info, TextureOpt& options,
+                              int nchannels_result, int actualchannels,
+                              vfloat4* accum_, vfloat4* daccumds_,
+                              vfloat4* daccumdt_, int& ntexels)
+{
+    bool allok = true;
+    const SubimageInfo& si(texturefile.subimageinfo(options.subimage));
+    const LevelInfo& lvl(si.levelinfo(miplevel));
+    const ImageDims& dims(si.leveldims(miplevel));
+    TypeDesc::BASETYPE pixeltype = texturefile.pixeltype(options.subimage);
+    wrap_impl swrap_func         = wrap_functions[(int)options.swrap];
+    wrap_impl twrap_func         = wrap_functions[(int)options.twrap];
+    int firstchannel             = options.firstchannel;
+    int tile_chbegin = 0, tile_chend = dims.nchannels;
+    if (dims.nchannels > m_max_tile_channels) {
+        // For files with many channels, narrow the range we cache
+        tile_chbegin = options.firstchannel;
+        tile_chend   = options.firstchannel + actualchannels;
+    }
+    TileID id(texturefile, options.subimage, miplevel, 0, 0, 0, tile_chbegin,
+              tile_chend, options.colortransformid);
+
+    // Center of the ellipse in the raster space of this level, in which
+    // texel centers sit on integer coordinates (cf. st_to_texel_simd).
+    float sscale, tscale, sc, tc;
+    if (texturefile.sample_border() == 0) {
+        sscale = float(dims.width);
+        tscale = float(dims.height);
+        sc     = s * sscale + (dims.x - 0.5f);
+        tc     = t * tscale + (dims.y - 0.5f);
+    } else {
+        sscale = float(dims.width - 1);
+        tscale = float(dims.height - 1);
+        sc     = s * sscale + float(dims.x);
+        tc     = t * tscale + float(dims.y);
+    }
+
+    // Express the ellipse as a 2x2 covariance in raster space and add the
+    // unit circle of the reconstruction filter, so that a magnified lookup
+    // still covers the nearest texels.  There's no point in a footprint
+    // larger than the whole image, so clamp the axes to that.  Inverting
+    // the matrix gives the conic A*x^2 + B*x*y + C*y^2 < 1 of the filter.
+    float a2 = std::min(majorlength, 1.0f), b2 = std::min(minorlength, 1.0f);
+    a2 *= a2;
+    b2 *= b2;
+    float sintheta, costheta;
+    fast_sincos(theta, &sintheta, &costheta);
+    float Sss = (costheta * costheta * a2 + sintheta * sintheta * b2) * sscale
+                    * sscale
+                + 1.0f;
+    float Stt = (sintheta * sintheta * a2 + costheta * costheta * b2) * tscale
+                    * tscale
+                + 1.0f;
+    float Sst    = costheta * sintheta * (a2 - b2) * sscale * tscale;
+    float invdet = 1.0f / (Sss * Stt - Sst * Sst);
+    float A = Stt * invdet, B = -2.0f * Sst * invdet, C = Sss * invdet;
+
+    const vfloat8 iota     = vfloat8::Iota();
+    const vfloat8 lutscale = vfloat8(float(ewa_lut_size));
+    const vfloat8 wshift   = vfloat8(expf(-ewa_alpha));
+    bool derivs = (daccumds_ != nullptr);
+    vfloat4 accum, daccumds, daccumdt;
+    accum.clear();
+    daccumds.clear();
+    daccumdt.clear();
+    float wsum = 0.0f, dwsumds = 0.0f, dwsumdt = 0.0f, nonfill = 0.0f;
+    int tile_x = 0, tile_y = 0;
+    const ImageCacheTile* tile = nullptr;  // last tile we looked up
+    ntexels                    = 0;
+
+    // Visit the texels of each row that fall inside the ellipse, solving
+    // the conic for the row's extent, four texels at a time.
+    float trad = sqrtf(Stt);
+    int jbegin = int(ceilf(tc - trad)), jend = int(floorf(tc + trad));
+    for (int j = jbegin; j <= jend; ++j) {
+        float dy   = float(j) - tc;
+        float disc = B * B * dy * dy - 4.0f * A * (C * dy * dy - 1.0f);
+        if (disc <= 0.0f)
+            continue;
+        float xmid = -B * dy / (2.0f * A), xrad = sqrtf(disc) / (2.0f * A);
+        int ibegin = int(ceilf(sc + xmid - xrad));
+        int iend   = int(floorf(sc + xmid + xrad));
+
+        int jj      = j;
+        bool tvalid = twrap_func(jj, dims.y, dims.height);
+        if (!lvl.full_pixel_range)
+            tvalid &= (jj >= dims.y && jj < (dims.y + dims.height));
+
+        for (int i = ibegin; i <= iend; i += 8) {
+            // The weights of eight texels at a time. Those outside the
+            // ellipse (or past the end of the row) get the last entry of
+            // the table, which is zero.
+            vfloat8 dx = vfloat8(float(i) - sc) + iota;
+            vfloat8 q  = (A * dx + B * dy) * dx + C * dy * dy;
+            vint8 idx  = min(max(vint8(q * lutscale), vint8::Zero()),
+                             vint8(ewa_lut_size));
+            idx        = select(vint8(i) + vint8::Iota() <= vint8(iend), idx,
+                                vint8(ewa_lut_size));
+            vbool8 inside = idx < vint8(ewa_lut_size);
+            vfloat8 w;
+            w.gather(ewa_weights.w, idx);
+            wsum += reduce_add(w);
+            // d(weight)/d(center), for the derivatives of the result
+            vfloat8 dwds, dwdt;
+            if (derivs) {
+                vfloat8 dw = ewa_alpha * (w + wshift);
+                dwds = blend0(dw * (2.0f * A * dx + B * dy) * sscale, inside);
+                dwdt = blend0(dw * (B * dx + 2.0f * C * dy) * tscale, inside);
+                dwsumds += reduce_add(dwds);
+                dwsumdt += reduce_add(dwdt);
+            }
+            // Then fetch and accumulate the texels themselves.
+            for (int k = 0, mask = inside.bitmask(); mask; ++k, mask >>= 1) {
+                if (!(mask & 1))
+                    continue;  // outside the ellipse
+                ++ntexels;
+                int ii      = i + k;
+                bool svalid = swrap_func(ii, dims.x, dims.width);
+                if (!lvl.full_pixel_range)
+                    svalid &= (ii >= dims.x && ii < (dims.x + dims.width));
+                if (!(svalid & tvalid)) {
+                    // Out of range and using 'black' wrap
+                    nonfill += w[k];
+                    continue;
+                }
+
+                int tile_s = (ii - dims.x) % dims.tile_width;
+                int tile_t = (jj - dims.y) % dims.tile_height;
+                if (!tile || ii - tile_s != tile_x || jj - tile_t != tile_y) {
+                    tile_x = ii - tile_s;
+                    tile_y = jj - tile_t;
+                    id.xy(tile_x, tile_y);
+                    bool ok = find_tile(id, thread_info, ntexels == 1);
+                    if (!ok)
+                        error("{}", m_imagecache->geterror());
+                    tile = thread_info->tile.get();
+                    if (!tile || !ok) {
+                        tile  = nullptr;
+                        allok = false;
+                        continue;
+                    }
+                }
+                size_t offset = id.nchannels() * tile->pixel_index(tile_s, tile_t)
+                                + (firstchannel - id.chbegin());
+                simd::vfloat4 texel_simd;
+                if (pixeltype == TypeDesc::UINT8) {
+                    // special case for 8-bit tiles
+                    texel_simd = uchar2float4(tile->bytedata() + offset);
+                } else if (pixeltype == TypeDesc::UINT16) {
+                    texel_simd = ushort2float4(tile->ushortdata() + offset,
+                                               *tile, firstchannel);
+                } else if (pixeltype == TypeDesc::HALF) {
+                    texel_simd = vfloat4(tile->halfdata() + offset);
+                } else {
+                    OIIO_DASSERT(pixeltype == TypeDesc::FLOAT);
+                    texel_simd.load(tile->floatdata() + offset);
+                }
+                accum += w[k] * texel_simd;
+                if (derivs) {
+                    daccumds += dwds[k] * texel_simd;
+                    daccumdt += dwdt[k] * texel_simd;
+                }
+            }
+        }
+    }
+
+    // The unit circle we added guarantees the texel nearest the center
+    // is inside the ellipse, so wsum can only be zero for degenerate
+    // (NaN) input.
+    float invw = wsum > 0.0f ? 1.0f / wsum : 0.0f;
+    simd::vbool4 channel_mask = channel_masks[actualchannels];
+    vfloat4 r                 = blend0(accum * invw, channel_mask);
+    nonfill *= invw;
+    if (nonfill < 1.0f && nchannels_result > actualchannels && options.fill) {
+        // Add the weighted fill color
+        r += blend0not(vfloat4((1.0f - nonfill) * options.fill), channel_mask);
+    }
+    *accum_ = r;
+    if (derivs) {
+        // Quotient rule on r = sum(w*c) / sum(w)
+        *daccumds_ = blend0((daccumds - r * dwsumds) * invw, channel_mask);
+        *daccumdt_ = blend0((daccumdt - r * dwsumdt) * invw, channel_mask);
+    }
+    return allok;
+}
+
+
+
 const float*
 TextureSystemImpl::pole_color(TextureFile& texturefile,
                               PerThreadInfo* /*thread_info*/, TileRef& tile,
@@ -2446,8 +2749,9 @@ TextureSystemImpl::pole_color(TextureFile& texturefile,
                         if (pixeltype == TypeDesc::UINT8)
                             p[c] += uchar2float(texel[c]);
                         else if (pixeltype == TypeDesc::UINT16)
-                            p[c] += convert_type<uint16_t, float>(
-                                ((const uint16_t*)texel)[c]);
+                            p[c] += tile->dequantize(
+                                c, convert_type<uint16_t, float>(
+                                       ((const uint16_t*)texel)[c]));
                         else if (pixeltype == TypeDesc::HALF)
                             p[c] += ((const half*)texel)[c];
                         else {
@@ -2571,7 +2875,8 @@ TextureSystemImpl::sample_closest(
             // special case for 8-bit tiles
             texel_simd = uchar2float4(tile->bytedata() + offset);
         } else if (pixeltype == TypeDesc::UINT16) {
-            texel_simd = ushort2float4(tile->ushortdata() + offset);
+            texel_simd = ushort2float4(tile->ushortdata() + offset, *tile,
+                                       firstchannel);
         } else if (pixeltype == TypeDesc::HALF) {
             texel_simd = vfloat4(tile->halfdata() + offset);
         } else {
@@ -2764,11 +3069,15 @@ TextureSystemImpl::sample_bilinear(
                 texel_simd[1][0] = uchar2float4(p);
                 texel_simd[1][1] = uchar2float4(p + pixelsize);
             } else if (pixeltype == TypeDesc::UINT16) {
-                texel_simd[0][0] = ushort2float4((uint16_t*)p);
-                texel_simd[0][1] = ushort2float4((uint16_t*)(p + pixelsize));
+                texel_simd[0][0] = ushort2float4((uint16_t*)p, *tile,
+                                                 firstchannel);
+                texel_simd[0][1] = ushort2float4((uint16_t*)(p + pixelsize),
+                                                 *tile, firstchannel);
                 p += pixelsize * dims.tile_width;
-                texel_simd[1][0] = ushort2float4((uint16_t*)p);
-                texel_simd[1][1] = ushort2float4((uint16_t*)(p + pixelsize));
+                texel_simd[1][0] = ushort2float4((uint16_t*)p, *tile,
+                                                 firstchannel);
+                texel_simd[1][1] = ushort2float4((uint16_t*)(p + pixelsize),
+                                                 *tile, firstchannel);
             } else if (pixeltype == TypeDesc::HALF) {
                 texel_simd[0][0] = vfloat4((half*)p);
                 texel_simd[0][1] = vfloat4((half*)(p + pixelsize));
@@ -2823,7 +3132,8 @@ TextureSystemImpl::sample_bilinear(
                             (const unsigned char*)(tile->bytedata() + offset));
                     else if (pixeltype == TypeDesc::UINT16)
                         texel_simd[j][i] = ushort2float4(
-                            (const unsigned short*)(tile->bytedata() + offset));
+                            (const unsigned short*)(tile->bytedata() + offset),
+                            *tile, firstchannel);
                     else if (pixeltype == TypeDesc::HALF)
                         texel_simd[j][i] = vfloat4(
                             (const half*)(tile->bytedata() + offset));
@@ -3135,7 +3445,8 @@ TextureSystemImpl::sample_bicubic(
                     for (int i = 0, i_offset = j_offset; i < 4;
                          ++i, i_offset += pixelsize)
                         texel_simd[j][i] = ushort2float4(
-                            (const uint16_t*)(base + i_offset));
+                            (const uint16_t*)(base + i_offset), *tile,
+                            firstchannel);
             } else if (pixeltype == TypeDesc::HALF) {
                 for (int j = 0, j_offset = 0; j < 4;
                      ++j, j_offset += pixelsize * dims.tile_width)
@@ -3197,7 +3508,8 @@ TextureSystemImpl::sample_bicubic(
                                                         + offset);
                     else if (pixeltype == TypeDesc::UINT16)
                         texel_simd[j][i] = ushort2float4(
-                            (const uint16_t*)(tile->bytedata() + offset));
+                            (const uint16_t*)(tile->bytedata() + offset),
+                            *tile, firstchannel);
                     else if (pixeltype == TypeDesc::HALF)
                         texel_simd[j][i] = vfloat4(
                             (const half*)(tile->bytedata() + offset));
@@ -3,8 +3,11 @@
 // https://github.com/AcademySoftwareFoundation/OpenImageIO
 
 #include <algorithm>
+#include <cctype>
 #include <cstdio>
 #include <cstdlib>
+#include <cstring>
+#include <unordered_map>
 
 #include <OpenImageIO/dassert.h>
 #include <OpenImageIO/half.h>
@@ -360,23 +363,86 @@ ParamValue::clear_value() noexcept
 
 
 
-ParamValueList::const_iterator
-ParamValueList::find(ustring name, TypeDesc type, bool casesensitive) const
+// Case-sensitive comparisons of an attribute name against a search name.
+static inline bool
+name_equals(ustring name, ustring search)
+{
+    return name == search;
+}
+
+static inline bool
+name_equals(ustring name, string_view search)
+{
+    return name.length() == search.size()
+           && (name.data() == search.data()
+               || !memcmp(name.data(), search.data(), search.size()));
+}
+
+
+
+// Case-insensitive comparison of single characters.
+static inline bool
+char_iequals(char a, char b)
+{
+    return a == b || ((a ^ b) == 0x20 && isalpha((unsigned char)a));
+}
+
+
+
+// Case-insensitive comparison of an attribute name against a search name.
+// Most lookups are for the exact name that is in the list, or compare
+// against names of different lengths or first or last letters (names often
+// differ only in a numbered suffix), so check those cheap cases before
+// resorting to a full case-folding compare.
+static inline bool
+name_iequals(ustring name, string_view search)
 {
+    if (name.data() == search.data())
+        return true;
+    size_t len = name.length();
+    if (len != search.size())
+        return false;
+    if (len == 0)
+        return true;
+    const char* n = name.data();
+    if (!char_iequals(n[0], search[0])
+        || !char_iequals(n[len - 1], search[len - 1]))
+        return false;
+    return Strutil::iequals(name, search);
+}
+
+
+
+// Shared implementation of all the ParamValueList::find varieties.
+template<typename Iterator, typename Name>
+static inline Iterator
+find_param(Iterator begin, Iterator end, Name name, TypeDesc type,
+           bool casesensitive)
+{
+    auto typematch = [=](const ParamValue& p) {
+        return type == TypeDesc::UNKNOWN || type == p.type();
+    };
+    // A string_view name is compared as it is, rather than interning it as
+    // a ustring. Either way, one pass finds the first match: name_iequals
+    // tries the cheap exact comparison before folding case.
     if (casesensitive) {
-        for (const_iterator i = cbegin(), e = cend(); i != e; ++i) {
-            if (i->name() == name
-                && (type == TypeDesc::UNKNOWN || type == i->type()))
+        for (Iterator i = begin; i != end; ++i)
+            if (name_equals(i->name(), name) && typematch(*i))
                 return i;
-        }
     } else {
-        for (const_iterator i = cbegin(), e = cend(); i != e; ++i) {
-            if (Strutil::iequals(i->name(), name)
-                && (type == TypeDesc::UNKNOWN || type == i->type()))
+        for (Iterator i = begin; i != end; ++i)
+            if (name_iequals(i->name(), name) && typematch(*i))
                 return i;
-        }
     }
-    return cend();
+    return end;
+}
+
+
+
+ParamValueList::const_iterator
+ParamValueList::find(ustring name, TypeDesc type, bool casesensitive) const
+{
+    return find_param(cbegin(), cend(), name, type, casesensitive);
 }
 
 
@@ -384,16 +450,7 @@ ParamValueList::find(ustring name, TypeDesc type, bool casesensitive) const
 ParamValueList::const_iterator
 ParamValueList::find(string_view name, TypeDesc type, bool casesensitive) const
 {
-    if (casesensitive) {
-        return find(ustring(name), type, casesensitive);
-    } else {
-        for (const_iterator i = cbegin(), e = cend(); i != e; ++i) {
-            if (Strutil::iequals(i->name(), name)
-                && (type == TypeDesc::UNKNOWN || type == i->type()))
-                return i;
-        }
-    }
-    return cend();
+    return find_param(cbegin(), cend(), name, type, casesensitive);
 }
 
 
@@ -401,20 +458,7 @@ ParamValueList::find(string_view name, TypeDesc type, bool casesensitive) const
 ParamValueList::iterator
 ParamValueList::find(ustring name, TypeDesc type, bool casesensitive)
 {
-    if (casesensitive) {
-        for (iterator i = begin(), e = end(); i != e; ++i) {
-            if (i->name() == name
-                && (type == TypeDesc::UNKNOWN || type == i->type()))
-                return i;
-        }
-    } else {
-        for (iterator i = begin(), e = end(); i != e; ++i) {
-            if (Strutil::iequals(i->name(), name)
-                && (type == TypeDesc::UNKNOWN || type == i->type()))
-                return i;
-        }
-    }
-    return end();
+    return find_param(begin(), end(), name, type, casesensitive);
 }
 
 
@@ -422,16 +466,7 @@ ParamValueList::find(ustring name, TypeDesc type, bool casesensitive)
 ParamValueList::iterator
 ParamValueList::find(string_view name, TypeDesc type, bool casesensitive)
 {
-    if (casesensitive) {
-        return find(ustring(name), type, casesensitive);
-    } else {
-        for (iterator i = begin(), e = end(); i != e; ++i) {
-            if (Strutil::iequals(i->name(), name)
-                && (type == TypeDesc::UNKNOWN || type == i->type()))
-                return i;
-        }
-    }
-    return end();
+    return find_param(begin(), end(), name, type, casesensitive);
 }
 
 
@@ -661,9 +696,20 @@ ParamValueList::sort(bool casesensitive)
 void
 ParamValueList::merge(const ParamValueList& other, bool override)
 {
+    // Merging two long lists one attribute at a time would be quadratic,
+    // so build a temporary hash index of our own names to search instead.
+    std::unordered_map<ustring, size_t> index;
+    index.reserve(size() + other.size());
+    for (size_t i = 0, e = size(); i < e; ++i)
+        index.emplace((*this)[int(i)].name(), i);
     for (const auto& attr : other) {
-        if (override || !contains(attr.name()))
-            add_or_replace(attr);
+        auto found = index.find(attr.name());
+        if (found == index.end()) {
+            index.emplace(attr.name(), size());
+            emplace_back(attr);
+        } else if (override) {
+            (*this)[int(found->second)] = attr;
+        }
     }
 }
 
@@ -6,6 +6,7 @@
 #include <limits>
 
 #include <OpenImageIO/Imath.h>
+#include <OpenImageIO/benchmark.h>
 #include <OpenImageIO/paramlist.h>
 #include <OpenImageIO/span.h>
 #include <OpenImageIO/typedesc.h>
@@ -530,6 +531,78 @@ test_implied_construction()
 
 
 
+// Camera raw and PSD files can carry hundreds of metadata attributes, so
+// make sure lookups and merges in lists that large are correct, and time
+// them.
+static void
+test_large_lists()
+{
+    std::cout << "test_large_lists\n";
+    const int nattribs = 500;
+    ParamValueList pl, other;
+    for (int i = 0; i < nattribs; ++i) {
+        pl.attribute(Strutil::fmt::format("Exif:Tag{}", i), i);
+        other.attribute(Strutil::fmt::format("Exif:Tag{}", i + nattribs / 2),
+                        -i);
+    }
+    OIIO_CHECK_EQUAL(pl.get_int("Exif:Tag123"), 123);
+    OIIO_CHECK_EQUAL(pl.get_int("exif:tag123"), 123);
+    OIIO_CHECK_ASSERT(pl.find("exif:tag123") == pl.cend());
+    OIIO_CHECK_ASSERT(!pl.contains("Exif:Tag12345"));
+
+    // A case-insensitive search finds the first match, even if a later
+    // entry matches exactly; a case-sensitive one finds the exact match.
+    ParamValueList cases;
+    cases.attribute("Foo", 1);
+    cases.attribute("foo", 2);
+    cases.attribute("FOO", 3);
+    OIIO_CHECK_EQUAL(cases.get_int("foo"), 1);
+    OIIO_CHECK_EQUAL(cases.get_int("FOO"), 1);
+    OIIO_CHECK_EQUAL(cases.get_int("fOO"), 1);
+    OIIO_CHECK_EQUAL(cases.get_int("fOO", 0, true), 0);
+    OIIO_CHECK_EQUAL(cases.get_int("FOO", 0, true), 3);
+    OIIO_CHECK_EQUAL(cases.find(ustring("foo"), TypeUnknown, false)->get_int(),
+                     1);
+    OIIO_CHECK_EQUAL(cases.find(ustring("foo"))->get_int(), 2);
+
+    // Looking up a name that isn't a ustring doesn't make it one.
+    size_t nustrings = ustring::total_ustrings();
+    OIIO_CHECK_ASSERT(!pl.contains("Exif:NeverInterned"));
+    OIIO_CHECK_ASSERT(pl.find("exif:neverinterned", TypeUnknown, false)
+                      == pl.cend());
+    OIIO_CHECK_EQUAL(ustring::total_ustrings(), nustrings);
+
+    ParamValueList merged = pl;
+    merged.merge(other);
+    OIIO_CHECK_EQUAL(merged.size(), size_t(nattribs + nattribs / 2));
+    OIIO_CHECK_EQUAL(merged.get_int("Exif:Tag300"), 300);
+    merged.merge(other, true);
+    OIIO_CHECK_EQUAL(merged.get_int("Exif:Tag300"), -50);
+    OIIO_CHECK_EQUAL(merged.get_int("Exif:Tag700"), -450);
+
+    Benchmarker bench;
+    bench.indent(2);
+    bench.units(Benchmarker::Unit::us);
+    ustring last("Exif:Tag499");
+    bench("find last of 500, case-sensitive", [&]() {
+        DoNotOptimize(pl.find(last));
+    });
+    bench("find last of 500, case-insensitive", [&]() {
+        DoNotOptimize(pl.find(last, TypeUnknown, false));
+    });
+    bench("find missing of 500, case-insensitive", [&]() {
+        DoNotOptimize(pl.find("Exif:Missing", TypeUnknown, false));
+    });
+    bench("get_int of 500", [&]() { DoNotOptimize(pl.get_int("Exif:Tag250")); });
+    bench("merge 500 into 500", [&]() {
+        ParamValueList m = pl;
+        m.merge(other);
+        DoNotOptimize(m.size());
+    });
+}
+
+
+
 int
 main(int /*argc*/, char* /*argv*/[])
 {
@@ -542,6 +615,7 @@ main(int /*argc*/, char* /*argv*/[])
     test_delegates();
     test_implied_construction();
     test_paramlistspan();
+    test_large_lists();
 
     return unit_test_failures;
 }
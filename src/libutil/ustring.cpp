@@ -2,6 +2,7 @@
 // SPDX-License-Identifier: Apache-2.0
 // https://github.com/AcademySoftwareFoundation/OpenImageIO
 
+#include <atomic>
 #include <string>
 #include <unordered_map>
 
@@ -32,16 +33,24 @@ template<class T> struct identity {
 // #define USTRING_TRACK_NUM_LOOKUPS
 
 
+// Open-addressed hash table of TableRep pointers. Lookups (by far the
+// common case -- most ustrings constructed already exist) take no lock at
+// all: the slot array is published with release semantics and each slot is
+// written at most once, from null to its final rep, so a reader can probe
+// concurrently with an insert. Inserts and growth are serialized by the
+// mutex. When the table grows, the old slot array is retired but never
+// freed, because readers may still be probing it; a reader that misses in
+// a stale array falls through to insert(), which repeats the search under
+// the write lock. Like the string pool, this memory is never returned, and
+// the retired arrays total less than the live one.
 template<unsigned BASE_CAPACITY, unsigned POOL_SIZE> struct TableRepMap {
     static_assert((BASE_CAPACITY & (BASE_CAPACITY - 1)) == 0,
                   "BASE_CAPACITY must be a power of 2");
 
     TableRepMap()
-        : entries(static_cast<ustring::TableRep**>(
-            calloc(BASE_CAPACITY, sizeof(ustring::TableRep*))))
+        : table(new_table(BASE_CAPACITY - 1))
         , pool(static_cast<char*>(malloc(POOL_SIZE)))
-        , memory_usage(sizeof(*this) + POOL_SIZE
-                       + sizeof(ustring::TableRep*) * BASE_CAPACITY)
+        , memory_usage(sizeof(*this) + POOL_SIZE + table_bytes(BASE_CAPACITY))
     {
     }
 
@@ -62,34 +71,30 @@ template<unsigned BASE_CAPACITY, unsigned POOL_SIZE> struct TableRepMap {
     }
 
 #ifdef USTRING_TRACK_NUM_LOOKUPS
-    size_t get_num_lookups()
-    {
-        ustring_read_lock_t lock(mutex);
-        return num_lookups;
-    }
+    size_t get_num_lookups() { return num_lookups.load(); }
 #endif
 
     const char* lookup(string_view str, uint64_t hash)
     {
-        ustring_read_lock_t lock(mutex);
 #ifdef USTRING_TRACK_NUM_LOOKUPS
         // NOTE: this simple increment adds a substantial amount of overhead
         // so keep it off by default, unless the user really wants it
         // NOTE2: note that in debug, asserts like the one in ustring::from_unique
         // can skew the number of lookups compared to release builds
-        ++num_lookups;
+        num_lookups.fetch_add(1, std::memory_order_relaxed);
 #endif
-        size_t pos = hash & mask, dist = 0;
+        const Table* t = table.load(std::memory_order_acquire);
+        size_t pos = hash & t->mask, dist = 0;
         for (;;) {
-            if (entries[pos] == 0)
-                return 0;
-            if (entries[pos]->hashed == hash
-                && entries[pos]->length == str.length()
-                && strncmp(entries[pos]->c_str(), str.data(), str.length())
-                       == 0)
-                return entries[pos]->c_str();
+            const ustring::TableRep* e = t->entries[pos].load(
+                std::memory_order_acquire);
+            if (e == nullptr)
+                return nullptr;
+            if (e->hashed == hash && e->length == str.length()
+                && strncmp(e->c_str(), str.data(), str.length()) == 0)
+                return e->c_str();
             ++dist;
-            pos = (pos + dist) & mask;  // quadratic probing
+            pos = (pos + dist) & t->mask;  // quadratic probing
         }
     }
 
@@ -98,79 +103,103 @@ template<unsigned BASE_CAPACITY, unsigned POOL_SIZE> struct TableRepMap {
     // the hash.
     const char* lookup(uint64_t hash)
     {
-        ustring_read_lock_t lock(mutex);
 #ifdef USTRING_TRACK_NUM_LOOKUPS
-        // NOTE: this simple increment adds a substantial amount of overhead
-        // so keep it off by default, unless the user really wants it
-        // NOTE2: note that in debug, asserts like the one in ustring::from_unique
-        // can skew the number of lookups compared to release builds
-        ++num_lookups;
+        num_lookups.fetch_add(1, std::memory_order_relaxed);
 #endif
-        size_t pos = hash & mask, dist = 0;
+        const Table* t = table.load(std::memory_order_acquire);
+        size_t pos = hash & t->mask, dist = 0;
         for (;;) {
-            if (entries[pos] == 0)
-                return 0;
-            if (entries[pos]->hashed == hash)
-                return entries[pos]->c_str();
+            const ustring::TableRep* e = t->entries[pos].load(
+                std::memory_order_acquire);
+            if (e == nullptr)
+                return nullptr;
+            if (e->hashed == hash)
+                return e->c_str();
             ++dist;
-            pos = (pos + dist) & mask;  // quadratic probing
+            pos = (pos + dist) & t->mask;  // quadratic probing
         }
     }
 
     const char* insert(string_view str, uint64_t hash)
     {
         ustring_write_lock_t lock(mutex);
-        size_t pos = hash & mask, dist = 0;
+        // Only writers modify the table, and we hold the write lock, so
+        // relaxed loads suffice here.
+        Table* t   = table.load(std::memory_order_relaxed);
+        size_t pos = hash & t->mask, dist = 0;
         for (;;) {
-            if (entries[pos] == 0)
+            ustring::TableRep* e = t->entries[pos].load(
+                std::memory_order_relaxed);
+            if (e == nullptr)
                 break;  // found insert pos
-            if (entries[pos]->hashed == hash
-                && entries[pos]->length == str.length()
-                && !strncmp(entries[pos]->c_str(), str.data(), str.length())) {
+            if (e->hashed == hash && e->length == str.length()
+                && !strncmp(e->c_str(), str.data(), str.length())) {
                 // same string is already inserted, return the one that is
                 // already in the table
-                return entries[pos]->c_str();
+                return e->c_str();
             }
             ++dist;
-            pos = (pos + dist) & mask;  // quadratic probing
+            pos = (pos + dist) & t->mask;  // quadratic probing
         }
 
         ustring::TableRep* rep = make_rep(str, hash);
-        entries[pos]           = rep;
+        // Release so that lock-free readers who see the pointer also see
+        // the fully constructed rep.
+        t->entries[pos].store(rep, std::memory_order_release);
         ++num_entries;
-        if (2 * num_entries > mask)
+        if (2 * num_entries > t->mask)
             grow();           // maintain 0.5 load factor
         return rep->c_str();  // rep is now in the table
     }
 
 private:
-    void grow()
+    // A slot array and its mask, allocated as a single block.
+    struct Table {
+        size_t mask;
+        std::atomic<ustring::TableRep*>* entries;
+    };
+
+    static size_t table_bytes(size_t capacity)
     {
-        size_t new_mask = mask * 2 + 1;
+        return sizeof(Table) + capacity * sizeof(std::atomic<ustring::TableRep*>);
+    }
 
-        // NOTE: only increment by half because we are doubling the entries and freeing the old
-        memory_usage += (mask + 1) * sizeof(ustring::TableRep*);
+    static Table* new_table(size_t mask)
+    {
+        char* mem = static_cast<char*>(malloc(table_bytes(mask + 1)));
+        Table* t  = new (mem) Table;
+        t->mask   = mask;
+        t->entries = reinterpret_cast<std::atomic<ustring::TableRep*>*>(
+            mem + sizeof(Table));
+        for (size_t i = 0; i <= mask; ++i)
+            new (&t->entries[i]) std::atomic<ustring::TableRep*>(nullptr);
+        return t;
+    }
 
-        ustring::TableRep** new_entries = static_cast<ustring::TableRep**>(
-            calloc(new_mask + 1, sizeof(ustring::TableRep*)));
+    void grow()
+    {
+        Table* old     = table.load(std::memory_order_relaxed);
+        Table* t       = new_table(old->mask * 2 + 1);
         size_t to_copy = num_entries;
         for (size_t i = 0; to_copy != 0; i++) {
-            if (entries[i] == 0)
+            ustring::TableRep* e = old->entries[i].load(
+                std::memory_order_relaxed);
+            if (e == nullptr)
                 continue;
-            size_t pos = entries[i]->hashed & new_mask, dist = 0;
+            size_t pos = e->hashed & t->mask, dist = 0;
             for (;;) {
-                if (new_entries[pos] == 0)
+                if (t->entries[pos].load(std::memory_order_relaxed) == nullptr)
                     break;
                 ++dist;
-                pos = (pos + dist) & new_mask;  // quadratic probing
+                pos = (pos + dist) & t->mask;  // quadratic probing
             }
-            new_entries[pos] = entries[i];
+            t->entries[pos].store(e, std::memory_order_relaxed);
             to_copy--;
         }
-
-        free(entries);
-        entries = new_entries;
-        mask    = new_mask;
+        // Publish the fully populated table. The old one is retired but
+        // not freed, since concurrent readers may still be probing it.
+        table.store(t, std::memory_order_release);
+        memory_usage += table_bytes(t->mask + 1);
     }
 
     ustring::TableRep* make_rep(string_view str, uint64_t hash)
@@ -201,14 +230,13 @@ private:
     }
 
     OIIO_CACHE_ALIGN mutable ustring_mutex_t mutex;
-    size_t mask = BASE_CAPACITY - 1;
-    ustring::TableRep** entries;
+    std::atomic<Table*> table;
     size_t num_entries = 0;
     char* pool;
     size_t pool_offset = 0;
     size_t memory_usage;
 #ifdef USTRING_TRACK_NUM_LOOKUPS
-    size_t num_lookups = 0;
+    std::atomic<size_t> num_lookups { 0 };
 #endif
 };
 
@@ -300,6 +300,52 @@ benchmark_threaded_ustring_creation()
 
 
 
+static std::vector<std::string> hot_strings;
+
+static void
+lookup_hot_ustrings(int iterations)
+{
+    // Every thread hammers the same small set of already-interned strings,
+    // which is the common case in renderers and texture systems and used
+    // to serialize on the table's bin locks.
+    size_t h = 0, n = hot_strings.size();
+    for (int i = 0; i < iterations; ++i) {
+        ustring s(hot_strings[i % n]);
+        h += s.hash();
+    }
+    if (verbose)
+        Strutil::printf("checksum %08x\n", unsigned(h));
+}
+
+
+
+void
+benchmark_contended_ustring_lookup()
+{
+    Strutil::print("\nContended lookups of existing ustrings:\n");
+    hot_strings.clear();
+    for (int i = 0; i < 64; ++i)
+        hot_strings.push_back(Strutil::fmt::format("hot_ustring_{}", i));
+    for (auto& s : hot_strings)
+        (void)ustring(s);  // intern them up front
+    size_t entries_before = ustring::total_ustrings();
+
+    if (wedge) {
+        timed_thread_wedge(lookup_hot_ustrings, numthreads, iterations,
+                           ntrials);
+    } else {
+        timed_thread_wedge(lookup_hot_ustrings, numthreads, iterations,
+                           ntrials,
+                           numthreads /* just this one thread count */);
+    }
+    // Pure lookups must not have added anything to the table
+    OIIO_CHECK_EQUAL(ustring::total_ustrings(), entries_before);
+    for (auto& s : hot_strings)
+        OIIO_CHECK_EQUAL(ustring(s).string(), s);
+}
+
+
+
 void
 verify_no_collisions()
 {
@@ -328,6 +374,7 @@ main(int argc, char* argv[])
     test_ustringhash();
     verify_no_collisions();
     benchmark_threaded_ustring_creation();
+    benchmark_contended_ustring_lookup();
     verify_no_collisions();
 
     std::cout << "\n" << ustring::getstats(true) << "\n";
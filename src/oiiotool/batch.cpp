@@ -0,0 +1,466 @@
+// Copyright Contributors to the OpenImageIO project.
+// SPDX-License-Identifier: Apache-2.0
+// https://github.com/AcademySoftwareFoundation/OpenImageIO
+
+
+// oiiotool --batch: run many command lines in one process, so that they
+// all share the same warm ImageCache, ColorConfig, and loaded plugins,
+// rather than paying to set all of those up again for every launch.
+//
+// Jobs are read one per line from a file, from stdin ("-"), or from
+// clients connecting to a Unix-domain socket ("unix:PATH"). Up to
+// --batch-jobs of them run at once, on their own threads; their image
+// operations all draw on the one shared thread pool (sized by --threads).
+//
+// Because the cache, the thread pool, and the global OIIO attributes are
+// shared by every job, a job may not use the options that change them;
+// those belong on the command line that starts the batch.
+
+#include <atomic>
+#include <cerrno>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <iostream>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "oiiotool.h"
+
+#include <OpenImageIO/filesystem.h>
+#include <OpenImageIO/strutil.h>
+#include <OpenImageIO/sysutil.h>
+#include <OpenImageIO/thread.h>
+#include <OpenImageIO/timer.h>
+
+#if !defined(_WIN32)
+#    include <poll.h>
+#    include <sys/socket.h>
+#    include <sys/time.h>
+#    include <sys/stat.h>
+#    include <sys/un.h>
+#    include <unistd.h>
+#endif
+
+using namespace OIIO;
+using namespace OiioTool;
+
+
+
+namespace {
+
+// A connected socket client, which gets one reply line per job it sent.
+// The connection is closed when the last of its jobs is done with it.
+class BatchClient {
+public:
+    explicit BatchClient(int fd)
+        : m_fd(fd)
+    {
+    }
+    ~BatchClient()
+    {
+#if !defined(_WIN32)
+        ::close(m_fd);
+#endif
+    }
+    void reply(string_view msg)
+    {
+#if !defined(_WIN32)
+        std::lock_guard lock(m_mutex);
+        while (msg.size()) {
+            ssize_t n = ::write(m_fd, msg.data(), msg.size());
+            if (n <= 0)
+                break;  // Client went away; nothing more we can do
+            msg.remove_prefix(size_t(n));
+        }
+#endif
+    }
+
+private:
+    int m_fd;
+    std::mutex m_mutex;
+};
+
+
+
+struct BatchJob {
+    size_t number = 0;
+    std::string command;
+    std::shared_ptr<BatchClient> client;  // Reply here, if from a socket
+};
+
+
+
+class BatchQueue {
+public:
+    void push(BatchJob&& job)
+    {
+        {
+            std::lock_guard lock(m_mutex);
+            m_jobs.push_back(std::move(job));
+        }
+        m_cv.notify_one();
+    }
+
+    // Wait for the next job. Return false if there are no more jobs and
+    // there never will be.
+    bool pop(BatchJob& job)
+    {
+        std::unique_lock lock(m_mutex);
+        m_cv.wait(lock, [&]() { return m_jobs.size() || m_closed; });
+        if (m_jobs.empty())
+            return false;
+        job = std::move(m_jobs.front());
+        m_jobs.pop_front();
+        return true;
+    }
+
+    void close()
+    {
+        {
+            std::lock_guard lock(m_mutex);
+            m_closed = true;
+        }
+        m_cv.notify_all();
+    }
+
+private:
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    std::deque<BatchJob> m_jobs;
+    bool m_closed = false;
+};
+
+
+
+// Split a job line into arguments, honoring single and double quotes.
+// A leading "oiiotool" is optional, so that lines may be copied straight
+// from shell scripts.
+static std::vector<std::string>
+split_job_line(string_view line)
+{
+    std::vector<std::string> args { "oiiotool" };
+    for (string_view arg;;) {
+        Strutil::skip_whitespace(line);
+        if (line.empty() || !Strutil::parse_string(line, arg))
+            break;
+        args.emplace_back(arg);
+    }
+    if (args.size() > 1 && Filesystem::filename(args[1]) == "oiiotool")
+        args.erase(args.begin() + 1);
+    return args;
+}
+
+
+
+// Options that change state shared by all of the jobs -- the ImageCache,
+// the thread pool, or global OIIO attributes -- so that one job could
+// change how every later job runs. They are only allowed on the command
+// line that starts the batch. Return the offending option, or "" if there
+// is none.
+static string_view
+shared_state_option(cspan<std::string> args)
+{
+    static const char* shared[]
+        = { "cache",      "autotile", "native",       "autopremult",
+            "no-autopremult", "oiioattrib", "threads", "gpu",
+            "async-writes",   "batch",      "batch-jobs" };
+    for (size_t i = 1; i < args.size(); ++i) {
+        string_view arg = args[i];
+        if (!Strutil::parse_char(arg, '-'))
+            continue;
+        Strutil::parse_char(arg, '-');
+        arg = arg.substr(0, arg.find(':'));
+        for (const char* s : shared)
+            if (arg == s)
+                return args[i];
+    }
+    return {};
+}
+
+
+
+static void
+run_batch_job(Oiiotool& otmain, BatchJob& job)
+{
+    std::vector<std::string> args = split_job_line(job.command);
+    if (string_view opt = shared_state_option(args); opt.size()) {
+        {
+            std::lock_guard<std::mutex> lock(otmain.m_stat_mutex);
+            OIIO::print(std::cerr,
+                        "oiiotool batch job {}: {} is not allowed in a "
+                        "batch job\n",
+                        job.number, opt);
+        }
+        if (job.client)
+            job.client->reply(
+                Strutil::fmt::format("{} failed 0.000\n", job.number));
+        return;
+    }
+    std::vector<const char*> argv;
+    for (auto& a : args)
+        argv.push_back(a.c_str());
+
+    // Pick up any changes on disk to the files this job names, in case an
+    // earlier job (or somebody else) rewrote them since they were cached.
+    // Only this job's files: other jobs may be reading theirs right now.
+    // Arguments that aren't cached files are ignored by invalidate().
+    for (size_t i = 1; i < args.size(); ++i)
+        if (args[i].size() && args[i][0] != '-')
+            otmain.imagecache->invalidate(ustring(args[i]), false);
+
+    Timer timer;
+    Oiiotool otjob;
+    otjob.imagecache    = otmain.imagecache;
+    otjob.m_colorconfig = otmain.m_colorconfig;
+    // Like parallel frames, concurrent jobs share the one thread pool, so
+    // they must not be allowed to resize it with --threads.
+    otjob.m_in_parallel_frame_loop = otmain.batch_jobs > 1;
+    run_command_line(otjob, int(argv.size()), argv.data());
+    double time = timer();
+
+    bool ok = (otjob.return_value == EXIT_SUCCESS && !otjob.ap.aborted());
+    otmain.merge_stats(otjob);
+    if (job.client) {
+        job.client->reply(Strutil::fmt::format("{} {} {:.3f}\n", job.number,
+                                               ok ? "ok" : "failed", time));
+    } else if (!otmain.quiet) {
+        std::lock_guard<std::mutex> lock(otmain.m_stat_mutex);
+        OIIO::print("oiiotool batch job {} {}: {} (total {}) mem {}\n",
+                    job.number, ok ? "done" : "FAILED",
+                    Strutil::timeintervalformat(time, 2),
+                    Strutil::timeintervalformat(otmain.total_runtime(), 2),
+                    Strutil::memformat(Sysutil::memory_used()));
+    }
+}
+
+
+
+// Queue every job line from `in`, skipping blank lines and # comments.
+// Return false if a "quit" line was seen.
+static bool
+queue_job_lines(std::istream& in, BatchQueue& queue,
+                std::atomic<size_t>& njobs,
+                std::shared_ptr<BatchClient> client = nullptr)
+{
+    std::string line;
+    while (std::getline(in, line)) {
+        string_view cmd = Strutil::strip(line);
+        if (cmd.empty() || cmd[0] == '#')
+            continue;
+        if (cmd == "quit")
+            return false;
+        queue.push({ ++njobs, std::string(cmd), client });
+    }
+    return true;
+}
+
+
+
+#if !defined(_WIN32)
+// Is the process at the other end of socket `fd` running as our own user?
+// Anyone else could use a job's -o to write wherever we are able to.
+static bool
+peer_is_us(int fd)
+{
+#    if defined(__linux__)
+    ucred cred {};
+    socklen_t len = sizeof(cred);
+    return ::getsockopt(fd, SOL_SOCKET, SO_PEERCRED, &cred, &len) == 0
+           && cred.uid == ::geteuid();
+#    else
+    uid_t uid;
+    gid_t gid;
+    return ::getpeereid(fd, &uid, &gid) == 0 && uid == ::geteuid();
+#    endif
+}
+
+
+
+// Read the job lines sent by one socket client and queue them. A client
+// gets this long to send its jobs before we give up on it.
+static void
+read_batch_client(int fd, BatchQueue& queue, std::atomic<size_t>& njobs,
+                  std::atomic<bool>& quit)
+{
+    timeval timeout { 60, 0 };
+    ::setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    auto client = std::make_shared<BatchClient>(fd);
+    std::string text;
+    char buf[4096];
+    ssize_t n;
+    while ((n = ::read(fd, buf, sizeof(buf))) > 0)
+        text.append(buf, size_t(n));
+    if (n < 0)
+        return;  // Timed out or failed: run none of a partial job list
+    std::istringstream in(text);
+    if (!queue_job_lines(in, queue, njobs, client))
+        quit = true;
+}
+
+
+
+// Accept clients on the Unix-domain socket at `path`, and queue the jobs
+// each sends. A client sends its job lines and shuts down its side of the
+// connection for writing; it then gets back, as each job finishes, a line
+// "JOBNUMBER ok|failed SECONDS". A "quit" line stops the server once the
+// jobs already queued are done. Each client is read on its own thread, so
+// a slow one doesn't hold up the others, and only clients running as the
+// same user as the server are served at all.
+static bool
+serve_batch_socket(Oiiotool& ot, const std::string& path, BatchQueue& queue)
+{
+    int listener = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    sockaddr_un addr {};
+    addr.sun_family = AF_UNIX;
+    if (listener < 0 || path.size() >= sizeof(addr.sun_path)) {
+        ot.errorfmt("--batch", "Could not create socket \"{}\"", path);
+        if (listener >= 0)
+            ::close(listener);
+        return false;
+    }
+    Strutil::safe_strcpy(addr.sun_path, path, sizeof(addr.sun_path));
+    // Something already at the path may only be a stale socket left by an
+    // earlier server that is gone, which we clear away. Anything else, or a
+    // socket that a running server still answers on, is not ours to remove.
+    struct stat st;
+    if (::lstat(path.c_str(), &st) == 0) {
+        bool stale = false;
+        if (S_ISSOCK(st.st_mode)) {
+            int probe = ::socket(AF_UNIX, SOCK_STREAM, 0);
+            if (probe >= 0) {
+                stale = ::connect(probe, (sockaddr*)&addr, sizeof(addr)) != 0
+                        && errno == ECONNREFUSED;
+                ::close(probe);
+            }
+        }
+        if (!stale) {
+            ot.errorfmt("--batch",
+                        "\"{}\" already exists and is not a stale socket",
+                        path);
+            ::close(listener);
+            return false;
+        }
+        ::unlink(path.c_str());
+    }
+    // Create the socket readable and writable by its owner only.
+    mode_t oldmask = ::umask(077);
+    bool bound     = ::bind(listener, (sockaddr*)&addr, sizeof(addr)) == 0;
+    ::umask(oldmask);
+    if (!bound || ::chmod(path.c_str(), 0600) != 0
+        || ::listen(listener, 16) != 0) {
+        ot.errorfmt("--batch", "Could not listen on socket \"{}\": {}", path,
+                    std::strerror(errno));
+        ::close(listener);
+        return false;
+    }
+    if (ot.verbose)
+        OIIO::print("oiiotool batch server listening on {}\n", path);
+
+    std::atomic<size_t> njobs { 0 };
+    std::atomic<bool> quit { false };
+    // Each reader thread flags when it is done, so that finished ones are
+    // joined as the server goes along rather than piling up for as long as
+    // it runs.
+    struct Reader {
+        std::thread thread;
+        std::atomic<bool> done { false };
+    };
+    std::list<Reader> readers;
+    auto join_readers = [&](bool all) {
+        for (auto r = readers.begin(); r != readers.end();) {
+            if (all || r->done) {
+                r->thread.join();
+                r = readers.erase(r);
+            } else {
+                ++r;
+            }
+        }
+    };
+    while (!quit) {
+        join_readers(false);
+        // Wake up now and then to notice a "quit" from a reader thread.
+        pollfd pfd { listener, POLLIN, 0 };
+        int r = ::poll(&pfd, 1, 250);
+        if (r < 0 && errno != EINTR)
+            break;
+        if (r <= 0)
+            continue;
+        int fd = ::accept(listener, nullptr, nullptr);
+        if (fd < 0) {
+            if (errno == EINTR || errno == ECONNABORTED)
+                continue;
+            break;
+        }
+        if (!peer_is_us(fd)) {
+            ot.warningfmt("--batch",
+                          "refused a connection from another user on \"{}\"",
+                          path);
+            ::close(fd);
+            continue;
+        }
+        Reader* reader = &readers.emplace_back();
+        reader->thread = std::thread([&, fd, reader]() {
+            read_batch_client(fd, queue, njobs, quit);
+            reader->done = true;
+        });
+    }
+    join_readers(true);
+    ::close(listener);
+    Filesystem::remove(path);
+    return true;
+}
+#endif
+
+}  // namespace
+
+
+
+bool
+OiioTool::run_batch(Oiiotool& ot)
+{
+    // Everything the jobs share should be set up before any of them start.
+    ot.colorconfig();
+    int njobs = std::max(1, ot.batch_jobs);
+
+    BatchQueue queue;
+    thread_group workers;
+    for (int i = 0; i < njobs; ++i)
+        workers.create_thread([&]() {
+            BatchJob job;
+            while (queue.pop(job))
+                run_batch_job(ot, job);
+        });
+
+    bool ok         = true;
+    std::atomic<size_t> nqueued { 0 };
+    string_view src = ot.batch_source;
+    if (Strutil::parse_prefix(src, "unix:")) {
+#if !defined(_WIN32)
+        ok = serve_batch_socket(ot, std::string(src), queue);
+#else
+        ot.error("--batch", "Unix-domain sockets are not supported here");
+        ok = false;
+#endif
+    } else if (src == "-") {
+        queue_job_lines(std::cin, queue, nqueued);
+    } else {
+        std::ifstream in;
+        Filesystem::open(in, src);
+        if (in.good()) {
+            queue_job_lines(in, queue, nqueued);
+        } else {
+            ot.errorfmt("--batch", "Could not open job file \"{}\"", src);
+            ok = false;
+        }
+    }
+    queue.close();
+    workers.join_all();
+    return ok;
+}
@@ -0,0 +1,355 @@
+// Copyright Contributors to the OpenImageIO project.
+// SPDX-License-Identifier: Apache-2.0
+// https://github.com/AcademySoftwareFoundation/OpenImageIO
+
+
+// oiiotool --parallel-branches: run the ops of independent branches of the
+// command line at the same time.
+//
+// Rather than running each op as soon as it's parsed, an op that supports
+// it leaves a placeholder for its result on the stack and is handed to the
+// BranchScheduler, which runs it as soon as the ops producing its inputs
+// are done. Parsing carries on meanwhile, so in a command line like
+//
+//     oiiotool a.exr --resize 50% b.exr --blur 5x5 --over -o out.exr
+//
+// the resize and the blur run concurrently, and the over runs when both of
+// them are finished. Anything that needs to look at a placeholder simply
+// waits for it, and commands that might disturb images still in use (see
+// branch_safe() in oiiotool.cpp) wait for all running ops to finish first.
+
+#include <algorithm>
+#include <exception>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "oiiotool.h"
+
+#include <OpenImageIO/strutil.h>
+#include <OpenImageIO/timer.h>
+
+using namespace OIIO;
+using namespace OiioTool;
+
+
+
+struct BranchScheduler::Node {
+    std::string opname;
+    std::vector<NodeRef> deps;  // Nodes producing this one's inputs
+    // The placeholder for the result. Only the stack (and the ops using it)
+    // should keep it, and the images it holds, alive.
+    std::weak_ptr<ImageRec> result;
+    // Set by the worker running the node, and only read after `finished`:
+    double start = 0.0;
+    double end   = 0.0;
+    bool failed  = false;
+    bool finished = false;  // Guarded by m_mutex
+};
+
+
+
+// The scheduler whose worker is running on this thread, if any, and
+// whether the op it's running has reported an error.
+static thread_local BranchScheduler* this_thread_scheduler = nullptr;
+static thread_local bool this_thread_error                 = false;
+
+
+
+// Rough estimate of the memory an op will need while it runs: its inputs,
+// plus a result about as big as the first of them.
+static imagesize_t
+op_footprint(const OiiotoolOp& op)
+{
+    imagesize_t total = 0, first = 0;
+    for (int i = 1; i < op.nimages(); ++i) {
+        const ImageRecRef& in(op.ir(i));
+        if (!in)
+            continue;
+        imagesize_t bytes = 0;
+        for (int s = 0, n = in->subimages(); s < n; ++s)
+            if (const ImageSpec* spec = in->spec(s))
+                bytes += spec->image_bytes();
+        total += bytes;
+        if (i == 1)
+            first = bytes;
+    }
+    return total + first;
+}
+
+
+
+BranchScheduler::BranchScheduler(Oiiotool& ot, int maxbranches,
+                                 imagesize_t memory)
+    : m_ot(ot)
+{
+    limits(maxbranches, memory);
+}
+
+
+
+void
+BranchScheduler::limits(int maxbranches, imagesize_t memory)
+{
+    {
+        std::lock_guard lock(m_mutex);
+        m_maxbranches = std::max(1, maxbranches);
+        m_memory      = memory;
+    }
+    m_cv.notify_all();
+}
+
+
+
+void
+BranchScheduler::defer(std::shared_ptr<OiiotoolOp> op)
+{
+    auto node    = std::make_shared<Node>();
+    node->opname = op->opname();
+    for (int i = 1; i < op->nimages(); ++i) {
+        const ImageRecRef& in(op->ir(i));
+        auto producer = in ? m_producers.find(in.get()) : m_producers.end();
+        if (producer != m_producers.end()
+            && producer->second->result.lock() == in) {
+            node->deps.push_back(producer->second);
+        } else if (in && !m_ot.read(in)) {
+            // Inputs that aren't pending results are read right here, on
+            // the main thread, where all the bookkeeping about inputs is
+            // done. If that fails, the op would have failed the same way
+            // (and pushed no result) had it run right away.
+            return;
+        }
+    }
+
+    Job job;
+    job.node   = node;
+    job.op     = std::move(op);
+    job.result = std::make_shared<ImageRec>(node->opname, 0);
+    job.result->pending(job.done.get_future().share());
+    node->result = job.result;
+    m_nodes.push_back(node);
+    m_producers[job.result.get()] = node;
+    m_ot.push(job.result);
+    job.op->deferred(true);
+    {
+        std::lock_guard lock(m_mutex);
+        m_queue.push_back(std::move(job));
+        // Start another worker if we don't have as many as may run at once
+        if (m_workers.size() < size_t(m_maxbranches))
+            m_workers.emplace_back(&BranchScheduler::worker, this);
+    }
+    m_cv.notify_all();
+}
+
+
+
+std::deque<BranchScheduler::Job>::iterator
+BranchScheduler::next_job()
+{
+    if (m_running >= m_maxbranches)
+        return m_queue.end();
+    for (auto job = m_queue.begin(); job != m_queue.end(); ++job) {
+        bool ready = std::all_of(job->node->deps.begin(),
+                                 job->node->deps.end(),
+                                 [](const NodeRef& dep) {
+                                     return dep->finished;
+                                 });
+        if (!ready)
+            continue;
+        for (auto& dep : job->node->deps)
+            job->node->failed |= dep->failed;
+        if (job->node->failed)
+            return job;  // Nothing to run, it just needs to be finished
+        if (!job->sized) {
+            job->bytes = op_footprint(*job->op);
+            job->sized = true;
+        }
+        // An op that would be over the memory budget all by itself still
+        // gets to run, just not alongside any others.
+        if (m_running == 0 || m_memory_used + job->bytes <= m_memory)
+            return job;
+    }
+    return m_queue.end();
+}
+
+
+
+void
+BranchScheduler::worker()
+{
+    this_thread_scheduler = this;
+    std::unique_lock lock(m_mutex);
+    while (true) {
+        auto next = m_queue.end();
+        m_cv.wait(lock, [&]() {
+            next = next_job();
+            return next != m_queue.end() || (m_stopping && m_queue.empty());
+        });
+        if (next == m_queue.end())
+            break;  // Told to stop, and nothing is left to do
+        Job job(std::move(*next));
+        m_queue.erase(next);
+        ++m_running;
+        m_peak_running = std::max(m_peak_running, m_running);
+        m_memory_used += job.bytes;
+        lock.unlock();
+
+        run_job(job);
+
+        lock.lock();
+        --m_running;
+        m_memory_used -= job.bytes;
+        job.node->finished = true;
+        // Tell the other workers (whose jobs may have been waiting on this
+        // one), and then anybody waiting on the placeholder.
+        m_cv.notify_all();
+        job.done.set_value();
+    }
+}
+
+
+
+void
+BranchScheduler::run_job(Job& job)
+{
+    Node& node(*job.node);
+    if (!node.failed) {
+        node.start        = m_timer();
+        this_thread_error = false;
+        try {
+            (*job.op)();
+        } catch (const std::exception& e) {
+            m_ot.error(node.opname, e.what());
+        }
+        // Whatever it did report, an op that failed passes on no result,
+        // so that the ops depending on it don't run either.
+        if (job.op->ir(0) && !this_thread_error)
+            job.result->adopt(*job.op->ir(0));
+        else
+            node.failed = true;
+        node.end = m_timer();
+    }
+    // Let go of the inputs before anybody waiting on us gets going.
+    job.op.reset();
+    job.result.reset();
+}
+
+
+
+bool
+BranchScheduler::defer_error(string_view command, string_view explanation)
+{
+    if (this_thread_scheduler != this)
+        return false;
+    this_thread_error = true;
+    std::lock_guard lock(m_mutex);
+    m_errors.emplace_back(command, explanation);
+    return true;
+}
+
+
+
+void
+BranchScheduler::wait_all()
+{
+    {
+        std::lock_guard lock(m_mutex);
+        m_stopping = true;
+    }
+    m_cv.notify_all();
+    for (auto& t : m_workers)
+        t.join();
+    m_workers.clear();
+
+    std::vector<std::pair<std::string, std::string>> errors;
+    {
+        std::lock_guard lock(m_mutex);
+        m_stopping = false;
+        std::swap(errors, m_errors);
+    }
+    // Now that we're back on the main thread, errors may abort the
+    // command line.
+    for (auto& e : errors)
+        m_ot.error(e.first, e.second);
+}
+
+
+
+void
+BranchScheduler::print_stats() const
+{
+    if (m_nodes.empty())
+        return;
+    // Nodes were created in command line order, so every node comes after
+    // the ones it depends on, and one pass finds the longest chain.
+    size_t n = m_nodes.size();
+    std::map<const Node*, size_t> index;
+    std::vector<double> length(n);
+    std::vector<size_t> prev(n, n);
+    size_t last = 0;
+    for (size_t i = 0; i < n; ++i) {
+        const Node& node(*m_nodes[i]);
+        index[&node] = i;
+        double before = 0.0;
+        for (auto& dep : node.deps) {
+            size_t d = index[dep.get()];
+            if (length[d] > before) {
+                before  = length[d];
+                prev[i] = d;
+            }
+        }
+        length[i] = before + (node.end - node.start);
+        if (length[i] > length[last])
+            last = i;
+    }
+    std::vector<std::string> path;
+    for (size_t i = last; i < n; i = prev[i])
+        path.push_back(Strutil::fmt::format(
+            "{} ({})", m_nodes[i]->opname,
+            Strutil::timeintervalformat(m_nodes[i]->end - m_nodes[i]->start,
+                                        2)));
+    std::reverse(path.begin(), path.end());
+
+    OIIO::print("  Parallel branches: {} ops, up to {} at once\n", n,
+                m_peak_running);
+    OIIO::print("  Critical path: {} over {} ops: {}\n",
+                Strutil::timeintervalformat(length[last], 2), path.size(),
+                Strutil::join(path, " -> "));
+}
+
+
+
+void
+OiiotoolOp::run(std::shared_ptr<OiiotoolOp> op)
+{
+    if (op->ot.m_branches && !op->inplace()) {
+        op->ot.m_branches->defer(std::move(op));
+    } else {
+        // An in-place op must not change an image while it's being written
+        if (op->inplace())
+            op->ot.wait_for_writes();
+        (*op)();
+    }
+}
+
+
+
+void
+Oiiotool::parallel_branches(int maxbranches, imagesize_t memory)
+{
+    if (m_branches)
+        m_branches->limits(maxbranches, memory);
+    else
+        m_branches.reset(new BranchScheduler(*this, maxbranches, memory));
+}
+
+
+
+void
+Oiiotool::wait_for_branches()
+{
+    if (m_branches)
+        m_branches->wait_all();
+}
@@ -353,7 +353,16 @@ ImageRec::read(ReadPolicy readpolicy, string_view channel_set)
                 forceread = true;
             }
 
-            bool ok = ib->read(s, m, chbegin, chend, forceread, convert);
+            bool ok;
+            if (s == 0 && m == 0 && m_input_processor && forceread
+                && !post_channel_set_action && !ib->deep()) {
+                ok = ib->read_colorconvert(s, m, chbegin, chend, convert,
+                                           m_input_processor.get(),
+                                           m_input_unpremult);
+                m_input_colorconverted = ok;
+            } else {
+                ok = ib->read(s, m, chbegin, chend, forceread, convert);
+            }
             if (ok && post_channel_set_action) {
                 ImageBufRef allchan_buf(new ImageBuf);
                 std::swap(allchan_buf, ib);
@@ -399,6 +408,34 @@ ImageRec::read(ReadPolicy readpolicy, string_view channel_set)
 }
 
 
+
+void
+ImageRec::adopt(const ImageRec& result)
+{
+    // This is how a placeholder gets filled in, by the thread that computed
+    // the result and before it signals that the placeholder is ready, so
+    // (unlike everything else) it must not wait().
+    if (&result == this)
+        return;
+    m_name                 = result.m_name;
+    m_elaborated           = result.m_elaborated;
+    m_metadata_modified    = result.m_metadata_modified;
+    m_pixels_modified      = result.m_pixels_modified;
+    m_was_output           = result.m_was_output;
+    m_subimages            = result.m_subimages;
+    m_time                 = result.m_time;
+    m_input_dataformat     = result.m_input_dataformat;
+    m_input_processor      = result.m_input_processor;
+    m_input_unpremult      = result.m_input_unpremult;
+    m_input_colorconverted = result.m_input_colorconverted;
+    m_imagecache           = result.m_imagecache;
+    if (result.m_configspec)
+        m_configspec.reset(new ImageSpec(*result.m_configspec));
+    if (result.has_error())
+        append_error(result.geterror(false));
+}
+
+
 namespace {
 static spin_mutex err_mutex;
 }
@@ -408,6 +445,7 @@ static spin_mutex err_mutex;
 bool
 ImageRec::has_error() const
 {
+    wait();
     spin_lock lock(err_mutex);
     return !m_err.empty();
 }
@@ -417,6 +455,7 @@ ImageRec::has_error() const
 std::string
 ImageRec::geterror(bool clear_error) const
 {
+    wait();
     spin_lock lock(err_mutex);
     std::string e = m_err;
     if (clear_error)
@@ -13,6 +13,7 @@
 #include <map>
 #include <numeric>
 #include <regex>
+#include <set>
 #include <sstream>
 #include <string>
 #include <utility>
@@ -64,18 +65,47 @@ using pvt::print_info_options;
 
 
 
+// Actions whose ops can themselves be deferred to run in their own branch
+// (see --parallel-branches), as registered by the op macros below.
+static std::set<CallbackFunction>&
+branch_safe_actions()
+{
+    static std::set<CallbackFunction> actions;
+    return actions;
+}
+
+static bool
+branch_safe_action(CallbackFunction func)
+{
+    branch_safe_actions().insert(func);
+    return true;
+}
+
+// Can the action go ahead while ops in other branches are still running?
+static bool
+branch_safe(CallbackFunction func);
+
+// Can the action go ahead while outputs are still being written from
+// images it might modify?
+static bool
+write_safe(CallbackFunction func);
+
+
+
 // Macro to fully set up the "action" function that straightforwardly calls
 // a lambda for each subimage. Beware, the macro expansion rules may require
 // you may need to enclose the lambda itself in parenthesis () if there it
 // contains commas that are not inside other parentheses.
-#define OIIOTOOL_OP(name, ninputs, ...)                              \
-    static void action_##name(Oiiotool& ot, cspan<const char*> argv) \
-    {                                                                \
-        if (ot.postpone_callback(ninputs, action_##name, argv))      \
-            return;                                                  \
-        OiiotoolOp op(ot, "-" #name, argv, ninputs, __VA_ARGS__);    \
-        op();                                                        \
-    }
+#define OIIOTOOL_OP(name, ninputs, ...)                                  \
+    static void action_##name(Oiiotool& ot, cspan<const char*> argv)     \
+    {                                                                    \
+        if (ot.postpone_callback(ninputs, action_##name, argv))          \
+            return;                                                      \
+        OiiotoolOp::run(std::shared_ptr<OiiotoolOp>(                     \
+            new OiiotoolOp(ot, "-" #name, argv, ninputs, __VA_ARGS__))); \
+    }                                                                    \
+    [[maybe_unused]] static bool action_##name##_branches                \
+        = branch_safe_action(action_##name)
 
 // Lke OIIOTOOL_OP, but designate the op as "inplace" -- which means it
 // uses the input image itself as the destination.
@@ -128,9 +158,10 @@ using pvt::print_info_options;
     {                                                                \
         if (ot.postpone_callback(ninputs, action_##name, argv))      \
             return;                                                  \
-        opclass op(ot, #name, argv);                                 \
-        op();                                                        \
-    }
+        OiiotoolOp::run(std::make_shared<opclass>(ot, #name, argv)); \
+    }                                                                \
+    [[maybe_unused]] static bool action_##name##_branches            \
+        = branch_safe_action(action_##name)
 
 
 
@@ -138,6 +169,14 @@ Oiiotool::Oiiotool() { clear_options(); }
 
 
 
+Oiiotool::~Oiiotool()
+{
+    // Ops still running in other branches refer back to us
+    wait_for_branches();
+}
+
+
+
 void
 Oiiotool::clear_options()
 {
@@ -219,10 +258,16 @@ ColorConfig&
 Oiiotool::colorconfig()
 {
     // It's safe to check the pointer and if it exists, return it, since
-    // once it's created, it will never be changed.
+    // once it's set, only --colorconfig (which waits for any ops running
+    // in other branches) will replace it.
     if (ColorConfig* cc = m_colorconfig.get())
         return *cc;
 
+    // Frame iterations share their parent's config rather than each
+    // parsing it anew, unless they were given one of their own.
+    if (parent_oiiotool)
+        return parent_oiiotool->colorconfig();
+
     // Otherwise, we need to create it. But we need to be thread-safe.
     static std::mutex colorconfig_mutex;
     std::lock_guard lock(colorconfig_mutex);
@@ -405,16 +450,20 @@ Oiiotool::read(ImageRecRef img, ReadPolicy readpolicy, string_view channel_set)
 
     // Cause the ImageRec to get read.  Try to compute how long it took.
     // Subtract out ImageCache time, to avoid double-accounting it later.
+    // (Ops running in other branches may be looking at total_readtime.)
     float pre_ic_time, post_ic_time;
     imagecache->getattribute("stat:fileio_time", pre_ic_time);
-    total_readtime.start();
+    Timer readtimer;
     if (nativeread)
         readpolicy = ReadPolicy(readpolicy | ReadNative);
     bool ok = img->read(readpolicy, channel_set);
-    total_readtime.stop();
+    double readtime = readtimer();
     imagecache->getattribute("stat:fileio_time", post_ic_time);
     total_imagecache_readtime += post_ic_time - pre_ic_time;
-    total_readtime.add_seconds(pre_ic_time - post_ic_time);
+    {
+        std::lock_guard lock(m_stat_mutex);
+        total_readtime.add_seconds(readtime + pre_ic_time - post_ic_time);
+    }
 
     // If this is the first tiled image we have come across, use it to
     // set our tile size (unless the user explicitly set a tile size, or
@@ -448,11 +497,15 @@ Oiiotool::read_nativespec(ImageRecRef img)
     // Subtract out ImageCache time, to avoid double-accounting it later.
     float pre_ic_time, post_ic_time;
     imagecache->getattribute("stat:fileio_time", pre_ic_time);
-    total_readtime.start();
+    Timer readtimer;
     bool ok = img->read_nativespec();
-    total_readtime.stop();
+    double readtime = readtimer();
     imagecache->getattribute("stat:fileio_time", post_ic_time);
     total_imagecache_readtime += post_ic_time - pre_ic_time;
+    {
+        std::lock_guard lock(m_stat_mutex);
+        total_readtime.add_seconds(readtime);
+    }
 
     if (!ok)
         error("read", format_read_error(img->name(), img->geterror()));
@@ -536,15 +589,89 @@ Oiiotool::process_pending()
         std::vector<const char*> argv = std::move(m_pending_argv);
         CallbackFunction callback     = m_pending_callback;
         m_pending_callback            = NULL;
+        if (!branch_safe(callback))
+            wait_for_branches();
+        if (!write_safe(callback))
+            wait_for_writes();
         (*callback)(*this, argv);
     }
 }
 
 
 
+void
+Oiiotool::queue_write(string_view command, string_view filename,
+                      std::function<std::string()> job)
+{
+    // This waits if too many writes are already pending, so we can't get
+    // too far ahead of them.
+    auto done = OIIO::pvt::async_write(std::move(job));
+    std::lock_guard lock(m_writes_mutex);
+    m_pending_writes.push_back(
+        { std::string(command), std::string(filename), std::move(done) });
+}
+
+
+
+void
+Oiiotool::wait_for_writes()
+{
+    std::vector<PendingWrite> writes;
+    {
+        std::lock_guard lock(m_writes_mutex);
+        writes.swap(m_pending_writes);
+    }
+    for (auto& w : writes) {
+        const std::string& err(w.done.get());
+        if (err.size())
+            error(w.command, err);
+    }
+}
+
+
+
+void
+Oiiotool::wait_for_writes(string_view filename)
+{
+    std::vector<std::shared_future<std::string>> writes;
+    {
+        std::lock_guard lock(m_writes_mutex);
+        for (auto& w : m_pending_writes)
+            if (w.filename == filename)
+                writes.push_back(w.done);
+    }
+    for (auto& w : writes)
+        w.wait();
+    // An earlier frame might be writing it, too.
+    if (parent_oiiotool)
+        parent_oiiotool->wait_for_writes(filename);
+}
+
+
+
+void
+Oiiotool::pass_writes_to(Oiiotool& ot)
+{
+    std::vector<PendingWrite> writes;
+    {
+        std::lock_guard lock(m_writes_mutex);
+        writes.swap(m_pending_writes);
+    }
+    std::lock_guard lock(ot.m_writes_mutex);
+    for (auto& w : writes)
+        ot.m_pending_writes.push_back(std::move(w));
+}
+
+
+
 void
 Oiiotool::error(string_view command, string_view explanation) const
 {
+    // Errors from ops running in parallel branches are reported later, from
+    // the main thread, where it's safe to abort the command line.
+    if (m_branches && m_branches->defer_error(command, explanation))
+        return;
+    std::lock_guard lock(m_error_mutex);
     auto& errstream(nostderr ? std::cout : std::cerr);
     errstream << "oiiotool ERROR";
     if (command.size())
@@ -569,6 +696,7 @@ Oiiotool::error(string_view command, string_view explanation) const
 void
 Oiiotool::warning(string_view command, string_view explanation) const
 {
+    std::lock_guard lock(m_error_mutex);
     auto& errstream(nostderr ? std::cout : std::cerr);
     errstream << "oiiotool WARNING";
     if (command.size())
@@ -629,6 +757,37 @@ set_threads(Oiiotool& ot, cspan<const char*> argv)
 
 
 
+// --parallel-branches
+static void
+action_parallel_branches(Oiiotool& ot, cspan<const char*> argv)
+{
+    OIIO_DASSERT(argv.size() == 1);
+    string_view command = ot.express(argv[0]);
+    auto options        = ot.extract_options(command);
+    int maxbranches     = options.get_int("maxbranches",
+                                          OIIO::get_int_attribute("threads"));
+    // Memory budget in MB, by default half of physical memory
+    int memory = options.get_int("memory",
+                                 int(Sysutil::physical_memory() >> 21));
+    ot.parallel_branches(maxbranches, imagesize_t(std::max(memory, 0)) << 20);
+}
+
+
+
+// --async-writes
+static void
+action_async_writes(Oiiotool& ot, cspan<const char*> argv)
+{
+    OIIO_DASSERT(argv.size() == 1);
+    string_view command = ot.express(argv[0]);
+    auto options        = ot.extract_options(command);
+    ot.async_writes     = true;
+    if (options.contains("queue"))
+        OIIO::attribute("imagebuf:async_writes", options.get_int("queue"));
+}
+
+
+
 // --cache
 static void
 set_cachesize(Oiiotool& ot, cspan<const char*> argv)
@@ -2308,10 +2467,15 @@ static void
 set_colorconfig(Oiiotool& ot, cspan<const char*> argv)
 {
     OIIO_DASSERT(argv.size() == 2);
-    ot.colorconfig().reset(argv[1]);
-    if (ot.colorconfig().has_error()) {
-        ot.errorfmt("--colorconfig", "{}", ot.colorconfig().geterror());
+    // The config we have may be shared with a parent command line, with
+    // frame iterations, or with other batch jobs, so never reset it in
+    // place: this command line gets a new one of its own.
+    auto cc = std::make_shared<ColorConfig>(argv[1]);
+    if (cc->has_error()) {
+        ot.errorfmt("--colorconfig", "{}", cc->geterror());
+        return;
     }
+    ot.m_colorconfig = std::move(cc);
 }
 
 
@@ -2374,8 +2538,7 @@ public:
             // The whole thing is a no-op. Get rid of the empty result we
             // pushed on the stack, replace it with the original image, and
             // signal that we're done.
-            ot.pop();
-            ot.push(ir(1));
+            use_input_as_result();
             return false;
         }
         return true;
@@ -4221,8 +4384,7 @@ public:
         }
         if (nochange) {
             // No change -- pop the temp result and restore the original
-            ot.pop();
-            ot.push(ir(1));
+            use_input_as_result();
             return false;  // nothing more to do
         }
         for (int s = 0; s < subimages; ++s)
@@ -4286,8 +4448,7 @@ public:
         if (nochange) {
             // No change necessary to any subimage -- pop the temp result and
             // restore the original.
-            ot.pop();
-            ot.push(ir(1));
+            use_input_as_result();
             return false;  // nothing more to do
         }
         // If a change is necessary to any subimage, allocate the new images
@@ -5248,6 +5409,70 @@ OIIOTOOL_INPLACE_OP(text, 1, [&](OiiotoolOp& op, span<ImageBuf*> img) {
 
 
 
+// The color space of the pixels of an input file: as declared with
+// -i:iscolorspace=, or else as deduced from the file name, or else as given
+// by the file's metadata (which doesn't require reading the pixels).
+static std::string
+input_colorspace(Oiiotool& ot, string_view filename, string_view declared)
+{
+    if (declared.size())
+        return declared;
+    std::string colorspace(
+        ot.colorconfig().getColorSpaceFromFilepath(filename, "", true));
+    if (colorspace.size()) {
+        if (ot.debug)
+            OIIO::print("  From {}, we deduce color space \"{}\"\n",
+                        filename, colorspace);
+        return colorspace;
+    }
+    ustring metadata;
+    if (ot.imagecache->get_image_info(ustring(filename), 0, 0,
+                                      ustring("oiio:ColorSpace"), TypeString,
+                                      &metadata)) {
+        colorspace = metadata.string();
+        if (ot.debug)
+            OIIO::print("  Metadata of {} indicates color space \"{}\"\n",
+                        filename, colorspace);
+    }
+    return colorspace;
+}
+
+
+
+// For --autocc or -i:colorconvert=, when the pixels of a single-image file
+// are about to be read anyway, arrange for the conversion to happen strip
+// by strip as part of the read, instead of as a separate --colorconvert
+// pass over the whole image.
+static void
+colorconvert_on_read(Oiiotool& ot, string_view filename,
+                     string_view fromspace, string_view tospace,
+                     bool unpremult)
+{
+    static ustring u_subimages("subimages"), u_miplevels("miplevels");
+    ustring uname(filename);
+    int subimages = 0, miplevels = 0;
+    if (!ot.imagecache->get_image_info(uname, 0, 0, u_subimages, TypeInt,
+                                       &subimages)
+        || !ot.imagecache->get_image_info(uname, 0, 0, u_miplevels, TypeInt,
+                                          &miplevels)
+        || subimages != 1 || miplevels != 1)
+        return;
+    auto processor = ot.colorconfig().createColorProcessor(fromspace,
+                                                           tospace);
+    if (!processor) {
+        // Leave it to the usual conversion after the read, which reports
+        // the problem as strictly as it should.
+        (void)ot.colorconfig().geterror();
+        return;
+    }
+    if (ot.debug)
+        OIIO::print("  Converting {} from {} to {} as it is read\n", filename,
+                    fromspace, tospace);
+    ot.curimg->input_colorconvert(processor, unpremult);
+}
+
+
+
 // -i
 static int
 input_file(Oiiotool& ot, cspan<const char*> argv)
@@ -5270,7 +5495,16 @@ input_file(Oiiotool& ot, cspan<const char*> argv)
     std::string infoformat = fileoptions.get_string("infoformat",
                                                     ot.printinfo_format);
     TypeDesc input_dataformat(fileoptions.get_string("type"));
-    std::string channel_set = fileoptions["ch"];
+    std::string channel_set  = fileoptions["ch"];
+    std::string iscolorspace = fileoptions["iscolorspace"];
+    // Where the input's colors should go: an explicit -i:colorconvert= is
+    // a strict conversion, while --autocc quietly skips what it can't do.
+    std::string tocolorspace = fileoptions["colorconvert"];
+    bool ccstrict            = true;
+    if (tocolorspace.empty() && autocc) {
+        tocolorspace = ot.colorconfig().resolve("scene_linear");
+        ccstrict     = false;
+    }
 
     for (int i = 0; i < std::ssize(argv); i++) {
         // FIXME: this loop is pointless, since there is ever only one arg
@@ -5284,7 +5518,11 @@ input_file(Oiiotool& ot, cspan<const char*> argv)
             ot.process_pending();
             break;
         }
-        int exists = 1;
+        // Don't read a file we're still writing (--async-writes)
+        ot.wait_for_writes(filename);
+        std::string fromspace;
+        bool converted = false;
+        int exists     = 1;
         if (ot.input_config_set) {
             // User has set some input configuration, so seed the cache with
             // that information.
@@ -5380,7 +5618,23 @@ input_file(Oiiotool& ot, cspan<const char*> argv)
             ot.curimg->input_dataformat(input_dataformat);
             if (readnow) {
                 ReadPolicy policy = native ? ReadNativeNoCache : ReadNoCache;
+                if (tocolorspace.size()
+                    && !(printinfo || ot.printstats || ot.dumpdata
+                         || ot.hash)) {
+                    fromspace = input_colorspace(ot, filename, iscolorspace);
+                    if (fromspace.size()
+                        && !ot.colorconfig().equivalent(fromspace,
+                                                        tocolorspace))
+                        colorconvert_on_read(ot, filename, fromspace,
+                                             tocolorspace, autoccunpremult);
+                }
                 ot.read(policy, channel_set);
+                if (ot.curimg->input_colorconverted()) {
+                    ot.colorconfig().set_colorspace(
+                        (*ot.curimg)(0, 0).specmod(), tocolorspace);
+                    ot.curimg->update_spec_from_imagebuf(0, 0);
+                    converted = true;
+                }
             } else
                 ot.read_nativespec();
             if (!ot.first_input_dimensions_is_set()) {
@@ -5419,37 +5673,40 @@ input_file(Oiiotool& ot, cspan<const char*> argv)
             action_reorient(ot, argv);
         }
 
-        if (autocc) {
+        // Like following the input with --iscolorspace
+        if (iscolorspace.size() && !converted) {
+            const char* argv[] = { "iscolorspace", iscolorspace.c_str() };
+            action_iscolorspace(ot, argv);
+        }
+
+        if (tocolorspace.size() && !converted) {
             // Try to deduce the color space it's in
-            std::string colorspace(
-                ot.colorconfig().getColorSpaceFromFilepath(filename, "", true));
-            if (colorspace.size() && ot.debug)
-                OIIO::print("  From {}, we deduce color space \"{}\"\n",
-                            filename, colorspace);
-            if (colorspace.empty()) {
-                ot.read();
-                colorspace = ot.curimg->spec()->get_string_attribute(
-                    "oiio:ColorSpace");
-                if (ot.debug)
-                    OIIO::print(
-                        "  Metadata of {} indicates color space \"{}\"\n",
-                        colorspace, filename);
+            std::string colorspace = fromspace.size()
+                                         ? fromspace
+                                         : input_colorspace(ot, filename,
+                                                            iscolorspace);
+            if (colorspace.empty() && ccstrict) {
+                ot.errorfmt("read",
+                            "Could not deduce the color space of {} to "
+                            "convert it to {}",
+                            filename, tocolorspace);
+                break;
             }
-            std::string linearspace = ot.colorconfig().resolve("scene_linear");
             if (colorspace.size()
-                && !ot.colorconfig().equivalent(colorspace, linearspace)) {
-                std::string cmd = "colorconvert:strict=0";
+                && !ot.colorconfig().equivalent(colorspace, tocolorspace)) {
+                std::string cmd = ccstrict ? "colorconvert"
+                                           : "colorconvert:strict=0";
                 if (autoccunpremult)
                     cmd += ":unpremult=1";
                 const char* argv[] = { cmd.c_str(), colorspace.c_str(),
-                                       linearspace.c_str() };
+                                       tocolorspace.c_str() };
                 if (ot.debug)
                     OIIO::print("  Converting {} from {} to {}\n", filename,
-                                colorspace, linearspace);
+                                colorspace, tocolorspace);
                 action_colorconvert(ot, argv);
             } else if (ot.debug) {
                 OIIO::print("  no auto conversion necessary for {}->{}\n",
-                            colorspace, linearspace);
+                            colorspace, tocolorspace);
             }
         }
 
@@ -5571,6 +5828,68 @@ remove_all_cmd(std::string& str)
 
 
 
+// One subimage or MIP level of an output file
+struct OutputLevel {
+    int subimage, miplevel;
+    ImageSpec spec;
+    ImageOutput::OpenMode mode;
+};
+
+
+
+// Write the image to the (not yet opened) output, and close it, calling
+// level_written() after each subimage or MIP level. Return an error message
+// if anything went wrong.
+static std::string
+write_output(ImageOutput& out, ImageRec& ir, const std::string& filename,
+             const std::vector<ImageSpec>& subimagespecs,
+             const std::vector<OutputLevel>& levels,
+             const std::function<void()>& level_written)
+{
+    // Do the initial open
+    bool opened = (ir.subimages() > 1 && out.supports("multiimage"))
+                      ? out.open(filename, ir.subimages(), &subimagespecs[0])
+                      : out.open(filename, subimagespecs[0],
+                                 ImageOutput::Create);
+    if (!opened)
+        return out.geterror();
+
+    // Output all the subimages and MIP levels
+    std::string err;
+    for (auto& level : levels) {
+        // The first subimage and level are already open
+        if ((level.subimage > 0 || level.miplevel > 0)
+            && !out.open(filename, level.spec, level.mode)) {
+            err = out.geterror();
+            break;
+        }
+        ImageBuf& img(ir(level.subimage, level.miplevel));
+        if (!img.write(&out)) {
+            err = img.geterror();
+            break;
+        }
+        level_written();
+    }
+    if (!out.close() && err.empty())
+        err = out.geterror();
+    return err;
+}
+
+
+
+// Make sure to invalidate any IC entries that think they are the file we
+// just wrote, and for --adjust-time, set its modification time.
+static void
+finish_output(ImageCache& imagecache, const std::string& filename,
+              bool adjust_time, std::time_t time)
+{
+    imagecache.invalidate(ustring(filename), true);
+    if (adjust_time)
+        Filesystem::last_write_time(filename, time);
+}
+
+
+
 // -o
 static void
 output_file(Oiiotool& ot, cspan<const char*> argv)
@@ -5847,6 +6166,16 @@ output_file(Oiiotool& ot, cspan<const char*> argv)
     // FIXME -- the various automatic transformations above neglect to handle
     // MIPmaps or subimages with full generality.
 
+    // What --adjust-time will set the output file's modification time to
+    std::time_t in_time = 0;
+    if (ot.output_adjust_time) {
+        std::string metadatatime = ir->spec(0, 0)->get_string_attribute(
+            "DateTime");
+        in_time = ir->time();
+        if (!metadatatime.empty())
+            DateTime_to_time_t(metadatatime.c_str(), in_time);
+    }
+
     bool ok = true;
     if (do_tex || do_latlong || do_bumpslopes) {
         ImageSpec configspec;
@@ -5875,6 +6204,8 @@ output_file(Oiiotool& ot, cspan<const char*> argv)
         // N.B. make_texture already internally writes to a temp file and
         // then atomically moves it to the final destination, so we don't
         // need to explicitly do that here.
+        finish_output(*ot.imagecache, filename, ok && ot.output_adjust_time,
+                      in_time);
     } else {
         // Non-texture case
         std::vector<ImageSpec> subimagespecs(ir->subimages());
@@ -5889,55 +6220,17 @@ output_file(Oiiotool& ot, cspan<const char*> argv)
             subimagespecs[s] = spec;
         }
 
-        // Write the output to a temp file first, then rename it to the
-        // final destination (same directory). This improves robustness.
-        // There is less chance a crash during execution will leave behind a
-        // partially formed file, and it also protects us against corrupting
-        // an input if they are "oiiotooling in place" (especially
-        // problematic for large files that are ImageCache-based and so only
-        // partially read at the point that we open the file. We also force
-        // a unique filename to protect against multiple processes running
-        // at the same time on the same file.
-        std::string extension = Filesystem::extension(filename);
-        std::string tmpfilename
-            = Filesystem::replace_extension(filename,
-                                            ".%%%%%%%%.temp" + extension);
-        tmpfilename = Filesystem::unique_path(tmpfilename);
-
-        // Do the initial open
+        // Work out here, where the options are at hand, the spec and open
+        // mode for each subimage and MIP level that the file can hold.
+        std::vector<OutputLevel> levels;
         ImageOutput::OpenMode mode = ImageOutput::Create;
-        if (ir->subimages() > 1 && out->supports("multiimage")) {
-            if (!out->open(tmpfilename, ir->subimages(), &subimagespecs[0])) {
-                ot.error(command, out->geterror());
-                return;
-            }
-        } else {
-            if (!out->open(tmpfilename, subimagespecs[0], mode)) {
-                ot.error(command, out->geterror());
-                return;
-            }
-        }
-
-        // Output all the subimages and MIP levels
         for (int s = 0, send = ir->subimages(); s < send; ++s) {
-            for (int m = 0, mend = ir->miplevels(s); m < mend && ok; ++m) {
+            for (int m = 0, mend = ir->miplevels(s); m < mend; ++m) {
                 ImageSpec spec = *ir->spec(s, m);
                 adjust_output_options(filename, spec, ir->nativespec(s, m), ot,
                                       supports_tiles, fileoptions,
                                       (*ir)[s].was_direct_read());
-                if (s > 0 || m > 0) {  // already opened first subimage/level
-                    if (!out->open(tmpfilename, spec, mode)) {
-                        ot.error(command, out->geterror());
-                        ok = false;
-                        break;
-                    }
-                }
-                if (!(*ir)(s, m).write(out.get())) {
-                    ot.error(command, (*ir)(s, m).geterror());
-                    ok = false;
-                    break;
-                }
-                ot.check_peak_memory();
+                levels.push_back({ s, m, spec, mode });
                 if (mend > 1) {
                     if (out->supports("mipmap")) {
                         mode = ImageOutput::AppendMIPLevel;  // for next level
@@ -5960,38 +6253,58 @@ output_file(Oiiotool& ot, cspan<const char*> argv)
             }
         }
 
-        if (!out->close()) {
-            ot.error(command, out->geterror());
-            ok = false;
-        }
-        out.reset();  // make extra sure it's cleaned up
+        // Write the output to a temp file first, then rename it to the
+        // final destination (same directory). This improves robustness.
+        // There is less chance a crash during execution will leave behind a
+        // partially formed file, and it also protects us against corrupting
+        // an input if they are "oiiotooling in place" (especially
+        // problematic for large files that are ImageCache-based and so only
+        // partially read at the point that we open the file. We also force
+        // a unique filename to protect against multiple processes running
+        // at the same time on the same file.
+        std::string extension = Filesystem::extension(filename);
+        std::string tmpfilename
+            = Filesystem::replace_extension(filename,
+                                            ".%%%%%%%%.temp" + extension);
+        tmpfilename = Filesystem::unique_path(tmpfilename);
 
-        // We wrote to a temporary file, so now atomically move it to the
-        // original desired location.
-        if (ok && !procedural) {
-            std::string err;
-            ok = Filesystem::rename(tmpfilename, filename, err);
-            if (!ok)
-                ot.errorfmt(
-                    command,
+        // The rest needs nothing more from `ot`, so that it can be done in
+        // the background, after we've moved on, if so requested. Only the
+        // peak memory is still noted as each level is written, and that
+        // in the top-level oiiotool, which outlives all pending writes
+        // (unlike those of frame iterations).
+        std::shared_ptr<ImageOutput> output(std::move(out));
+        bool adjust_time = ot.output_adjust_time;
+        Oiiotool* topot  = &ot;
+        while (topot->parent_oiiotool)
+            topot = topot->parent_oiiotool;
+        auto write = [=, imagecache = ot.imagecache]() {
+            std::string err = write_output(*output, *ir, tmpfilename,
+                                           subimagespecs, levels, [topot]() {
+                                               topot->check_peak_memory();
+                                           });
+            // We wrote to a temporary file, so now atomically move it to
+            // the original desired location.
+            if (err.empty() && !procedural
+                && !Filesystem::rename(tmpfilename, filename, err))
+                err = Strutil::fmt::format(
                     "oiiotool ERROR: could not move temp file {} to {}: {}",
                     tmpfilename, filename, err);
+            if (err.size())
+                Filesystem::remove(tmpfilename);
+            finish_output(*imagecache, filename, err.empty() && adjust_time,
+                          in_time);
+            return err;
+        };
+        if (fileoptions.get_int("async", ot.async_writes)) {
+            ot.queue_write(command, filename, std::move(write));
+        } else {
+            std::string err = write();
+            if (err.size()) {
+                ot.error(command, err);
+                ok = false;
+            }
         }
-        if (!ok)
-            Filesystem::remove(tmpfilename);
-    }
-
-    // Make sure to invalidate any IC entries that think they are the
-    // file we just wrote.
-    ot.imagecache->invalidate(ustring(filename), true);
-
-    if (ot.output_adjust_time && ok) {
-        std::string metadatatime = ir->spec(0, 0)->get_string_attribute(
-            "DateTime");
-        std::time_t in_time = ir->time();
-        if (!metadatatime.empty())
-            DateTime_to_time_t(metadatatime.c_str(), in_time);
-        Filesystem::last_write_time(filename, in_time);
     }
 
     ot.check_peak_memory();
@@ -6515,14 +6828,60 @@ oiiotool_unit_tests(Oiiotool& ot)
 
 
 
+static bool
+branch_safe(CallbackFunction func)
+{
+    // Besides the ops that can be deferred themselves, it's safe to go on
+    // rearranging (only references to) images on the stack. Anything else
+    // might alter, or depend on state altered by, ops still running.
+    return branch_safe_actions().count(func) || func == action_label
+           || func == action_dup || func == action_swap || func == action_pop
+           || func == action_popbottom || func == action_stackreverse;
+}
+
+static bool
+branch_safe(int (*func)(Oiiotool&, cspan<const char*>))
+{
+    // And it's safe to go on reading inputs.
+    return func == input_file;
+}
+
+
+static bool
+write_safe(CallbackFunction func)
+{
+    // Writing only reads images, so other outputs can go ahead too.
+    return branch_safe(func) || func == output_file;
+}
+
+static bool
+write_safe(int (*func)(Oiiotool&, cspan<const char*>))
+{
+    // input_file waits itself, if it's reading a file still being written.
+    return branch_safe(func);
+}
+
+
+
 void
 Oiiotool::getargs(int argc, char* argv[])
 {
     Oiiotool& ot(*this);  // Local reference alias for *this
 
 // Macro that wraps a call to prepend a ref to the ot
-#define OTACTION(act) \
-    action([&ot](cspan<const char*> argv) { return act(ot, argv); })
+// Errors held from ops in branches are reported by wait_for_branches(), and
+// if they aborted the command line, the action is skipped.
+#define OTACTION(act)                                                   \
+    action([&ot](cspan<const char*> argv) -> decltype(act(ot, argv)) { \
+        if (!branch_safe(act)) {                                        \
+            ot.wait_for_branches();                                     \
+            if (ot.ap.aborted())                                        \
+                return decltype(act(ot, argv))();                       \
+        }                                                               \
+        if (!write_safe(act))                                           \
+            ot.wait_for_writes();                                       \
+        return act(ot, argv);                                           \
+    })
 // Macro that wraps a call to an ot method
 #define OTMACTION(act) \
     action([&ot](cspan<const char*> argv) { return ot.act(argv); })
@@ -6607,6 +6966,9 @@ Oiiotool::getargs(int argc, char* argv[])
       .hidden(); // synonym
     ap.arg("--create-dir", &ot.create_dir)
       .help("Create output directories if it doesn't exists");
+    ap.arg("--async-writes")
+      .help("Write outputs in the background, going right on to the next commands (options: queue=N)")
+      .OTACTION(action_async_writes);
     ap.arg("--threads %d:N")
       .help("Number of threads (default 0 == #cores)")
       .OTACTION(set_threads);
@@ -6691,6 +7053,13 @@ Oiiotool::getargs(int argc, char* argv[])
       .help("Skip to next frame in range if there's an error, rather than exiting");
     ap.arg("--parallel-frames")
       .help("Parallelize evaluation of frame range");
+    ap.arg("--parallel-branches")
+      .help("Run independent branches of the command line concurrently (options: maxbranches=N, memory=MB)")
+      .OTACTION(action_parallel_branches);
+    ap.arg("--batch %s:SOURCE", &ot.batch_source)
+      .help("Run the oiiotool command lines read from a file, '-' for stdin, or 'unix:PATH' for a socket, sharing one image cache");
+    ap.arg("--batch-jobs %d:N", &ot.batch_jobs)
+      .help("Number of --batch jobs to run concurrently (default: 1)");
     ap.arg("--wildcardoff")
       .help("Disable numeric wildcard expansion for subsequent command line arguments");
     ap.arg("--wildcardon")
@@ -6713,7 +7082,7 @@ Oiiotool::getargs(int argc, char* argv[])
 
     ap.separator("Commands that read images:");
     ap.arg("-i %s:FILENAME")
-      .help("Input file (options: autocc=, ch=, info=, infoformat=, native=, now=, type=, unpremult=)")
+      .help("Input file (options: autocc=, ch=, colorconvert=, info=, infoformat=, iscolorspace=, native=, now=, type=, unpremult=)")
       .OTACTION(input_file);
     ap.arg("--iconfig %s:NAME %s:VALUE")
       .help("Sets input config attribute (options: type=...)")
@@ -7317,6 +7686,9 @@ one_sequence_iteration(Oiiotool& otmain, size_t i, int frame_number,
     otit.parent_oiiotool          = &otmain;
     otit.m_in_parallel_frame_loop = otmain.in_parallel_frame_loop();
     otit.getargs((int)seq_argv.size(), (char**)&seq_argv[0]);
+    otit.wait_for_branches();
+    // Outputs may still be being written while we go on to the next frame.
+    otit.pass_writes_to(otmain);
 
     if (otit.ap.aborted()) {
         if (!otit.skip_bad_frames) {
@@ -7560,6 +7932,31 @@ handle_sequence(Oiiotool& ot, int argc, const char** argv)
 
 
 
+void
+OiioTool::run_command_line(Oiiotool& ot, int argc, const char** argv)
+{
+    if (handle_sequence(ot, argc, argv)) {
+        // Deal with sequence
+
+    } else {
+        // Not a sequence
+        ot.getargs(argc, (char**)argv);
+        if (!ot.ap.aborted()) {
+            ot.process_pending();
+            if (ot.pending_callback())
+                ot.warning(ot.pending_callback_name(),
+                           "pending command never executed");
+            if (!ot.control_stack.empty())
+                ot.warningfmt(ot.control_stack.top().command, "unterminated {}",
+                              ot.control_stack.top().command);
+        }
+        ot.wait_for_branches();
+    }
+    ot.wait_for_writes();
+}
+
+
+
 void
 Oiiotool::begin_parallel_frame_loop(int nthreads)
 {
@@ -7628,21 +8025,14 @@ main(int argc, char* argv[])
     ot.imagecache->attribute("autoscanline", int(ot.autotile ? 1 : 0));
 
     Filesystem::convert_native_arguments(argc, (const char**)argv);
-    if (handle_sequence(ot, argc, (const char**)argv)) {
-        // Deal with sequence
+    run_command_line(ot, argc, (const char**)argv);
 
-    } else {
-        // Not a sequence
-        ot.getargs(argc, argv);
-        if (!ot.ap.aborted()) {
-            ot.process_pending();
-            if (ot.pending_callback())
-                ot.warning(ot.pending_callback_name(),
-                           "pending command never executed");
-            if (!ot.control_stack.empty())
-                ot.warningfmt(ot.control_stack.top().command, "unterminated {}",
-                              ot.control_stack.top().command);
-        }
+    // --batch: the command line only set up global options; now run the
+    // jobs it named.
+    if (ot.batch_source.size() && !ot.ap.aborted()) {
+        if (!run_batch(ot))
+            ot.return_value = EXIT_FAILURE;
+        ot.printed_info = true;  // Don't warn about the lack of outputs
     }
 
     if (!ot.printinfo && !ot.printstats && !ot.dumpdata && !ot.dryrun
@@ -7674,6 +8064,8 @@ main(int argc, char* argv[])
         if (unaccounted > 0.0)
             Strutil::print("      {:<12} : {:5.2f}\n", "unaccounted",
                            unaccounted);
+        if (ot.m_branches)
+            ot.m_branches->print_stats();
         ot.check_peak_memory();
         OIIO::print("  Peak memory:    {}\n",
                     Strutil::memformat(ot.peak_memory));
@@ -5,9 +5,15 @@
 
 #pragma once
 
+#include <condition_variable>
+#include <deque>
 #include <functional>
+#include <future>
+#include <map>
 #include <memory>
+#include <mutex>
 #include <stack>
+#include <thread>
 
 #include <tsl/robin_set.h>
 
@@ -29,6 +35,7 @@ namespace OiioTool {
 
 class Oiiotool;
 class ImageRec;
+class BranchScheduler;
 typedef std::shared_ptr<ImageRec> ImageRecRef;
 
 typedef void (*CallbackFunction)(Oiiotool& ot, cspan<const char*> argv);
@@ -79,6 +86,8 @@ public:
     int frame_padding;
     bool eval_enable;              // Enable evaluation of expressions
     bool parallel_frames = false;  // Parallelize over frame iteration
+    bool async_writes    = false;  // Write outputs in the background
+    int batch_jobs       = 1;      // Concurrent --batch jobs
     bool skip_bad_frames = false;  // Just skip a bad frame, don't exit
     bool nostderr        = false;  // If true, use stdout for errors
     bool noerrexit       = false;  // Don't exit on error
@@ -89,6 +98,7 @@ public:
     std::string printinfo_nometamatch;
     std::string printinfo_format;
     std::string missingfile_policy;
+    std::string batch_source;       // --batch job file, "-", or socket
     ImageSpec input_config;         // configuration options for reading
     std::string input_channel_set;  // Optional input channel set
     ParamValueList uservars;        // User-defined variables (with --set)
@@ -143,7 +153,8 @@ public:
     std::vector<ImageRecRef> image_stack;  // stack of previous images
     std::map<std::string, ImageRecRef> image_labels;  // labeled images
     std::shared_ptr<ImageCache> imagecache;           // back ptr to ImageCache
-    std::unique_ptr<ColorConfig> m_colorconfig;       // OCIO color config
+    std::shared_ptr<ColorConfig> m_colorconfig;       // OCIO color config
+    std::unique_ptr<BranchScheduler> m_branches;      // --parallel-branches
     Timer total_runtime;
     // total_readtime is the amount of time for direct reads, and does not
     // count time spent inside ImageCache.
@@ -167,10 +178,23 @@ public:
     ImageSpec m_first_input_dimensions;
     mutable spin_mutex m_first_input_dimensions_mutex;
 
+    // Outputs still being written in the background (--async-writes),
+    // each with the command that wrote it, for reporting errors.
+    struct PendingWrite {
+        std::string command;
+        std::string filename;
+        std::shared_future<std::string> done;  // Holds any error message
+    };
+    std::vector<PendingWrite> m_pending_writes;
+    std::mutex m_writes_mutex;
+
     // stat_mutex guards when we are merging another ot's stats into this one
+    // (or when ops running concurrently in different branches update them)
     std::mutex m_stat_mutex;
+    mutable std::mutex m_error_mutex;  // keep concurrent messages whole
 
     Oiiotool();
+    ~Oiiotool();
 
     void clear_options();
     void clear_input_config();
@@ -236,6 +260,30 @@ public:
     // Process any pending commands.
     void process_pending();
 
+    // Turn on (or adjust the limits of) running the independent branches
+    // of the command line concurrently, with at most `maxbranches` ops at
+    // once and, where they can be made to fit, inputs totaling no more
+    // than `memory` bytes.
+    void parallel_branches(int maxbranches, imagesize_t memory);
+    bool parallel_branches() const { return m_branches != nullptr; }
+
+    // Wait for any ops still running in other branches to finish.
+    void wait_for_branches();
+
+    // Run `job`, which writes `filename` and returns an error message (or
+    // an empty string if all went well), in the background.
+    void queue_write(string_view command, string_view filename,
+                     std::function<std::string()> job);
+
+    // Wait for the outputs we're writing in the background to be finished,
+    // and report any errors writing them. Given a filename, just make sure
+    // that that file is done (errors are still saved for later).
+    void wait_for_writes();
+    void wait_for_writes(string_view filename);
+
+    // Leave waiting for the outputs we're still writing to `ot`.
+    void pass_writes_to(Oiiotool& ot);
+
     CallbackFunction pending_callback() const { return m_pending_callback; }
     const char* pending_callback_name() const { return m_pending_argv[0]; }
 
@@ -337,7 +385,8 @@ public:
 
     size_t check_peak_memory()
     {
-        size_t mem  = Sysutil::memory_used();
+        size_t mem = Sysutil::memory_used();
+        std::lock_guard lock(m_stat_mutex);
         peak_memory = std::max(peak_memory, mem);
         return mem;
     }
@@ -519,8 +568,28 @@ public:
              WinMerge pixwin = WinMergeUnion, WinMerge fullwin = WinMergeUnion,
              TypeDesc pixeltype = TypeDesc::UNKNOWN);
 
+    // An ImageRec may stand in for the result of an op that is still
+    // running in another branch (see --parallel-branches). Every accessor
+    // waits for `pending` to be ready, by which time adopt() will have
+    // filled in the real contents.
+    void pending(std::shared_future<void> pending)
+    {
+        m_pending = std::move(pending);
+    }
+    void wait() const
+    {
+        if (m_pending.valid())
+            m_pending.wait();
+    }
+    // Take on the subimages (sharing their ImageBufs) and state of result.
+    void adopt(const ImageRec& result);
+
     // Number of subimages
-    int subimages() const { return (int)m_subimages.size(); }
+    int subimages() const
+    {
+        wait();
+        return (int)m_subimages.size();
+    }
 
     // Number of MIP levels of the given subimage
     int miplevels(int subimage = 0) const
@@ -531,21 +600,41 @@ public:
     }
 
     // Subimage reference accessors.
-    SubimageRec& subimage(int i) { return m_subimages[i]; }
-    const SubimageRec& subimage(int i) const { return m_subimages[i]; }
+    SubimageRec& subimage(int i)
+    {
+        wait();
+        return m_subimages[i];
+    }
+    const SubimageRec& subimage(int i) const
+    {
+        wait();
+        return m_subimages[i];
+    }
 
     // Accessing it like an array returns a specific subimage
-    SubimageRec& operator[](int i) { return m_subimages[i]; }
-    const SubimageRec& operator[](int i) const { return m_subimages[i]; }
+    SubimageRec& operator[](int i) { return subimage(i); }
+    const SubimageRec& operator[](int i) const { return subimage(i); }
 
     // Remove a subimage from the list
-    void erase_subimage(int i) { m_subimages.erase(m_subimages.begin() + i); }
+    void erase_subimage(int i)
+    {
+        wait();
+        m_subimages.erase(m_subimages.begin() + i);
+    }
 
-    string_view name() const { return m_name; }
+    string_view name() const
+    {
+        wait();
+        return m_name;
+    }
 
     // Has the ImageRec been actually read or evaluated?  (Until needed,
     // it's lazily kept as name only, without reading the file.)
-    bool elaborated() const { return m_elaborated; }
+    bool elaborated() const
+    {
+        wait();
+        return m_elaborated;
+    }
 
     // Read just enough to fill in the nativespecs
     bool read_nativespec();
@@ -558,11 +647,11 @@ public:
     // ir() references the first MIP level of the first subimage
     ImageBuf& operator()(int subimg = 0, int mip = 0)
     {
-        return *m_subimages[subimg][mip];
+        return *subimage(subimg)[mip];
     }
     const ImageBuf& operator()(int subimg = 0, int mip = 0) const
     {
-        return *m_subimages[subimg][mip];
+        return *subimage(subimg)[mip];
     }
 
     ImageSpec* spec(int subimg = 0, int mip = 0)
@@ -580,49 +669,98 @@ public:
                                     : nullptr;
     }
 
-    bool was_output() const { return m_was_output; }
-    void was_output(bool val) { m_was_output = val; }
-    bool metadata_modified() const { return m_metadata_modified; }
+    bool was_output() const
+    {
+        wait();
+        return m_was_output;
+    }
+    void was_output(bool val)
+    {
+        wait();
+        m_was_output = val;
+    }
+    bool metadata_modified() const
+    {
+        wait();
+        return m_metadata_modified;
+    }
     void metadata_modified(bool mod)
     {
+        wait();
         m_metadata_modified = mod;
         if (mod)
             was_output(false);
     }
-    bool pixels_modified() const { return m_pixels_modified; }
+    bool pixels_modified() const
+    {
+        wait();
+        return m_pixels_modified;
+    }
     void pixels_modified(bool mod)
     {
+        wait();
         m_pixels_modified = mod;
         if (mod)
             was_output(false);
     }
 
-    std::time_t time() const { return m_time; }
+    std::time_t time() const
+    {
+        wait();
+        return m_time;
+    }
 
     // Request that any eventual input reads be stored internally in this
     // format. UNKNOWN means to use the usual default logic.
     void input_dataformat(TypeDesc dataformat)
     {
+        wait();
         m_input_dataformat = dataformat;
     }
 
+    // Request that the pixels of the first subimage be transformed by
+    // `processor` as they are decoded, rather than in a separate pass
+    // afterwards. Only honored by a read that bypasses the ImageCache;
+    // input_colorconverted() tells whether it was done.
+    void input_colorconvert(ColorProcessorHandle processor, bool unpremult)
+    {
+        wait();
+        m_input_processor = processor;
+        m_input_unpremult = unpremult;
+    }
+    bool input_colorconverted() const
+    {
+        wait();
+        return m_input_colorconverted;
+    }
+
     // This should be called if for some reason the underlying
     // ImageBuf's spec may have been modified in place.  We need to
     // update the outer copy held by the SubimageRec.
     void update_spec_from_imagebuf(int subimg = 0, int mip = 0)
     {
-        *m_subimages[subimg].spec(mip) = m_subimages[subimg][mip]->spec();
+        SubimageRec& sub(subimage(subimg));
+        *sub.spec(mip) = sub[mip]->spec();
         metadata_modified(true);
     }
 
     // Get or set the configuration spec that will be used any time the
     // image is opened.
-    const ImageSpec* configspec() const { return m_configspec.get(); }
+    const ImageSpec* configspec() const
+    {
+        wait();
+        return m_configspec.get();
+    }
     void configspec(const ImageSpec& spec)
     {
+        wait();
         m_configspec.reset(new ImageSpec(spec));
     }
-    void clear_configspec() { m_configspec.reset(); }
+    void clear_configspec()
+    {
+        wait();
+        m_configspec.reset();
+    }
 
     /// Error reporting for ImageRec: call this with printf-like arguments.
     /// Note however that this is fully typesafe!
@@ -650,9 +788,13 @@ private:
     std::vector<SubimageRec> m_subimages;
     std::time_t m_time;  //< Modification time of the input file
     TypeDesc m_input_dataformat;
+    ColorProcessorHandle m_input_processor;
+    bool m_input_unpremult      = false;
+    bool m_input_colorconverted = false;
     std::shared_ptr<ImageCache> m_imagecache;
     mutable std::string m_err;
     std::unique_ptr<ImageSpec> m_configspec;
+    std::shared_future<void> m_pending;  // Not ready while being computed
 
     // Add to the error message
     void append_error(string_view message) const;
@@ -674,6 +816,17 @@ bool
 print_info(std::ostream& out, Oiiotool& ot, ImageRec* img,
            const pvt::print_info_options& opt, std::string& error);
 
+// Run one complete oiiotool command line with `ot`, including any frame
+// range or wildcard iteration, just as main() does with the process's own
+// arguments.
+void
+run_command_line(Oiiotool& ot, int argc, const char** argv);
+
+// Run the stream of --batch jobs named by ot.batch_source. Return false if
+// the source could not be opened.
+bool
+run_batch(Oiiotool& ot);
+
 // Print the stats into output stream `out`.
 void
 print_stats(std::ostream& out, Oiiotool& ot, const std::string& filename,
@@ -754,6 +907,7 @@ public:
     ~OTScopedTimer()
     {
         stop();
+        std::lock_guard lock(m_ot.m_stat_mutex);
         m_ot.function_times[m_name] += m_timer() - m_io_time;
         m_ot.function_times["-i"] += m_io_time;
     }
@@ -766,7 +920,7 @@ public:
         m_timer.start();
         // Record how much time we've spent so far on reads and IC.
         // We will use that to correctly credit each account.
-        m_pre_input_time = m_ot.total_readtime();
+        m_pre_input_time = readtime();
         m_ot.imagecache->getattribute("stat:fileio_time", m_pre_ic_time);
     }
 
@@ -775,8 +929,7 @@ public:
     {
         double ic_time = 0.0;
         m_ot.imagecache->getattribute("stat:fileio_time", ic_time);
-        m_io_time += (ic_time - m_pre_ic_time + m_ot.total_readtime()
-                      - m_pre_input_time);
+        m_io_time += (ic_time - m_pre_ic_time + readtime() - m_pre_input_time);
         m_timer.stop();
     }
 
@@ -784,6 +937,12 @@ public:
     double operator()() { return m_timer(); }
 
 private:
+    double readtime()
+    {
+        std::lock_guard lock(m_ot.m_stat_mutex);
+        return m_ot.total_readtime();
+    }
+
     Timer m_timer;
     Oiiotool& m_ot;
     std::string m_name;
@@ -816,6 +975,8 @@ public:
         : ot(ot)
         , m_nargs((int)argv.size())
         , m_nimages(ninputs + 1)
+        , m_allsubimages(ot.allsubimages)
+        , m_metamerge(ot.metamerge)
         , m_setup_func(setup_func)
         , m_impl_func(impl_func)
     {
@@ -825,8 +986,12 @@ public:
             opname.remove_prefix(1);  // canonicalize to one dash
         m_opname = opname.substr(0, opname.find_first_of(':'));  // and no :
         m_args.reserve(m_nargs);
-        for (int i = 0; i < m_nargs; ++i)
+        for (int i = 0; i < m_nargs; ++i) {
             m_args.push_back(ot.express(argv[i]));
+            // The op may run after argv is gone, so hold on to copies
+            if (ot.parallel_branches())
+                m_args.back() = ustring(m_args.back());
+        }
         m_ir.resize(ninputs + 1);  // including reserving a spot for result
         for (int i = 0; i < ninputs; ++i)
             m_ir[ninputs - i] = ot.pop();
@@ -844,6 +1009,11 @@ public:
     }
     virtual ~OiiotoolOp() {}
 
+    // Run the op: right now, or if --parallel-branches is in effect, on
+    // another thread once its inputs are ready, leaving a placeholder for
+    // the result on the stack in the meantime.
+    static void run(std::shared_ptr<OiiotoolOp> op);
+
     // The operator(), function-call mode, does most of the work. Although
     // it's virtual, in general you shouldn't need to override it. Instead,
     // just override impl() or supply an impl_func at construction.
@@ -863,7 +1033,7 @@ public:
 
         // Parse the options.
         m_options.clear();
-        m_options["allsubimages"] = (int)ot.allsubimages;
+        m_options["allsubimages"] = (int)m_allsubimages;
         m_options                 = ot.extract_options(m_args[0]);
 
         // Read all input images, and reserve (and push) the output image.
@@ -887,7 +1057,9 @@ public:
                 // Not in-place, so make a new output image.
                 m_ir[0] = new_output_imagerec();
             }
-            ot.push(m_ir[0]);
+            // A deferred op's placeholder is already on the stack
+            if (!deferred())
+                ot.push(m_ir[0]);
         }
 
         // Give a chance for customization before we walk the subimages.
@@ -943,7 +1115,7 @@ public:
                         ot.errorfmt(opname(), "{}", m_img[0]->geterror());
 
                     // Merge metadata if called for
-                    if (ot.metamerge)
+                    if (m_metamerge)
                         for (int i = 1; i < nimages(); ++i)
                             m_img[0]->specmod().extra_attribs.merge(
                                 m_img[i]->spec().extra_attribs);
@@ -1050,7 +1222,7 @@ public:
                 all_subimages = 1;
             }
         }
-        all_subimages |= m_options.get_int("allsubimages", ot.allsubimages);
+        all_subimages |= m_options.get_int("allsubimages", m_allsubimages);
 
         // How many subimages are we going to operate on? There are a few
         // strategies for handling the decision when the input images differ
@@ -1158,6 +1330,22 @@ public:
     void inplace(bool val) { m_inplace = val; }
     bool inplace() const { return m_inplace; }
 
+    // Is the op running in its own branch, with a placeholder for its
+    // result already on the stack (see run())?
+    void deferred(bool val) { m_deferred = val; }
+    bool deferred() const { return m_deferred; }
+
+    // For a setup() that finds there's nothing to do: the result is just
+    // another reference to the first input image.
+    void use_input_as_result()
+    {
+        if (!deferred()) {
+            ot.pop();
+            ot.push(ir(1));
+        }
+        m_ir[0] = m_ir[1];
+    }
+
     int current_subimage() const { return m_current_subimage; }
     int current_miplevel() const { return m_current_miplevel; }
 
@@ -1169,6 +1357,11 @@ protected:
     bool m_preserve_miplevels = false;
     bool m_skip_impl          = false;
     bool m_inplace            = false;
+    bool m_deferred           = false;
+    // The global -a and --metamerge settings as of when the op was given
+    // on the command line, in case it doesn't run until later.
+    bool m_allsubimages;
+    bool m_metamerge;
     std::vector<ImageRecRef> m_ir;
     std::vector<ImageBuf*> m_img;
     std::vector<string_view> m_args;
@@ -1185,5 +1378,82 @@ protected:
 };
 
 
+
+/// Runs the ops of independent branches of the command line concurrently,
+/// for --parallel-branches. Each deferred op is a node of a dependency
+/// graph whose edges are the images passed from one op to another. Nodes
+/// wait in a queue until the ops producing their inputs are done and there
+/// is room under the limits on concurrent ops and their memory, and are
+/// then run by a pool of at most `maxbranches` worker threads, whose image
+/// processing draws on the shared thread pool.
+///
+/// Errors that ops running on the workers report are held, and only passed
+/// on to the Oiiotool (which may abort the command line) from the main
+/// thread, when it next waits for the branches.
+class BranchScheduler {
+public:
+    BranchScheduler(Oiiotool& ot, int maxbranches, imagesize_t memory);
+    ~BranchScheduler() { wait_all(); }
+
+    void limits(int maxbranches, imagesize_t memory);
+
+    // Push a placeholder for the result of op onto the stack, and run op
+    // once its inputs are ready.
+    void defer(std::shared_ptr<OiiotoolOp> op);
+
+    // Wait for every deferred op to finish, then report any errors they
+    // ran into.
+    void wait_all();
+
+    // If called from one of our workers, hold the error for wait_all() to
+    // report, and return true. Otherwise, return false.
+    bool defer_error(string_view command, string_view explanation);
+
+    // Print how many ops ran in branches, how many of them at most ran at
+    // once, and the critical path: the chain of dependent ops that took
+    // the longest in total, which bounds the runtime however many branches
+    // run at once.
+    void print_stats() const;
+
+private:
+    struct Node;
+    using NodeRef = std::shared_ptr<Node>;
+
+    // A deferred op waiting in the queue to be run.
+    struct Job {
+        NodeRef node;
+        ImageRecRef result;  // The placeholder, to adopt the op's result
+        std::shared_ptr<OiiotoolOp> op;
+        std::promise<void> done;
+        imagesize_t bytes = 0;  // Memory estimate, once the inputs are ready
+        bool sized        = false;
+    };
+
+    void worker();
+    void run_job(Job& job);
+    // The first queued job that may run now, or m_queue.end(). Call with
+    // m_mutex held.
+    std::deque<Job>::iterator next_job();
+
+    Oiiotool& m_ot;
+    Timer m_timer;
+    // The main thread alone adds nodes and starts and joins the workers.
+    std::vector<NodeRef> m_nodes;  // in order of creation
+    std::map<const ImageRec*, NodeRef> m_producers;  // placeholder -> node
+    std::vector<std::thread> m_workers;
+    // Guarded by m_mutex:
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    std::deque<Job> m_queue;  // in order of creation
+    std::vector<std::pair<std::string, std::string>> m_errors;
+    int m_maxbranches;
+    imagesize_t m_memory;
+    int m_running             = 0;
+    int m_peak_running        = 0;
+    imagesize_t m_memory_used = 0;
+    bool m_stopping           = false;
+};
+
+
 }  // namespace OiioTool
 OIIO_NAMESPACE_END;
@@ -102,6 +102,7 @@ openexr_input_imageio_create()
 
 OIIO_EXPORT const char* openexr_input_extensions[] = { "exr", "sxr", "mxr",
                                                        nullptr };
+OIIO_EXPORT const char* openexr_imageio_signatures[] = { "762f3101", nullptr };
 
 OIIO_PLUGIN_EXPORTS_END
 
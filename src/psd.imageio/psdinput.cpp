@@ -19,6 +19,9 @@
 #include <OpenImageIO/fmath.h>
 #include <OpenImageIO/imagebuf.h>
 #include <OpenImageIO/imagebufalgo.h>
+#include <OpenImageIO/parallel.h>
+#include <OpenImageIO/simd.h>
+#include <OpenImageIO/thread.h>
 #include <OpenImageIO/tiffutils.h>
 
 // #include "jpeg_memory_src.h"
@@ -48,6 +51,8 @@ public:
     bool seek_subimage(int subimage, int miplevel) override;
     bool read_native_scanline(int subimage, int miplevel, int y, int z,
                               void* data) override;
+    bool read_native_scanlines(int subimage, int miplevel, int ybegin,
+                               int yend, int z, void* data) override;
     bool get_thumbnail(ImageBuf& thumb, int subimage) override
     {
         thumb = m_thumbnail;
@@ -137,6 +142,9 @@ private:
         // codecs zip and zipprediction as we need to preallocate
         // the memory this vector is already decompressed and byteswapped
         std::vector<char> decompressed_data;
+        // Zip data that is still waiting to be inflated into
+        // decompressed_data by inflate_layer_channels().
+        bool inflate_pending = false;
 
         std::vector<uint32_t> rle_lengths;
         std::vector<int64_t> row_pos;
@@ -278,6 +286,9 @@ private:
     bool load_layer(Layer& layer);
     bool load_layer_channels(Layer& layer);
     bool load_layer_channel(Layer& layer, ChannelInfo& channel_info);
+    // Read and inflate the zip compressed channels of all layers, in
+    // parallel. Only returns false if the data can't be read.
+    bool inflate_layer_channels();
     bool read_rle_lengths(uint32_t height, std::vector<uint32_t>& rle_lengths);
 
     //Global Mask Info
@@ -299,6 +310,18 @@ private:
 
     //Read a row of channel data
     bool read_channel_row(ChannelInfo& channel_info, uint32_t row, char* data);
+    // Decode a row of channel data whose raw or RLE bytes are already in
+    // memory at src. Safe to call from multiple threads at once; on
+    // failure, err describes the problem.
+    bool decode_channel_row(const ChannelInfo& channel_info, uint32_t row,
+                            const char* src, char* data,
+                            std::string& err) const;
+    // Turn decoded channel rows into one scanline of the subimage: color
+    // conversion, interleaving, and alpha handling.
+    void convert_row(int subimage,
+                     cspan<std::vector<unsigned char>> channel_buffers,
+                     void* data) const;
+    bool supported_color_mode() const;
 
     // Interleave channels (RRRGGGBBB -> RGBRGBRGB) while copying from
     // channel_buffers[0..nchans-1] to dst.
@@ -431,15 +454,21 @@ private:
 
     // Swap a planar bytespan representing the bytes of a float vector to its
     // interleaved byte order. This is per scanline
-    void float_planar_to_interleaved(span<char> data, size_t width,
-                                     size_t height);
-
-    // All the compression modes known to photoshop
-    bool decompress_packbits(const char* src, char* dst, uint32_t packed_length,
-                             uint32_t unpacked_length);
-    bool decompress_zip(span<char> src, span<char> dest);
+    static void float_planar_to_interleaved(span<char> data, size_t width,
+                                            size_t height);
+
+    // All the compression modes known to photoshop. These don't touch the
+    // ImageInput state, so that channels may be decoded in parallel; any
+    // error is described in err.
+    static bool decompress_packbits(const char* src, char* dst,
+                                    uint32_t packed_length,
+                                    uint32_t unpacked_length,
+                                    std::string& err);
+    static bool decompress_zip(span<char> src, span<char> dest,
+                               std::string& err);
     bool decompress_zip_prediction(span<char> src, span<char> dest,
-                                   const uint32_t width, const uint32_t height);
+                                   const uint32_t width, const uint32_t height,
+                                   std::string& err) const;
 
     // These are AdditionalInfo entries that, for PSBs, have an 8-byte length
     static const char* additional_info_psb[];
@@ -543,6 +572,10 @@ psd_imageio_library_version()
 
 OIIO_EXPORT const char* psd_input_extensions[] = { "psd", "pdd", "psb",
                                                    nullptr };
+OIIO_EXPORT const char* psd_imageio_signatures[] = {
+    "38425053",  // 8BPS
+    nullptr
+};
 
 OIIO_PLUGIN_EXPORTS_END
 
@@ -773,12 +806,15 @@ PSDInput::read_native_scanline(int subimage, int miplevel, int y, int /*z*/,
         return false;
     }
 
+    if (!supported_color_mode()) {
+        errorfmt("Unknown color mode: {:d}", m_header.color_mode);
+        return false;
+    }
+
     // Buffers for channel data, one per channel
     std::vector<std::vector<unsigned char>> channel_buffers;
     channel_buffers.resize(m_channels[subimage].size());
 
-    int bps = (m_header.depth + 7) / 8;  // bytes per sample
-    OIIO_DASSERT(bps == 1 || bps == 2 || bps == 4);
     std::vector<ChannelInfo*>& channels = m_channels[subimage];
     int channel_count                   = (int)channels.size();
     for (int c = 0; c < channel_count; ++c) {
@@ -787,7 +823,117 @@ PSDInput::read_native_scanline(int subimage, int miplevel, int y, int /*z*/,
         if (!read_channel_row(channel_info, y, (char*)channel_buffers[c].data()))
             return false;
     }
-    // OIIO_ASSERT(m_channels[subimage].size() == size_t(spec.nchannels));
+    convert_row(subimage, channel_buffers, data);
+    return true;
+#undef DEB
+}
+
+
+
+bool
+PSDInput::read_native_scanlines(int subimage, int miplevel, int ybegin,
+                                int yend, int z, void* data)
+{
+    if (subimage < 0 || subimage >= m_subimage_count || miplevel != 0)
+        return false;
+    const ImageSpec& spec = m_specs[subimage];
+    yend                  = std::min(yend, spec.y + spec.height);
+    if (yend - ybegin < 2 || ybegin < spec.y)
+        return ImageInput::read_native_scanlines(subimage, miplevel, ybegin,
+                                                 yend, z, data);
+    if (!supported_color_mode()) {
+        errorfmt("Unknown color mode: {:d}", m_header.color_mode);
+        return false;
+    }
+
+    lock_guard lock(*this);
+    std::vector<ChannelInfo*>& channels = m_channels[subimage];
+    size_t channel_count                = channels.size();
+    uint32_t row0                       = uint32_t(ybegin - spec.y);
+    uint32_t nrows                      = uint32_t(yend - ybegin);
+
+    // The rows of each channel are stored back to back, so fetch the whole
+    // band of still-compressed rows of a channel with one read. Channels
+    // that were zip compressed are already inflated in memory.
+    std::vector<std::vector<char>> packed(channel_count);
+    for (size_t c = 0; c < channel_count; ++c) {
+        const ChannelInfo& channel_info = *channels[c];
+        if (row0 + nrows > channel_info.row_pos.size()) {
+            errorfmt("Reading channel row out of range ({}, should be < {})",
+                     row0 + nrows - 1, channel_info.row_pos.size());
+            return false;
+        }
+        if (channel_info.compression != Compression_Raw
+            && channel_info.compression != Compression_RLE)
+            continue;
+        uint32_t last = row0 + nrows - 1;
+        int64_t begin = channel_info.row_pos[row0];
+        int64_t end   = channel_info.row_pos[last]
+                      + (channel_info.compression == Compression_RLE
+                             ? channel_info.rle_lengths[last]
+                             : channel_info.row_length);
+        if (end < begin || uint64_t(end) > ioproxy()->size()) {
+            errorfmt("Corrupt PSD file: channel data is past the end of the "
+                     "file");
+            return false;
+        }
+        packed[c].resize(end - begin);
+        if (!ioseek(begin) || !ioread(packed[c].data(), packed[c].size()))
+            return false;
+    }
+
+    // Decompress and convert bands of rows in parallel. Errors can't be
+    // reported from the worker threads, so remember the first one.
+    size_t ystride = spec.scanline_bytes(true);
+    std::string firsterr;
+    spin_mutex err_mutex;
+    parallel_for_chunked(
+        0, nrows, 0,
+        [&](int64_t yb, int64_t ye) {
+            std::vector<std::vector<unsigned char>> channel_buffers(
+                channel_count);
+            for (size_t c = 0; c < channel_count; ++c)
+                channel_buffers[c].resize(channels[c]->row_length);
+            std::string err;
+            for (int64_t y = yb; y < ye; ++y) {
+                uint32_t row = row0 + uint32_t(y);
+                for (size_t c = 0; c < channel_count; ++c) {
+                    const ChannelInfo& channel_info = *channels[c];
+                    const char* src = nullptr;
+                    if (packed[c].size())
+                        src = packed[c].data()
+                              + (channel_info.row_pos[row]
+                                 - channel_info.row_pos[row0]);
+                    if (!decode_channel_row(channel_info, row, src,
+                                            (char*)channel_buffers[c].data(),
+                                            err)) {
+                        spin_lock lock(err_mutex);
+                        if (firsterr.empty())
+                            firsterr = err;
+                        return;
+                    }
+                }
+                convert_row(subimage, channel_buffers,
+                            (char*)data + y * ystride);
+            }
+        },
+        paropt(threads()));
+    if (firsterr.size()) {
+        errorfmt("{}", firsterr);
+        return false;
+    }
+    return true;
+}
+
+
+void
+PSDInput::convert_row(int subimage,
+                      cspan<std::vector<unsigned char>> channel_buffers,
+                      void* data) const
+{
+    const ImageSpec& spec = m_specs[subimage];
+    int bps               = (m_header.depth + 7) / 8;  // bytes per sample
+    int channel_count     = (int)channel_buffers.size();
     char* dst = (char*)data;
     if (m_WantRaw || m_header.color_mode == ColorMode_RGB
         || m_header.color_mode == ColorMode_Multichannel
@@ -841,19 +987,15 @@ PSDInput::read_native_scanline(int subimage, int miplevel, int y, int /*z*/,
         }
         }
     } else if (m_header.color_mode == ColorMode_Indexed) {
-        if (!indexed_to_rgb({ (unsigned char*)dst,
-                              span_size_t(spec.width * spec.nchannels) },
-                            channel_buffers[0], spec.width))
-            return false;
+        indexed_to_rgb({ (unsigned char*)dst,
+                         span_size_t(spec.width * spec.nchannels) },
+                       channel_buffers[0], spec.width);
     } else if (m_header.color_mode == ColorMode_Bitmap) {
-        if (!bitmap_to_rgb({ (unsigned char*)dst,
-                             span_size_t(spec.width * spec.nchannels) },
-                           channel_buffers[0], spec.width))
-            return false;
+        bitmap_to_rgb({ (unsigned char*)dst,
+                        span_size_t(spec.width * spec.nchannels) },
+                      channel_buffers[0], spec.width);
     } else {
-        errorfmt("Unknown color mode: {:d}", m_header.color_mode);
         OIIO_ASSERT(0 && "unknown color mode");
-        return false;
     }
 
     // PSD specifically dictates unassociated (un-"premultiplied") alpha.
@@ -889,9 +1031,22 @@ PSDInput::read_native_scanline(int subimage, int miplevel, int y, int /*z*/,
             }
         }
     }
+}
 
-    return true;
-#undef DEB
+
+
+bool
+PSDInput::supported_color_mode() const
+{
+    switch (m_header.color_mode) {
+    case ColorMode_Bitmap:
+    case ColorMode_Grayscale:
+    case ColorMode_Indexed:
+    case ColorMode_RGB:
+    case ColorMode_CMYK:
+    case ColorMode_Multichannel: return true;
+    default: return m_WantRaw;
+    }
 }
 
 
@@ -1483,6 +1638,8 @@ PSDInput::load_layers()
         if (!load_layer_channels(layer))
             return false;
     }
+    if (!inflate_layer_channels())
+        return false;
     return ok;
 }
 
@@ -1672,41 +1829,25 @@ PSDInput::load_layer_channel(Layer& layer, ChannelInfo& channel_info)
         if (!ioseek(channel_info.data_length, SEEK_CUR))
             return false;
         break;
-    case Compression_ZIP: {
-        // We subtract the compression marker from the data length
-        channel_info.data_length -= 2;
-
-        // Unlike with raw and rle compression we cannot access each scanline
-        // randomly so we parse the data up-front and store it
-        std::vector<char> compressed_data(channel_info.data_length);
-        channel_info.decompressed_data = std::vector<char>(
-            width * height * (m_header.depth / 8));
-
-        if (!ioseek(channel_info.data_pos))
-            return false;
-        if (!ioread(compressed_data.data(), channel_info.data_length))
-            return false;
-
-        decompress_zip(compressed_data, channel_info.decompressed_data);
-    } break;
+    case Compression_ZIP:
     case Compression_ZIP_Predict: {
         // We subtract the compression marker from the data length
         channel_info.data_length -= 2;
 
         // Unlike with raw and rle compression we cannot access each scanline
-        // randomly so we parse the data up-front and store it
-        std::vector<char> compressed_data(channel_info.data_length);
+        // randomly so we decompress the data up-front. That's done (for all
+        // layers at once, in parallel) by inflate_layer_channels().
+        if (channel_info.data_pos + channel_info.data_length
+            > ioproxy()->size()) {
+            errorfmt("[Layer Channel] data is past the end of the file");
+            return false;
+        }
         channel_info.decompressed_data = std::vector<char>(
             width * height * (m_header.depth / 8));
+        channel_info.inflate_pending = true;
 
-        if (!ioseek(channel_info.data_pos))
-            return false;
-        if (!ioread(compressed_data.data(), channel_info.data_length))
+        if (!ioseek(channel_info.data_pos + channel_info.data_length))
             return false;
-
-        decompress_zip_prediction(compressed_data,
-                                  channel_info.decompressed_data, width,
-                                  height);
     } break;
     default:
         errorfmt("[Layer Channel] unsupported compression {}",
@@ -1718,6 +1859,73 @@ PSDInput::load_layer_channel(Layer& layer, ChannelInfo& channel_info)
 
 
 
+bool
+PSDInput::inflate_layer_channels()
+{
+    std::vector<ChannelInfo*> pending;
+    for (Layer& layer : m_layers)
+        for (ChannelInfo& channel_info : layer.channel_info)
+            if (channel_info.inflate_pending)
+                pending.push_back(&channel_info);
+    if (pending.empty())
+        return true;
+
+    // Layered documents commonly have dozens of zip compressed channels,
+    // each one an independent zlib stream, so inflate them in parallel.
+    // Rather than holding the compressed data of every layer in memory at
+    // once, read the channels in batches of at most this many bytes (or a
+    // single channel, if it's bigger than that).
+    const uint64_t max_batch_bytes = uint64_t(256) << 20;
+    int64_t pos                    = iotell();
+    std::vector<std::vector<char>> compressed;
+    std::vector<std::string> errors;
+    for (size_t first = 0, last = 0; first < pending.size(); first = last) {
+        uint64_t batch_bytes = 0;
+        for (last = first; last < pending.size(); ++last) {
+            uint64_t bytes = pending[last]->data_length;
+            if (last > first && batch_bytes + bytes > max_batch_bytes)
+                break;
+            batch_bytes += bytes;
+        }
+        compressed.resize(last - first);
+        for (size_t i = first; i < last; ++i) {
+            ChannelInfo& channel_info = *pending[i];
+            std::vector<char>& data   = compressed[i - first];
+            data.resize(channel_info.data_length);
+            if (!ioseek(channel_info.data_pos)
+                || !ioread(data.data(), data.size()))
+                return false;
+            channel_info.inflate_pending = false;
+        }
+        errors.assign(last - first, std::string());
+        OIIO::parallel_for(
+            int64_t(first), int64_t(last),
+            [&](int64_t i) {
+                ChannelInfo& channel_info = *pending[i];
+                std::vector<char>& data   = compressed[i - first];
+                if (channel_info.compression == Compression_ZIP)
+                    decompress_zip(data, channel_info.decompressed_data,
+                                   errors[i - first]);
+                else
+                    decompress_zip_prediction(data,
+                                              channel_info.decompressed_data,
+                                              channel_info.width,
+                                              channel_info.height,
+                                              errors[i - first]);
+                std::vector<char>().swap(data);
+            },
+            paropt(threads()).minitems(1));
+        // As before, a channel that fails to inflate doesn't fail open(),
+        // but the error is reported.
+        for (const std::string& err : errors)
+            if (err.size())
+                errorfmt("{}", err);
+    }
+    return ioseek(pos);
+}
+
+
+
 bool
 PSDInput::read_rle_lengths(uint32_t height, std::vector<uint32_t>& rle_lengths)
 {
@@ -1868,6 +2076,8 @@ PSDInput::load_layers_16_32(uint64_t length)
         if (!load_layer_channels(layer))
             return false;
     }
+    if (!inflate_layer_channels())
+        return false;
 
     // This section, like the other tagged blocks are padded to 4 bytes
     uint64_t length_read = iotell() - begin;
@@ -2043,19 +2253,14 @@ PSDInput::read_channel_row(ChannelInfo& channel_info, uint32_t row, char* data)
         return false;
     }
 
+    std::string err;
     switch (channel_info.compression) {
     case Compression_Raw:
         if (!ioseek(channel_info.row_pos[row]))
             return false;
         if (!ioread(data, channel_info.row_length))
             return false;
-
-        if (!bigendian()) {
-            switch (m_header.depth) {
-            case 16: swap_endian((uint16_t*)data, channel_info.width); break;
-            case 32: swap_endian((uint32_t*)data, channel_info.width); break;
-            }
-        }
+        decode_channel_row(channel_info, row, data, data, err);
         break;
     case Compression_RLE: {
         if (!ioseek(channel_info.row_pos[row]))
@@ -2063,33 +2268,60 @@ PSDInput::read_channel_row(ChannelInfo& channel_info, uint32_t row, char* data)
         uint32_t rle_length = channel_info.rle_lengths[row];
         char* rle_buffer;
         OIIO_ALLOCATE_STACK_OR_HEAP(rle_buffer, char, rle_length);
-        if (!ioread(rle_buffer, rle_length)
-            || !decompress_packbits(rle_buffer, data, rle_length,
-                                    channel_info.row_length))
+        if (!ioread(rle_buffer, rle_length))
             return false;
+        if (!decode_channel_row(channel_info, row, rle_buffer, data, err)) {
+            errorfmt("{}", err);
+            return false;
+        }
     } break;
-    case Compression_ZIP: {
-        OIIO_ASSERT(channel_info.decompressed_data.size()
-                    == static_cast<uint64_t>(channel_info.width)
-                           * channel_info.height * (m_header.depth / 8));
-        // We simply copy over the row into destination
-        uint64_t row_index = static_cast<uint64_t>(row) * channel_info.width
-                             * (m_header.depth / 8);
-        std::memcpy(data, channel_info.decompressed_data.data() + row_index,
-                    channel_info.row_length);
-    } break;
+    case Compression_ZIP:
+    case Compression_ZIP_Predict:
+        decode_channel_row(channel_info, row, nullptr, data, err);
+        break;
+    }
+
+    return true;
+}
+
+
+
+bool
+PSDInput::decode_channel_row(const ChannelInfo& channel_info, uint32_t row,
+                             const char* src, char* data,
+                             std::string& err) const
+{
+    switch (channel_info.compression) {
+    case Compression_Raw:
+        if (src != data)
+            std::memcpy(data, src, channel_info.row_length);
+        break;
+    case Compression_RLE:
+        if (!decompress_packbits(src, data, channel_info.rle_lengths[row],
+                                 channel_info.row_length, err))
+            return false;
+        break;
+    case Compression_ZIP:
     case Compression_ZIP_Predict: {
         OIIO_ASSERT(channel_info.decompressed_data.size()
                     == static_cast<uint64_t>(channel_info.width)
                            * channel_info.height * (m_header.depth / 8));
-        // We simply copy over the row into destination
+        // We simply copy over the row into destination, it was already
+        // byteswapped when it was inflated.
         uint64_t row_index = static_cast<uint64_t>(row) * channel_info.width
                              * (m_header.depth / 8);
         std::memcpy(data, channel_info.decompressed_data.data() + row_index,
                     channel_info.row_length);
-    } break;
+        return true;
+    }
     }
 
+    if (!bigendian()) {
+        switch (m_header.depth) {
+        case 16: swap_endian((uint16_t*)data, channel_info.width); break;
+        case 32: swap_endian((uint32_t*)data, channel_info.width); break;
+        }
+    }
     return true;
 }
 
@@ -2101,10 +2333,49 @@ PSDInput::interleave_row(T* dst,
                          cspan<std::vector<unsigned char>> channel_buffers,
                          int width, int nchans)
 {
+    int x = 0;
+    if (nchans == 4 && sizeof(T) == 4) {
+        // The common RGBA float case: load 4 values of each channel and
+        // transpose them into 4 interleaved pixels.
+        const int* r = reinterpret_cast<const int*>(channel_buffers[0].data());
+        const int* g = reinterpret_cast<const int*>(channel_buffers[1].data());
+        const int* b = reinterpret_cast<const int*>(channel_buffers[2].data());
+        const int* a = reinterpret_cast<const int*>(channel_buffers[3].data());
+        int* d       = reinterpret_cast<int*>(dst);
+        for (; x + 4 <= width; x += 4) {
+            simd::vint4 p0(r + x), p1(g + x), p2(b + x), p3(a + x);
+            simd::transpose(p0, p1, p2, p3);
+            p0.store(d + 4 * x);
+            p1.store(d + 4 * x + 4);
+            p2.store(d + 4 * x + 8);
+            p3.store(d + 4 * x + 12);
+        }
+    } else if (nchans == 3 || nchans == 4) {
+        // Walk the pixels with a fixed channel count rather than striding
+        // through dst once per channel.
+        const T* cbuf[4];
+        for (int c = 0; c < nchans; ++c)
+            cbuf[c] = reinterpret_cast<const T*>(channel_buffers[c].data());
+        if (nchans == 3) {
+            for (; x < width; ++x) {
+                dst[3 * x + 0] = cbuf[0][x];
+                dst[3 * x + 1] = cbuf[1][x];
+                dst[3 * x + 2] = cbuf[2][x];
+            }
+        } else {
+            for (; x < width; ++x) {
+                dst[4 * x + 0] = cbuf[0][x];
+                dst[4 * x + 1] = cbuf[1][x];
+                dst[4 * x + 2] = cbuf[2][x];
+                dst[4 * x + 3] = cbuf[3][x];
+            }
+        }
+    }
+    // Any other channel count, and whatever is left over from above
     for (int c = 0; c < nchans; ++c) {
         const T* cbuf = reinterpret_cast<const T*>(channel_buffers[c].data());
-        for (int x = 0; x < width; ++x)
-            dst[nchans * x + c] = cbuf[x];
+        for (int xx = x; xx < width; ++xx)
+            dst[nchans * xx + c] = cbuf[xx];
     }
 }
 
@@ -2210,37 +2481,40 @@ void
 PSDInput::float_planar_to_interleaved(span<char> data, size_t width,
                                       size_t height)
 {
-    std::vector<char> buffer(data.size());
-
-    // Shuffle from planar 1111... 2222... 3333... 4444... byte order to 1234 1234 1234 1234...
+    // Shuffle from planar 1111... 2222... 3333... 4444... byte order to
+    // 1234 1234 1234 1234..., one scanline at a time through a row buffer.
+    // Each output word is assembled from the four byte planes with shifts.
+    std::vector<uint32_t> buffer(width);
+    const int s0 = littleendian() ? 0 : 24;
+    const int s1 = littleendian() ? 8 : 16;
+    const int s2 = littleendian() ? 16 : 8;
+    const int s3 = littleendian() ? 24 : 0;
     for (uint64_t y = 0; y < height; ++y) {
-        for (uint64_t x = 0; x < width; ++x) {
-            uint64_t rowIndex = y * width * sizeof(float);
-
-            buffer[rowIndex + x * sizeof(float) + 0] = data[rowIndex + x];
-            buffer[rowIndex + x * sizeof(float) + 1]
-                = data[rowIndex + width + x];
-            buffer[rowIndex + x * sizeof(float) + 2]
-                = data[rowIndex + width * 2 + x];
-            buffer[rowIndex + x * sizeof(float) + 3]
-                = data[rowIndex + width * 3 + x];
-        }
+        const uint8_t* p0 = reinterpret_cast<const uint8_t*>(data.data())
+                            + y * width * sizeof(float);
+        const uint8_t* p1 = p0 + width;
+        const uint8_t* p2 = p0 + width * 2;
+        const uint8_t* p3 = p0 + width * 3;
+        for (uint64_t x = 0; x < width; ++x)
+            buffer[x] = (uint32_t(p0[x]) << s0) | (uint32_t(p1[x]) << s1)
+                        | (uint32_t(p2[x]) << s2) | (uint32_t(p3[x]) << s3);
+        std::memcpy(data.data() + y * width * sizeof(float), buffer.data(),
+                    width * sizeof(float));
     }
-    std::memcpy(data.data(), buffer.data(), buffer.size());
 }
 
 
 
 bool
 PSDInput::decompress_packbits(const char* src, char* dst,
-                              uint32_t packed_length, uint32_t unpacked_length)
+                              uint32_t packed_length, uint32_t unpacked_length,
+                              std::string& err)
 {
     int32_t src_remaining = packed_length;
     int32_t dst_remaining = unpacked_length;
     int16_t header;
     int length;
 
-    char* dst_start = dst;
     while (src_remaining > 0 && dst_remaining > 0) {
         header = *reinterpret_cast<const signed char*>(src);
         src++;
@@ -2254,7 +2528,7 @@ PSDInput::decompress_packbits(const char* src, char* dst,
             src_remaining -= length;
             dst_remaining -= length;
             if (src_remaining < 0 || dst_remaining < 0) {
-                errorfmt(
+                err = Strutil::fmt::format(
                     "unable to decode packbits (case 1, literal bytes: src_rem={}, dst_rem={}, len={})",
                     src_remaining, dst_remaining, length);
                 return false;
@@ -2269,7 +2543,7 @@ PSDInput::decompress_packbits(const char* src, char* dst,
             src_remaining--;
             dst_remaining -= length;
             if (src_remaining < 0 || dst_remaining < 0) {
-                errorfmt(
+                err = Strutil::fmt::format(
                     "unable to decode packbits (case 2, repeating byte: src_rem={}, dst_rem={}, len={})",
                     src_remaining, dst_remaining, length);
                 return false;
@@ -2280,21 +2554,13 @@ PSDInput::decompress_packbits(const char* src, char* dst,
             dst += length;
         }
     }
-
-    if (!bigendian()) {
-        switch (m_header.depth) {
-        case 16: swap_endian((uint16_t*)dst_start, m_spec.width); break;
-        case 32: swap_endian((uint32_t*)dst_start, m_spec.width); break;
-        }
-    }
-
     return true;
 }
 
 
 
 bool
-PSDInput::decompress_zip(span<char> src, span<char> dest)
+PSDInput::decompress_zip(span<char> src, span<char> dest, std::string& err)
 {
     z_stream stream {};
     stream.zfree     = Z_NULL;
@@ -2305,21 +2571,21 @@ PSDInput::decompress_zip(span<char> src, span<char> dest)
     stream.next_out  = (Bytef*)dest.data();
 
     if (inflateInit(&stream) != Z_OK) {
-        errorfmt(
+        err = Strutil::fmt::format(
             "zip compression inflate init failed with: src_size={}, dst_size={}",
             src.size(), dest.size());
         return false;
     }
 
     if (inflate(&stream, Z_FINISH) != Z_STREAM_END) {
-        errorfmt(
+        err = Strutil::fmt::format(
             "unable to decode zip compressed data: src_size={}, dst_size={}",
             src.size(), dest.size());
         return false;
     }
 
     if (inflateEnd(&stream) != Z_OK) {
-        errorfmt(
+        err = Strutil::fmt::format(
             "zip compression inflate cleanup failed with: src_size={}, dst_size={}",
             src.size(), dest.size());
         return false;
@@ -2332,13 +2598,14 @@ PSDInput::decompress_zip(span<char> src, span<char> dest)
 
 bool
 PSDInput::decompress_zip_prediction(span<char> src, span<char> dest,
-                                    const uint32_t width, const uint32_t height)
+                                    const uint32_t width, const uint32_t height,
+                                    std::string& err) const
 {
     OIIO_ASSERT(width * height * (m_header.depth / 8) == dest.size());
     bool ok = true;
     // Decompress into dest first and then apply the prediction decoding
     // on dest
-    ok &= decompress_zip(src, dest);
+    ok &= decompress_zip(src, dest, err);
 
     switch (m_header.depth) {
     case 8:
@@ -2389,7 +2656,8 @@ PSDInput::decompress_zip_prediction(span<char> src, span<char> dest,
                                dest.size() / 4));
     } break;
     default:
-        errorfmt("Unknown bitdepth: {} encountered", m_header.depth);
+        err = Strutil::fmt::format("Unknown bitdepth: {} encountered",
+                                   m_header.depth);
         return false;
     }
 
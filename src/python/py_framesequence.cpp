@@ -0,0 +1,84 @@
+// Copyright Contributors to the OpenImageIO project.
+// SPDX-License-Identifier: Apache-2.0
+// https://github.com/AcademySoftwareFoundation/OpenImageIO
+
+#include "py_oiio.h"
+
+
+namespace PyOpenImageIO {
+
+
+void
+declare_framesequencereader(py::module& m)
+{
+    using namespace pybind11::literals;
+
+    py::class_<FrameSequenceReader>(m, "FrameSequenceReader")
+        .def(py::init<>())
+        .def("set_readahead", &FrameSequenceReader::set_readahead,
+             "nframes"_a)
+        .def("set_memory_limit", &FrameSequenceReader::set_memory_limit,
+             "megabytes"_a)
+        .def("set_threads", &FrameSequenceReader::set_threads, "nthreads"_a)
+        .def("set_format", &FrameSequenceReader::set_format, "format"_a)
+        .def(
+            "open",
+            [](FrameSequenceReader& self, const std::string& pattern,
+               const std::string& framespec, int framepadding) {
+                py::gil_scoped_release gil;
+                return self.open(pattern, framespec, framepadding);
+            },
+            "pattern"_a, "framespec"_a = "", "framepadding"_a = 0)
+        .def(
+            "open_files",
+            [](FrameSequenceReader& self,
+               const std::vector<std::string>& filenames,
+               const std::vector<int>& frame_numbers) {
+                py::gil_scoped_release gil;
+                return self.open_files(filenames, frame_numbers);
+            },
+            "filenames"_a, "frame_numbers"_a = std::vector<int>())
+        .def(
+            "close",
+            [](FrameSequenceReader& self) {
+                py::gil_scoped_release gil;
+                self.close();
+            })
+        .def("is_open", &FrameSequenceReader::is_open)
+        .def_property_readonly("nframes", &FrameSequenceReader::nframes)
+        .def("filename", &FrameSequenceReader::filename, "index"_a)
+        .def("frame_number", &FrameSequenceReader::frame_number, "index"_a)
+        .def(
+            "spec",
+            [](FrameSequenceReader& self, int index) -> py::object {
+                const ImageSpec* spec = nullptr;
+                {
+                    py::gil_scoped_release gil;
+                    spec = self.spec(index);
+                }
+                if (!spec)
+                    return py::none();
+                return py::cast(*spec);
+            },
+            "index"_a)
+        .def_property_readonly("position", &FrameSequenceReader::position)
+        // Return the next frame as an ImageBuf, or None if there are no
+        // more frames or it could not be read (see geterror()).
+        .def("next",
+             [](FrameSequenceReader& self) -> py::object {
+                 ImageBuf frame;
+                 bool ok;
+                 {
+                     py::gil_scoped_release gil;
+                     ok = self.next(frame);
+                 }
+                 if (!ok)
+                     return py::none();
+                 return py::cast(std::move(frame));
+             })
+        .def("seek", &FrameSequenceReader::seek, "index"_a)
+        .def("has_error", &FrameSequenceReader::has_error)
+        .def("geterror", &FrameSequenceReader::geterror, "clear"_a = true);
+}
+
+}  // namespace PyOpenImageIO
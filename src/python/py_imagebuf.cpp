@@ -5,6 +5,7 @@
 #include "py_oiio.h"
 
 #include <memory>
+#include <unordered_map>
 
 #include <OpenImageIO/filesystem.h>
 #include <OpenImageIO/platform.h>
@@ -14,8 +15,14 @@ namespace PyOpenImageIO {
 
 
 
+// Construct an ImageBuf from a Python buffer (such as a NumPy array) laid
+// out as [y][x] (one channel), [y][x][c], or [z][y][x][c]. If `wrap` is
+// false, the pixels are copied into a new LOCALBUFFER ImageBuf. If `wrap` is
+// true, the ImageBuf is an APPBUFFER that uses the buffer's memory directly
+// (read-only if the buffer is), and the caller must keep the buffer alive
+// for as long as the ImageBuf.
 static ImageBuf
-ImageBuf_from_buffer(const py::buffer& buffer)
+ImageBuf_from_buffer(const py::buffer& buffer, bool wrap = false)
 {
     ImageBuf ib;
     const py::buffer_info info = buffer.request();
@@ -67,17 +74,146 @@ ImageBuf_from_buffer(const py::buffer& buffer)
     ImageSpec spec(width, height, nchans, format);
     spec.depth      = depth;
     spec.full_depth = depth;
-    ib.reset(spec, InitializePixels::No);
-    image_span<const std::byte> bufspan(reinterpret_cast<std::byte*>(info.ptr),
-                                        nchans, width, height, depth,
-                                        format.size(), xstride, ystride,
-                                        zstride, format.size());
-    ib.set_pixels(get_roi(spec), format, bufspan);
+    image_span<std::byte> bufspan(reinterpret_cast<std::byte*>(info.ptr),
+                                  nchans, width, height, depth, format.size(),
+                                  xstride, ystride, zstride, format.size());
+    if (wrap && info.readonly) {
+        ib.reset(spec, image_span<const std::byte>(bufspan));
+    } else if (wrap) {
+        ib.reset(spec, bufspan);
+    } else {
+        ib.reset(spec, InitializePixels::No);
+        ib.set_pixels(get_roi(spec), format,
+                      image_span<const std::byte>(bufspan));
+    }
     return ib;
 }
 
 
 
+// Describe the in-memory pixels of an ImageBuf to the Python buffer
+// protocol as [y][x][c] (or [z][y][x][c] for a volume) with the ImageBuf's
+// own strides, so that `numpy.asarray(buf)` is a view of the pixels rather
+// than a copy. Python keeps the ImageBuf alive while the view exists, and
+// the view holds ImageBuf::localpixels_owner(), so that the memory stays
+// valid even if something reallocates the ImageBuf's pixels. The bindings
+// that would do so directly refuse to while views exist (see
+// ImageBufReallocGuard).
+static py::buffer_info
+ImageBuf_buffer_info(ImageBuf& self)
+{
+    const ImageSpec& spec(self.spec());
+    std::string code = python_array_code(spec.format);
+    if (self.deep() || !self.localpixels() || code.empty())
+        throw py::buffer_error(
+            "ImageBuf pixels are not in memory in a buffer-compatible type");
+    bool readonly  = self.localpixels_as_writable_byte_image_span().empty();
+    void* pixels   = self.localpixels();
+    py::ssize_t sz = py::ssize_t(spec.format.size());
+    std::vector<py::ssize_t> shape, strides;
+    if (spec.depth > 1) {
+        shape.assign({ spec.depth, spec.height, spec.width, spec.nchannels });
+        strides.assign({ self.z_stride(), self.scanline_stride(),
+                         self.pixel_stride(), sz });
+    } else {
+        shape.assign({ spec.height, spec.width, spec.nchannels });
+        strides.assign({ self.scanline_stride(), self.pixel_stride(), sz });
+    }
+    return py::buffer_info(pixels, sz, code, py::ssize_t(shape.size()), shape,
+                           strides, readonly);
+}
+
+
+
+// For each ImageBuf, the number of live buffer views of its pixels, or if
+// negative, the number of ImageBufReallocGuards on it. Only accessed with
+// the GIL held.
+static std::unordered_map<const ImageBuf*, int> ImageBuf_exports;
+static getbufferproc pybind_getbuffer         = nullptr;
+static releasebufferproc pybind_releasebuffer = nullptr;
+// The pixel memory each live view refers to, kept allocated until the view
+// is released. Only accessed with the GIL held.
+static std::unordered_map<const Py_buffer*, std::shared_ptr<void>>
+    ImageBuf_view_owners;
+
+
+
+ImageBufReallocGuard::ImageBufReallocGuard(const ImageBuf& ib,
+                                           string_view what)
+    : m_ib(&ib)
+{
+    int& n = ImageBuf_exports[m_ib];
+    if (n > 0)
+        throw py::buffer_error(Strutil::fmt::format(
+            "{}: cannot reallocate ImageBuf pixels while {} buffer view(s) "
+            "of them (such as NumPy arrays) exist",
+            what, n));
+    --n;
+}
+
+
+
+ImageBufReallocGuard::~ImageBufReallocGuard()
+{
+    auto found = ImageBuf_exports.find(m_ib);
+    if (++found->second == 0)
+        ImageBuf_exports.erase(found);
+}
+
+
+
+static const ImageBuf*
+ImageBuf_from_pyobject(PyObject* obj)
+{
+    try {
+        return py::handle(obj).cast<ImageBuf*>();
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+
+
+// Wrap pybind11's buffer protocol slots to count the live views of each
+// ImageBuf's pixels, and to make each view share ownership of the memory.
+static int
+ImageBuf_getbuffer(PyObject* obj, Py_buffer* view, int flags)
+{
+    const ImageBuf* ib = ImageBuf_from_pyobject(obj);
+    auto found         = ImageBuf_exports.find(ib);
+    if (found != ImageBuf_exports.end() && found->second < 0) {
+        PyErr_SetString(PyExc_BufferError,
+                        "ImageBuf pixels are being reallocated");
+        view->obj = nullptr;
+        return -1;
+    }
+    std::shared_ptr<void> owner;
+    if (ib)
+        owner = ib->localpixels_owner();
+    int result = pybind_getbuffer(obj, view, flags);
+    if (result == 0 && ib) {
+        ++ImageBuf_exports[ib];
+        if (owner)
+            ImageBuf_view_owners[view] = std::move(owner);
+    }
+    return result;
+}
+
+
+
+static void
+ImageBuf_releasebuffer(PyObject* obj, Py_buffer* view)
+{
+    auto found = ImageBuf_exports.find(ImageBuf_from_pyobject(obj));
+    if (found != ImageBuf_exports.end() && --found->second == 0)
+        ImageBuf_exports.erase(found);
+    if (pybind_releasebuffer)
+        pybind_releasebuffer(obj, view);
+    ImageBuf_view_owners.erase(view);
+}
+
+
+
 py::tuple
 ImageBuf_getpixel(const ImageBuf& buf, int x, int y, int z = 0,
                   const std::string& wrapname = "black")
@@ -286,7 +422,8 @@ declare_imagebuf(py::module& m)
 {
     using namespace pybind11::literals;
 
-    py::class_<ImageBuf>(m, "ImageBuf")
+    py::class_<ImageBuf>(m, "ImageBuf", py::buffer_protocol())
+        .def_buffer(&ImageBuf_buffer_info)
         .def(py::init<>())
         .def(py::init<const std::string&>())
         .def(py::init<const std::string&, int, int>())
@@ -304,16 +441,30 @@ declare_imagebuf(py::module& m)
                  return ImageBuf_from_buffer(buffer);
              }),
              "buffer"_a)
-        .def("clear", &ImageBuf::clear)
+        .def_static(
+            "wrap",
+            [](const py::buffer& buffer) {
+                return ImageBuf_from_buffer(buffer, true);
+            },
+            "buffer"_a, py::keep_alive<0, 1>())
+        .def("clear",
+             [](ImageBuf& self) {
+                 ImageBufReallocGuard guard(self, "ImageBuf.clear");
+                 self.clear();
+             })
         .def(
             "reset",
             [](ImageBuf& self, const std::string& name, int subimage,
-               int miplevel) { self.reset(name, subimage, miplevel); },
+               int miplevel) {
+                ImageBufReallocGuard guard(self, "ImageBuf.reset");
+                self.reset(name, subimage, miplevel);
+            },
             "name"_a, "subimage"_a = 0, "miplevel"_a = 0)
         .def(
             "reset",
             [](ImageBuf& self, const std::string& name, int subimage,
                int miplevel, const ImageSpec& config) {
+                ImageBufReallocGuard guard(self, "ImageBuf.reset");
                 self.reset(name, subimage, miplevel, nullptr, &config);
             },
             "name"_a, "subimage"_a = 0, "miplevel"_a = 0,
@@ -321,6 +472,7 @@ declare_imagebuf(py::module& m)
         .def(
             "reset",
             [](ImageBuf& self, const ImageSpec& spec, bool zero) {
+                ImageBufReallocGuard guard(self, "ImageBuf.reset");
                 auto z = zero ? InitializePixels::Yes : InitializePixels::No;
                 self.reset(spec, z);
             },
@@ -328,6 +480,7 @@ declare_imagebuf(py::module& m)
         .def(
             "reset",
             [](ImageBuf& self, const py::buffer& buffer) {
+                ImageBufReallocGuard guard(self, "ImageBuf.reset");
                 self = ImageBuf_from_buffer(buffer);
             },
             "buffer"_a)
@@ -340,6 +493,7 @@ declare_imagebuf(py::module& m)
             "init_spec",
             [](ImageBuf& self, std::string filename, int subimage,
                int miplevel) {
+                ImageBufReallocGuard guard(self, "ImageBuf.init_spec");
                 py::gil_scoped_release gil;
                 return self.init_spec(filename, subimage, miplevel);
             },
@@ -348,6 +502,7 @@ declare_imagebuf(py::module& m)
             "read",
             [](ImageBuf& self, int subimage, int miplevel, int chbegin,
                int chend, bool force, TypeDesc convert) {
+                ImageBufReallocGuard guard(self, "ImageBuf.read");
                 py::gil_scoped_release gil;
                 return self.read(subimage, miplevel, chbegin, chend, force,
                                  convert);
@@ -358,6 +513,7 @@ declare_imagebuf(py::module& m)
             "read",
             [](ImageBuf& self, int subimage, int miplevel, bool force,
                TypeDesc convert) {
+                ImageBufReallocGuard guard(self, "ImageBuf.read");
                 py::gil_scoped_release gil;
                 return self.read(subimage, miplevel, force, convert);
             },
@@ -379,6 +535,19 @@ declare_imagebuf(py::module& m)
                 return self.write(&out);
             },
             "out"_a)
+        .def(
+            "write_async",
+            [](ImageBuf& self, const std::string& filename, TypeDesc dtype,
+               const std::string& fileformat) {
+                py::gil_scoped_release gil;
+                return self.write_async(filename, dtype, fileformat);
+            },
+            "filename"_a, "dtype"_a = TypeUnknown, "fileformat"_a = "")
+        .def_static("wait_for_async_writes",
+                    []() {
+                        py::gil_scoped_release gil;
+                        return ImageBuf::wait_for_async_writes();
+                    })
         .def(
             "make_writable",
             [](ImageBuf& self, bool keep_cache_type) {
@@ -460,6 +629,7 @@ declare_imagebuf(py::module& m)
         .def(
             "copy",
             [](ImageBuf& self, const ImageBuf& src, TypeDesc format) {
+                ImageBufReallocGuard guard(self, "ImageBuf.copy");
                 py::gil_scoped_release gil;
                 return self.copy(src, format);
             },
@@ -480,7 +650,12 @@ declare_imagebuf(py::module& m)
                 self.merge_metadata(src, override, pattern);
             },
             "src"_a, "override"_a = false, "pattern"_a = "")
-        .def("swap", &ImageBuf::swap)
+        .def("swap",
+             [](ImageBuf& self, ImageBuf& other) {
+                 ImageBufReallocGuard guard(self, "ImageBuf.swap");
+                 ImageBufReallocGuard otherguard(other, "ImageBuf.swap");
+                 self.swap(other);
+             })
         .def("getchannel", &ImageBuf::getchannel, "x"_a, "y"_a, "z"_a, "c"_a,
              "wrap"_a = "black")
         .def("getpixel", &ImageBuf_getpixel, "x"_a, "y"_a, "z"_a = 0,
@@ -526,6 +701,13 @@ declare_imagebuf(py::module& m)
 
         // FIXME -- do we want to provide pixel iterators?
         ;
+
+    // Count the buffer views of each ImageBuf, for ImageBufReallocGuard
+    auto type = reinterpret_cast<PyTypeObject*>(m.attr("ImageBuf").ptr());
+    pybind_getbuffer     = type->tp_as_buffer->bf_getbuffer;
+    pybind_releasebuffer = type->tp_as_buffer->bf_releasebuffer;
+    type->tp_as_buffer->bf_getbuffer     = ImageBuf_getbuffer;
+    type->tp_as_buffer->bf_releasebuffer = ImageBuf_releasebuffer;
 }
 
 }  // namespace PyOpenImageIO
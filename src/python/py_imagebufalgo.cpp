@@ -212,6 +212,7 @@ IBA_channels(ImageBuf& dst, const ImageBuf& src, py::tuple channelorder_,
         dst.errorfmt("Inconsistent number of channel arguments");
         return false;
     }
+    ImageBufReallocGuard guard(dst, "ImageBufAlgo.channels");
     py::gil_scoped_release gil;
     return ImageBufAlgo::channels(dst, src, (int)nchannels, channelorder,
                                   channelvalues, newchannelnames,
@@ -235,6 +236,7 @@ bool
 IBA_channel_append(ImageBuf& dst, const ImageBuf& A, const ImageBuf& B, ROI roi,
                    int nthreads)
 {
+    ImageBufReallocGuard guard(dst, "ImageBufAlgo.channel_append");
     py::gil_scoped_release gil;
     return ImageBufAlgo::channel_append(dst, A, B, roi, nthreads);
 }
@@ -254,6 +256,7 @@ bool
 IBA_deepen(ImageBuf& dst, const ImageBuf& src, float zvalue, ROI roi,
            int nthreads)
 {
+    ImageBufReallocGuard guard(dst, "ImageBufAlgo.deepen");
     py::gil_scoped_release gil;
     return ImageBufAlgo::deepen(dst, src, zvalue, roi, nthreads);
 }
@@ -272,6 +275,7 @@ IBA_deepen_ret(const ImageBuf& src, float zvalue, ROI roi, int nthreads)
 bool
 IBA_flatten(ImageBuf& dst, const ImageBuf& src, ROI roi, int nthreads)
 {
+    ImageBufReallocGuard guard(dst, "ImageBufAlgo.flatten");
     py::gil_scoped_release gil;
     return ImageBufAlgo::flatten(dst, src, roi, nthreads);
 }
@@ -349,6 +353,7 @@ IBA_copy_ret(const ImageBuf& src, TypeDesc convert, ROI roi, int nthreads)
 bool
 IBA_crop(ImageBuf& dst, const ImageBuf& src, ROI roi, int nthreads)
 {
+    ImageBufReallocGuard guard(dst, "ImageBufAlgo.crop");
     py::gil_scoped_release gil;
     return ImageBufAlgo::crop(dst, src, roi, nthreads);
 }
@@ -471,6 +476,7 @@ IBA_flop_ret(const ImageBuf& src, ROI roi, int nthreads)
 bool
 IBA_reorient(ImageBuf& dst, const ImageBuf& src, int nthreads)
 {
+    ImageBufReallocGuard guard(dst, "ImageBufAlgo.reorient");
     py::gil_scoped_release gil;
     return ImageBufAlgo::reorient(dst, src, nthreads);
 }
@@ -1486,6 +1492,7 @@ IBA_fit(ImageBuf& dst, const ImageBuf& src, const std::string& filtername = "",
         float filterwidth = 0.0f, const std::string& fillmode = "letterbox",
         bool exact = false, ROI roi = ROI::All(), int nthreads = 0)
 {
+    ImageBufReallocGuard guard(dst, "ImageBufAlgo.fit");
     py::gil_scoped_release gil;
     return ImageBufAlgo::fit(dst, src,
                              { { "filtername", filtername },
@@ -1642,6 +1649,7 @@ IBA_laplacian_ret(const ImageBuf& src, ROI roi, int nthreads)
 bool
 IBA_fft(ImageBuf& dst, const ImageBuf& src, ROI roi, int nthreads)
 {
+    ImageBufReallocGuard guard(dst, "ImageBufAlgo.fft");
     py::gil_scoped_release gil;
     return ImageBufAlgo::fft(dst, src, roi, nthreads);
 }
@@ -1658,6 +1666,7 @@ IBA_fft_ret(const ImageBuf& src, ROI roi, int nthreads)
 bool
 IBA_ifft(ImageBuf& dst, const ImageBuf& src, ROI roi, int nthreads)
 {
+    ImageBufReallocGuard guard(dst, "ImageBufAlgo.ifft");
     py::gil_scoped_release gil;
     return ImageBufAlgo::ifft(dst, src, roi, nthreads);
 }
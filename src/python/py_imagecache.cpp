@@ -184,7 +184,14 @@ declare_imagecache(py::module& m)
                 py::gil_scoped_release gil;
                 ic.m_cache->invalidate_all(force);
             },
-            "force"_a = false);
+            "force"_a = false)
+        .def(
+            "prefetch_trace",
+            [](ImageCacheWrap& ic, const std::string& tracefile) {
+                py::gil_scoped_release gil;
+                return ic.m_cache->prefetch_trace(tracefile);
+            },
+            "tracefile"_a);
 }
 
 }  // namespace PyOpenImageIO
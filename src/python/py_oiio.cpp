@@ -9,27 +9,26 @@
 namespace PyOpenImageIO {
 
 
-#if 0 /* unused */
-const char*
+std::string
 python_array_code(TypeDesc format)
 {
+    // These are the Python struct module characters that the buffer
+    // protocol (and therefore NumPy) understands for each pixel type.
     switch (format.basetype) {
-    case TypeDesc::UINT8: return "uint8";
-    case TypeDesc::INT8: return "int8";
-    case TypeDesc::UINT16: return "uint16";
-    case TypeDesc::INT16: return "int16";
-    case TypeDesc::UINT32: return "uint32";
-    case TypeDesc::INT32: return "int32";
-    case TypeDesc::FLOAT: return "float";
-    case TypeDesc::DOUBLE: return "double";
-    case TypeDesc::HALF: return "half";
-    default:
-        // For any other type, including UNKNOWN, pack it into an
-        // unsigned byte array.
-        return "B";
+    case TypeDesc::UINT8: return "B";
+    case TypeDesc::INT8: return "b";
+    case TypeDesc::UINT16: return "H";
+    case TypeDesc::INT16: return "h";
+    case TypeDesc::UINT32: return "I";
+    case TypeDesc::INT32: return "i";
+    case TypeDesc::UINT64: return "Q";
+    case TypeDesc::INT64: return "q";
+    case TypeDesc::HALF: return "e";
+    case TypeDesc::FLOAT: return "f";
+    case TypeDesc::DOUBLE: return "d";
+    default: return std::string();
     }
 }
-#endif
 
 
 TypeDesc
@@ -51,9 +50,9 @@ typedesc_from_python_array_code(string_view code)
         return TypeDesc::INT;
     if (code == "I")
         return TypeDesc::UINT;
-    if (code == "l")
+    if (code == "l" || code == "q")
         return TypeDesc::INT64;
-    if (code == "L")
+    if (code == "L" || code == "Q")
         return TypeDesc::UINT64;
     if (code == "f")
         return TypeDesc::FLOAT;
@@ -285,6 +284,7 @@ OIIO_DECLARE_PYMODULE(PYMODULE_NAME)
     declare_imageoutput(m);
     declare_imagebuf(m);
     declare_imagecache(m);
+    declare_framesequencereader(m);
 
     // TextureSys classes
     declare_wrap(m);
@@ -31,6 +31,7 @@
 
 #include <OpenImageIO/Imath.h>
 #include <OpenImageIO/deepdata.h>
+#include <OpenImageIO/framesequence.h>
 #include <OpenImageIO/imagebuf.h>
 #include <OpenImageIO/imagecache.h>
 #include <OpenImageIO/imageio.h>
@@ -94,6 +95,7 @@ void declare_deepdata (py::module& m);
 void declare_colorconfig (py::module& m);
 void declare_imagecache (py::module& m);
 void declare_imagebuf (py::module& m);
+void declare_framesequencereader (py::module& m);
 void declare_imagebufalgo (py::module& m);
 void declare_paramvalue (py::module& m);
 void declare_global (py::module& m);
@@ -106,7 +108,22 @@ void declare_texturesystem (py::module& m);
 // bool PyProgressCallback(void*, float);
 // object C_array_to_Python_array (const char *data, TypeDesc type, size_t size);
 TypeDesc typedesc_from_python_array_code (string_view code);
-// const char * python_array_code (TypeDesc format);  // unused
+// Buffer protocol format code for a pixel type, or empty if none.
+std::string python_array_code (TypeDesc format);
+
+// Held (with the GIL) around anything that may reallocate an ImageBuf's
+// pixels. Raises BufferError if buffer views of the pixels (such as NumPy
+// arrays) are alive, since they would be left dangling, and refuses new
+// views until it is destroyed.
+class ImageBufReallocGuard {
+public:
+    ImageBufReallocGuard (const ImageBuf& ib, string_view what);
+    ~ImageBufReallocGuard ();
+    ImageBufReallocGuard (const ImageBufReallocGuard&) = delete;
+    ImageBufReallocGuard& operator= (const ImageBufReallocGuard&) = delete;
+private:
+    const ImageBuf* m_ib;
+};
 
 
 inline std::string
@@ -86,7 +86,8 @@ declare_mipmpode(py::module& m)
         .value("NoMIP", Tex::MipMode::NoMIP)
         .value("OneLevel", Tex::MipMode::OneLevel)
         .value("Trilinear", Tex::MipMode::Trilinear)
-        .value("Aniso", Tex::MipMode::Aniso);
+        .value("Aniso", Tex::MipMode::Aniso)
+        .value("EWA", Tex::MipMode::EWA);
 }
 
 
@@ -361,6 +362,13 @@ declare_texturesystem(py::module& m)
                  py::gil_scoped_release gil;
                  ts.m_texsys->close_all();
              })
+        .def(
+            "prefetch_trace",
+            [](TextureSystemWrap& ts, const std::string& tracefile) {
+                py::gil_scoped_release gil;
+                return ts.m_texsys->prefetch_trace(tracefile);
+            },
+            "tracefile"_a)
         .def("has_error",
              [](TextureSystemWrap& ts) { return ts.m_texsys->has_error(); })
         .def(
@@ -308,6 +308,7 @@ class ImageBuf:
     def __init__(self, name: str, subimage: typing.SupportsInt, miplevel: typing.SupportsInt, config: ImageSpec) -> None: ...
     @overload
     def __init__(self, buffer: typing_extensions.Buffer) -> None: ...
+    def __buffer__(self, flags: int, /) -> memoryview: ...
     def clear(self) -> None: ...
     def clear_thumbnail(self) -> None: ...
     @overload
@@ -367,6 +368,8 @@ class ImageBuf:
     def spec(self) -> ImageSpec: ...
     def specmod(self) -> ImageSpec: ...
     def swap(self, arg0: ImageBuf, /) -> None: ...
+    @staticmethod
+    def wrap(buffer: typing_extensions.Buffer) -> ImageBuf: ...
     @overload
     def write(self, filename: str, dtype: TypeDesc | BASETYPE | str = ..., fileformat: str = ...) -> bool: ...
     @overload
@@ -1094,6 +1097,7 @@ class ImageCache:
     def getstats(self, level: typing.SupportsInt = ...) -> str: ...
     def invalidate(self, filename: str, force: bool = ...) -> None: ...
     def invalidate_all(self, force: bool = ...) -> None: ...
+    def prefetch_trace(self, tracefile: str) -> bool: ...
     def resolve_filename(self, arg0: str, /) -> str: ...
     @property
     def has_error(self) -> bool: ...
@@ -1329,6 +1333,7 @@ class MipMode:
     __members__: ClassVar[dict] = ...  # read-only
     Aniso: ClassVar[MipMode] = ...
     Default: ClassVar[MipMode] = ...
+    EWA: ClassVar[MipMode] = ...
     NoMIP: ClassVar[MipMode] = ...
     OneLevel: ClassVar[MipMode] = ...
     Trilinear: ClassVar[MipMode] = ...
@@ -1519,6 +1524,7 @@ class TextureSystem:
     def invalidate_all(self, force: bool = ...) -> None: ...
     def inventory_udim(self, filename: str) -> tuple: ...
     def is_udim(self, filename: str) -> bool: ...
+    def prefetch_trace(self, tracefile: str) -> bool: ...
     def reset_stats(self) -> None: ...
     def resolve_filename(self, filename: str) -> str: ...
     def resolve_udim(self, filename: str, s: typing.SupportsFloat, t: typing.SupportsFloat) -> str: ...
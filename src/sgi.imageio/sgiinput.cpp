@@ -4,6 +4,8 @@
 
 #include <OpenImageIO/dassert.h>
 #include <OpenImageIO/fmath.h>
+#include <OpenImageIO/parallel.h>
+#include <OpenImageIO/thread.h>
 
 #include "sgi_pvt.h"
 
@@ -25,6 +27,8 @@ public:
     bool close(void) override;
     bool read_native_scanline(int subimage, int miplevel, int y, int z,
                               void* data) override;
+    bool read_native_scanlines(int subimage, int miplevel, int ybegin,
+                               int yend, int z, void* data) override;
 
 private:
     std::string m_filename;
@@ -53,6 +57,19 @@ private:
     // Return true if ok, false if there was a read error.
     bool uncompress_rle_channel(int scanline_off, int scanline_len,
                                 unsigned char* out);
+
+    // uncompress one RLE channel scanline that is already in memory. Safe
+    // to call from multiple threads at once; on failure, err describes
+    // the problem.
+    bool decode_rle_channel(const unsigned char* rle_scanline,
+                            int scanline_len, unsigned char* out,
+                            std::string& err) const;
+
+    // interleave one scanline of per-channel data into 'data', swapping
+    // 16 bit values to native byte order.
+    void interleave_channels(
+        const std::vector<std::vector<unsigned char>>& channeldata,
+        void* data) const;
 };
 
 
@@ -76,6 +93,7 @@ sgi_input_imageio_create()
 
 OIIO_EXPORT const char* sgi_input_extensions[] = { "sgi", "rgb",  "rgba", "bw",
                                                    "int", "inta", nullptr };
+OIIO_EXPORT const char* sgi_imageio_signatures[] = { "01da", nullptr };
 
 OIIO_PLUGIN_EXPORTS_END
 
@@ -198,8 +216,9 @@ SgiInput::read_native_scanline(int subimage, int miplevel, int y, int /*z*/,
             ptrdiff_t scanline_offset = start_tab[off];
             ptrdiff_t scanline_length = length_tab[off];
             channeldata[c].resize(m_spec.width * bpc);
-            uncompress_rle_channel(scanline_offset, scanline_length,
-                                   &(channeldata[c][0]));
+            if (!uncompress_rle_channel(scanline_offset, scanline_length,
+                                        &(channeldata[c][0])))
+                return false;
         }
     } else {
         // non-RLE case -- just read directly into our channel data
@@ -215,25 +234,166 @@ SgiInput::read_native_scanline(int subimage, int miplevel, int y, int /*z*/,
         }
     }
 
-    if (m_spec.nchannels == 1) {
+    interleave_channels(channeldata, data);
+    return true;
+}
+
+
+
+bool
+SgiInput::read_native_scanlines(int subimage, int miplevel, int ybegin,
+                                int yend, int z, void* data)
+{
+    lock_guard lock(*this);
+    if (!seek_subimage(subimage, miplevel))
+        return false;
+    yend = std::min(yend, m_spec.y + m_spec.height);
+    if (yend - ybegin < 2 || ybegin < 0)
+        return ImageInput::read_native_scanlines(subimage, miplevel, ybegin,
+                                                 yend, z, data);
+
+    int nchannels     = m_spec.nchannels;
+    int64_t row_bytes = int64_t(m_spec.width) * m_sgi_header.bpc;
+    bool rle          = (m_sgi_header.storage == sgi_pvt::RLE);
+    // File offset and size of the data for scanline y of channel c
+    auto extent = [&](int64_t y, int c) -> std::pair<int64_t, int64_t> {
+        int64_t off = (m_spec.height - y - 1) + int64_t(c) * m_spec.height;
+        if (rle)
+            return { start_tab[off], length_tab[off] };
+        return { sgi_pvt::SGI_HEADER_LEN + off * row_bytes, row_bytes };
+    };
+
+    // The scanlines of a channel are (nearly always) stored together, so
+    // fetch the whole band of each channel with a single read. The offset
+    // tables come straight from the file, so make sure the band lies within
+    // it before allocating anything, and don't gather rows that are
+    // scattered all over the file (we'd read far more than we need).
+    int64_t filesize = int64_t(ioproxy()->size());
+    std::vector<int64_t> band_begin(nchannels), band_end(nchannels);
+    for (int c = 0; c < nchannels; ++c) {
+        int64_t begin = std::numeric_limits<int64_t>::max(), end = 0;
+        int64_t total = 0;
+        for (int y = ybegin; y < yend; ++y) {
+            auto e = extent(y, c);
+            if (e.first + e.second > filesize) {
+                errorfmt("Corrupt SGI file: scanline {} data is past the "
+                         "end of the file",
+                         y);
+                return false;
+            }
+            begin = std::min(begin, e.first);
+            end   = std::max(end, e.first + e.second);
+            total += e.second;
+        }
+        if (end - begin > 2 * total + row_bytes)
+            return ImageInput::read_native_scanlines(subimage, miplevel,
+                                                     ybegin, yend, z, data);
+        band_begin[c] = begin;
+        band_end[c]   = end;
+    }
+    std::vector<std::vector<unsigned char>> packed(nchannels);
+    std::vector<int64_t> packed_begin(nchannels);
+    for (int c = 0; c < nchannels; ++c) {
+        int64_t begin = band_begin[c], end = band_end[c];
+        packed_begin[c] = begin;
+        packed[c].resize(end - begin);
+        if (!ioseek(begin) || !ioread(packed[c].data(), 1, packed[c].size()))
+            return false;
+    }
+
+    // Uncompress and interleave bands of scanlines in parallel. Errors
+    // can't be reported from the worker threads, so remember the first.
+    size_t ystride = m_spec.scanline_bytes(true);
+    std::string firsterr;
+    spin_mutex err_mutex;
+    parallel_for_chunked(
+        ybegin, yend, 0,
+        [&](int64_t yb, int64_t ye) {
+            std::vector<std::vector<unsigned char>> channeldata(
+                nchannels, std::vector<unsigned char>(row_bytes));
+            std::string err;
+            for (int64_t y = yb; y < ye; ++y) {
+                for (int c = 0; c < nchannels; ++c) {
+                    auto e = extent(y, c);
+                    const unsigned char* src = packed[c].data() + e.first
+                                               - packed_begin[c];
+                    if (!rle) {
+                        memcpy(channeldata[c].data(), src, row_bytes);
+                    } else if (!decode_rle_channel(src, int(e.second),
+                                                   channeldata[c].data(),
+                                                   err)) {
+                        spin_lock lock(err_mutex);
+                        if (firsterr.empty())
+                            firsterr = err;
+                        return;
+                    }
+                }
+                interleave_channels(channeldata,
+                                    (char*)data + (y - ybegin) * ystride);
+            }
+        },
+        paropt(threads()));
+    if (firsterr.size()) {
+        errorfmt("{}", firsterr);
+        return false;
+    }
+    return true;
+}
+
+
+
+void
+SgiInput::interleave_channels(
+    const std::vector<std::vector<unsigned char>>& channeldata,
+    void* data) const
+{
+    int nchannels = m_spec.nchannels;
+    int width     = m_spec.width;
+    if (nchannels == 1) {
         // If just one channel, no interleaving is necessary, just memcpy
         memcpy(data, &(channeldata[0][0]), channeldata[0].size());
-    } else {
+    } else if (m_sgi_header.bpc == 1) {
+        // Walk the pixels with the channel loop innermost and a known
+        // channel count for the common cases, so dst is written in order
+        // instead of once per channel.
         unsigned char* cdata = (unsigned char*)data;
-        for (int x = 0; x < m_spec.width; ++x) {
-            for (int c = 0; c < m_spec.nchannels; ++c) {
-                *cdata++ = channeldata[c][x * bpc];
-                if (bpc == 2)
-                    *cdata++ = channeldata[c][x * bpc + 1];
+        if (nchannels == 3) {
+            const unsigned char *r = channeldata[0].data(),
+                                *g = channeldata[1].data(),
+                                *b = channeldata[2].data();
+            for (int x = 0; x < width; ++x) {
+                cdata[3 * x + 0] = r[x];
+                cdata[3 * x + 1] = g[x];
+                cdata[3 * x + 2] = b[x];
+            }
+        } else if (nchannels == 4) {
+            const unsigned char *r = channeldata[0].data(),
+                                *g = channeldata[1].data(),
+                                *b = channeldata[2].data(),
+                                *a = channeldata[3].data();
+            for (int x = 0; x < width; ++x) {
+                cdata[4 * x + 0] = r[x];
+                cdata[4 * x + 1] = g[x];
+                cdata[4 * x + 2] = b[x];
+                cdata[4 * x + 3] = a[x];
             }
+        } else {
+            for (int c = 0; c < nchannels; ++c)
+                for (int x = 0; x < width; ++x)
+                    cdata[nchannels * x + c] = channeldata[c][x];
+        }
+    } else {
+        uint16_t* sdata = (uint16_t*)data;
+        for (int c = 0; c < nchannels; ++c) {
+            const uint16_t* cbuf = (const uint16_t*)channeldata[c].data();
+            for (int x = 0; x < width; ++x)
+                sdata[nchannels * x + c] = cbuf[x];
         }
     }
 
     // Swap endianness if needed
-    if (bpc == 2 && littleendian())
+    if (m_sgi_header.bpc == 2 && littleendian())
         swap_endian((unsigned short*)data, m_spec.width * m_spec.nchannels);
-
-    return true;
 }
 
 
@@ -242,12 +402,34 @@ bool
 SgiInput::uncompress_rle_channel(int scanline_off, int scanline_len,
                                  unsigned char* out)
 {
-    int bpc = m_sgi_header.bpc;
+    if (scanline_off < 0 || scanline_len < 0
+        || uint64_t(scanline_off) + uint64_t(scanline_len)
+               > ioproxy()->size()) {
+        errorfmt("Corrupt SGI file: scanline data is past the end of the "
+                 "file");
+        return false;
+    }
     std::unique_ptr<unsigned char[]> rle_scanline(
         new unsigned char[scanline_len]);
     ioseek(scanline_off);
     if (!ioread(&rle_scanline[0], 1, scanline_len))
         return false;
+    std::string err;
+    if (!decode_rle_channel(rle_scanline.get(), scanline_len, out, err)) {
+        errorfmt("{}", err);
+        return false;
+    }
+    return true;
+}
+
+
+
+bool
+SgiInput::decode_rle_channel(const unsigned char* rle_scanline,
+                             int scanline_len, unsigned char* out,
+                             std::string& err) const
+{
+    int bpc   = m_sgi_header.bpc;
     int limit = m_spec.width;
     int i     = 0;
     if (bpc == 1) {
@@ -308,11 +490,11 @@ SgiInput::uncompress_rle_channel(int scanline_off, int scanline_len,
             }
         }
     } else {
-        errorfmt("Unknown bytes per channel {}", bpc);
+        err = Strutil::fmt::format("Unknown bytes per channel {}", bpc);
         return false;
     }
     if (i != scanline_len || limit != 0) {
-        errorfmt("Corrupt RLE data");
+        err = "Corrupt RLE data";
         return false;
     }
 
@@ -56,6 +56,8 @@ static bool test_construction   = false;
 static bool test_gettexels      = false;
 static bool test_getimagespec   = false;
 static bool filtertest          = false;
+static bool ewabench            = false;
+static bool ewatest             = false;
 static std::shared_ptr<TextureSystem> texsys;
 static std::string searchpath;
 static bool batch         = false;
@@ -94,6 +96,8 @@ static std::string subimagename;
 static Imath::M33f xform;
 static std::string texoptions;
 static std::string gtiname;
+static std::string recordtrace;
+static std::string prefetchtrace;
 static std::string maketest_template;
 static int maketest_res   = 2048;
 static int maketest_chans = 4;
@@ -177,7 +181,7 @@ getargs(int argc, const char* argv[])
     ap.arg("--anisomax %d:MAX", &anisomax)
       .help(Strutil::fmt::format("Set max anisotropy (default: {})", anisomax));
     ap.arg("--mipmode %d:MODE", &mipmode)
-      .help("Set mip mode (default: 0 = aniso)");
+      .help("Set mip mode (default: 0 = aniso, 5 = ewa)");
     ap.arg("--interpmode %d:MODE", &interpmode)
       .help("Set interp mode (default: 3 = smart bicubic)");
     ap.arg("--stochastic %d:MODE", &stochastic)
@@ -196,6 +200,10 @@ getargs(int argc, const char* argv[])
       .help("Search path for files (colon-separated directory list)");
     ap.arg("--filtertest", &filtertest)
       .help("Test the filter sizes");
+    ap.arg("--ewabench", &ewabench)
+      .help("Compare speed and results of the EWA and aniso filters");
+    ap.arg("--ewatest", &ewatest)
+      .help("Check EWA lookups with known results (see texture-ewa test)");
     ap.arg("--nowarp", &nowarp)
       .help("Do not warp the image->texture mapping");
     ap.arg("--tube", &tube)
@@ -212,6 +220,10 @@ getargs(int argc, const char* argv[])
       .help("Offset texture coordinates");
     ap.arg("--scalest %f:SSCALE %f:TSCALE", &sscale, &tscale)
       .help("Scale texture lookups (s, t)");
+    ap.arg("--recordtrace %s:FILENAME", &recordtrace)
+      .help("Record the tiles read into a tile access trace file");
+    ap.arg("--prefetch %s:FILENAME", &prefetchtrace)
+      .help("Prefetch the tiles of a recorded trace before the tests");
     ap.arg("--cachesize %f:MB", &cachesize)
       .help("Set cache size, in MB");
     ap.arg("--nodedup %!", &dedup)
@@ -1579,6 +1591,156 @@ launch_tex_threads(int numthreads, int iterations)
 
 
 
+// Time the same set of anisotropic lookups with MipMode::Aniso and
+// MipMode::EWA over a range of ellipse aspect ratios, and report how far
+// apart the two filters' results are.
+static void
+test_ewa_benchmark(ustring filename)
+{
+    ImageSpec spec;
+    if (!texsys->get_imagespec(filename, spec, 0)) {
+        Strutil::print(std::cerr, "Unexpected error: {}\n",
+                       texsys->geterror());
+        return;
+    }
+    const int nlookups = iters > 1 ? iters : 1000000;
+    int nchannels      = nchannels_override ? nchannels_override : 3;
+    std::vector<float> results[2];
+    results[0].resize(size_t(nlookups) * nchannels);
+    results[1].resize(size_t(nlookups) * nchannels);
+    TextureSystem::Perthread* perthread_info = texsys->get_perthread_info();
+    TextureSystem::TextureHandle* handle = texsys->get_texture_handle(filename);
+
+    Strutil::print("EWA vs aniso, {} lookups per trial\n", nlookups);
+    Strutil::print("aspect   aniso (s)    ewa (s)  ewa/aniso  mean |diff|\n");
+    Strutil::print("------ ---------- ---------- ---------- ------------\n");
+    for (float aspect : { 1.0f, 2.0f, 4.0f, 8.0f, 16.0f, 32.0f }) {
+        // Same footprint as the --threadtimes workloads: an ellipse 30
+        // degrees off horizontal, between the second and third MIP levels.
+        float fw = 3.0f / spec.width, fh = 3.0f / spec.height;
+        float xs = sqrtf(3.0f) / 2.0f, ys = 0.5f;
+        float dsdx = fw * xs * aspect, dtdx = fh * ys * aspect;
+        float dsdy = fw * ys, dtdy = -fh * xs;
+        double times[2];
+        for (int m = 0; m < 2; ++m) {
+            TextureOpt opt;
+            initialize_opt(opt);
+            opt.mipmode = m ? TextureOpt::MipModeEWA : TextureOpt::MipModeAniso;
+            opt.anisotropic = std::max(anisomax, int(aspect));
+            texsys->invalidate_all(true);
+            Timer timer;
+            for (int i = 0; i < nlookups; ++i) {
+                float s = (((2 * i) % spec.width) + 0.5f) / spec.width;
+                float t = (((2 * ((2 * i) / spec.width)) % spec.height) + 0.5f)
+                          / spec.height;
+                texsys->texture(handle, perthread_info, opt, s, t, dsdx, dtdx,
+                                dsdy, dtdy, nchannels,
+                                &results[m][size_t(i) * nchannels]);
+            }
+            times[m] = timer();
+        }
+        double diff = 0.0;
+        for (size_t i = 0, e = results[0].size(); i < e; ++i)
+            diff += fabs(results[0][i] - results[1][i]);
+        Strutil::print("{:6.0f} {:10.3f} {:10.3f} {:9.2f}x {:12.5f}\n",
+                       aspect, times[0], times[1], times[1] / times[0],
+                       diff / double(results[0].size()));
+    }
+    Strutil::print("\n");
+}
+
+
+
+// Check MipMode::EWA lookups whose results are known, on the texture made
+// by the texture-ewa test: its first channel is vertical stripes 8 texels
+// wide, alternating between 0 and 1, and the other two ramp linearly in s
+// and t. A footprint stretched along a stripe should see only that stripe,
+// one stretched across many stripes (at any angle) should average them to
+// 1/2, and since the filter is symmetric about its center, it should give
+// the ramps' values there, and their slopes as the derivatives.
+static void
+test_ewa_analytic(ustring filename)
+{
+    ImageSpec spec;
+    if (!texsys->get_imagespec(filename, spec, 0)) {
+        Strutil::print(std::cerr, "Unexpected error: {}\n",
+                       texsys->geterror());
+        return;
+    }
+    TextureSystem::Perthread* perthread_info = texsys->get_perthread_info();
+    TextureSystem::TextureHandle* handle = texsys->get_texture_handle(filename);
+    // The references are bilinear lookups on the finest level, which are
+    // exact for the stripes away from their edges, and for the ramps.
+    TextureOpt ref, ewa;
+    initialize_opt(ref);
+    initialize_opt(ewa);
+    ref.mipmode    = TextureOpt::MipModeNoMIP;
+    ref.interpmode = TextureOpt::InterpBilinear;
+    ewa.mipmode    = TextureOpt::MipModeEWA;
+    const float texel = 1.0f / spec.width;
+
+    // Look up an ellipse whose major axis is `angle` radians from the s
+    // axis, with the axis lengths given in texels of the finest level.
+    auto lookup = [&](TextureOpt& opt, float s, float t, float angle,
+                      float major, float minor, float* result,
+                      float* dresultds = nullptr, float* dresultdt = nullptr) {
+        float c = cosf(angle) * texel, sn = sinf(angle) * texel;
+        texsys->texture(handle, perthread_info, opt, s, t, major * c,
+                        major * sn, -minor * sn, minor * c, 3, result,
+                        dresultds, dresultdt);
+    };
+    auto check = [](string_view what, float value, float expected,
+                    float tolerance) {
+        bool pass = fabsf(value - expected) <= tolerance;
+        if (pass)
+            Strutil::print("  {}: PASS\n", what);
+        else
+            Strutil::print("  {}: FAIL, {} (expected {} +/- {})\n", what,
+                           value, expected, tolerance);
+    };
+
+    Strutil::print("EWA lookups with known results:\n");
+    const float pi = float(M_PI);
+    float r[3], rref[3];
+    for (int stripe = 14; stripe < 18; ++stripe) {
+        float s = (8 * stripe + 4) * texel;
+        lookup(ref, s, 0.5f, 0.0f, 0.0f, 0.0f, rref);
+        lookup(ewa, s, 0.5f, pi / 2, 24.0f, 1.0f, r);
+        check(Strutil::fmt::format("along stripe {}", stripe), r[0], rref[0],
+              0.001f);
+    }
+    for (int degrees : { 0, 30, 60 }) {
+        lookup(ewa, 0.5f, 0.5f, degrees * pi / 180, 128.0f, 4.0f, r);
+        check(Strutil::fmt::format("across the stripes at {} degrees",
+                                   degrees),
+              r[0], 0.5f, 0.02f);
+    }
+
+    const float h = 8 * texel;
+    float up[3], down[3];
+    lookup(ref, 0.5f + h, 0.5f + h, 0.0f, 0.0f, 0.0f, up);
+    lookup(ref, 0.5f - h, 0.5f - h, 0.0f, 0.0f, 0.0f, down);
+    float sslope = (up[1] - down[1]) / (2 * h);
+    float tslope = (up[2] - down[2]) / (2 * h);
+    for (int degrees : { 0, 45, 100 }) {
+        float s = 0.4f + degrees * 0.001f, t = 0.6f - degrees * 0.001f;
+        float drds[3], drdt[3];
+        lookup(ref, s, t, 0.0f, 0.0f, 0.0f, rref);
+        lookup(ewa, s, t, degrees * pi / 180, 16.0f, 2.0f, r, drds, drdt);
+        std::string at = Strutil::fmt::format("at {} degrees", degrees);
+        check("s ramp " + at, r[1], rref[1], 0.002f);
+        check("t ramp " + at, r[2], rref[2], 0.002f);
+        // The derivatives are those of a sum over the texels that happen
+        // to be inside the ellipse, so they only roughly follow the slope.
+        check("d(s ramp)/ds " + at, drds[1], sslope, 0.3f * sslope);
+        check("d(s ramp)/dt " + at, drdt[1], 0.0f, 0.3f * sslope);
+        check("d(t ramp)/dt " + at, drdt[2], tslope, 0.3f * tslope);
+    }
+    Strutil::print("\n");
+}
+
+
+
 class GridImageInput final : public ImageInput {
 public:
     GridImageInput()
@@ -1906,11 +2068,33 @@ main(int argc, const char* argv[])
     xform = persp * rot * trans * scale;
     xform.invert();
 
+    if (recordtrace.size())
+        texsys->attribute("trace_file", recordtrace);
+    if (prefetchtrace.size()) {
+        Timer timer;
+        if (!texsys->prefetch_trace(prefetchtrace))
+            Strutil::print(std::cerr, "Prefetch error: {}\n",
+                           texsys->geterror());
+        else if (runstats || verbose)
+            Strutil::print("Prefetched \"{}\" in {}\n", prefetchtrace,
+                           Strutil::timeintervalformat(timer()));
+    }
+
     for (auto f : filenames) {
         texture_handles.emplace_back(texsys->get_texture_handle(f));
         // Strutil::print("tex {} -> {:p}\n", f, (void*)texture_handles.back());
     }
 
+    if (ewatest && filenames.size()) {
+        test_ewa_analytic(ustring(filenames[0]));
+        iters = 0;
+    }
+
+    if (ewabench && filenames.size()) {
+        test_ewa_benchmark(ustring(filenames[0]));
+        iters = 0;
+    }
+
     if (threadtimes) {
         // If the --iters flag was used, do that number of iterations total
         // (divided among the threads). If not supplied (iters will be 1),
@@ -2039,6 +2223,9 @@ main(int argc, const char* argv[])
         }
     }
 
+    if (recordtrace.size())
+        texsys->attribute("trace_file", "");  // finish and write the trace
+
     if (runstats || verbose) {
         Strutil::print("Memory use: {}\n",
                        Strutil::memformat(Sysutil::memory_used(true)));
@@ -543,6 +543,13 @@ tiff_input_imageio_create()
 
 OIIO_EXPORT const char* tiff_input_extensions[]
     = { "tif", "tiff", "tx", "env", "sm", "vsm", nullptr };
+OIIO_EXPORT const char* tiff_imageio_signatures[] = {
+    "49492a00",  // II*\0
+    "4d4d002a",  // MM\0*
+    "49492b00",  // BigTIFF
+    "4d4d002b",  // BigTIFF
+    nullptr
+};
 
 OIIO_PLUGIN_EXPORTS_END
 
@@ -422,6 +422,10 @@ webp_input_imageio_create()
 }
 
 OIIO_EXPORT const char* webp_input_extensions[] = { "webp", nullptr };
+OIIO_EXPORT const char* webp_imageio_signatures[] = {
+    "8:57454250",  // WEBP, after the RIFF header
+    nullptr
+};
 
 OIIO_PLUGIN_EXPORTS_END
 
@@ -8,3 +8,6 @@ imagedir = "ref/"
 files = [ "vp9_display_p3.mkv", "vp9_rec2100_pq.mkv" ]
 for f in files:
     command = command + info_command (os.path.join(imagedir, f))
+
+# Random access: frames read out of order must match a sequential read
+command += pythonbin + " src/test_random_access.py >> out.txt ;"
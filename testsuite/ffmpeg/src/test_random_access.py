@@ -0,0 +1,41 @@
+#!/usr/bin/env python
+
+# Copyright Contributors to the OpenImageIO project.
+# SPDX-License-Identifier: Apache-2.0
+# https://github.com/AcademySoftwareFoundation/OpenImageIO
+
+# Read the frames of a movie out of order and in reverse, which needs
+# seeking (using the keyframe index) and the decoded-frame cache, and make
+# sure they match the frames read straight through.
+
+import numpy
+import OpenImageIO as oiio
+
+filename = "ref/vp9_display_p3.mkv"
+
+
+def read_frames(order):
+    inp = oiio.ImageInput.open(filename)
+    frames = {}
+    for f in order:
+        inp.seek_subimage(f, 0)
+        frames[f] = inp.read_image("uint8")
+    inp.close()
+    return frames
+
+
+inp = oiio.ImageInput.open(filename)
+nframes = inp.spec().get_int_attribute("oiio:subimages")
+inp.close()
+sequential = read_frames(range(nframes))
+
+orders = [ ("reverse", list(reversed(range(nframes)))),
+           ("out of order", [ (3 * i) % nframes for i in range(nframes) ]),
+           ("back and forth", [ nframes - 1, 0, nframes // 2, 1, nframes - 2 ]) ]
+for cache_mb in [ 32, 0 ]:
+    oiio.attribute("ffmpeg:frame_cache_MB", cache_mb)
+    for name, order in orders:
+        frames = read_frames(order)
+        same = all(numpy.array_equal(frames[f], sequential[f]) for f in order)
+        print("{} (frame cache {} MB): {}".format(name, cache_mb,
+              "match" if same else "MISMATCH"))
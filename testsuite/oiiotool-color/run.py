@@ -97,6 +97,16 @@ command += oiiotool ("--autocc ../common/tahoe-tiny.tif --ociolook \"ACES 1.3 Re
 # test various behaviors and misbehaviors related to OCIO configs.
 command += oiiotool ("--nostderr --colorconfig missing.ocio -echo \"Nonexistent config\"", failureok=True)
 
+# Declaring the color space and converting as part of the input, which
+# converts the pixels as they are decoded, must match doing it separately.
+linspace = "lin_srgb" if float(ociover) >= 2.2 else "linear"
+command += oiiotool ("-i:now=1:iscolorspace=sRGB:colorconvert=" + linspace
+                     + " ../common/tahoe-tiny.tif -d float -o incc-fused.exr")
+command += oiiotool ("../common/tahoe-tiny.tif --iscolorspace sRGB "
+                     + "--colorconvert sRGB " + linspace
+                     + " -d float -o incc-separate.exr")
+command += diff_command ("incc-fused.exr", "incc-separate.exr")
+
 
 # To add more tests, just append more lines like the above and also add
 # the new 'feature.tif' (or whatever you call it) to the outputs list,
@@ -207,6 +207,52 @@ command += oiiotool (
 command += oiiotool ("../common/tahoe-tiny.tif -sub ../common/tahoe-tiny.tif "
                      + "-echo \"postponed sub:\" --printinfo:stats=1:verbose=0")
 
+# Test --batch: several command lines run in one oiiotool process
+with open ("batchjobs.txt", "w") as f :
+    f.write ("# comment lines and blank lines are skipped\n\n" +
+             "--echo \"batch job one\"\n" +
+             "oiiotool ../common/tahoe-tiny.tif --echo \"batch job two: {TOP.width}x{TOP.height}\"\n" +
+             "../common/tahoe-tiny.tif --echo 'batch job three: {TOP.nchannels} channels'\n" +
+             "# options that change the shared cache are refused, so no echo\n" +
+             "--cache 64 --echo \"batch job four should not run\"\n")
+command += oiiotool ("-q --batch batchjobs.txt")
+
+# Test --parallel-branches: the result of two branches computed at the same
+# time must match computing them one after the other.
+branches = ("../common/tahoe-tiny.tif --resize 64x48 --blur 3x3 " +
+            "../common/tahoe-tiny.tif --resize 64x48 --invert --add -d uint8 ")
+command += oiiotool (branches + "-o parbranches-serial.tif")
+command += oiiotool ("--parallel-branches:maxbranches=2 " + branches +
+                     "-o parbranches.tif")
+command += oiiotool ("parbranches.tif parbranches-serial.tif --diff")
+# More branches than may run at once must still all be run, in the right
+# order, by the bounded pool of workers.
+branches = ("../common/tahoe-tiny.tif --resize 64x48 --blur 3x3 " +
+            "../common/tahoe-tiny.tif --resize 64x48 --invert " +
+            "../common/tahoe-tiny.tif --resize 64x48 --mulc 0.5 " +
+            "../common/tahoe-tiny.tif --resize 64x48 --median 3x3 " +
+            "--add --add --add -d uint8 ")
+command += oiiotool (branches + "-o parbranches4-serial.tif")
+command += oiiotool ("--parallel-branches:maxbranches=2 " + branches +
+                     "-o parbranches4.tif")
+command += oiiotool ("parbranches4.tif parbranches4-serial.tif --diff")
+# An error in a branch is reported, and stops the command line, from the
+# main thread: neither the op depending on it nor the output should run.
+command += oiiotool ("--parallel-branches:maxbranches=2 " +
+                     "../common/tahoe-tiny.tif --resize 64x48 " +
+                     "../common/tahoe-tiny.tif --median bogus " +
+                     "--add -o parfail.tif --echo \"should not be reached\"")
+
+# --async-writes: frames written in the background must match frames
+# written the usual way, and reading back an output waits for it.
+frame = "../common/tahoe-tiny.tif --addc 0.{FRAME_NUMBER} -d uint8 "
+command += oiiotool ("--frames 1-3 " + frame + "-o asyncserial.#.tif")
+command += oiiotool ("--frames 1-3 --async-writes:queue=2 " + frame +
+                     "-o async.#.tif")
+command += oiiotool ("async.0002.tif asyncserial.0002.tif --diff")
+command += oiiotool ("--async-writes ../common/tahoe-tiny.tif -o async.tif " +
+                     "async.tif ../common/tahoe-tiny.tif --diff")
+
 # To add more tests, just append more lines like the above and also add
 # the new 'feature.tif' (or whatever you call it) to the outputs list,
 # below.
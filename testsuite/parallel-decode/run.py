@@ -0,0 +1,40 @@
+#!/usr/bin/env python
+
+# Copyright Contributors to the OpenImageIO project.
+# SPDX-License-Identifier: Apache-2.0
+# https://github.com/AcademySoftwareFoundation/OpenImageIO
+
+# Readers that decode bands of scanlines, layer channels, or tiles in
+# parallel must match reading one scanline at a time (or one thread).
+
+redirect = " >> out.txt 2>&1 "
+
+# SGI, raw and RLE, 8 and 16 bit
+sgifiles = [ "../sgi/ref/" + f for f in
+             [ "norle-8.sgi", "rle-8.sgi", "norle-16.sgi", "rle-16.sgi" ] ]
+command += run_app (pythonbin + " src/compare_reads.py scanlines "
+                    + " ".join(sgifiles))
+
+# PSD: raw, RLE, and zip compressed layers
+psdfiles = [ OIIO_TESTSUITE_IMAGEDIR + "/psd/" + f for f in
+             [ "psd_rgb_8.psd", "psd_rgb_16_rle.psd", "psd_rgb_32.psd",
+               "psd_rgba_8.psd" ] ]
+psdfiles += [ "../psd/src/" + f for f in
+              [ "layer-mask.psd", "Layers_8bit_RGB.psd",
+                "Layers_16bit_RGB.psd", "Layers_32bit_RGB.psd" ] ]
+command += run_app (pythonbin + " src/compare_reads.py scanlines "
+                    + " ".join(psdfiles))
+command += run_app (pythonbin + " src/compare_reads.py threads "
+                    + " ".join(psdfiles[4:]))
+
+# IFF: many tiles, decoded in parallel
+command += oiiotool (OIIO_TESTSUITE_IMAGEDIR + "/grid.tif --tile 64 64 -o gridtile.iff")
+command += run_app (pythonbin + " src/compare_reads.py threads gridtile.iff")
+
+# DPX and Cineon: 10 bit data unpacked a band of scanlines at a time
+dpxfiles = [ OIIO_TESTSUITE_IMAGEDIR + "/cineon/checker.cin",
+             OIIO_TESTSUITE_IMAGEDIR + "/dpx/dpx_nuke_10bits_rgb.dpx" ]
+command += run_app (pythonbin + " src/compare_reads.py scanlines "
+                    + " ".join(dpxfiles))
+command += run_app (pythonbin + " src/compare_reads.py bitpack "
+                    + " ".join(dpxfiles))
@@ -0,0 +1,90 @@
+#!/usr/bin/env python
+
+# Copyright Contributors to the OpenImageIO project.
+# SPDX-License-Identifier: Apache-2.0
+# https://github.com/AcademySoftwareFoundation/OpenImageIO
+
+# Make sure that the readers which decode many scanlines (or tiles) in
+# parallel get the same pixels as reading one scanline at a time, or
+# decoding with a single thread, or (for DPX and Cineon) unpacking one
+# pixel at a time.
+
+from __future__ import annotations
+
+import os
+import sys
+
+import numpy as np
+
+import OpenImageIO as oiio
+
+
+def read_all (filename: str) :
+    inp = oiio.ImageInput.open (filename)
+    if not inp :
+        print ("Could not open", filename, ":", oiio.geterror())
+        return None
+    images = []
+    sub = 0
+    while inp.seek_subimage (sub, 0) :
+        images.append (inp.read_image (oiio.FLOAT))
+        sub += 1
+    inp.close ()
+    return images
+
+
+def compare_scanlines (filename: str) :
+    inp = oiio.ImageInput.open (filename)
+    if not inp :
+        print ("Could not open", filename, ":", oiio.geterror())
+        return
+    sub = 0
+    while inp.seek_subimage (sub, 0) :
+        spec = inp.spec ()
+        whole = inp.read_image (oiio.FLOAT)
+        rows = [ inp.read_scanline (y, spec.z, oiio.FLOAT)
+                 for y in range (spec.y, spec.y + spec.height) ]
+        ymid = spec.y + spec.height // 3
+        band = inp.read_scanlines (ymid, spec.y + spec.height, spec.z,
+                                   0, spec.nchannels, oiio.FLOAT)
+        ok = (whole is not None
+              and np.array_equal (whole, np.stack (rows))
+              and np.array_equal (whole[ymid-spec.y:], band))
+        print ("{} subimage {}: whole image {} scanlines".format (
+               os.path.basename(filename), sub, "matches" if ok else "DOES NOT MATCH"))
+        sub += 1
+    inp.close ()
+
+
+def compare_threads (filename: str) :
+    whole = read_all (filename)
+    oiio.attribute ("threads", 1)
+    single = read_all (filename)
+    oiio.attribute ("threads", 0)
+    ok = (whole is not None and single is not None
+          and len(whole) == len(single)
+          and all(np.array_equal (a, b) for a, b in zip(whole, single)))
+    print ("{}: parallel decode {} single thread".format (
+           os.path.basename(filename), "matches" if ok else "DOES NOT MATCH"))
+
+
+def compare_bitpack (filename: str) :
+    whole = read_all (filename)
+    oiio.attribute ("dpx:bitpack_bands", 0)
+    single = read_all (filename)
+    oiio.attribute ("dpx:bitpack_bands", 1)
+    ok = (whole is not None and single is not None
+          and len(whole) == len(single)
+          and all(np.array_equal (a, b) for a, b in zip(whole, single)))
+    print ("{}: band unpacking {} pixel at a time".format (
+           os.path.basename(filename), "matches" if ok else "DOES NOT MATCH"))
+
+
+mode = sys.argv[1]
+for f in sys.argv[2:] :
+    if mode == "scanlines" :
+        compare_scanlines (f)
+    elif mode == "bitpack" :
+        compare_bitpack (f)
+    else :
+        compare_threads (f)
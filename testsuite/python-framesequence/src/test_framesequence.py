@@ -0,0 +1,90 @@
+#!/usr/bin/env python
+
+# Copyright Contributors to the OpenImageIO project.
+# SPDX-License-Identifier: Apache-2.0
+# https://github.com/AcademySoftwareFoundation/OpenImageIO
+
+from __future__ import annotations
+
+import os
+
+import OpenImageIO as oiio
+
+
+# Write frames 1..n of a small sequence, each filled with a value that
+# tells which frame it is.
+def create_sequence (n: int) :
+    if not os.path.exists ("seq") :
+        os.mkdir ("seq")
+    for f in range (1, n+1) :
+        buf = oiio.ImageBuf (oiio.ImageSpec (16, 8, 3, "uint8"))
+        oiio.ImageBufAlgo.fill (buf, (f / 255.0, 0.5, 1.0))
+        buf.write ("seq/seq.{:04d}.tif".format(f))
+
+
+# Which frame does this image hold?
+def frame_value (buf) :
+    if buf is None :
+        return None
+    return int (buf.getpixel (0, 0)[0] * 255.0 + 0.5)
+
+
+
+######################################################################
+# main test starts here
+
+try:
+    create_sequence (4)
+
+    seq = oiio.FrameSequenceReader ()
+    seq.set_readahead (2)
+    seq.set_memory_limit (16)
+    print ("open:", seq.open ("seq/seq.1-4#.tif"))
+    print ("is_open:", seq.is_open ())
+    print ("nframes:", seq.nframes)
+    print ("frame_number(2):", seq.frame_number (2))
+    print ("filename(2):", seq.filename (2))
+    spec = seq.spec (0)
+    print ("spec(0): {}x{} {} channels {}".format (spec.width, spec.height,
+           spec.nchannels, spec.format))
+    for i in range (seq.nframes) :
+        print ("  next holds frame", frame_value (seq.next ()))
+    print ("past the end:", seq.next ())
+    seq.seek (1)
+    print ("after seek(1), position", seq.position, "holds frame",
+           frame_value (seq.next ()), "and position is now", seq.position)
+    seq.close ()
+    print ("after close, is_open:", seq.is_open ())
+    print ("")
+
+    # An explicit frame range, read as float
+    seq.set_format ("float")
+    print ("open with framespec:", seq.open ("seq/seq.%04d.tif", "4-1x2"))
+    print ("frame numbers:", [ seq.frame_number (i) for i in range (seq.nframes) ])
+    frame = seq.next ()
+    print ("first frame holds", frame_value (frame), "as", frame.spec().format)
+    print ("")
+
+    # A list of files, one of which is missing. It fails when its turn
+    # comes, and reading carries on with the next one.
+    seq.set_format ("unknown")
+    print ("open_files:", seq.open_files ([ "seq/seq.0002.tif",
+                                            "seq/missing.tif",
+                                            "seq/seq.0003.tif" ],
+                                          [ 10, 20, 30 ]))
+    print ("frame numbers:", [ seq.frame_number (i) for i in range (seq.nframes) ])
+    print ("spec(1):", seq.spec (1))
+    seq.geterror ()
+    print ("  next holds frame", frame_value (seq.next ()))
+    print ("  missing frame:", seq.next (), "has_error:", seq.has_error ())
+    seq.geterror ()
+    print ("  next holds frame", frame_value (seq.next ()))
+    print ("has_error:", seq.has_error ())
+    print ("")
+
+    print ("open of a non-pattern fails:", seq.open ("seq/notapattern.tif"))
+    seq.geterror ()
+
+    print ("Done.")
+except Exception as detail:
+    print ("Unknown exception:", detail)
@@ -223,6 +223,92 @@ def test_outofrange_subimage_miplevel() :
 
 
 
+# Test numpy views of ImageBuf pixels, and ImageBufs wrapping numpy arrays,
+# neither of which should copy the pixels.
+def test_numpy_views() :
+    print("\nTesting numpy views and wrapped arrays")
+    b = oiio.ImageBuf (oiio.ImageSpec(4, 3, 2, oiio.UINT8))
+    v = numpy.asarray (b)
+    print("  view shape", v.shape, "dtype", v.dtype)
+    v[1, 2, 1] = 255
+    print("  pixel (2,1) after writing the view:", b.getpixel(2, 1))
+    oiio.ImageBufAlgo.fill (b, (0.0, 1.0))
+    print("  view after filling the ImageBuf:", v[0, 0].tolist(), v[2, 3].tolist())
+    a = numpy.zeros ((2, 3, 3), dtype="float32")
+    w = oiio.ImageBuf.wrap (a)
+    print("  wrapped array:", w.spec().format, w.roi)
+    oiio.ImageBufAlgo.fill (w, (0.25, 0.5, 1.0))
+    print("  array after filling the ImageBuf:", a[1, 2].tolist())
+    del a
+    print("  pixel (0,0) after deleting the array:", w.getpixel(0, 0))
+    r = numpy.ones ((2, 2, 1), dtype="float32")
+    r.flags.writeable = False
+    rv = numpy.asarray (oiio.ImageBuf.wrap (r))
+    print("  view of wrapped read-only array is writeable:", rv.flags.writeable)
+    spec = oiio.ImageSpec (2, 2, 1, oiio.FLOAT)
+    spec.deep = True
+    try :
+        numpy.asarray (oiio.ImageBuf (spec))
+        print("  deep image view: no error")
+    except BufferError :
+        print("  deep image view: BufferError")
+
+
+
+# While a numpy view of an ImageBuf's pixels is alive, anything that would
+# reallocate them must raise rather than leave the view dangling.
+def test_numpy_view_reallocation() :
+    print("\nTesting reallocating ImageBuf pixels under a numpy view")
+    b = oiio.ImageBuf ("../common/tahoe-tiny.tif")
+    b.read (force=True)
+    v = numpy.asarray (b)
+    row = v[1]
+    del v   # row still refers to the pixels
+    other = oiio.ImageBuf (oiio.ImageSpec(2, 2, 3, oiio.UINT8))
+    for name, call in [
+            ("reset", lambda: b.reset (oiio.ImageSpec(64, 64, 3, oiio.FLOAT))),
+            ("reset from file", lambda: b.reset ("../common/grid-small.exr")),
+            ("clear", lambda: b.clear ()),
+            ("read", lambda: b.read (force=True, convert=oiio.FLOAT)),
+            ("copy", lambda: b.copy (other)),
+            ("swap", lambda: other.swap (b)),
+            ("ImageBufAlgo.channels", lambda: oiio.ImageBufAlgo.channels (b, other, (0,))),
+            ("ImageBufAlgo.crop", lambda: oiio.ImageBufAlgo.crop (b, other)),
+            ("ImageBufAlgo.reorient", lambda: oiio.ImageBufAlgo.reorient (b, other)),
+            ("ImageBufAlgo.flatten", lambda: oiio.ImageBufAlgo.flatten (b, other)) ] :
+        try :
+            call ()
+            print("  {}: no error".format(name))
+        except BufferError :
+            print("  {}: BufferError".format(name))
+    print("  view still matches the pixels:",
+          bool((row == b.get_pixels(oiio.UINT8)[1]).all()))
+    del row
+    b.reset (oiio.ImageSpec(2, 2, 1, oiio.UINT8))
+    print("  reset after the view is gone:", b.roi)
+
+
+
+# Test write_async: each write sees the image as it was when it was queued,
+# and failures are only reported by wait_for_async_writes.
+def test_write_async() :
+    print("\nTesting write_async")
+    b = oiio.ImageBuf (oiio.ImageSpec(8, 8, 3, oiio.UINT8))
+    for i in range(3) :
+        oiio.ImageBufAlgo.fill (b, (0.4 * i, 0.2, 1.0))
+        b.write_async ("async{}.tif".format(i))
+    oiio.ImageBufAlgo.zero (b)
+    print("  wait_for_async_writes:", oiio.ImageBuf.wait_for_async_writes())
+    for i in range(3) :
+        r = oiio.ImageBuf ("async{}.tif".format(i))
+        print("  async{}.tif pixel (3,3): {}".format(i, ftupstr(r.getpixel(3, 3))))
+    print("  queued a write to a missing directory:",
+          b.write_async ("no-such-dir/async.tif"))
+    print("  wait_for_async_writes:", oiio.ImageBuf.wait_for_async_writes())
+    print("  the failure was reported:", len(oiio.geterror()) > 0)
+    print("  wait_for_async_writes again:", oiio.ImageBuf.wait_for_async_writes())
+
+
 ######################################################################
 # main test starts here
 
@@ -334,6 +420,9 @@ try:
     test_copy_metadata ()
     test_repr_png ()
     test_outofrange_subimage_miplevel ()
+    test_numpy_views ()
+    test_numpy_view_reallocation ()
+    test_write_async ()
 
     print ("\nDone.")
 except Exception as detail:
@@ -0,0 +1,19 @@
+#!/usr/bin/env python
+
+# Copyright Contributors to the OpenImageIO project.
+# SPDX-License-Identifier: Apache-2.0
+# https://github.com/AcademySoftwareFoundation/OpenImageIO
+
+# Check EWA texture lookups against results known in advance. The texture's
+# first channel is vertical stripes 8 texels wide, alternating 0 and 1, and
+# its other two channels ramp linearly in s and t. 'testtex --ewatest' then
+# checks that an ellipse stretched along a stripe sees only that stripe,
+# that one stretched across the stripes averages them to 1/2 at any angle,
+# and that the ramps (and roughly, their slopes) come out right at the
+# center of the ellipse.
+
+command += oiiotool ("--pattern checker:width=8:height=256:color1=0:color2=1 256x256 1 " +
+                     "--pattern fill:topleft=0,0:topright=1,0:bottomleft=0,1:bottomright=1,1 256x256 2 " +
+                     "--chappend -d float -otex:filter=box ewa.tx")
+command += testtex_command ("ewa.tx", "--ewatest")
+outputs = [ "out.txt" ]